@@ -10,43 +10,69 @@ import json
 # Thresholds based on articles like:
 # https://hbr.org/2020/04/what-makes-an-office-building-healthy
 #
+
+# A still desk reads about 1 mg of activity; typing or moving raises it.
+PRESENCE_ACTIVITY = 3.0
+
+# What the device heard most in the last second, by its sound_class_t number
+NOISE_SOURCES = {1: "talking", 2: "the air conditioning", 3: "typing", 4: "music"}
+
 def lambda_handler(event, context):
     deviceShadowClient = boto3.client('iot-data')
     
     # TODO(caterpillai): squash input using incoming rule
     reported = event['state']['reported']
     temperature = reported['temperature']
+    # A-weighted levels in dBA: the 1 s average (LAeq) and its loudest moment (LAFmax)
     sound = reported['noiseLevel']
+    soundPeak = reported.get('noisePeak', sound)
+    noiseSource = NOISE_SOURCES.get(reported.get('noiseType'))
     light = reported['lightIntensity']
+    # Percent flicker of the lighting, 0 for steady light or devices without it
+    flicker = reported.get('flickerPercent', 0)
+    flickerFrequency = reported.get('flickerFrequency', 0)
     tvoc = reported['tvoc']
     eCO2 = reported['eCO2']
+    # RMS of the desk's motion in milli-g; devices without it count as occupied
+    activity = reported.get('activity', PRESENCE_ACTIVITY)
     
     notifications = []
+    # Comfort recommendations only matter when someone is at the desk
+    present = activity >= PRESENCE_ACTIVITY
     
     if (temperature >= 100):
         notifications.append("Dangerously high temperature!")
-    elif (temperature >= 80):
+    elif (temperature >= 80 and present):
         notifications.append("Its a little warm in here.")
-    elif (temperature < 70):
+    elif (temperature < 70 and present):
         notifications.append("Its a little chilly in here.")
     elif (temperature < 55):
         notifications.append("Dangerously low temperature!")
     
-    if (sound >= 200):
+    # 85 dBA is the usual limit for hearing damage; focused work wants under 55
+    if (sound >= 85 or soundPeak >= 100):
         notifications.append("Dangerously high levels of noise!")
-    elif (sound >= 50):
+    elif (sound >= 55 and present and noiseSource):
+        notifications.append("Its a little too noisy (mostly %s)." % noiseSource)
+    elif (sound >= 55 and present):
         notifications.append("Its a little too noisy.")
     
-    # Assumes that the regular resistance numbers are being sent back for now
-    # TODO(caterpillai): change to handle lumens
-    if (light >= 2250):
+    # Illuminance in lux (desk work is usually lit at 300-500 lux)
+    if (light <= 100 and present):
         notifications.append("Its a little too dark in here.")
-    elif (light <= 1000):
+    elif (light >= 2000 and present):
         notifications.append("Its a little too bright in here.")
+
+    # IEEE 1789 low-risk limit: percent flicker under 0.08 x frequency from
+    # 90 Hz (8% at 100 Hz), and under 0.025 x frequency below that.
+    flickerLimit = flickerFrequency * (0.08 if flickerFrequency >= 90 else 0.025)
+    if (flickerFrequency > 0 and flicker >= flickerLimit and present):
+        notifications.append("The lights are flickering (%d Hz) - try another lamp or driver." % flickerFrequency)
         
-    if (tvoc >= 20):
+    # Assumes ppb
+    if (tvoc >= 2200):
         notifications.append("Dangerous air quality levels!")
-    elif (tvoc >= 5):
+    elif (tvoc >= 660):
         notifications.append("TVOC is a little high.")
         
     # Assumes ppm
@@ -0,0 +1,70 @@
+#include "adc_filter.h"
+
+#define ADC_CAL_LUT_STEP (1u << ADC_CAL_LUT_SHIFT)
+
+static void sort_samples(uint16_t *samples, size_t count) {
+    // Insertion sort: bursts are small and usually nearly sorted already.
+    for (size_t i = 1; i < count; i++) {
+        uint16_t value = samples[i];
+        size_t j = i;
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+}
+
+uint16_t AdcFilter_Median(uint16_t *samples, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    sort_samples(samples, count);
+    if (count % 2) {
+        return samples[count / 2];
+    }
+    return (samples[count / 2 - 1] + samples[count / 2] + 1) / 2;
+}
+
+uint16_t AdcFilter_TrimmedMean(uint16_t *samples, size_t count, size_t trim) {
+    if (2 * trim >= count) {
+        return AdcFilter_Median(samples, count);
+    }
+    sort_samples(samples, count);
+
+    uint32_t sum = 0;
+    size_t kept = count - 2 * trim;
+    for (size_t i = trim; i < count - trim; i++) {
+        sum += samples[i];
+    }
+    return (sum + kept / 2) / kept;
+}
+
+void AdcCalLut_Build(adc_cal_lut_t *lut, adc_cal_convert_fn_t convert, void *context) {
+    for (size_t i = 0; i < ADC_CAL_LUT_SIZE; i++) {
+        uint32_t raw = i * ADC_CAL_LUT_STEP;
+        // The last entry extrapolates the final segment up to the max code.
+        if (raw > ADC_CAL_LUT_MAX_RAW) {
+            raw = ADC_CAL_LUT_MAX_RAW;
+        }
+        lut->millivolts[i] = convert(raw, context);
+    }
+}
+
+uint32_t AdcCalLut_ToMilliVolts(const adc_cal_lut_t *lut, uint32_t raw) {
+    if (raw > ADC_CAL_LUT_MAX_RAW) {
+        raw = ADC_CAL_LUT_MAX_RAW;
+    }
+
+    size_t index = raw >> ADC_CAL_LUT_SHIFT;
+    uint32_t base = index * ADC_CAL_LUT_STEP;
+    uint32_t next = base + ADC_CAL_LUT_STEP;
+    if (next > ADC_CAL_LUT_MAX_RAW) {
+        next = ADC_CAL_LUT_MAX_RAW;
+    }
+
+    int32_t low = lut->millivolts[index];
+    int32_t high = lut->millivolts[index + 1];
+    int32_t span = next - base;
+    return low + ((high - low) * (int32_t)(raw - base) + span / 2) / span;
+}
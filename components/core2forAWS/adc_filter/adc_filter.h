@@ -0,0 +1,101 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of raw samples in one oversampled ADC burst.
+ */
+/* @[declare_adc_filter_max_samples] */
+#define ADC_FILTER_MAX_SAMPLES 64
+/* @[declare_adc_filter_max_samples] */
+
+/**
+ * @brief Spacing (as a power of two) of the raw codes stored in the
+ * calibration lookup table.
+ *
+ * The ESP32 ADC calibration curve is piecewise linear, so storing every
+ * 32nd code and interpolating in between reproduces it to within a
+ * millivolt while keeping the table small.
+ */
+/* @[declare_adc_cal_lut_shift] */
+#define ADC_CAL_LUT_SHIFT 5
+/* @[declare_adc_cal_lut_shift] */
+
+/**
+ * @brief Maximum raw ADC code (12-bit width).
+ */
+/* @[declare_adc_cal_lut_max_raw] */
+#define ADC_CAL_LUT_MAX_RAW 4095
+/* @[declare_adc_cal_lut_max_raw] */
+
+#define ADC_CAL_LUT_SIZE ((ADC_CAL_LUT_MAX_RAW >> ADC_CAL_LUT_SHIFT) + 2)
+
+/**
+ * @brief Raw ADC code to millivolt lookup table.
+ */
+/* @[declare_adc_cal_lut_t] */
+typedef struct {
+    uint16_t millivolts[ADC_CAL_LUT_SIZE];
+} adc_cal_lut_t;
+/* @[declare_adc_cal_lut_t] */
+
+/**
+ * @brief Converts one raw ADC code to millivolts. Used to build the
+ * lookup table, e.g. a wrapper around `esp_adc_cal_raw_to_voltage`.
+ */
+typedef uint32_t (*adc_cal_convert_fn_t)(uint32_t raw, void *context);
+
+/**
+ * @brief Reduces a burst of raw ADC samples to one value with a trimmed mean.
+ *
+ * Sorts the samples, drops the `trim` lowest and `trim` highest ones and
+ * averages the rest (rounded to the nearest code). Dropping the extremes
+ * rejects the spikes single ESP32 ADC reads are prone to. If `trim` leaves
+ * fewer than one sample, the median is returned instead.
+ *
+ * @note The samples are sorted in place.
+ *
+ * @param[in,out] samples The raw samples.
+ * @param[in] count The number of samples (at most ADC_FILTER_MAX_SAMPLES).
+ * @param[in] trim The number of samples dropped from each end.
+ *
+ * @return the decimated raw value, or 0 if `count` is 0.
+ */
+/* @[declare_adcfilter_trimmedmean] */
+uint16_t AdcFilter_TrimmedMean(uint16_t *samples, size_t count, size_t trim);
+/* @[declare_adcfilter_trimmedmean] */
+
+/**
+ * @brief Returns the median of a burst of raw ADC samples (the mean of the
+ * two middle samples for an even count).
+ *
+ * @note The samples are sorted in place.
+ */
+/* @[declare_adcfilter_median] */
+uint16_t AdcFilter_Median(uint16_t *samples, size_t count);
+/* @[declare_adcfilter_median] */
+
+/**
+ * @brief Fills the calibration lookup table by calling `convert` once per
+ * stored raw code.
+ */
+/* @[declare_adccallut_build] */
+void AdcCalLut_Build(adc_cal_lut_t *lut, adc_cal_convert_fn_t convert, void *context);
+/* @[declare_adccallut_build] */
+
+/**
+ * @brief Converts a raw ADC code to millivolts by interpolating the
+ * calibration lookup table.
+ */
+/* @[declare_adccallut_tomillivolts] */
+uint32_t AdcCalLut_ToMilliVolts(const adc_cal_lut_t *lut, uint32_t raw);
+/* @[declare_adccallut_tomillivolts] */
+
+#ifdef __cplusplus
+}
+#endif
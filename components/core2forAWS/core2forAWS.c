@@ -21,6 +21,7 @@
 
 #define DEFAULT_VREF    1100
 static esp_adc_cal_characteristics_t *adc_characterization;
+static adc_cal_lut_t *adc_calibration_lut;
 
 #define ADC_CHANNEL ADC1_CHANNEL_0
 #define ADC_WIDTH ADC_WIDTH_BIT_12
@@ -397,6 +398,10 @@ static void guiTask(void *pvParameter) {
 /* ----------------------------------------- Expansion Ports -----------------------------------------*/
 #if CONFIG_SOFTWARE_EXPPORTS_SUPPORT
 
+static uint32_t adc_raw_to_millivolts(uint32_t raw, void *characterization){
+    return esp_adc_cal_raw_to_voltage(raw, characterization);
+}
+
 static esp_err_t check_pins(gpio_num_t pin, pin_mode_t mode){
     esp_err_t err = ESP_ERR_NOT_SUPPORTED;
     if (pin != PORT_A_SDA_PIN && pin != PORT_A_SCL_PIN && pin != PORT_B_ADC_PIN && pin != PORT_B_DAC_PIN && pin != PORT_C_UART_RX_PIN && pin != PORT_C_UART_TX_PIN)
@@ -472,8 +477,12 @@ esp_err_t Core2ForAWS_Port_PinMode(gpio_num_t pin, pin_mode_t mode){
             ESP_LOGE(TAG, "Error configuring ADC channel attenuation on pin %d. Error code: 0x%x.", pin, err);
         }
         
-        adc_characterization = calloc(1, sizeof(esp_adc_cal_characteristics_t));
+        if (adc_characterization == NULL) {
+            adc_characterization = calloc(1, sizeof(esp_adc_cal_characteristics_t));
+            adc_calibration_lut = calloc(1, sizeof(adc_cal_lut_t));
+        }
         esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTENUATION, ADC_WIDTH, DEFAULT_VREF, adc_characterization);
+        AdcCalLut_Build(adc_calibration_lut, adc_raw_to_millivolts, adc_characterization);
     }
     else if (mode == DAC){
         dac_output_enable(DAC_CHANNEL);
@@ -542,6 +551,34 @@ uint32_t Core2ForAWS_Port_B_ADC_ReadMilliVolts(void){
     return voltage;
 }
 
+uint32_t Core2ForAWS_Port_B_ADC_ReadMilliVoltsOversampled(uint16_t samples, uint16_t trim){
+    uint16_t burst[ADC_FILTER_MAX_SAMPLES];
+    if (samples == 0 || samples > ADC_FILTER_MAX_SAMPLES){
+        ESP_LOGE(TAG, "Oversampling supports 1 to %d samples, requested: %d", ADC_FILTER_MAX_SAMPLES, samples);
+        return 0;
+    }
+
+    size_t count = 0;
+    for (uint16_t i = 0; i < samples; i++){
+        int raw = adc1_get_raw(ADC_CHANNEL);
+        if (raw >= 0){
+            burst[count++] = raw;
+        }
+    }
+    if (count == 0){
+        ESP_LOGE(TAG, "Failed to read ADC channel %d.", ADC_CHANNEL);
+        return 0;
+    }
+
+    // Trim in proportion to the samples that were actually read.
+    size_t kept_trim = (size_t)trim * count / samples;
+    return AdcCalLut_ToMilliVolts(adc_calibration_lut, AdcFilter_TrimmedMean(burst, count, kept_trim));
+}
+
+uint32_t Core2ForAWS_Port_B_ADC_RawToMilliVolts(uint32_t raw){
+    return AdcCalLut_ToMilliVolts(adc_calibration_lut, raw);
+}
+
 esp_err_t Core2ForAWS_Port_B_DAC_WriteMilliVolts(uint16_t mvolts){
     esp_err_t err = dac_output_voltage(DAC_CHANNEL, mvolts);
     return err;
@@ -105,6 +105,7 @@ extern SemaphoreHandle_t xGuiSemaphore;
 #include "driver/gpio.h"
 #include "driver/uart.h"
 #include "i2c_device.h"
+#include "adc_filter.h"
 
 /**
  * @brief The I2C SDA pin on expansion port A.
@@ -1218,6 +1219,60 @@ uint32_t Core2ForAWS_Port_B_ADC_ReadRaw(void);
 uint32_t Core2ForAWS_Port_B_ADC_ReadMilliVolts(void);
 /* @[declare_core2foraws_port_b_adc_readmillivolts] */
 
+/**
+ * @brief Read the calibrated ADC voltage from GPIO36, oversampled.
+ *
+ * @note pin_mode_t for PORT_B_ADC_PIN must be set to ADC before using
+ * Core2ForAWS_Port_B_ADC_ReadMilliVoltsOversampled.
+ *
+ * This function reads a burst of `samples` raw values from Port B's
+ * Analog-to-Digital-Converter (ADC) on GPIO36, back to back, and
+ * decimates them with a trimmed mean: the `trim` lowest and `trim`
+ * highest readings are dropped and the rest are averaged (a `trim` of at
+ * least half the samples yields the median). The result is converted to
+ * millivolts through a calibration lookup table that is built from the
+ * eFuse VRef calibration when the pin mode is set, so no calibration
+ * math runs per reading.
+ *
+ * Single ESP32 ADC reads are noisy and prone to spikes; a burst of 16
+ * samples with a trim of 4 takes well under a millisecond and is much
+ * more stable than Core2ForAWS_Port_B_ADC_ReadMilliVolts.
+ *
+ * **Example:**
+ * @code{c}
+ *  ESP_LOGI(TAG, "Moisture ADC converted to voltage: %d",
+ *      Core2ForAWS_Port_B_ADC_ReadMilliVoltsOversampled(16, 4));
+ * @endcode
+ *
+ * @param[in] samples The number of raw reads, 1 to ADC_FILTER_MAX_SAMPLES.
+ * @param[in] trim The number of reads dropped from each end of the sorted burst.
+ *
+ * @return the voltage reading from the ADC in millivolts, or 0 on error.
+ */
+/* @[declare_core2foraws_port_b_adc_readmillivoltsoversampled] */
+uint32_t Core2ForAWS_Port_B_ADC_ReadMilliVoltsOversampled(uint16_t samples, uint16_t trim);
+/* @[declare_core2foraws_port_b_adc_readmillivoltsoversampled] */
+
+/**
+ * @brief Converts a raw reading from Core2ForAWS_Port_B_ADC_ReadRaw to
+ * millivolts.
+ *
+ * @note pin_mode_t for PORT_B_ADC_PIN must be set to ADC before using
+ * Core2ForAWS_Port_B_ADC_RawToMilliVolts.
+ *
+ * Uses the same calibration lookup table as
+ * Core2ForAWS_Port_B_ADC_ReadMilliVoltsOversampled, so raw samples taken
+ * where the conversion would be too slow (e.g. from a timer callback) can
+ * be converted afterwards.
+ *
+ * @param[in] raw The raw 12-bit ADC reading.
+ *
+ * @return the voltage in millivolts.
+ */
+/* @[declare_core2foraws_port_b_adc_rawtomillivolts] */
+uint32_t Core2ForAWS_Port_B_ADC_RawToMilliVolts(uint32_t raw);
+/* @[declare_core2foraws_port_b_adc_rawtomillivolts] */
+
 /**
  * @brief Outputs the specified voltage (millivolts) to the DAC.
  *
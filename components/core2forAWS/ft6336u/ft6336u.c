@@ -22,6 +22,8 @@ static void FT6336U_UpdateTask(void *arg);
 
 void FT6336U_Init() {
     ft6336u_i2c = i2c_malloc_device(I2C_NUM_1, 21, 22, 400000, FT6336U_I2C_ADDR);
+    // Touch polling yields the shared bus to the other devices.
+    i2c_device_set_priority(ft6336u_i2c, I2C_PRIORITY_LOW);
     i2c_write_byte(ft6336u_i2c, 0xa4, 0x00);
     
     thread_mutex = xSemaphoreCreateMutex();
@@ -0,0 +1,51 @@
+#include <stddef.h>
+
+#include "i2c_arbiter.h"
+
+// True if `a` must be served before `b`.
+static bool serve_before(const i2c_waiter_t *a, const i2c_waiter_t *b) {
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    if (a->has_deadline != b->has_deadline) {
+        return a->has_deadline;
+    }
+    return a->has_deadline && i2c_tick_before(a->deadline, b->deadline);
+}
+
+void i2c_wait_queue_insert(i2c_wait_queue_t *queue, i2c_waiter_t *waiter) {
+    // Equal waiters keep their arrival order.
+    i2c_waiter_t **link = &queue->head;
+    while (*link != NULL && !serve_before(waiter, *link)) {
+        link = &(*link)->next;
+    }
+    waiter->next = *link;
+    *link = waiter;
+}
+
+bool i2c_wait_queue_remove(i2c_wait_queue_t *queue, i2c_waiter_t *waiter) {
+    for (i2c_waiter_t **link = &queue->head; *link != NULL; link = &(*link)->next) {
+        if (*link == waiter) {
+            *link = waiter->next;
+            waiter->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+i2c_waiter_t *i2c_wait_queue_pop(i2c_wait_queue_t *queue) {
+    i2c_waiter_t *waiter = queue->head;
+    if (waiter != NULL) {
+        queue->head = waiter->next;
+        waiter->next = NULL;
+    }
+    return waiter;
+}
+
+i2c_bus_change_t i2c_bus_config_change(const i2c_bus_config_t *applied, const i2c_bus_config_t *requested) {
+    if (applied == NULL || applied->sda != requested->sda || applied->scl != requested->scl) {
+        return I2C_BUS_REINSTALL;
+    }
+    return applied->freq != requested->freq ? I2C_BUS_SET_CLOCK : I2C_BUS_UNCHANGED;
+}
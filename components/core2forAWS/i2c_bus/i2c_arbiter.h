@@ -0,0 +1,105 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief A task waiting for an I2C port.
+ *
+ * Waiters live on the waiting task's stack and are linked into the
+ * port's wait queue. They are served by descending priority, then by
+ * earliest deadline, then in arrival order. Waiters without a deadline
+ * are served after waiters of the same priority that have one.
+ */
+/* @[declare_i2c_waiter_t] */
+typedef struct i2c_waiter {
+    struct i2c_waiter *next;
+    uint8_t priority;
+    bool has_deadline;
+    uint32_t deadline;
+    void *owner;
+    volatile bool granted;
+} i2c_waiter_t;
+/* @[declare_i2c_waiter_t] */
+
+/* @[declare_i2c_wait_queue_t] */
+typedef struct {
+    i2c_waiter_t *head;
+} i2c_wait_queue_t;
+/* @[declare_i2c_wait_queue_t] */
+
+/**
+ * @brief The pins and clock an I2C port is configured with.
+ */
+/* @[declare_i2c_bus_config_t] */
+typedef struct {
+    int sda;
+    int scl;
+    uint32_t freq;
+} i2c_bus_config_t;
+/* @[declare_i2c_bus_config_t] */
+
+/**
+ * @brief What has to be done to switch a port to a new configuration.
+ *
+ * Only a change of pins needs the driver to be reinstalled; a new clock
+ * can be applied to the installed driver.
+ */
+/* @[declare_i2c_bus_change_t] */
+typedef enum {
+    I2C_BUS_UNCHANGED,
+    I2C_BUS_SET_CLOCK,
+    I2C_BUS_REINSTALL,
+} i2c_bus_change_t;
+/* @[declare_i2c_bus_change_t] */
+
+/**
+ * @brief Compares two tick counts that may have wrapped around.
+ *
+ * @return true if `a` is strictly before `b`.
+ */
+/* @[declare_i2c_tick_before] */
+static inline bool i2c_tick_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+/* @[declare_i2c_tick_before] */
+
+/**
+ * @brief Adds a waiter to the queue in service order.
+ */
+/* @[declare_i2c_wait_queue_insert] */
+void i2c_wait_queue_insert(i2c_wait_queue_t *queue, i2c_waiter_t *waiter);
+/* @[declare_i2c_wait_queue_insert] */
+
+/**
+ * @brief Removes a waiter, e.g. one whose deadline passed.
+ *
+ * @return false if the waiter was not queued.
+ */
+/* @[declare_i2c_wait_queue_remove] */
+bool i2c_wait_queue_remove(i2c_wait_queue_t *queue, i2c_waiter_t *waiter);
+/* @[declare_i2c_wait_queue_remove] */
+
+/**
+ * @brief Removes and returns the waiter to serve next, or NULL.
+ */
+/* @[declare_i2c_wait_queue_pop] */
+i2c_waiter_t *i2c_wait_queue_pop(i2c_wait_queue_t *queue);
+/* @[declare_i2c_wait_queue_pop] */
+
+/**
+ * @brief Decides how to switch a port from `applied` to `requested`.
+ *
+ * Pass NULL as `applied` if no driver is installed on the port.
+ */
+/* @[declare_i2c_bus_config_change] */
+i2c_bus_change_t i2c_bus_config_change(const i2c_bus_config_t *applied, const i2c_bus_config_t *requested);
+/* @[declare_i2c_bus_config_change] */
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,11 +1,15 @@
 
+#include <string.h>
+
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #include "driver/i2c.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 
+#include "i2c_arbiter.h"
 #include "i2c_device.h"
 
 #define TAG "I2C-DEVICE"
@@ -30,53 +34,278 @@
 
 #define I2C_TIMEOUT_MS (100)
 
-typedef struct _i2c_port_obj_t {
-    i2c_port_t port;
-    gpio_num_t scl;
-    gpio_num_t sda;
-    uint32_t freq;
-} i2c_port_obj_t;
-
 typedef struct _i2c_device_t {
-    i2c_port_obj_t* i2c_port;
+    i2c_port_t port;
+    i2c_bus_config_t bus;
     uint8_t addr;
+    i2c_priority_t priority;
+    i2c_device_stats_t stats;
 } i2c_device_t;
 
-static SemaphoreHandle_t i2c_mutex[I2C_NUM_MAX];
-static i2c_port_obj_t *i2c_port_used[2] = { NULL, NULL };
+/*
+    A port is owned by one task at a time. Tasks that find it owned
+    wait in a queue ordered by transaction priority and deadline, and
+    the releasing task hands the port directly to the first waiter.
+    The configuration the driver was installed with is cached so that
+    devices sharing the port with the same pins and clock never
+    reconfigure it.
+*/
+typedef struct {
+    portMUX_TYPE lock;
+    TaskHandle_t owner;
+    UBaseType_t depth;
+    i2c_wait_queue_t waiters;
+    bool installed;
+    i2c_bus_config_t applied;
+} i2c_port_state_t;
+
+static i2c_port_state_t i2c_ports[I2C_NUM_MAX] = {
+    [0 ... I2C_NUM_MAX - 1] = { .lock = portMUX_INITIALIZER_UNLOCKED },
+};
+
+static esp_err_t port_acquire(i2c_port_t port, i2c_priority_t priority, TickType_t deadline) {
+    i2c_port_state_t *state = &i2c_ports[port];
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    bool has_deadline = deadline != I2C_NO_DEADLINE;
+    i2c_waiter_t waiter = {
+        .priority = priority,
+        .has_deadline = has_deadline,
+        .deadline = deadline,
+        .owner = self,
+        .granted = false,
+    };
 
-I2CDevice_t i2c_malloc_device(i2c_port_t i2c_num, gpio_num_t sda, gpio_num_t scl, uint32_t freq, uint8_t device_addr) {
-    if (i2c_num > I2C_NUM_MAX) {
-        i2c_num = I2C_NUM_MAX;
+    portENTER_CRITICAL(&state->lock);
+    if (state->owner == self) {
+        state->depth++;
+        portEXIT_CRITICAL(&state->lock);
+        return ESP_OK;
+    }
+    if (state->owner == NULL) {
+        state->owner = self;
+        state->depth = 1;
+        portEXIT_CRITICAL(&state->lock);
+        return ESP_OK;
+    }
+    if (has_deadline && !i2c_tick_before(xTaskGetTickCount(), deadline)) {
+        portEXIT_CRITICAL(&state->lock);
+        return ESP_ERR_TIMEOUT;
+    }
+    i2c_wait_queue_insert(&state->waiters, &waiter);
+    portEXIT_CRITICAL(&state->lock);
+
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        if (has_deadline) {
+            TickType_t now = xTaskGetTickCount();
+            wait = i2c_tick_before(now, deadline) ? deadline - now : 0;
+        }
+        bool notified = (wait > 0) && (ulTaskNotifyTake(pdTRUE, wait) > 0);
+
+        portENTER_CRITICAL(&state->lock);
+        bool granted = waiter.granted;
+        bool expired = !granted && has_deadline && !i2c_tick_before(xTaskGetTickCount(), deadline);
+        if (expired) {
+            i2c_wait_queue_remove(&state->waiters, &waiter);
+        }
+        portEXIT_CRITICAL(&state->lock);
+
+        if (granted) {
+            if (!notified) {
+                // Granted as the wait timed out: consume the notification
+                // the releasing task is about to send.
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+            return ESP_OK;
+        }
+        if (expired) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
+
+static esp_err_t port_release(i2c_port_t port) {
+    i2c_port_state_t *state = &i2c_ports[port];
+    TaskHandle_t next_owner = NULL;
+
+    portENTER_CRITICAL(&state->lock);
+    if (state->owner != xTaskGetCurrentTaskHandle()) {
+        portEXIT_CRITICAL(&state->lock);
+        return ESP_FAIL;
     }
+    if (--state->depth == 0) {
+        i2c_waiter_t *waiter = i2c_wait_queue_pop(&state->waiters);
+        if (waiter != NULL) {
+            next_owner = waiter->owner;
+            state->owner = next_owner;
+            state->depth = 1;
+            waiter->granted = true;
+        } else {
+            state->owner = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&state->lock);
 
-    if (i2c_mutex[0] == NULL) {
-        i2c_mutex[0] = xSemaphoreCreateRecursiveMutex();
+    if (next_owner != NULL) {
+        xTaskNotifyGive(next_owner);
     }
+    return ESP_OK;
+}
+
+// Must be called while owning the port.
+static esp_err_t port_configure(i2c_port_t port, const i2c_bus_config_t *bus) {
+    i2c_port_state_t *state = &i2c_ports[port];
+    i2c_bus_change_t change = i2c_bus_config_change(state->installed ? &state->applied : NULL, bus);
+    if (change == I2C_BUS_UNCHANGED) {
+        return ESP_OK;
+    }
+
+    if (change == I2C_BUS_REINSTALL && state->installed) {
+        i2c_driver_delete(port);
+        gpio_reset_pin(state->applied.sda);
+        gpio_reset_pin(state->applied.scl);
+        state->installed = false;
+    }
+
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = bus->sda,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_io_num = bus->scl,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = bus->freq,
+    };
 
-    if (i2c_mutex[1] == NULL) {
-        i2c_mutex[1] = xSemaphoreCreateRecursiveMutex(); 
+    // A new clock is applied to the installed driver.
+    esp_err_t err = i2c_param_config(port, &conf);
+    if (err == ESP_OK && change == I2C_BUS_REINSTALL) {
+        err = i2c_driver_install(port, I2C_MODE_MASTER, 0, 0, 0);
     }
+    if (err != ESP_OK) {
+        log_e("I2C config update failed, port: %d, Code: 0x%x", port, err);
+        return err;
+    }
+
+    state->installed = true;
+    state->applied = *bus;
+    log_i("I2C config update, scl: %d, sda: %d, freq: %d HZ", bus->scl, bus->sda, bus->freq);
+    return ESP_OK;
+}
+
+static void record_transaction(i2c_device_t *device, esp_err_t err, bool granted, int64_t wait_us, int64_t latency_us) {
+    i2c_port_state_t *state = &i2c_ports[device->port];
+    i2c_device_stats_t *stats = &device->stats;
 
-    i2c_port_obj_t* new_device_port = (i2c_port_obj_t *)malloc(sizeof(i2c_port_obj_t));
-    if (new_device_port == NULL) {
+    portENTER_CRITICAL(&state->lock);
+    stats->transactions++;
+    if (err != ESP_OK) {
+        stats->errors++;
+        if (!granted) {
+            stats->deadline_misses++;
+        } else if (err == ESP_ERR_TIMEOUT) {
+            stats->timeouts++;
+        }
+    }
+    if (wait_us > stats->max_wait_us) {
+        stats->max_wait_us = wait_us;
+    }
+    if (latency_us > stats->max_latency_us) {
+        stats->max_latency_us = latency_us;
+    }
+    stats->total_latency_us += latency_us;
+    portEXIT_CRITICAL(&state->lock);
+}
+
+static i2c_cmd_handle_t build_command(const i2c_device_t *device, const i2c_transaction_t *transaction) {
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    if (cmd == NULL) {
         return NULL;
     }
 
-    new_device_port->sda = sda;
-    new_device_port->scl = scl;
-    new_device_port->freq = freq;
-    new_device_port->port = i2c_num;
+    bool previous_read = true;
+    for (size_t i = 0; i < transaction->segment_count; i++) {
+        const i2c_segment_t *segment = &transaction->segments[i];
+        bool read = segment->flags & I2C_SEGMENT_READ;
+
+        if (read || previous_read || !(segment->flags & I2C_SEGMENT_CONTINUE)) {
+            i2c_master_start(cmd);
+            i2c_master_write_byte(cmd, (device->addr << 1) | (read ? I2C_MASTER_READ : I2C_MASTER_WRITE), 1);
+        }
+        previous_read = read;
+
+        if (segment->length == 0) {
+            continue;
+        }
+        if (read) {
+            if (segment->length > 1) {
+                i2c_master_read(cmd, segment->data, segment->length - 1, I2C_MASTER_ACK);
+            }
+            i2c_master_read_byte(cmd, &segment->data[segment->length - 1], I2C_MASTER_NACK);
+        } else {
+            i2c_master_write(cmd, segment->data, segment->length, 1);
+        }
+    }
+    i2c_master_stop(cmd);
+    return cmd;
+}
+
+esp_err_t i2c_device_transaction(I2CDevice_t i2c_device, const i2c_transaction_t *transaction) {
+    if (i2c_device == NULL || transaction == NULL || (transaction->segment_count > 0 && transaction->segments == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < transaction->segment_count; i++) {
+        if (transaction->segments[i].length > 0 && transaction->segments[i].data == NULL) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    int64_t start = esp_timer_get_time();
+
+    // The command link is built before waiting for the port.
+    i2c_cmd_handle_t cmd = build_command(device, transaction);
+    if (cmd == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = port_acquire(device->port, transaction->priority, transaction->deadline);
+    bool granted = err == ESP_OK;
+    int64_t granted_at = esp_timer_get_time();
+    if (granted) {
+        err = port_configure(device->port, &device->bus);
+        if (err == ESP_OK) {
+            err = i2c_master_cmd_begin(device->port, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+        }
+        port_release(device->port);
+    }
+    i2c_cmd_link_delete(cmd);
+
+    record_transaction(device, err, granted, granted_at - start, esp_timer_get_time() - start);
+    if (err != ESP_OK) {
+        log_e("I2C Transaction Error: 0x%02x, segments: %u, Code: 0x%x", device->addr, (unsigned)transaction->segment_count, err);
+    }
+    return err;
+}
+
+I2CDevice_t i2c_malloc_device(i2c_port_t i2c_num, gpio_num_t sda, gpio_num_t scl, uint32_t freq, uint8_t device_addr) {
+    if (i2c_num >= I2C_NUM_MAX) {
+        i2c_num = I2C_NUM_MAX - 1;
+    }
 
     i2c_device_t* device = (i2c_device_t *)malloc(sizeof(i2c_device_t));
     if (device == NULL) {
         return NULL;
     }
 
-    device->i2c_port = new_device_port;
+    memset(device, 0, sizeof(i2c_device_t));
+    device->port = i2c_num;
+    device->bus.sda = sda;
+    device->bus.scl = scl;
+    device->bus.freq = freq;
     device->addr = device_addr;
+    device->priority = I2C_PRIORITY_NORMAL;
     log_i("New device malloc, scl: %d, sda: %d, freq: %d HZ",
-        device->i2c_port->scl, device->i2c_port->sda, device->i2c_port->freq);
+        device->bus.scl, device->bus.sda, device->bus.freq);
 
     return (I2CDevice_t)device;
 }
@@ -85,24 +314,45 @@ void i2c_free_device(I2CDevice_t i2c_device) {
     if (i2c_device == NULL) {
         return ;
     }
-    free(((i2c_device_t *)i2c_device)->i2c_port);
     free(i2c_device);
 }
 
+esp_err_t i2c_device_set_priority(I2CDevice_t i2c_device, i2c_priority_t priority) {
+    if (i2c_device == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ((i2c_device_t *)i2c_device)->priority = priority;
+    return ESP_OK;
+}
+
+esp_err_t i2c_device_get_stats(I2CDevice_t i2c_device, i2c_device_stats_t *stats) {
+    if (i2c_device == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    i2c_port_state_t *state = &i2c_ports[device->port];
+
+    portENTER_CRITICAL(&state->lock);
+    *stats = device->stats;
+    portEXIT_CRITICAL(&state->lock);
+    return ESP_OK;
+}
+
 BaseType_t i2c_take_port(i2c_port_t i2c_num, uint32_t timeout) {
-    if (i2c_mutex[i2c_num] == NULL) {
+    if (i2c_num >= I2C_NUM_MAX) {
         return pdFAIL;
     }
 
-    return xSemaphoreTakeRecursive(i2c_mutex[i2c_num], timeout);
+    TickType_t deadline = (timeout == portMAX_DELAY) ? I2C_NO_DEADLINE : xTaskGetTickCount() + timeout;
+    return (port_acquire(i2c_num, I2C_PRIORITY_NORMAL, deadline) == ESP_OK) ? pdPASS : pdFAIL;
 }
 
 BaseType_t i2c_free_port(i2c_port_t i2c_num) {
-    if (i2c_mutex[i2c_num] == NULL) {
+    if (i2c_num >= I2C_NUM_MAX) {
         return pdFAIL;
     }
 
-    return xSemaphoreGiveRecursive(i2c_mutex[i2c_num]);
+    return (port_release(i2c_num) == ESP_OK) ? pdPASS : pdFAIL;
 }
 
 esp_err_t i2c_apply_bus(I2CDevice_t i2c_device) {
@@ -111,45 +361,8 @@ esp_err_t i2c_apply_bus(I2CDevice_t i2c_device) {
     }
 
     i2c_device_t* device = (i2c_device_t *)i2c_device;
-    xSemaphoreTakeRecursive(i2c_mutex[device->i2c_port->port], portMAX_DELAY);
-    i2c_port_obj_t* used_port = i2c_port_used[device->i2c_port->port];
-    
-    if (used_port == device->i2c_port) {
-        return ESP_OK;
-    }
-
-    if ((used_port != NULL) && 
-        (device->i2c_port->sda == used_port->sda) && 
-        (device->i2c_port->scl == used_port->scl) && 
-        ((device->i2c_port->freq == used_port->freq))) {
-            i2c_port_used[device->i2c_port->port] = device->i2c_port;
-            return ESP_OK;    
-    }
-
-    if (used_port != NULL) {
-        i2c_driver_delete(device->i2c_port->port);
-        if ((device->i2c_port->sda != used_port->sda) || (device->i2c_port->scl != used_port->scl)) {
-            gpio_reset_pin(used_port->sda);
-            gpio_reset_pin(used_port->scl);
-        }
-    }
-
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = device->i2c_port->sda,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_io_num = device->i2c_port->scl,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = device->i2c_port->freq,
-    };
-
-    i2c_param_config(device->i2c_port->port, &conf);
-    i2c_driver_install(device->i2c_port->port, I2C_MODE_MASTER, 0, 0, 0);
-
-    i2c_port_used[device->i2c_port->port] = device->i2c_port;
-    log_i("I2C config update, scl: %d, sda: %d, freq: %d HZ",
-            device->i2c_port->scl, device->i2c_port->sda, device->i2c_port->freq);
-    return ESP_OK;
+    port_acquire(device->port, device->priority, I2C_NO_DEADLINE);
+    return port_configure(device->port, &device->bus);
 }
 
 esp_err_t i2c_free_bus(I2CDevice_t i2c_device) {
@@ -157,7 +370,7 @@ esp_err_t i2c_free_bus(I2CDevice_t i2c_device) {
         return ESP_ERR_INVALID_ARG;
     }
     i2c_device_t* device = (i2c_device_t *)i2c_device;
-    return (xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]) == pdTRUE) ? ESP_OK : ESP_FAIL;
+    return port_release(device->port);
 }
 
 esp_err_t i2c_read_bytes(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t *data, uint16_t length) {
@@ -166,31 +379,20 @@ esp_err_t i2c_read_bytes(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t *dat
     }
 
     i2c_device_t* device = (i2c_device_t *)i2c_device;
+    uint8_t reg = reg_addr;
+    i2c_segment_t segments[] = {
+        { .data = &reg, .length = 1, .flags = I2C_SEGMENT_WRITE },
+        { .data = data, .length = length, .flags = I2C_SEGMENT_READ },
+    };
+    bool has_reg = !(reg_addr & I2C_NO_REG);
+    i2c_transaction_t transaction = {
+        .segments = has_reg ? segments : &segments[1],
+        .segment_count = has_reg ? 2 : 1,
+        .priority = device->priority,
+        .deadline = I2C_NO_DEADLINE,
+    };
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-    if(!(reg_addr & I2C_NO_REG)){
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
-        i2c_master_write_byte(cmd, reg_addr, 1);
-    }
- 
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (device->addr << 1) | I2C_MASTER_READ, 1);
-    if (length > 1) {
-        i2c_master_read(cmd, data, length - 1, I2C_MASTER_ACK);
-    }
-    if (length > 0) {
-        i2c_master_read_byte(cmd, &data[length-1], I2C_MASTER_NACK);
-    }
-    i2c_master_stop(cmd);
-    i2c_apply_bus(i2c_device);
-    
-    esp_err_t err = ESP_FAIL;
-
-    err = i2c_master_cmd_begin(device->i2c_port->port, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    i2c_free_bus(i2c_device);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t err = i2c_device_transaction(i2c_device, &transaction);
 
     if (err != ESP_OK) {
         log_e("I2C Read Error: 0x%02x, reg: 0x%02x, length: %d, Code: 0x%x", device->addr, reg_addr, length, err);
@@ -203,45 +405,7 @@ esp_err_t i2c_read_bytes(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t *dat
 }
 
 esp_err_t i2c_read_bytes_no_stop(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t *data, uint16_t length) {
-    if (i2c_device == NULL || (length > 0 && data == NULL)) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    i2c_device_t* device = (i2c_device_t *)i2c_device;
-
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    
-    if(!(reg_addr & I2C_NO_REG)){
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
-        i2c_master_write_byte(cmd, reg_addr, 1);
-    }
-
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (device->addr << 1) | I2C_MASTER_READ, 1);
-    if (length > 1) {
-        i2c_master_read(cmd, data, length - 1, I2C_MASTER_ACK);
-    }
-    if (length > 0) {
-        i2c_master_read_byte(cmd, &data[length-1], I2C_MASTER_NACK);
-    }
-    i2c_master_stop(cmd);
-    i2c_apply_bus(i2c_device);
-
-    esp_err_t err = ESP_FAIL;
-    
-    err = i2c_master_cmd_begin(device->i2c_port->port, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    i2c_free_bus(i2c_device);
-    i2c_cmd_link_delete(cmd);
-
-    if (err != ESP_OK) {
-        log_e("I2C Read Error: 0x%02x, reg: 0x%02x, length: %d, Code: 0x%x", device->addr, reg_addr, length, err);
-    } else {
-        log_i("I2C Read Success: 0x%02x, reg: 0x%02x, length: %d", device->addr, reg_addr, length);
-        log_reg(data, length);
-    }
-
-    return err;
+    return i2c_read_bytes(i2c_device, reg_addr, data, length);
 }
 
 esp_err_t i2c_read_byte(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t* data) {
@@ -288,25 +452,20 @@ esp_err_t i2c_write_bytes(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t *da
     }
 
     i2c_device_t* device = (i2c_device_t *)i2c_device;
+    uint8_t reg = reg_addr;
+    i2c_segment_t segments[] = {
+        { .data = &reg, .length = 1, .flags = I2C_SEGMENT_WRITE },
+        { .data = data, .length = length, .flags = I2C_SEGMENT_WRITE | I2C_SEGMENT_CONTINUE },
+    };
+    bool has_reg = !(reg_addr & I2C_NO_REG);
+    i2c_transaction_t transaction = {
+        .segments = has_reg ? segments : &segments[1],
+        .segment_count = has_reg ? 2 : 1,
+        .priority = device->priority,
+        .deadline = I2C_NO_DEADLINE,
+    };
 
-    i2c_cmd_handle_t write_cmd = i2c_cmd_link_create();
-    i2c_master_start(write_cmd);
-    i2c_master_write_byte(write_cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
-    if(!(reg_addr & I2C_NO_REG)){
-        i2c_master_write_byte(write_cmd, reg_addr, 1);
-    }
-    if (length > 0) {
-        i2c_master_write(write_cmd, data, length, 1);
-    }
-    i2c_master_stop(write_cmd);
-
-    esp_err_t err = ESP_FAIL;
-
-    i2c_apply_bus(i2c_device);
-    err = i2c_master_cmd_begin(device->i2c_port->port, write_cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    i2c_free_bus(i2c_device);
-
-    i2c_cmd_link_delete(write_cmd);
+    esp_err_t err = i2c_device_transaction(i2c_device, &transaction);
 
     if (err != ESP_OK) {
         log_e("I2C Write Error, addr: 0x%02x, reg: 0x%02x, length: %d, Code: 0x%x", device->addr, reg_addr, length, err);
@@ -323,16 +482,26 @@ esp_err_t i2c_write_byte(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t data
 }
 
 esp_err_t i2c_write_bit(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t data, uint8_t bit_pos) {
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    if (device == NULL) {
+        return ESP_FAIL;
+    }
+
+    // Hold the port so no other task writes the register in between.
     uint8_t value = 0x00;
     esp_err_t err = ESP_FAIL;
+    port_acquire(device->port, device->priority, I2C_NO_DEADLINE);
     err = i2c_read_byte(i2c_device, reg_addr, &value);
     if (err != ESP_OK) {
+        port_release(device->port);
         return err;
     }
 
     value &= ~(1 << bit_pos);
     value |= (data & 0x01) << bit_pos;
-    return i2c_write_byte(i2c_device, reg_addr, value);
+    err = i2c_write_byte(i2c_device, reg_addr, value);
+    port_release(device->port);
+    return err;
 }
 
 esp_err_t i2c_write_bits(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t data, uint8_t bit_pos, uint8_t bit_length) {
@@ -340,10 +509,18 @@ esp_err_t i2c_write_bits(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t data
         return ESP_FAIL;
     }
 
+    i2c_device_t* device = (i2c_device_t *)i2c_device;
+    if (device == NULL) {
+        return ESP_FAIL;
+    }
+
+    // Hold the port so no other task writes the register in between.
     uint8_t value = 0x00;
     esp_err_t err = ESP_FAIL;
+    port_acquire(device->port, device->priority, I2C_NO_DEADLINE);
     err = i2c_read_byte(i2c_device, reg_addr, &value);
     if (err != ESP_OK) {
+        port_release(device->port);
         return err;
     }
 
@@ -351,7 +528,9 @@ esp_err_t i2c_write_bits(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t data
     data &= (1 << bit_length) - 1;
     value |= data << bit_pos;
 
-    return i2c_write_byte(i2c_device, reg_addr, value);
+    err = i2c_write_byte(i2c_device, reg_addr, value);
+    port_release(device->port);
+    return err;
 }
 
 esp_err_t i2c_device_change_freq(I2CDevice_t i2c_device, uint32_t freq) {
@@ -359,17 +538,11 @@ esp_err_t i2c_device_change_freq(I2CDevice_t i2c_device, uint32_t freq) {
         return ESP_FAIL;
     }
     i2c_device_t* device = (i2c_device_t *)i2c_device;
-    xSemaphoreTakeRecursive(i2c_mutex[device->i2c_port->port], portMAX_DELAY);
-    if (device->i2c_port->freq == freq) {
-        xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]);
-        return ESP_OK;
-    }
 
-    device->i2c_port->freq = freq;
-    if (i2c_port_used[device->i2c_port->port] == device->i2c_port) {
-        i2c_port_used[device->i2c_port->port] = NULL;
-    }
-    xSemaphoreGiveRecursive(i2c_mutex[device->i2c_port->port]);
+    // The port picks up the new clock on the device's next transaction.
+    port_acquire(device->port, device->priority, I2C_NO_DEADLINE);
+    device->bus.freq = freq;
+    port_release(device->port);
     return ESP_OK;
 }
 
@@ -379,18 +552,13 @@ esp_err_t i2c_device_valid(I2CDevice_t i2c_device) {
     }
 
     i2c_device_t* device = (i2c_device_t *)i2c_device;
+    i2c_segment_t address_only = { .data = NULL, .length = 0, .flags = I2C_SEGMENT_WRITE };
+    i2c_transaction_t transaction = {
+        .segments = &address_only,
+        .segment_count = 1,
+        .priority = device->priority,
+        .deadline = I2C_NO_DEADLINE,
+    };
 
-    i2c_cmd_handle_t write_cmd = i2c_cmd_link_create();
-    i2c_master_start(write_cmd);
-    i2c_master_write_byte(write_cmd, (device->addr << 1) | I2C_MASTER_WRITE, 1);
-    i2c_master_stop(write_cmd);
-
-    esp_err_t err = ESP_FAIL;
-
-    i2c_apply_bus(i2c_device);
-    err = i2c_master_cmd_begin(device->i2c_port->port, write_cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
-    i2c_free_bus(i2c_device);
-
-    i2c_cmd_link_delete(write_cmd);
-    return err;
+    return i2c_device_transaction(i2c_device, &transaction);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@ extern "C" {
 #endif
 
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 
@@ -41,6 +42,105 @@ extern "C" {
 typedef void * I2CDevice_t;
 /* @[declare_i2cdevice_t] */
 
+/**
+ * @brief Priority of a transaction when several tasks wait for the
+ * same I2C port.
+ *
+ * The port is handed to the waiting transaction with the highest
+ * priority; among equal priorities, to the one with the earliest
+ * deadline. The calls that do not take a priority use the device's
+ * priority (see @ref i2c_device_set_priority), which defaults to
+ * I2C_PRIORITY_NORMAL.
+ */
+/* @[declare_i2c_priority_t] */
+typedef enum {
+    I2C_PRIORITY_LOW,
+    I2C_PRIORITY_NORMAL,
+    I2C_PRIORITY_HIGH,
+} i2c_priority_t;
+/* @[declare_i2c_priority_t] */
+
+/**
+ * @brief Flags of a transaction segment.
+ *
+ * Every segment starts with a (repeated) START and the device
+ * address, except a write segment flagged I2C_SEGMENT_CONTINUE
+ * directly after another write segment, whose bytes are appended to
+ * the same message. This allows a register address and its data to
+ * come from different buffers.
+ */
+/* @[declare_i2c_segment_flags] */
+#define I2C_SEGMENT_WRITE       ( 0 )
+#define I2C_SEGMENT_READ        ( 1 << 0 )
+#define I2C_SEGMENT_CONTINUE    ( 1 << 1 )
+/* @[declare_i2c_segment_flags] */
+
+/**
+ * @brief One read or write of a transaction.
+ */
+/* @[declare_i2c_segment_t] */
+typedef struct {
+    uint8_t *data;
+    uint16_t length;
+    uint8_t flags;
+} i2c_segment_t;
+/* @[declare_i2c_segment_t] */
+
+/**
+ * @brief Used as a transaction deadline to wait for the port
+ * indefinitely.
+ */
+/* @[declare_i2c_no_deadline] */
+#define I2C_NO_DEADLINE     portMAX_DELAY
+/* @[declare_i2c_no_deadline] */
+
+/**
+ * @brief A sequence of segments sent to one device as a single
+ * command link, ending with a STOP.
+ *
+ * Contains:
+ * - segments       (the reads and writes, in bus order)
+ * - segment_count
+ * - priority       (see @ref i2c_priority_t)
+ * - deadline       (tick count by which the port must be granted,
+ *                   or I2C_NO_DEADLINE)
+ *
+ */
+/* @[declare_i2c_transaction_t] */
+typedef struct {
+    const i2c_segment_t *segments;
+    size_t segment_count;
+    i2c_priority_t priority;
+    TickType_t deadline;
+} i2c_transaction_t;
+/* @[declare_i2c_transaction_t] */
+
+/**
+ * @brief Counters of the transactions sent to one device.
+ *
+ * Contains:
+ * - transactions       (every transaction, including failed ones)
+ * - errors             (transactions that did not return ESP_OK)
+ * - timeouts           (transactions the bus timed out on)
+ * - deadline_misses    (transactions dropped because the port was
+ *                       not granted before their deadline)
+ * - max_wait_us        (longest wait for the port)
+ * - max_latency_us     (longest transaction, waiting included)
+ * - total_latency_us   (sum of the transaction latencies)
+ *
+ */
+/* @[declare_i2c_device_stats_t] */
+typedef struct {
+    uint32_t transactions;
+    uint32_t errors;
+    uint32_t timeouts;
+    uint32_t deadline_misses;
+    uint32_t max_wait_us;
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;
+} i2c_device_stats_t;
+/* @[declare_i2c_device_stats_t] */
+
 I2CDevice_t i2c_malloc_device(i2c_port_t i2c_num, gpio_num_t sda, gpio_num_t scl, uint32_t freq, uint8_t device_addr);
 
 void i2c_free_device(I2CDevice_t i2c_device);
@@ -87,6 +187,44 @@ esp_err_t i2c_write_bits(I2CDevice_t i2c_device, uint32_t reg_addr, uint8_t data
 
 esp_err_t i2c_device_valid(I2CDevice_t i2c_device);
 
+/**
+ * @brief Sends a transaction to a device.
+ *
+ * The segments are queued in one command link and sent while holding
+ * the device's port, so no other transaction on the port can come in
+ * between them. The driver is only reconfigured if the port was last
+ * used with different pins or clock, and a clock change alone does
+ * not reinstall the driver.
+ *
+ * @param[in] i2c_device The device to address.
+ * @param[in] transaction The segments, priority and deadline.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the deadline passed
+ * before the port was granted or the bus timed out, or the driver's
+ * error code.
+ */
+/* @[declare_i2c_device_transaction] */
+esp_err_t i2c_device_transaction(I2CDevice_t i2c_device, const i2c_transaction_t *transaction);
+/* @[declare_i2c_device_transaction] */
+
+/**
+ * @brief Sets the priority used by the calls that do not take one.
+ */
+/* @[declare_i2c_device_set_priority] */
+esp_err_t i2c_device_set_priority(I2CDevice_t i2c_device, i2c_priority_t priority);
+/* @[declare_i2c_device_set_priority] */
+
+/**
+ * @brief Copies a device's transaction counters.
+ */
+/* @[declare_i2c_device_get_stats] */
+esp_err_t i2c_device_get_stats(I2CDevice_t i2c_device, i2c_device_stats_t *stats);
+/* @[declare_i2c_device_get_stats] */
+
+/*
+    Holds the port across several calls, e.g. a command sequence of
+    the ATECC608. Takes are recursive and queue with
+    I2C_PRIORITY_NORMAL; each take needs a matching i2c_free_port.
+*/
 BaseType_t i2c_take_port(i2c_port_t i2c_num, uint32_t timeout);
 
 BaseType_t i2c_free_port(i2c_port_t i2c_num);
@@ -5,6 +5,12 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_err.h"
+
 /**
  * @brief Microphone I2S port number. 
  */
@@ -12,6 +18,35 @@
 #define MIC_I2S_NUMBER I2S_NUM_0
 /* @[declare_microphone_mici2s_number] */
 
+/**
+ * @brief I2S capture settings of the microphone.
+ *
+ * The DMA buffers hold `dma_buf_count * dma_buf_len` samples; that is how
+ * long a reader may fall behind before the I2S driver overwrites audio.
+ * Set `event_queue_length` to receive the driver's `i2s_event_t`s.
+ */
+/* @[declare_microphone_config_t] */
+typedef struct {
+    uint32_t sample_rate;
+    int dma_buf_count;
+    int dma_buf_len;
+    int event_queue_length;
+} microphone_config_t;
+/* @[declare_microphone_config_t] */
+
+/**
+ * @brief The settings used by `Microphone_Init`: 44.1 kHz, two DMA buffers
+ * of 128 samples and no event queue.
+ */
+/* @[declare_microphone_config_default] */
+#define MICROPHONE_CONFIG_DEFAULT() { \
+    .sample_rate = 44100,             \
+    .dma_buf_count = 2,               \
+    .dma_buf_len = 128,               \
+    .event_queue_length = 0,          \
+}
+/* @[declare_microphone_config_default] */
+
 /**
  * @brief Initializes the microphone over I2S.
  * 
@@ -24,6 +59,19 @@
 void Microphone_Init();
 /* @[declare_microphone_init] */
 
+/**
+ * @brief Initializes the microphone over I2S with the given settings.
+ *
+ * @param[in] config The capture settings.
+ * @param[out] events The driver's event queue, if `config->event_queue_length`
+ * is not 0. May be NULL otherwise.
+ *
+ * @return ESP_OK, or the error of the I2S driver.
+ */
+/* @[declare_microphone_initwithconfig] */
+esp_err_t Microphone_InitWithConfig(const microphone_config_t *config, QueueHandle_t *events);
+/* @[declare_microphone_initwithconfig] */
+
 /**
  * @brief De-initializes the microphone over I2S. 
  */
@@ -1,12 +1,33 @@
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
 #include "i2c_device.h"
 #include "mpu6886.h"
 
+#define MPU6886_CONFIG_FIFO_MODE (0x01 << 6)
+#define USER_CTRL_FIFO_EN       (0x01 << 6)
+#define USER_CTRL_FIFO_RST      (0x01 << 2)
+#define FIFO_EN_GYRO            (0x01 << 4)
+#define FIFO_EN_ACCEL           (0x01 << 3)
+#define INT_FIFO_OFLOW          (0x01 << 4)
+#define INT_DATA_RDY            (0x01 << 0)
+#define FIFO_MAX_PACKETS        (MPU6886_FIFO_SIZE / MPU6886_FIFO_PACKET_SIZE)
+
+static const char *TAG = "MPU6886";
+
 static I2CDevice_t mpu6886_device;
 static gyro_scale_t gyro_scale = MPU6886_GFS_2000DPS;
 static acc_scale_t acc_scale = MPU6886_AFS_8G;
 static float acc_res, gyro_res;
 
+static uint8_t fifo_buffer[FIFO_MAX_PACKETS * MPU6886_FIFO_PACKET_SIZE];
+static portMUX_TYPE fifo_mux = portMUX_INITIALIZER_UNLOCKED;
+static mpu6886_fifo_sample_t fifo_ring[MPU6886_FIFO_RING_SIZE];
+static uint32_t fifo_ring_head, fifo_ring_tail;
+static mpu6886_activity_t activity;
+static int32_t temp_sum;
+static uint32_t temp_count;
+
 static void MPU6886_I2CInit() {
     mpu6886_device = i2c_malloc_device(I2C_NUM_1, 21, 22, 400000, MPU6886_ADDRESS);
 }
@@ -187,3 +208,126 @@ void MPU6886_GetTempData(float *t) {
     MPU6886_GetTempAdc(&temp);
     *t = (float)temp / 326.8 + 25.0;
 }
+
+void MPU6886_FifoStart(void) {
+    unsigned char regdata;
+
+    // Stop and flush the FIFO before changing what is written to it.
+    regdata = 0x00;
+    MPU6886_I2CWriteBytes(MPU6886_FIFO_EN, 1, &regdata);
+    regdata = USER_CTRL_FIFO_RST;
+    MPU6886_I2CWriteBytes(MPU6886_USER_CTRL, 1, &regdata);
+    vTaskDelay(1);
+
+    // Sample rate = 1 kHz / (1 + SMPLRT_DIV) with the DLPF enabled.
+    regdata = 1000 / MPU6886_FIFO_SAMPLE_RATE_HZ - 1;
+    MPU6886_I2CWriteBytes(MPU6886_SMPLRT_DIV, 1, &regdata);
+
+    // Stop writing when full, so an overflow cannot split packets silently.
+    regdata = MPU6886_CONFIG_FIFO_MODE | 0x01;
+    MPU6886_I2CWriteBytes(MPU6886_CONFIG, 1, &regdata);
+
+    // 21 Hz accelerometer bandwidth, below the Nyquist rate of the FIFO.
+    regdata = 0x04;
+    MPU6886_I2CWriteBytes(MPU6886_ACCEL_CONFIG2, 1, &regdata);
+
+    regdata = USER_CTRL_FIFO_EN;
+    MPU6886_I2CWriteBytes(MPU6886_USER_CTRL, 1, &regdata);
+    regdata = FIFO_EN_GYRO | FIFO_EN_ACCEL;
+    MPU6886_I2CWriteBytes(MPU6886_FIFO_EN, 1, &regdata);
+
+    regdata = INT_FIFO_OFLOW | INT_DATA_RDY;
+    MPU6886_I2CWriteBytes(MPU6886_INT_ENABLE, 1, &regdata);
+
+    portENTER_CRITICAL(&fifo_mux);
+    fifo_ring_head = fifo_ring_tail = 0;
+    temp_sum = 0;
+    temp_count = 0;
+    MPU6886_Activity_Init(&activity, MPU6886_FIFO_SAMPLE_RATE_HZ, MPU6886_ACTIVITY_CUTOFF_HZ);
+    portEXIT_CRITICAL(&fifo_mux);
+}
+
+int MPU6886_FifoDrain(void) {
+    // Interrupt status and FIFO count in one transaction.
+    uint8_t status_reg = MPU6886_INT_STATUS;
+    uint8_t count_reg = MPU6886_FIFO_COUNTH;
+    uint8_t status = 0;
+    uint8_t count[2] = { 0 };
+    i2c_segment_t segments[] = {
+        { .data = &status_reg, .length = 1, .flags = I2C_SEGMENT_WRITE },
+        { .data = &status, .length = 1, .flags = I2C_SEGMENT_READ },
+        { .data = &count_reg, .length = 1, .flags = I2C_SEGMENT_WRITE },
+        { .data = count, .length = 2, .flags = I2C_SEGMENT_READ },
+    };
+    i2c_transaction_t transaction = {
+        .segments = segments,
+        .segment_count = sizeof(segments) / sizeof(segments[0]),
+        .priority = I2C_PRIORITY_NORMAL,
+        .deadline = I2C_NO_DEADLINE,
+    };
+    if (i2c_device_transaction(mpu6886_device, &transaction) != ESP_OK) {
+        return -1;
+    }
+
+    if (status & INT_FIFO_OFLOW) {
+        ESP_LOGW(TAG, "FIFO overflowed, resetting it.");
+        unsigned char regdata = USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RST;
+        MPU6886_I2CWriteBytes(MPU6886_USER_CTRL, 1, &regdata);
+        return 0;
+    }
+
+    uint16_t packets = ((((uint16_t)count[0] & 0x1F) << 8) | count[1]) / MPU6886_FIFO_PACKET_SIZE;
+    if (packets > FIFO_MAX_PACKETS) {
+        packets = FIFO_MAX_PACKETS;
+    }
+    if (packets == 0) {
+        return 0;
+    }
+    if (i2c_read_bytes(mpu6886_device, MPU6886_FIFO_R_W, fifo_buffer, packets * MPU6886_FIFO_PACKET_SIZE) != ESP_OK) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&fifo_mux);
+    for (uint16_t i = 0; i < packets; i++) {
+        mpu6886_fifo_sample_t sample;
+        MPU6886_DecodeFifoPacket(&fifo_buffer[i * MPU6886_FIFO_PACKET_SIZE], &sample);
+
+        fifo_ring[fifo_ring_head++ % MPU6886_FIFO_RING_SIZE] = sample;
+        if (fifo_ring_head - fifo_ring_tail > MPU6886_FIFO_RING_SIZE) {
+            fifo_ring_tail = fifo_ring_head - MPU6886_FIFO_RING_SIZE;
+        }
+
+        MPU6886_Activity_Add(&activity, sample.ax * acc_res, sample.ay * acc_res, sample.az * acc_res);
+        temp_sum += sample.temp;
+        temp_count++;
+    }
+    portEXIT_CRITICAL(&fifo_mux);
+    return packets;
+}
+
+void MPU6886_FifoPoll(void *context) {
+    if (MPU6886_FifoDrain() < 0) {
+        ESP_LOGE(TAG, "Failed to drain the FIFO.");
+    }
+}
+
+size_t MPU6886_FifoReadSamples(mpu6886_fifo_sample_t *samples, size_t max) {
+    size_t copied = 0;
+    portENTER_CRITICAL(&fifo_mux);
+    while (copied < max && fifo_ring_tail != fifo_ring_head) {
+        samples[copied++] = fifo_ring[fifo_ring_tail++ % MPU6886_FIFO_RING_SIZE];
+    }
+    portEXIT_CRITICAL(&fifo_mux);
+    return copied;
+}
+
+bool MPU6886_FifoTakeSummary(mpu6886_imu_summary_t *summary) {
+    portENTER_CRITICAL(&fifo_mux);
+    summary->samples = temp_count;
+    summary->temperature = temp_count > 0 ? MPU6886_TempAdcToCelsius(temp_sum / (int32_t)temp_count) : 0;
+    summary->activity = MPU6886_Activity_TakeRms(&activity);
+    temp_sum = 0;
+    temp_count = 0;
+    portEXIT_CRITICAL(&fifo_mux);
+    return summary->samples > 0;
+}
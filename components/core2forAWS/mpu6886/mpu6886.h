@@ -6,6 +6,10 @@
 #pragma once
 
 #include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+#include "mpu6886_fifo.h"
 
 #define MPU6886_ADDRESS           0x68 
 #define MPU6886_WHOAMI            0x75
@@ -13,6 +17,7 @@
 #define MPU6886_SMPLRT_DIV        0x19
 #define MPU6886_INT_PIN_CFG       0x37
 #define MPU6886_INT_ENABLE        0x38
+#define MPU6886_INT_STATUS        0x3A
 #define MPU6886_ACCEL_XOUT_H      0x3B
 #define MPU6886_ACCEL_XOUT_L      0x3C
 #define MPU6886_ACCEL_YOUT_H      0x3D
@@ -38,6 +43,18 @@
 #define MPU6886_ACCEL_CONFIG      0x1C
 #define MPU6886_ACCEL_CONFIG2     0x1D
 #define MPU6886_FIFO_EN           0x23
+#define MPU6886_FIFO_COUNTH       0x72
+#define MPU6886_FIFO_COUNTL       0x73
+#define MPU6886_FIFO_R_W          0x74
+
+/** Size of the on-chip FIFO in bytes. */
+#define MPU6886_FIFO_SIZE               1024
+/** Output data rate of the FIFO acquisition mode. */
+#define MPU6886_FIFO_SAMPLE_RATE_HZ     50
+/** Cut-off of the high-pass filter of the activity metric. */
+#define MPU6886_ACTIVITY_CUTOFF_HZ      0.5f
+/** Number of drained samples kept for `MPU6886_FifoReadSamples`. */
+#define MPU6886_FIFO_RING_SIZE          64
 
 /**
  * @brief List of possible accelerometer scalars in Gs.
@@ -210,3 +227,97 @@ void MPU6886_GetGyroData(float *roll, float *yaw, float *pitch);
 /* @[declare_mpu6886_gettempdata] */
 void MPU6886_GetTempData(float *t);
 /* @[declare_mpu6886_gettempdata] */
+
+/**
+ * @brief Averages of the samples drained from the FIFO.
+ * 
+ * Contains:
+ * - temperature    (mean temperature of the MPU6886 in Celsius)
+ * - activity       (RMS of the high-passed acceleration in Gs, see
+ *                   @ref mpu6886_activity_t)
+ * - samples        (number of samples averaged)
+ *
+ */
+/* @[declare_mpu6886_imu_summary_t] */
+typedef struct {
+    float temperature;
+    float activity;
+    uint32_t samples;
+} mpu6886_imu_summary_t;
+/* @[declare_mpu6886_imu_summary_t] */
+
+/**
+ * @brief Switches the MPU6886 to FIFO acquisition.
+ * 
+ * Accelerometer, temperature and gyroscope samples are written to the
+ * on-chip FIFO at `MPU6886_FIFO_SAMPLE_RATE_HZ`, and the data-ready and
+ * FIFO overflow interrupts are raised on the INT pin. The FIFO must then
+ * be drained with `MPU6886_FifoDrain` (or `MPU6886_FifoPoll`) at least
+ * every second; one drain reads all buffered samples in a single burst
+ * transaction instead of a register read per getter.
+ * 
+ * @note The register getters keep working in this mode.
+ */
+/* @[declare_mpu6886_fifostart] */
+void MPU6886_FifoStart(void);
+/* @[declare_mpu6886_fifostart] */
+
+/**
+ * @brief Reads every complete sample from the FIFO into the sample ring
+ * and the running averages.
+ * 
+ * The FIFO is reset if it overflowed, dropping its contents.
+ * 
+ * @return The number of samples drained, or -1 on an I2C error.
+ */
+/* @[declare_mpu6886_fifodrain] */
+int MPU6886_FifoDrain(void);
+/* @[declare_mpu6886_fifodrain] */
+
+/**
+ * @brief Drains the FIFO.
+ * 
+ * @note Meant to be run periodically as a sensor scheduler read callback.
+ * 
+ * @param context unused.
+ */
+/* @[declare_mpu6886_fifopoll] */
+void MPU6886_FifoPoll(void *context);
+/* @[declare_mpu6886_fifopoll] */
+
+/**
+ * @brief Pops the oldest drained samples from the sample ring.
+ * 
+ * The ring keeps the last `MPU6886_FIFO_RING_SIZE` samples; older ones
+ * are overwritten.
+ * 
+ * @param[out] samples Buffer for up to `max` samples.
+ * @param[in] max The capacity of `samples`.
+ * 
+ * @return The number of samples copied.
+ */
+/* @[declare_mpu6886_fiforeadsamples] */
+size_t MPU6886_FifoReadSamples(mpu6886_fifo_sample_t *samples, size_t max);
+/* @[declare_mpu6886_fiforeadsamples] */
+
+/**
+ * @brief Returns the averages of the samples drained since the previous
+ * call and starts a new period.
+ * 
+ * **Example:**
+ * 
+ * Use the activity as a presence signal.
+ * @code{c}
+ *  mpu6886_imu_summary_t summary;
+ *  if (MPU6886_FifoTakeSummary(&summary) && summary.activity > 0.003f) {
+ *      // Someone is moving at the desk.
+ *  }
+ * @endcode
+ * 
+ * @param[out] summary The averages.
+ * 
+ * @return false if no sample was drained since the previous call.
+ */
+/* @[declare_mpu6886_fifotakesummary] */
+bool MPU6886_FifoTakeSummary(mpu6886_imu_summary_t *summary);
+/* @[declare_mpu6886_fifotakesummary] */
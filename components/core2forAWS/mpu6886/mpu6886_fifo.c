@@ -0,0 +1,63 @@
+#include <math.h>
+
+#include "mpu6886_fifo.h"
+
+static inline int16_t read_be16(const uint8_t *bytes) {
+    return (int16_t)(((uint16_t)bytes[0] << 8) | bytes[1]);
+}
+
+void MPU6886_DecodeFifoPacket(const uint8_t *packet, mpu6886_fifo_sample_t *sample) {
+    sample->ax = read_be16(&packet[0]);
+    sample->ay = read_be16(&packet[2]);
+    sample->az = read_be16(&packet[4]);
+    sample->temp = read_be16(&packet[6]);
+    sample->gx = read_be16(&packet[8]);
+    sample->gy = read_be16(&packet[10]);
+    sample->gz = read_be16(&packet[12]);
+}
+
+float MPU6886_TempAdcToCelsius(int16_t temp) {
+    return (float)temp / 326.8f + 25.0f;
+}
+
+void MPU6886_Activity_Init(mpu6886_activity_t *activity, float sample_rate_hz, float cutoff_hz) {
+    // alpha = RC / (RC + dt) of a first-order RC high-pass filter.
+    float rc = 1.0f / (6.2831853f * cutoff_hz);
+    float dt = 1.0f / sample_rate_hz;
+    activity->alpha = rc / (rc + dt);
+    activity->primed = false;
+    activity->sum_squares = 0;
+    activity->count = 0;
+    for (int i = 0; i < 3; i++) {
+        activity->previous[i] = 0;
+        activity->filtered[i] = 0;
+    }
+}
+
+void MPU6886_Activity_Add(mpu6886_activity_t *activity, float ax, float ay, float az) {
+    const float input[3] = { ax, ay, az };
+
+    if (!activity->primed) {
+        // Start from rest so gravity does not show up as a step.
+        for (int i = 0; i < 3; i++) {
+            activity->previous[i] = input[i];
+        }
+        activity->primed = true;
+    }
+
+    float magnitude_squared = 0;
+    for (int i = 0; i < 3; i++) {
+        activity->filtered[i] = activity->alpha * (activity->filtered[i] + input[i] - activity->previous[i]);
+        activity->previous[i] = input[i];
+        magnitude_squared += activity->filtered[i] * activity->filtered[i];
+    }
+    activity->sum_squares += magnitude_squared;
+    activity->count++;
+}
+
+float MPU6886_Activity_TakeRms(mpu6886_activity_t *activity) {
+    float rms = activity->count > 0 ? sqrtf(activity->sum_squares / activity->count) : 0;
+    activity->sum_squares = 0;
+    activity->count = 0;
+    return rms;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file mpu6886_fifo.h
+ * @brief Decoding of MPU6886 FIFO packets and the motion activity metric
+ * computed from them.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Bytes of one FIFO packet: accelerometer, temperature and gyroscope, big-endian. */
+#define MPU6886_FIFO_PACKET_SIZE  14
+
+/**
+ * @brief One sample drained from the MPU6886 FIFO, as raw ADC values.
+ */
+/* @[declare_mpu6886_fifo_sample_t] */
+typedef struct {
+    int16_t ax, ay, az;
+    int16_t temp;
+    int16_t gx, gy, gz;
+} mpu6886_fifo_sample_t;
+/* @[declare_mpu6886_fifo_sample_t] */
+
+/**
+ * @brief State of the activity metric: the RMS of the high-passed
+ * acceleration magnitude.
+ *
+ * The first-order high-pass filter removes gravity and slow tilts, so a
+ * still device reads close to 0 g and typing or moving at the desk raises
+ * the metric.
+ */
+/* @[declare_mpu6886_activity_t] */
+typedef struct {
+    float alpha;
+    bool primed;
+    float previous[3];
+    float filtered[3];
+    float sum_squares;
+    uint32_t count;
+} mpu6886_activity_t;
+/* @[declare_mpu6886_activity_t] */
+
+/**
+ * @brief Decodes one FIFO packet.
+ *
+ * @param[in] packet `MPU6886_FIFO_PACKET_SIZE` bytes read from FIFO_R_W.
+ * @param[out] sample The decoded raw values.
+ */
+/* @[declare_mpu6886_decodefifopacket] */
+void MPU6886_DecodeFifoPacket(const uint8_t *packet, mpu6886_fifo_sample_t *sample);
+/* @[declare_mpu6886_decodefifopacket] */
+
+/**
+ * @brief Converts a raw temperature to degrees Celsius.
+ */
+/* @[declare_mpu6886_tempadctocelsius] */
+float MPU6886_TempAdcToCelsius(int16_t temp);
+/* @[declare_mpu6886_tempadctocelsius] */
+
+/**
+ * @brief Initializes the activity metric.
+ *
+ * @param[out] activity The state to initialize.
+ * @param[in] sample_rate_hz The rate samples are added at.
+ * @param[in] cutoff_hz The cut-off frequency of the high-pass filter.
+ */
+/* @[declare_mpu6886_activity_init] */
+void MPU6886_Activity_Init(mpu6886_activity_t *activity, float sample_rate_hz, float cutoff_hz);
+/* @[declare_mpu6886_activity_init] */
+
+/**
+ * @brief Adds an acceleration sample, in Gs.
+ */
+/* @[declare_mpu6886_activity_add] */
+void MPU6886_Activity_Add(mpu6886_activity_t *activity, float ax, float ay, float az);
+/* @[declare_mpu6886_activity_add] */
+
+/**
+ * @brief Returns the RMS of the high-passed acceleration, in Gs, over the
+ * samples added since the previous call, and starts a new period.
+ *
+ * @return 0 if no sample was added.
+ */
+/* @[declare_mpu6886_activity_takerms] */
+float MPU6886_Activity_TakeRms(mpu6886_activity_t *activity);
+/* @[declare_mpu6886_activity_takerms] */
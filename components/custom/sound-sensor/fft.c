@@ -41,23 +41,59 @@
 
 #include "fft.h"
 
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#define fft_twiddle_alloc(bytes) heap_caps_malloc((bytes), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#else
+#define fft_twiddle_alloc(bytes) malloc(bytes)
+#endif
+
 #define TWO_PI 6.28318530
+
+// 1.0 in Q15, rounded down so that cos(0) fits in an int16_t
+#define Q15_ONE 32767
+
+// Block floating point: before a butterfly stage, the block is shifted right
+// until every component is below 2^bits, so that the stage output fits in
+// 16 bits. The first radix-4 pass grows a component by up to 4, the other
+// radix-2 stages by up to 1 + sqrt(2).
+#define Q15_RADIX4_PASS_BITS 13
+#define Q15_STAGE_BITS 13
 #define USE_SPLIT_RADIX 1
 #define LARGE_BASE_CASE 1
 
+int fft_size_supported(int size, fft_type_t type)
+{
+  /*
+   * The recursion bottoms out in fft4, so a complex FFT needs 4 points and
+   * a real one (a complex FFT of half its size) 8.
+   */
+  int min_size = (type == FFT_COMPLEX) ? 4 : 8;
+  return size >= min_size && (size & (size-1)) == 0;
+}
+
 fft_config_t *fft_init(int size, fft_type_t type, fft_direction_t direction, float *input, float *output)
 {
   /*
    * Prepare an FFT of correct size and types.
    *
    * If no input or output buffers are provided, they will be allocated.
+   * FFT_REAL_Q15 has no float buffers; its plans come from fft_plan_acquire.
    */
   int k,m;
 
-  fft_config_t *config = (fft_config_t *)malloc(sizeof(fft_config_t));
+  if (type != FFT_REAL && type != FFT_COMPLEX)
+    return NULL;
 
-  // Check if the size is a power of two
-  if ((size & (size-1)) != 0)  // tests if size is a power of two
+  // Check if the size is a power of two the transforms can handle
+  if (!fft_size_supported(size, type))
+    return NULL;
+
+  // A real FFT takes size samples, a complex one size pairs
+  int buffer_len = (type == FFT_REAL) ? size : 2 * size;
+
+  fft_config_t *config = (fft_config_t *)malloc(sizeof(fft_config_t));
+  if (config == NULL)
     return NULL;
 
   // start configuration
@@ -65,9 +101,16 @@ fft_config_t *fft_init(int size, fft_type_t type, fft_direction_t direction, flo
   config->type = type;
   config->direction = direction;
   config->size = size;
+  config->input = input;
+  config->output = output;
 
   // Allocate and precompute twiddle factors
   config->twiddle_factors = (float *)malloc(2 * config->size * sizeof(float));
+  if (config->twiddle_factors == NULL)
+  {
+    fft_destroy(config);
+    return NULL;
+  }
 
   float two_pi_by_n = TWO_PI / config->size;
 
@@ -78,37 +121,29 @@ fft_config_t *fft_init(int size, fft_type_t type, fft_direction_t direction, flo
   }
 
   // Allocate input buffer
-  if (input != NULL)
-    config->input = input;
-  else 
+  if (input == NULL)
   {
-    if (config->type == FFT_REAL)
-      config->input = (float *)malloc(config->size * sizeof(float));
-    else if (config->type == FFT_COMPLEX)
-      config->input = (float *)malloc(2 * config->size * sizeof(float));
-
+    config->input = (float *)malloc(buffer_len * sizeof(float));
+    if (config->input == NULL)
+    {
+      fft_destroy(config);
+      return NULL;
+    }
     config->flags |= FFT_OWN_INPUT_MEM;
   }
 
-  if (config->input == NULL)
-    return NULL;
-
   // Allocate output buffer
-  if (output != NULL)
-    config->output = output;
-  else
+  if (output == NULL)
   {
-    if (config->type == FFT_REAL)
-      config->output = (float *)malloc(config->size * sizeof(float));
-    else if (config->type == FFT_COMPLEX)
-      config->output = (float *)malloc(2 * config->size * sizeof(float));
-
+    config->output = (float *)malloc(buffer_len * sizeof(float));
+    if (config->output == NULL)
+    {
+      fft_destroy(config);
+      return NULL;
+    }
     config->flags |= FFT_OWN_OUTPUT_MEM;
   }
 
-  if (config->output == NULL)
-    return NULL;
-
   return config;
 }
 
@@ -136,6 +171,310 @@ void fft_execute(fft_config_t *config)
     ifft(config->input, config->output, config->twiddle_factors, config->size);
 }
 
+static fft_plan_t plan_cache[FFT_PLAN_CACHE_SIZE];
+
+fft_plan_t *fft_plan_acquire(int size, fft_type_t type, fft_direction_t direction)
+{
+  /*
+   * Get the cached plan of this size, type and direction, or create it.
+   *
+   * Unlike fft_init, the twiddle factors are only computed the first time a
+   * plan is acquired and no buffers are allocated: the caller passes its own
+   * (e.g. statically allocated) buffers to fft_plan_execute, so running a
+   * cached plan does not touch the heap.
+   *
+   * Each call must be balanced by fft_plan_release. The cache is not locked,
+   * so plans must be acquired and released from a single task.
+   *
+   * Returns NULL if the size is not supported (see fft_size_supported), the
+   * cache is full or the twiddle factors cannot be allocated.
+   */
+  int k, m;
+  fft_plan_t *free_slot = NULL;
+
+  if (!fft_size_supported(size, type))
+    return NULL;
+
+  for (k = 0 ; k < FFT_PLAN_CACHE_SIZE ; k++)
+  {
+    fft_plan_t *plan = &plan_cache[k];
+    if (plan->refs == 0)
+    {
+      if (free_slot == NULL)
+        free_slot = plan;
+    }
+    else if (plan->size == size && plan->type == type && plan->direction == direction)
+    {
+      plan->refs++;
+      return plan;
+    }
+  }
+
+  if (free_slot == NULL)
+    return NULL;
+
+  float two_pi_by_n = TWO_PI / size;
+  if (type == FFT_REAL_Q15)
+  {
+    // Only the first quarter turn is used by rfft_q15
+    if (direction != FFT_FORWARD)
+      return NULL;
+
+    free_slot->twiddle_q15 = (int16_t *)fft_twiddle_alloc(size / 2 * sizeof(int16_t));
+    if (free_slot->twiddle_q15 == NULL)
+      return NULL;
+
+    for (k = 0, m = 0 ; k < size / 4 ; k++, m+=2)
+    {
+      free_slot->twiddle_q15[m] = (int16_t)lrintf(Q15_ONE * cosf(two_pi_by_n * k));    // real
+      free_slot->twiddle_q15[m+1] = (int16_t)lrintf(Q15_ONE * sinf(two_pi_by_n * k));  // imag
+    }
+  }
+  else
+  {
+    free_slot->twiddle_factors = (float *)fft_twiddle_alloc(2 * size * sizeof(float));
+    if (free_slot->twiddle_factors == NULL)
+      return NULL;
+
+    for (k = 0, m = 0 ; k < size ; k++, m+=2)
+    {
+      free_slot->twiddle_factors[m] = cosf(two_pi_by_n * k);    // real
+      free_slot->twiddle_factors[m+1] = sinf(two_pi_by_n * k);  // imag
+    }
+  }
+
+  free_slot->size = size;
+  free_slot->type = type;
+  free_slot->direction = direction;
+  free_slot->refs = 1;
+  return free_slot;
+}
+
+void fft_plan_release(fft_plan_t *plan)
+{
+  /*
+   * Release a plan returned by fft_plan_acquire. The twiddle factors are
+   * freed with the last reference.
+   */
+  if (plan == NULL || plan->refs == 0)
+    return;
+
+  if (--plan->refs == 0)
+  {
+    free(plan->twiddle_factors);
+    free(plan->twiddle_q15);
+    plan->twiddle_factors = NULL;
+    plan->twiddle_q15 = NULL;
+  }
+}
+
+void fft_plan_execute(const fft_plan_t *plan, float *input, float *output)
+{
+  /*
+   * Run a cached plan, like fft_execute.
+   *
+   * The buffers hold `size` floats for a real FFT and `2 * size` floats
+   * (interleaved real/imaginary parts) for a complex one.
+   */
+  if (plan->type == FFT_REAL && plan->direction == FFT_FORWARD)
+    rfft(input, output, plan->twiddle_factors, plan->size);
+  else if (plan->type == FFT_REAL && plan->direction == FFT_BACKWARD)
+    irfft(input, output, plan->twiddle_factors, plan->size);
+  else if (plan->type == FFT_COMPLEX && plan->direction == FFT_FORWARD)
+    fft(input, output, plan->twiddle_factors, plan->size);
+  else if (plan->type == FFT_COMPLEX && plan->direction == FFT_BACKWARD)
+    ifft(input, output, plan->twiddle_factors, plan->size);
+}
+
+int fft_plan_execute_q15(const fft_plan_t *plan, const int16_t *input, int16_t *output)
+{
+  /*
+   * Run a cached FFT_REAL_Q15 plan, see rfft_q15.
+   */
+  return rfft_q15(input, output, plan->twiddle_q15, plan->size);
+}
+
+static inline int32_t magnitude_bound_q15(int32_t v)
+{
+  /*
+   * |v| for v >= 0 and |v| - 1 otherwise, without a branch. OR-ing these over
+   * a block gives a value with the same highest bit as the largest one.
+   */
+  return v ^ (v >> 31);
+}
+
+static int block_shift_q15(int32_t bound, int limit_bits)
+{
+  /*
+   * Number of bits a block has to be shifted right so that every component
+   * is below 2^limit_bits. The shift is applied as the next stage loads its
+   * inputs and is added to the block exponent.
+   */
+  int shift = 0;
+  while ((bound >> shift) >= (1 << limit_bits))
+    shift++;
+  return shift;
+}
+
+// Loads a block component scaled by the current block shift, rounding
+#define LOAD_Q15(v) (((int32_t)(v) + round) >> shift)
+
+// Radix-2 DIT butterfly a, b = a + W b, a - W b with W = c - j s, in place
+#define BUTTERFLY_Q15(a, b, c, s) \
+  do { \
+    int16_t *pa = (a), *pb = (b); \
+    int32_t ar = LOAD_Q15(pa[0]), ai = LOAD_Q15(pa[1]); \
+    int32_t br = LOAD_Q15(pb[0]), bi = LOAD_Q15(pb[1]); \
+    int32_t tr = (br * (c) + bi * (s) + (1 << 14)) >> 15; \
+    int32_t ti = (bi * (c) - br * (s) + (1 << 14)) >> 15; \
+    int32_t a0 = ar + tr, a1 = ai + ti, b0 = ar - tr, b1 = ai - ti; \
+    pa[0] = (int16_t)a0; \
+    pa[1] = (int16_t)a1; \
+    pb[0] = (int16_t)b0; \
+    pb[1] = (int16_t)b1; \
+    bound |= magnitude_bound_q15(a0) | magnitude_bound_q15(a1) \
+      | magnitude_bound_q15(b0) | magnitude_bound_q15(b1); \
+  } while (0)
+
+int rfft_q15(const int16_t *x, int16_t *y, const int16_t *twiddle_q15, int n)
+{
+  /*
+   * Forward real FFT of int16 samples in Q15 with block floating point
+   *
+   * The n samples are read as n / 2 complex samples (two-for-the-price-of-one,
+   * like rfft), so the I2S buffer can be passed as is. The complex FFT is an
+   * out-of-place radix-2 DIT with 32-bit intermediate products; the block is
+   * scaled down before a stage only when it could overflow.
+   *
+   * Parameters
+   * ----------
+   *  x (const int16_t *)
+   *    The n real input samples
+   *  y (int16_t *)
+   *    The output, in the layout of rfft: [X0, X(n/2), Re(X1), Im(X1), ...]
+   *  twiddle_q15 (const int16_t *)
+   *    The first n / 4 twiddle factors of size n in Q15, interleaved
+   *  n (int)
+   *    The FFT size, a power of 2 of at least 8
+   *
+   * Returns
+   * -------
+   *  The block exponent e: rfft(x) ~= y * 2^e. See host_test/fft_q15_test.c
+   *  for the error against the float rfft.
+   */
+  int half = n / 2;
+  int exponent = 0;
+  int32_t bound = 0;
+  int i, j, k, span;
+
+  // Bit-reversed copy of the complex samples, with a reversed counter
+  for (i = 0, j = 0 ; i < half ; i++)
+  {
+    y[2*j] = x[2*i];
+    y[2*j+1] = x[2*i+1];
+    bound |= magnitude_bound_q15(x[2*i]) | magnitude_bound_q15(x[2*i+1]);
+
+    int bit = half >> 1;
+    while (j & bit)
+    {
+      j ^= bit;
+      bit >>= 1;
+    }
+    j |= bit;
+  }
+
+  // Spans 1 and 2 only use the twiddles 1 and -j: a radix-4 first pass
+  int shift = block_shift_q15(bound, Q15_RADIX4_PASS_BITS);
+  int32_t round = (1 << shift) >> 1;
+  exponent += shift;
+  bound = 0;
+  for (k = 0 ; k < n ; k += 8)
+  {
+    int16_t *v = &y[k];
+    int32_t v0 = LOAD_Q15(v[0]), v1 = LOAD_Q15(v[1]), v2 = LOAD_Q15(v[2]), v3 = LOAD_Q15(v[3]);
+    int32_t v4 = LOAD_Q15(v[4]), v5 = LOAD_Q15(v[5]), v6 = LOAD_Q15(v[6]), v7 = LOAD_Q15(v[7]);
+    int32_t ar = v0 + v2, ai = v1 + v3;
+    int32_t br = v0 - v2, bi = v1 - v3;
+    int32_t cr = v4 + v6, ci = v5 + v7;
+    int32_t dr = v4 - v6, di = v5 - v7;
+
+    // d * -j = (di, -dr)
+    int32_t out[8] = {
+      ar + cr, ai + ci, br + di, bi - dr,
+      ar - cr, ai - ci, br - di, bi + dr
+    };
+    for (i = 0 ; i < 8 ; i++)
+    {
+      v[i] = (int16_t)out[i];
+      bound |= magnitude_bound_q15(out[i]);
+    }
+  }
+
+  for (span = 4 ; span < half ; span *= 2)
+  {
+    // The butterflies of this stage use W_(2 span)^j = W_n^(j * tw_stride)
+    int tw_stride = half / span;
+    shift = block_shift_q15(bound, Q15_STAGE_BITS);
+    round = (1 << shift) >> 1;
+    exponent += shift;
+    bound = 0;
+
+    for (k = 0 ; k < half ; k += 2 * span)
+    {
+      // W_n^m for j < span / 2; the second half of the group uses the same
+      // twiddles a quarter turn later, -j W_n^m = (-s, c)
+      for (j = 0 ; j < span / 2 ; j++)
+      {
+        int32_t c = twiddle_q15[2 * j * tw_stride];
+        int32_t s = twiddle_q15[2 * j * tw_stride + 1];
+        BUTTERFLY_Q15(&y[2*(k + j)], &y[2*(k + j + span)], c, s);
+        BUTTERFLY_Q15(&y[2*(k + j + span/2)], &y[2*(k + j + span/2 + span)], -s, c);
+      }
+    }
+  }
+
+  // The post processing of rfft grows a component by up to 1 + sqrt(2)
+  shift = block_shift_q15(bound, Q15_STAGE_BITS);
+  round = (1 << shift) >> 1;
+  exponent += shift;
+
+  int32_t t = LOAD_Q15(y[0]);
+  int32_t center = LOAD_Q15(y[1]);
+  y[0] = (int16_t)(t + center);  // DC coefficient
+  y[1] = (int16_t)(t - center);  // Center coefficient
+
+  y[half] = (int16_t)LOAD_Q15(y[half]);
+  y[half+1] = (int16_t)-LOAD_Q15(y[half+1]);
+
+  for (k = 2 ; k < half ; k += 2)
+  {
+    int32_t xer, xei, xor_t, xoi, tr, ti;
+    int32_t c = twiddle_q15[k];
+    int32_t s = twiddle_q15[k+1];
+    int32_t yr = LOAD_Q15(y[k]), yi = LOAD_Q15(y[k+1]);
+    int32_t zr = LOAD_Q15(y[n-k]), zi = LOAD_Q15(y[n-k+1]);
+
+    // even half coefficient
+    xer = (yr + zr) >> 1;
+    xei = (yi - zi) >> 1;
+
+    // odd half coefficient
+    xor_t = (yi + zi) >> 1;
+    xoi = -((yr - zr) >> 1);
+
+    tr = (c * xor_t + s * xoi + (1 << 14)) >> 15;
+    ti = (-s * xor_t + c * xoi + (1 << 14)) >> 15;
+
+    y[k]   = (int16_t)(xer + tr);
+    y[k+1] = (int16_t)(xei + ti);
+
+    y[n-k]   = (int16_t)(xer - tr);
+    y[n-k+1] = (int16_t)-(xei - ti);
+  }
+
+  return exponent;
+}
+
 void fft(float *input, float *output, float *twiddle_factors, int n)
 {
   /*
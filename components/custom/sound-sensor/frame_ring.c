@@ -0,0 +1,58 @@
+#include "frame_ring.h"
+
+#define FRAME_RING_MASK (FRAME_RING_SLOTS - 1)
+
+_Static_assert((FRAME_RING_SLOTS & FRAME_RING_MASK) == 0,
+    "FRAME_RING_SLOTS must be a power of two");
+
+static inline int16_t *slot(frame_ring_t *ring, uint32_t index) {
+    return ring->storage + (index & FRAME_RING_MASK) * ring->frame_samples;
+}
+
+void FrameRing_Init(frame_ring_t *ring, int16_t *storage, size_t frame_samples) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    ring->storage = storage;
+    ring->frame_samples = frame_samples;
+}
+
+int16_t *FrameRing_WriteSlot(frame_ring_t *ring) {
+    return slot(ring, atomic_load_explicit(&ring->head, memory_order_relaxed));
+}
+
+bool FrameRing_Commit(frame_ring_t *ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    // The write slot is never one the consumer may still be reading.
+    if (head - tail == FRAME_RING_SLOTS - 1) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+const int16_t *FrameRing_Peek(frame_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (atomic_load_explicit(&ring->head, memory_order_acquire) == tail) {
+        return NULL;
+    }
+    return slot(ring, tail);
+}
+
+void FrameRing_Release(frame_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+size_t FrameRing_Pending(const frame_ring_t *ring) {
+    frame_ring_t *r = (frame_ring_t *)ring;
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return atomic_load_explicit(&r->head, memory_order_acquire) - tail;
+}
+
+uint32_t FrameRing_Dropped(const frame_ring_t *ring) {
+    return atomic_load_explicit(&((frame_ring_t *)ring)->dropped, memory_order_relaxed);
+}
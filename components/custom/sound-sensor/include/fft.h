@@ -37,10 +37,13 @@
 #ifndef __FFT_H__
 #define __FFT_H__
 
+#include <stdint.h>
+
 typedef enum
 {
   FFT_REAL,
-  FFT_COMPLEX
+  FFT_COMPLEX,
+  FFT_REAL_Q15  // forward real FFT of int16 samples, plans only
 } fft_type_t;
 
 typedef enum
@@ -63,9 +66,28 @@ typedef struct
   unsigned int flags; // FFT flags
 } fft_config_t;
 
+// Number of distinct size/type/direction plans that can be cached at once
+#define FFT_PLAN_CACHE_SIZE 4
+
+typedef struct
+{
+  int size;  // FFT size
+  fft_type_t type;   // real or complex
+  fft_direction_t direction; // forward or backward
+  float *twiddle_factors;  // precomputed once, in internal RAM on the ESP32
+  int16_t *twiddle_q15;  // the same in Q15, for FFT_REAL_Q15 plans
+  unsigned int refs; // number of fft_plan_acquire calls not yet released
+} fft_plan_t;
+
+int fft_size_supported(int size, fft_type_t type);
 fft_config_t *fft_init(int size, fft_type_t type, fft_direction_t direction, float *input, float *output);
 void fft_destroy(fft_config_t *config);
 void fft_execute(fft_config_t *config);
+fft_plan_t *fft_plan_acquire(int size, fft_type_t type, fft_direction_t direction);
+void fft_plan_release(fft_plan_t *plan);
+void fft_plan_execute(const fft_plan_t *plan, float *input, float *output);
+int fft_plan_execute_q15(const fft_plan_t *plan, const int16_t *input, int16_t *output);
+int rfft_q15(const int16_t *x, int16_t *y, const int16_t *twiddle_q15, int n);
 void fft(float *input, float *output, float *twiddle_factors, int n);
 void ifft(float *input, float *output, float *twiddle_factors, int n);
 void rfft(float *x, float *y, float *twiddle_factors, int n);
@@ -0,0 +1,68 @@
+/**
+ * @file frame_ring.h
+ * @brief A lock-free, single-producer/single-consumer ring of fixed-size
+ * audio frames that hands frames over without copying them.
+ *
+ * The producer fills the slot returned by `FrameRing_WriteSlot` in place
+ * (e.g. `i2s_read` straight into it) and commits it; the consumer processes
+ * the oldest committed frame in place and releases it. One slot is always
+ * reserved for the producer, so it never waits: when the consumer falls
+ * behind, the frame being committed is dropped and its slot reused, and the
+ * drop is counted.
+ *
+ * @note Exactly one task may produce and one task may consume.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Number of frame slots. Must be a power of two; one is the producer's. */
+#define FRAME_RING_SLOTS 16
+
+typedef struct {
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+    int16_t *storage;
+    size_t frame_samples;
+} frame_ring_t;
+
+/**
+ * @brief Resets the ring to an empty state. Not safe against concurrent use.
+ *
+ * @param storage `FRAME_RING_SLOTS * frame_samples` samples, owned by the caller.
+ */
+void FrameRing_Init(frame_ring_t *ring, int16_t *storage, size_t frame_samples);
+
+/**
+ * @brief Returns the slot the producer fills next. It stays the same until
+ * the frame is committed.
+ */
+int16_t *FrameRing_WriteSlot(frame_ring_t *ring);
+
+/**
+ * @brief Hands the filled write slot to the consumer.
+ *
+ * @return false if the ring was full: the frame was dropped and the slot
+ * will be written again.
+ */
+bool FrameRing_Commit(frame_ring_t *ring);
+
+/**
+ * @brief Returns the oldest committed frame, or NULL if there is none. It
+ * stays valid until `FrameRing_Release`.
+ */
+const int16_t *FrameRing_Peek(frame_ring_t *ring);
+
+/** @brief Returns the frame from `FrameRing_Peek` to the producer. */
+void FrameRing_Release(frame_ring_t *ring);
+
+/** @brief Returns the number of committed frames not released yet. */
+size_t FrameRing_Pending(const frame_ring_t *ring);
+
+/** @brief Returns the number of frames dropped because the ring was full. */
+uint32_t FrameRing_Dropped(const frame_ring_t *ring);
@@ -0,0 +1,53 @@
+/**
+ * @file sound_classifier.h
+ * @brief Tells which kind of noise fills a second of audio from its Welch
+ * band levels: speech, HVAC (fans, air conditioning), keyboard or music.
+ *
+ * The model is a multinomial logistic regression with int8 weights in a
+ * `const` table (`sound_classifier_weights.h`, generated by
+ * `host_test/sound_classifier_train.py`). Its features are the 1/3-octave
+ * spectrum shape relative to the loudest band, the fluctuation of the frame
+ * levels and the peak-to-mean ratio of the frame spectra. Seconds whose
+ * loudest band is below `SOUND_CLASSIFIER_QUIET_DB` are quiet and are not
+ * classified.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "welch_psd.h"
+
+/** Loudest 1/3-octave band, in dB of full scale, below which a second is quiet. */
+#define SOUND_CLASSIFIER_QUIET_DB -80
+
+/** Lowest band level kept in the spectrum shape, relative to the loudest band. */
+#define SOUND_CLASSIFIER_SHAPE_FLOOR_DB -60
+
+#define SOUND_CLASSIFIER_FEATURES (WELCH_THIRD_OCTAVE_BANDS + 2)
+
+typedef enum {
+    SOUND_CLASS_QUIET,
+    SOUND_CLASS_SPEECH,
+    SOUND_CLASS_HVAC,
+    SOUND_CLASS_KEYBOARD,
+    SOUND_CLASS_MUSIC,
+    SOUND_CLASS_COUNT
+} sound_class_t;
+
+typedef struct {
+    sound_class_t label;
+    float confidence;  // probability of the label, 0 to 1
+} sound_classification_t;
+
+/** @brief Returns the lowercase name of a class, e.g. "speech". */
+const char *SoundClassifier_Name(sound_class_t label);
+
+/** @brief Fills `SOUND_CLASSIFIER_FEATURES` model inputs from a second's band levels. */
+void SoundClassifier_Features(const welch_bands_t *bands, int8_t *features);
+
+/**
+ * @brief Classifies a second of audio from its band levels. Quiet seconds
+ * are `SOUND_CLASS_QUIET` with a confidence of 1.
+ */
+sound_classification_t SoundClassifier_Classify(const welch_bands_t *bands);
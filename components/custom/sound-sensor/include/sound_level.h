@@ -0,0 +1,83 @@
+/**
+ * @file sound_level.h
+ * @brief An A-weighted sound level meter over a continuous stream of
+ * microphone samples.
+ *
+ * Samples go through the IEC 61672 A-weighting filter, realised as a
+ * cascade of three biquads designed for the sample rate, and their squares
+ * are integrated into:
+ * - LAeq over the last second and over the last minute (equivalent
+ *   continuous level, i.e. the mean energy in dB),
+ * - LAFmax over the last second (the maximum of the exponentially "fast"
+ *   time-weighted level, 125 ms time constant).
+ *
+ * Levels are in dBA SPL, calibrated with the microphone's sensitivity: the
+ * dBFS reading of a 94 dB SPL tone, where 0 dBFS is a full-scale sine.
+ * Results change once per second of processed audio.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Seconds of LAeq history kept for the long average. */
+#define SOUND_LEVEL_LONG_SECONDS 60
+
+/** Levels below this are reported as it (silence, or no signal at all). */
+#define SOUND_LEVEL_FLOOR_DB 0.0f
+
+/** One biquad section, transposed direct form II. */
+typedef struct {
+    float b0, b1, b2;
+    float a1, a2;
+    float z1, z2;
+} sound_level_biquad_t;
+
+/** The levels of the last completed second. */
+typedef struct {
+    float laeq_1s;
+    float laeq_1min;
+    float lafmax;
+    uint32_t seconds;  // completed seconds since SoundLevel_Init
+} sound_level_readout_t;
+
+typedef struct {
+    sound_level_biquad_t stages[3];
+    float gain;
+    float full_scale_db;
+
+    float fast_alpha;
+    float fast_ms;
+    float second_fast_max;
+    float second_sum;
+    uint32_t second_count;
+    uint32_t samples_per_second;
+
+    float second_ms[SOUND_LEVEL_LONG_SECONDS];
+    uint32_t seconds;
+
+    sound_level_readout_t readout;
+} sound_level_t;
+
+/**
+ * @brief Designs the A-weighting filter for the sample rate and resets the meter.
+ *
+ * @param sample_rate_hz Rate of the samples passed to `SoundLevel_Process`.
+ * @param sensitivity_dbfs dBFS of a 94 dB SPL 1 kHz tone.
+ */
+void SoundLevel_Init(sound_level_t *meter, uint32_t sample_rate_hz, float sensitivity_dbfs);
+
+/**
+ * @brief Adds samples; every completed second updates the readout.
+ */
+void SoundLevel_Process(sound_level_t *meter, const int16_t *samples, size_t count);
+
+/** @brief Returns the levels of the last completed second. */
+sound_level_readout_t SoundLevel_Latest(const sound_level_t *meter);
+
+/**
+ * @brief Returns the gain of the designed A-weighting filter at a
+ * frequency, in dB (0 dB at 1 kHz).
+ */
+float SoundLevel_WeightingDb(const sound_level_t *meter, float frequency_hz);
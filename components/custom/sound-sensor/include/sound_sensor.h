@@ -13,20 +13,79 @@
 
 #pragma once
 #include <ctype.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "sound_classifier.h"
+#include "sound_level.h"
+#include "welch_psd.h"
+
+/** Counters of the microphone capture task. */
+typedef struct {
+    uint32_t frames;          // frames read from the I2S driver
+    uint32_t dropped_frames;  // frames dropped because SoundSensor_Poll fell behind
+    uint32_t dma_overruns;    // DMA buffers the driver overwrote before they were read
+    uint32_t pending_frames;  // frames waiting for SoundSensor_Poll
+} sound_capture_stats_t;
+
+/**
+ * @brief Initializes the sound sensor for measuring the A-weighted sound
+ * level of the surrounding area.
+ * 
+ * Sets up the `Microphone` component provided by core2forAWS at
+ * `CONFIG_SOUND_SENSOR_SAMPLE_RATE` and starts a capture task that reads it
+ * continuously into a ring of frames. The frames are analysed by calling
+ * `SoundSensor_Poll` periodically.
+ *
+ * @note Creates a FreeRTOS task with the name `sound_capture`; give it a
+ * higher priority than the task calling `SoundSensor_Poll`.
+ *
+ * @param capturePriority priority of the capture task.
+ */
+void SoundSensor_Init(UBaseType_t capturePriority);
 
 /**
- * @brief Initializes the sound sensor for reading the maximum volume of the
- * surrounding area.
+ * @brief Runs every frame captured since the last poll through the
+ * A-weighted sound level meter and the Welch spectrum estimator.
+ * 
+ * @note Meant to be run periodically as a sensor scheduler read callback,
+ * often enough that the `FRAME_RING_SLOTS` frames do not fill up.
  * 
- * Creates a FreeRTOS task with the name `SoundSensor_Task`, which reads input
- * from the `Microphone` component provided by core2forAWS, performs a
- * FFT and stores the max of the sample for later reads.
+ * @param context unused.
  */
-void SoundSensor_Init();
+void SoundSensor_Poll(void *context);
 
 /**
- * @brief Returns the last recorded max volume from the latest microphone sample. 
+ * @brief Returns the sound levels of the last completed second, in dBA.
  * 
- * @return last max recorded volume.
-*/
-uint8_t SoundSensor_GetVolume();
\ No newline at end of file
+ * @note Not synchronized with `SoundSensor_Poll`; call it from the same task.
+ */
+sound_level_readout_t SoundSensor_GetLevels();
+
+/**
+ * @brief Returns the octave and 1/3-octave band levels of the last completed
+ * second (`seconds` is 0 until there is one).
+ *
+ * @note Not synchronized with `SoundSensor_Poll`; call it from the same task.
+ */
+welch_bands_t SoundSensor_GetBands();
+
+/**
+ * @brief Returns the noise type of the last completed second, and how sure
+ * the classifier is of it. `SOUND_CLASS_QUIET` until there is one.
+ *
+ * @note Not synchronized with `SoundSensor_Poll`; call it from the same task.
+ */
+sound_classification_t SoundSensor_GetNoiseType();
+
+/**
+ * @brief Returns the exponentially averaged power spectral density, in full
+ * scale^2 per Hz, and its number of bins (0 if it is not available).
+ *
+ * @note Updated by `SoundSensor_Poll`; read it from the same task.
+ */
+const float *SoundSensor_GetPsd(size_t *bins);
+
+/** @brief Returns the capture task's counters. */
+sound_capture_stats_t SoundSensor_GetCaptureStats();
@@ -0,0 +1,137 @@
+/**
+ * @file welch_psd.h
+ * @brief Welch power spectral density estimate of a continuous stream of
+ * microphone samples, and its octave and 1/3-octave band energies.
+ *
+ * Samples are copied once, into a ring holding the last FFT frame. Every
+ * `hop` new samples the ring is read oldest first through a Hann or
+ * Blackman window (a Q15 table shared by every estimator of the same size)
+ * into the Q15 real FFT. Each frame's periodogram updates an exponentially
+ * averaged PSD in a caller-owned buffer, and is summed into the bands; the
+ * band energies are averaged over each second of samples.
+ *
+ * Bands follow the base-10 series of IEC 61260: octaves centred from 63 Hz
+ * to 4 kHz and 1/3-octaves from 50 Hz to 5 kHz. Bins are split across band
+ * edges in proportion to their overlap, so the narrow low bands are only as
+ * sharp as the FFT's bin spacing. Bands above the Nyquist frequency read
+ * `WELCH_BAND_FLOOR_DB`.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fft.h"
+
+/** Number of distinct type/size windows that can be shared at once. */
+#define WELCH_WINDOW_CACHE_SIZE 2
+
+#define WELCH_OCTAVE_BANDS 7
+#define WELCH_THIRD_OCTAVE_BANDS 21
+
+/** Band level reported for no energy at all. */
+#define WELCH_BAND_FLOOR_DB INT8_MIN
+
+typedef enum {
+    WELCH_WINDOW_HANN,
+    WELCH_WINDOW_BLACKMAN,
+} welch_window_type_t;
+
+/** A periodic window of `size` Q15 coefficients. */
+typedef struct {
+    welch_window_type_t type;
+    int size;
+    int16_t *coefficients;
+    float power_sum;  // sum of the squared coefficients, as fractions of 1
+    unsigned int refs;
+} welch_window_t;
+
+/**
+ * Band levels of one second of samples, in whole dB relative to a
+ * full-scale sine (a full-scale sine in a single band reads 0 dB), and two
+ * shape features of its frames:
+ * - fluctuation_db, the standard deviation of the frame levels: near 0 for
+ *   steady noise, large for speech and clicks.
+ * - peak_to_mean_db, the mean ratio of a frame's strongest bin to its mean
+ *   bin: about 8 dB for white noise, more for tones and harmonics.
+ */
+typedef struct {
+    int8_t octave_db[WELCH_OCTAVE_BANDS];
+    int8_t third_octave_db[WELCH_THIRD_OCTAVE_BANDS];
+    int8_t fluctuation_db;
+    int8_t peak_to_mean_db;
+    uint32_t seconds;  // completed seconds since WelchPsd_Init
+} welch_bands_t;
+
+/** Centre frequencies of the bands, in Hz. */
+extern const float welch_octave_centers_hz[WELCH_OCTAVE_BANDS];
+extern const float welch_third_octave_centers_hz[WELCH_THIRD_OCTAVE_BANDS];
+
+typedef struct {
+    int size;
+    int hop;
+    uint32_t sample_rate;
+    float smoothing;
+    welch_window_t *window;
+    fft_plan_t *plan;
+
+    int16_t *ring;
+    int16_t *frame;
+    int16_t *spectrum;
+    float *periodogram;
+    float *psd;
+    int write;
+    int filled;
+    int since_frame;
+    uint32_t frames;
+
+    // Band edges in bins, and the sums of the current second
+    float octave_edges[WELCH_OCTAVE_BANDS + 1];
+    float third_octave_edges[WELCH_THIRD_OCTAVE_BANDS + 1];
+    float octave_sum[WELCH_OCTAVE_BANDS];
+    float third_octave_sum[WELCH_THIRD_OCTAVE_BANDS];
+    float level_sum;
+    float level_square_sum;
+    float peak_to_mean_sum;
+    uint32_t second_frames;
+    uint32_t second_samples;
+    welch_bands_t bands;
+} welch_psd_t;
+
+/**
+ * @brief Gets the shared window of this type and size, computing it the
+ * first time. Balance every call with `WelchPsd_ReleaseWindow`.
+ *
+ * @note Not locked; acquire and release windows from a single task.
+ *
+ * @return NULL if the cache is full or the table cannot be allocated.
+ */
+welch_window_t *WelchPsd_AcquireWindow(welch_window_type_t type, int size);
+
+/** @brief Releases a window; the last release frees its table. */
+void WelchPsd_ReleaseWindow(welch_window_t *window);
+
+/**
+ * @brief Sets up an estimator.
+ *
+ * @param size FFT size, a power of two.
+ * @param overlap_percent Overlap of consecutive frames, 0 to 75.
+ * @param smoothing Weight of a new periodogram in the averaged PSD, in (0, 1].
+ * @param psd `size / 2 + 1` bins of PSD output, in full scale^2 per Hz,
+ * owned by the caller.
+ *
+ * @return false if the window, FFT plan or buffers cannot be allocated.
+ */
+bool WelchPsd_Init(welch_psd_t *estimator, int size, uint32_t sample_rate,
+    welch_window_type_t window, int overlap_percent, float smoothing, float *psd);
+
+/** @brief Releases what `WelchPsd_Init` acquired. The PSD buffer stays the caller's. */
+void WelchPsd_Free(welch_psd_t *estimator);
+
+/** @brief Adds samples, running a frame every `hop` of them. */
+void WelchPsd_Process(welch_psd_t *estimator, const int16_t *samples, size_t count);
+
+/** @brief Returns the band levels of the last completed second. */
+welch_bands_t WelchPsd_Bands(const welch_psd_t *estimator);
@@ -0,0 +1,79 @@
+#include <math.h>
+
+#include "sound_classifier.h"
+#include "sound_classifier_weights.h"
+
+_Static_assert(SOUND_CLASSIFIER_WEIGHT_FEATURES == SOUND_CLASSIFIER_FEATURES,
+    "regenerate sound_classifier_weights.h for the current features");
+_Static_assert(SOUND_CLASSIFIER_WEIGHT_CLASSES == SOUND_CLASS_COUNT - 1,
+    "regenerate sound_classifier_weights.h for the current classes");
+
+#define MAX_SHAPE_FEATURE_DB 60
+
+static const char *const classNames[SOUND_CLASS_COUNT] = {
+    "quiet", "speech", "hvac", "keyboard", "music"
+};
+
+const char *SoundClassifier_Name(sound_class_t label) {
+    return (label < SOUND_CLASS_COUNT) ? classNames[label] : "unknown";
+}
+
+static int8_t loudest_band(const welch_bands_t *bands) {
+    int8_t loudest = WELCH_BAND_FLOOR_DB;
+    for (int b = 0; b < WELCH_THIRD_OCTAVE_BANDS; b++) {
+        if (bands->third_octave_db[b] > loudest) {
+            loudest = bands->third_octave_db[b];
+        }
+    }
+    return loudest;
+}
+
+static int8_t clamp_feature(int value, int low, int high) {
+    return (int8_t)(value < low ? low : (value > high ? high : value));
+}
+
+void SoundClassifier_Features(const welch_bands_t *bands, int8_t *features) {
+    int loudest = loudest_band(bands);
+    for (int b = 0; b < WELCH_THIRD_OCTAVE_BANDS; b++) {
+        features[b] = clamp_feature(bands->third_octave_db[b] - loudest, SOUND_CLASSIFIER_SHAPE_FLOOR_DB, 0);
+    }
+    features[WELCH_THIRD_OCTAVE_BANDS] = clamp_feature(bands->fluctuation_db, 0, MAX_SHAPE_FEATURE_DB);
+    features[WELCH_THIRD_OCTAVE_BANDS + 1] = clamp_feature(bands->peak_to_mean_db, 0, MAX_SHAPE_FEATURE_DB);
+}
+
+sound_classification_t SoundClassifier_Classify(const welch_bands_t *bands) {
+    sound_classification_t result = { .label = SOUND_CLASS_QUIET, .confidence = 1.0f };
+    if (loudest_band(bands) < SOUND_CLASSIFIER_QUIET_DB) {
+        return result;
+    }
+
+    int8_t features[SOUND_CLASSIFIER_FEATURES];
+    SoundClassifier_Features(bands, features);
+
+    // int8 x int8 dot products in int32, then a softmax over the few logits.
+    float logits[SOUND_CLASSIFIER_WEIGHT_CLASSES];
+    float largest = -INFINITY;
+    for (int c = 0; c < SOUND_CLASSIFIER_WEIGHT_CLASSES; c++) {
+        int32_t sum = soundClassifierBias[c];
+        for (int i = 0; i < SOUND_CLASSIFIER_FEATURES; i++) {
+            sum += (int32_t)soundClassifierWeights[c][i] * features[i];
+        }
+        logits[c] = sum * SOUND_CLASSIFIER_SCALE;
+        largest = fmaxf(largest, logits[c]);
+    }
+
+    float total = 0;
+    int best = 0;
+    for (int c = 0; c < SOUND_CLASSIFIER_WEIGHT_CLASSES; c++) {
+        logits[c] = expf(logits[c] - largest);
+        total += logits[c];
+        if (logits[c] > logits[best]) {
+            best = c;
+        }
+    }
+
+    // The model's classes follow SOUND_CLASS_QUIET.
+    result.label = (sound_class_t)(best + 1);
+    result.confidence = logits[best] / total;
+    return result;
+}
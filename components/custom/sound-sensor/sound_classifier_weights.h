@@ -0,0 +1,28 @@
+/**
+ * @file sound_classifier_weights.h
+ * @brief Generated by host_test/sound_classifier_train.py; do not edit.
+ *
+ * Multinomial logistic regression over 23 features, trained on 800 seconds
+ * of audio (99.6% training accuracy after int8 quantization).
+ * Logit of class c: SOUND_CLASSIFIER_SCALE * (bias[c] + sum weights[c][i] * feature[i]),
+ * for the classes after SOUND_CLASS_QUIET.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define SOUND_CLASSIFIER_WEIGHT_CLASSES 4
+#define SOUND_CLASSIFIER_WEIGHT_FEATURES 23
+#define SOUND_CLASSIFIER_SCALE 6.864604404e-03f
+
+static const int8_t soundClassifierWeights[SOUND_CLASSIFIER_WEIGHT_CLASSES][SOUND_CLASSIFIER_WEIGHT_FEATURES] = {
+    { 5, -8, -6, -3, -4, -6, 3, 0, 0, 0, 2, 7, 0, 2, -17, -14, -13, 1, 4, 6, 10, 39, 69 },  // speech
+    { 18, 14, 4, 2, 1, 8, 5, 2, 4, 10, 4, -2, -4, 5, 2, 0, -1, -6, -2, 2, 5, -8, -3 },  // hvac
+    { 1, 1, 1, 0, 1, -2, -8, -2, -6, -11, -7, -6, 1, 1, 7, 15, 17, 10, -3, -7, -10, 7, -127 },  // keyboard
+    { -24, -7, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 4, -8, 9, 0, -2, -6, 1, 0, -6, -37, 61 },  // music
+};
+
+static const int32_t soundClassifierBias[SOUND_CLASSIFIER_WEIGHT_CLASSES] = {
+    -1546, 1233, 1540, -1227
+};
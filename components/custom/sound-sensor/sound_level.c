@@ -0,0 +1,135 @@
+#include <math.h>
+#include <string.h>
+
+#include "sound_level.h"
+
+// Pole frequencies of the analog A-weighting filter (IEC 61672-1).
+#define A_WEIGHTING_F1 20.598997
+#define A_WEIGHTING_F2 107.65265
+#define A_WEIGHTING_F3 737.86223
+#define A_WEIGHTING_F4 12194.217
+
+#define FAST_TIME_CONSTANT_S 0.125
+#define REFERENCE_SPL_DB 94.0f
+// Mean square of a full-scale sine, in dB.
+#define FULL_SCALE_SINE_DB -3.0103f
+#define SAMPLE_SCALE (1.0f / 32768.0f)
+
+// Bilinear transform (s = 2 fs (1 - 1/z) / (1 + 1/z)) of the analog section
+// (b2 s^2 + b1 s + b0) / (s^2 + a1 s + a0).
+static void design_section(sound_level_biquad_t *stage, double fs,
+        double b2, double b1, double b0, double a1, double a0) {
+    double k = 2.0 * fs;
+    double k2 = k * k;
+    double norm = k2 + a1 * k + a0;
+
+    stage->b0 = (float)((b2 * k2 + b1 * k + b0) / norm);
+    stage->b1 = (float)((2.0 * b0 - 2.0 * b2 * k2) / norm);
+    stage->b2 = (float)((b2 * k2 - b1 * k + b0) / norm);
+    stage->a1 = (float)((2.0 * a0 - 2.0 * k2) / norm);
+    stage->a2 = (float)((k2 - a1 * k + a0) / norm);
+    stage->z1 = 0;
+    stage->z2 = 0;
+}
+
+// |H(e^jw)| of the cascade without the overall gain.
+static double cascade_magnitude(const sound_level_t *meter, double frequency_hz) {
+    double w = 2.0 * M_PI * frequency_hz / meter->samples_per_second;
+    double c1 = cos(w), s1 = -sin(w), c2 = cos(2 * w), s2 = -sin(2 * w);
+    double magnitude = 1.0;
+
+    for (int i = 0; i < 3; i++) {
+        const sound_level_biquad_t *stage = &meter->stages[i];
+        double nr = stage->b0 + stage->b1 * c1 + stage->b2 * c2;
+        double ni = stage->b1 * s1 + stage->b2 * s2;
+        double dr = 1.0 + stage->a1 * c1 + stage->a2 * c2;
+        double di = stage->a1 * s1 + stage->a2 * s2;
+        magnitude *= sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+    }
+    return magnitude;
+}
+
+static inline float run_biquad(sound_level_biquad_t *stage, float x) {
+    float y = stage->b0 * x + stage->z1;
+    stage->z1 = stage->b1 * x - stage->a1 * y + stage->z2;
+    stage->z2 = stage->b2 * x - stage->a2 * y;
+    return y;
+}
+
+static float level_db(const sound_level_t *meter, float mean_square) {
+    if (mean_square <= 0) {
+        return SOUND_LEVEL_FLOOR_DB;
+    }
+    float level = 10.0f * log10f(mean_square) + meter->full_scale_db;
+    return level > SOUND_LEVEL_FLOOR_DB ? level : SOUND_LEVEL_FLOOR_DB;
+}
+
+void SoundLevel_Init(sound_level_t *meter, uint32_t sample_rate_hz, float sensitivity_dbfs) {
+    memset(meter, 0, sizeof(*meter));
+    meter->samples_per_second = sample_rate_hz;
+    meter->full_scale_db = REFERENCE_SPL_DB - sensitivity_dbfs - FULL_SCALE_SINE_DB;
+    meter->fast_alpha = (float)(1.0 - exp(-1.0 / (FAST_TIME_CONSTANT_S * sample_rate_hz)));
+
+    // s^2 / (s + w1)^2, s^2 / ((s + w2)(s + w3)) and w4^2 / (s + w4)^2
+    double w1 = 2.0 * M_PI * A_WEIGHTING_F1;
+    double w2 = 2.0 * M_PI * A_WEIGHTING_F2;
+    double w3 = 2.0 * M_PI * A_WEIGHTING_F3;
+    double w4 = 2.0 * M_PI * A_WEIGHTING_F4;
+    design_section(&meter->stages[0], sample_rate_hz, 1, 0, 0, 2 * w1, w1 * w1);
+    design_section(&meter->stages[1], sample_rate_hz, 1, 0, 0, w2 + w3, w2 * w3);
+    design_section(&meter->stages[2], sample_rate_hz, 0, 0, w4 * w4, 2 * w4, w4 * w4);
+
+    // A-weighting is 0 dB at 1 kHz by definition.
+    meter->gain = (float)(1.0 / cascade_magnitude(meter, 1000.0));
+}
+
+static void complete_second(sound_level_t *meter) {
+    float mean_square = meter->second_sum / meter->second_count;
+    meter->second_ms[meter->seconds % SOUND_LEVEL_LONG_SECONDS] = mean_square;
+    meter->seconds++;
+
+    uint32_t filled = meter->seconds < SOUND_LEVEL_LONG_SECONDS ? meter->seconds : SOUND_LEVEL_LONG_SECONDS;
+    float long_sum = 0;
+    for (uint32_t i = 0; i < filled; i++) {
+        long_sum += meter->second_ms[i];
+    }
+
+    meter->readout.laeq_1s = level_db(meter, mean_square);
+    meter->readout.laeq_1min = level_db(meter, long_sum / filled);
+    meter->readout.lafmax = level_db(meter, meter->second_fast_max);
+    meter->readout.seconds = meter->seconds;
+
+    meter->second_sum = 0;
+    meter->second_count = 0;
+    meter->second_fast_max = 0;
+}
+
+void SoundLevel_Process(sound_level_t *meter, const int16_t *samples, size_t count) {
+    float scale = meter->gain * SAMPLE_SCALE;
+
+    for (size_t i = 0; i < count; i++) {
+        float x = samples[i] * scale;
+        x = run_biquad(&meter->stages[0], x);
+        x = run_biquad(&meter->stages[1], x);
+        x = run_biquad(&meter->stages[2], x);
+
+        float square = x * x;
+        meter->second_sum += square;
+        meter->fast_ms += meter->fast_alpha * (square - meter->fast_ms);
+        if (meter->fast_ms > meter->second_fast_max) {
+            meter->second_fast_max = meter->fast_ms;
+        }
+
+        if (++meter->second_count == meter->samples_per_second) {
+            complete_second(meter);
+        }
+    }
+}
+
+sound_level_readout_t SoundLevel_Latest(const sound_level_t *meter) {
+    return meter->readout;
+}
+
+float SoundLevel_WeightingDb(const sound_level_t *meter, float frequency_hz) {
+    return (float)(20.0 * log10(meter->gain * cascade_magnitude(meter, frequency_hz)));
+}
@@ -5,80 +5,162 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
-#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "driver/i2s.h"
 #include "esp_log.h"
 
 #include "core2forAWS.h"
 
-#include "fft.h"
+#include "frame_ring.h"
+#include "sound_classifier.h"
+#include "sound_level.h"
+#include "sound_sensor.h"
+#include "welch_psd.h"
 
-#define AUDIO_TIME_SLICES 60
+// 32 ms of audio at 16 kHz per frame.
+#define FRAME_SAMPLES 512
+
+// 4 x 256 samples is 64 ms of audio at 16 kHz that the capture task may fall
+// behind by before the I2S driver overwrites it.
+#define DMA_BUF_COUNT 4
+#define DMA_BUF_LEN 256
+#define DMA_BUF_BYTES (DMA_BUF_LEN * sizeof(int16_t))
+#define I2S_EVENT_QUEUE_LENGTH 16
+
+// Half-overlapping Hann frames; a new periodogram weighs a quarter in the PSD.
+#define PSD_OVERLAP_PERCENT 50
+#define PSD_SMOOTHING 0.25f
 
 static const char *TAG = "SoundSensor";
-static SemaphoreHandle_t thread_mutex;
-static uint8_t reportedSound;
-
-// Helper function for working with audio data
-long map(long x, long in_min, long in_max, long out_min, long out_max) {
-    long divisor = (in_max - in_min);
-    if(divisor == 0){
-        return -1; //AVR returns -1, SAM returns 0
-    }
-    return (x - in_min) * (out_max - out_min) / divisor + out_min;
-}
 
-// Underlying task for this process.
-void microphone_task() {
-    static int8_t i2s_readraw_buff[1024];
-    size_t bytesread;
-    int16_t *buffptr;
-    double data = 0;
+// Only touched by SoundSensor_Poll and the getters, on the same task.
+static sound_level_t meter;
+static welch_psd_t spectrum;
+static float soundPsd[FRAME_SAMPLES / 2 + 1];
+static bool spectrumReady;
+static sound_classification_t noiseType = { .label = SOUND_CLASS_QUIET, .confidence = 1.0f };
+static bool capturing;
+
+// Filled by the capture task straight from the I2S driver, drained by
+// SoundSensor_Poll on the sensor scheduler.
+static int16_t frameStorage[FRAME_RING_SLOTS * FRAME_SAMPLES];
+static frame_ring_t captureRing;
+static QueueHandle_t i2sEvents;
+static atomic_uint capturedFrames;
+static atomic_uint dmaOverruns;
+
+// Every I2S_EVENT_RX_DONE is a DMA buffer the driver filled. Once more of
+// them than the DMA can hold are unread, the driver has overwritten audio
+// the capture task never got.
+static void account_dma_buffers(size_t bytesRead) {
+    static uint32_t filledBuffers;
+    static uint64_t readBytes;
+    static uint32_t lostBuffers;
+    i2s_event_t event;
+
+    while (xQueueReceive(i2sEvents, &event, 0) == pdTRUE) {
+        if (event.type == I2S_EVENT_RX_DONE) {
+            filledBuffers++;
+        } else if (event.type == I2S_EVENT_DMA_ERROR) {
+            atomic_fetch_add(&dmaOverruns, 1);
+        }
+    }
 
-    Microphone_Init();
-    uint8_t maxSound = 0x00;
-    uint8_t currentSound = 0x00;
+    readBytes += bytesRead;
+    int32_t unread = (int32_t)(filledBuffers - (uint32_t)(readBytes / DMA_BUF_BYTES)) - DMA_BUF_COUNT;
+    if (unread > (int32_t)lostBuffers) {
+        atomic_fetch_add(&dmaOverruns, unread - lostBuffers);
+        lostBuffers = unread;
+    }
+}
 
+// Keeps the I2S DMA drained: reads every frame into the ring and goes
+// straight back to the driver.
+static void capture_task(void *param) {
     for (;;) {
-        maxSound = 0x00;
-        fft_config_t *real_fft_plan = 
-            fft_init(512, FFT_REAL, FFT_FORWARD, NULL, NULL);
-        i2s_read(I2S_NUM_0, (char *)i2s_readraw_buff, 1024, &bytesread, pdMS_TO_TICKS(100));
-        buffptr = (int16_t *)i2s_readraw_buff;
-        for (uint16_t count_n = 0; count_n < real_fft_plan->size; count_n++) {
-            real_fft_plan->input[count_n] = (float)map(buffptr[count_n], INT16_MIN, INT16_MAX, -1000, 1000);
+        int16_t *frame = FrameRing_WriteSlot(&captureRing);
+        size_t bytesRead = 0;
+        i2s_read(MIC_I2S_NUMBER, frame, FRAME_SAMPLES * sizeof(int16_t), &bytesRead, portMAX_DELAY);
+        account_dma_buffers(bytesRead);
+
+        if (bytesRead == FRAME_SAMPLES * sizeof(int16_t)) {
+            atomic_fetch_add(&capturedFrames, 1);
+            FrameRing_Commit(&captureRing);
         }
-        fft_execute(real_fft_plan);
-
-        for (uint16_t count_n = 1; count_n < AUDIO_TIME_SLICES; count_n++) {
-            data = sqrt(real_fft_plan->output[2 * count_n] * real_fft_plan->output[2 * count_n] + real_fft_plan->output[2 * count_n + 1] * real_fft_plan->output[2 * count_n + 1]);
-            currentSound = map(data, 0, 2000, 0, 256);
-            if(currentSound > maxSound) {
-                maxSound = currentSound;
-            }
+    }
+}
+
+void SoundSensor_Poll(void *context) {
+    const int16_t *frame;
+
+    if (!capturing) {
+        return;
+    }
+
+    // Every frame captured since the last poll; the meter keeps its own time.
+    while ((frame = FrameRing_Peek(&captureRing)) != NULL) {
+        SoundLevel_Process(&meter, frame, FRAME_SAMPLES);
+        if (spectrumReady) {
+            WelchPsd_Process(&spectrum, frame, FRAME_SAMPLES);
         }
-        fft_destroy(real_fft_plan);
-
-        // Store max of sample in semaphore
-        xSemaphoreTake(thread_mutex, portMAX_DELAY);
-        reportedSound = maxSound;
-        xSemaphoreGive(thread_mutex);
-        
-        // Minor delay to avoid bumping into other tasks
-        vTaskDelay(pdMS_TO_TICKS(100));
+        FrameRing_Release(&captureRing);
+    }
+
+    // Classify each second once, as its bands complete.
+    static uint32_t classifiedSeconds;
+    welch_bands_t bands = SoundSensor_GetBands();
+    if (bands.seconds != classifiedSeconds) {
+        noiseType = SoundClassifier_Classify(&bands);
+        classifiedSeconds = bands.seconds;
+    }
+}
+
+void SoundSensor_Init(UBaseType_t capturePriority) {
+    microphone_config_t config = MICROPHONE_CONFIG_DEFAULT();
+    config.sample_rate = CONFIG_SOUND_SENSOR_SAMPLE_RATE;
+    config.dma_buf_count = DMA_BUF_COUNT;
+    config.dma_buf_len = DMA_BUF_LEN;
+    config.event_queue_length = I2S_EVENT_QUEUE_LENGTH;
+    if (Microphone_InitWithConfig(&config, &i2sEvents) != ESP_OK) {
+        ESP_LOGE(TAG, "Couldn't start the microphone at %d Hz.", CONFIG_SOUND_SENSOR_SAMPLE_RATE);
+        return;
+    }
+
+    SoundLevel_Init(&meter, CONFIG_SOUND_SENSOR_SAMPLE_RATE, CONFIG_SOUND_SENSOR_MIC_SENSITIVITY_DBFS);
+    spectrumReady = WelchPsd_Init(&spectrum, FRAME_SAMPLES, CONFIG_SOUND_SENSOR_SAMPLE_RATE,
+        WELCH_WINDOW_HANN, PSD_OVERLAP_PERCENT, PSD_SMOOTHING, soundPsd);
+    if (!spectrumReady) {
+        ESP_LOGE(TAG, "Couldn't create the %d point spectrum estimator.", FRAME_SAMPLES);
     }
-    vTaskDelete(NULL);
+    FrameRing_Init(&captureRing, frameStorage, FRAME_SAMPLES);
+    capturing = true;
+    // Core 0, away from the UI and sensor scheduler; it mostly waits on DMA.
+    xTaskCreatePinnedToCore(&capture_task, "sound_capture", 2048, NULL, capturePriority, NULL, 0);
+}
+
+sound_level_readout_t SoundSensor_GetLevels() {
+    return SoundLevel_Latest(&meter);
+}
+
+welch_bands_t SoundSensor_GetBands() {
+    return spectrumReady ? WelchPsd_Bands(&spectrum) : (welch_bands_t){ .seconds = 0 };
+}
+
+sound_classification_t SoundSensor_GetNoiseType() {
+    return noiseType;
 }
 
-void SoundSensor_Init() {
-    thread_mutex = xSemaphoreCreateMutex();
-    xTaskCreatePinnedToCore(
-        &microphone_task, "SoundSensor_Task", 4096, NULL, 1, NULL, 1);
+const float *SoundSensor_GetPsd(size_t *bins) {
+    *bins = spectrumReady ? FRAME_SAMPLES / 2 + 1 : 0;
+    return soundPsd;
 }
 
-uint8_t SoundSensor_GetVolume() {
-    xSemaphoreTake(thread_mutex, portMAX_DELAY);
-    uint8_t result = reportedSound;
-    xSemaphoreGive(thread_mutex);
-    return result;
-}
\ No newline at end of file
+sound_capture_stats_t SoundSensor_GetCaptureStats() {
+    sound_capture_stats_t stats = {
+        .frames = atomic_load(&capturedFrames),
+        .dropped_frames = FrameRing_Dropped(&captureRing),
+        .dma_overruns = atomic_load(&dmaOverruns),
+        .pending_frames = FrameRing_Pending(&captureRing),
+    };
+    return stats;
+}
@@ -0,0 +1,291 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "welch_psd.h"
+
+#define Q15_ONE 32767.0f
+#define Q15_SCALE (1.0f / 32768.0f)
+#define MAX_OVERLAP_PERCENT 75
+
+// Base-10 band series of IEC 61260: centre 1000 * 10^(k / 10) Hz and edges
+// a half band away on either side.
+#define OCTAVE_FIRST_INDEX -12
+#define OCTAVE_STEP 3
+#define THIRD_OCTAVE_FIRST_INDEX -13
+
+// Frame level of silence, so that it still counts towards the fluctuation.
+#define SILENT_FRAME_DB -120.0f
+
+const float welch_octave_centers_hz[WELCH_OCTAVE_BANDS] = {
+    63, 125, 250, 500, 1000, 2000, 4000
+};
+const float welch_third_octave_centers_hz[WELCH_THIRD_OCTAVE_BANDS] = {
+    50, 63, 80, 100, 125, 160, 200, 250, 315, 400, 500,
+    630, 800, 1000, 1250, 1600, 2000, 2500, 3150, 4000, 5000
+};
+
+static welch_window_t window_cache[WELCH_WINDOW_CACHE_SIZE];
+
+welch_window_t *WelchPsd_AcquireWindow(welch_window_type_t type, int size) {
+    welch_window_t *free_slot = NULL;
+
+    for (int i = 0; i < WELCH_WINDOW_CACHE_SIZE; i++) {
+        welch_window_t *window = &window_cache[i];
+        if (window->refs == 0) {
+            if (free_slot == NULL) {
+                free_slot = window;
+            }
+        } else if (window->type == type && window->size == size) {
+            window->refs++;
+            return window;
+        }
+    }
+    if (free_slot == NULL) {
+        return NULL;
+    }
+
+    int16_t *coefficients = malloc(size * sizeof(int16_t));
+    if (coefficients == NULL) {
+        return NULL;
+    }
+
+    // Periodic windows, so that overlapping frames add up evenly.
+    float power_sum = 0;
+    for (int n = 0; n < size; n++) {
+        double phase = 2.0 * M_PI * n / size;
+        double w = (type == WELCH_WINDOW_HANN)
+            ? 0.5 - 0.5 * cos(phase)
+            : 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+        coefficients[n] = (int16_t)lrint(Q15_ONE * w);
+        power_sum += (coefficients[n] * Q15_SCALE) * (coefficients[n] * Q15_SCALE);
+    }
+
+    free_slot->type = type;
+    free_slot->size = size;
+    free_slot->coefficients = coefficients;
+    free_slot->power_sum = power_sum;
+    free_slot->refs = 1;
+    return free_slot;
+}
+
+void WelchPsd_ReleaseWindow(welch_window_t *window) {
+    if (window == NULL || window->refs == 0) {
+        return;
+    }
+    if (--window->refs == 0) {
+        free(window->coefficients);
+        window->coefficients = NULL;
+    }
+}
+
+static void band_edges(float *edges, int count, int first_index, int step, float bin_hz) {
+    for (int b = 0; b <= count; b++) {
+        float edge_index = first_index + step * b - step / 2.0f;
+        edges[b] = 1000.0f * powf(10.0f, edge_index / 10.0f) / bin_hz;
+    }
+}
+
+bool WelchPsd_Init(welch_psd_t *estimator, int size, uint32_t sample_rate,
+        welch_window_type_t window, int overlap_percent, float smoothing, float *psd) {
+    memset(estimator, 0, sizeof(*estimator));
+    if (overlap_percent < 0 || overlap_percent > MAX_OVERLAP_PERCENT || smoothing <= 0 || smoothing > 1) {
+        return false;
+    }
+
+    estimator->size = size;
+    estimator->hop = size * (100 - overlap_percent) / 100;
+    estimator->sample_rate = sample_rate;
+    estimator->smoothing = smoothing;
+    estimator->psd = psd;
+    estimator->window = WelchPsd_AcquireWindow(window, size);
+    estimator->plan = fft_plan_acquire(size, FFT_REAL_Q15, FFT_FORWARD);
+    estimator->ring = malloc(size * sizeof(int16_t));
+    estimator->frame = malloc(size * sizeof(int16_t));
+    estimator->spectrum = malloc(size * sizeof(int16_t));
+    estimator->periodogram = malloc((size / 2 + 1) * sizeof(float));
+
+    if (estimator->window == NULL || estimator->plan == NULL || estimator->ring == NULL
+            || estimator->frame == NULL || estimator->spectrum == NULL || estimator->periodogram == NULL) {
+        WelchPsd_Free(estimator);
+        return false;
+    }
+
+    float bin_hz = (float)sample_rate / size;
+    band_edges(estimator->octave_edges, WELCH_OCTAVE_BANDS, OCTAVE_FIRST_INDEX, OCTAVE_STEP, bin_hz);
+    band_edges(estimator->third_octave_edges, WELCH_THIRD_OCTAVE_BANDS, THIRD_OCTAVE_FIRST_INDEX, 1, bin_hz);
+    for (int b = 0; b < WELCH_OCTAVE_BANDS; b++) {
+        estimator->bands.octave_db[b] = WELCH_BAND_FLOOR_DB;
+    }
+    for (int b = 0; b < WELCH_THIRD_OCTAVE_BANDS; b++) {
+        estimator->bands.third_octave_db[b] = WELCH_BAND_FLOOR_DB;
+    }
+    return true;
+}
+
+void WelchPsd_Free(welch_psd_t *estimator) {
+    WelchPsd_ReleaseWindow(estimator->window);
+    if (estimator->plan != NULL) {
+        fft_plan_release(estimator->plan);
+    }
+    free(estimator->ring);
+    free(estimator->frame);
+    free(estimator->spectrum);
+    free(estimator->periodogram);
+    estimator->window = NULL;
+    estimator->plan = NULL;
+    estimator->ring = estimator->frame = estimator->spectrum = NULL;
+    estimator->periodogram = NULL;
+}
+
+// Adds the mean square of the bins each band covers, where bin k spans
+// [k - 1/2, k + 1/2).
+static void add_bands(const float *periodogram, int bins, const float *edges, float *sums, int count) {
+    for (int b = 0; b < count; b++) {
+        float low = edges[b], high = edges[b + 1];
+        int first = (int)floorf(low + 0.5f);
+        int last = (int)floorf(high + 0.5f);
+        if (last >= bins) {
+            last = bins - 1;
+        }
+
+        for (int k = first; k <= last; k++) {
+            float overlap = fminf(k + 0.5f, high) - fmaxf(k - 0.5f, low);
+            if (overlap > 0) {
+                sums[b] += overlap * periodogram[k];
+            }
+        }
+    }
+}
+
+static void run_frame(welch_psd_t *estimator) {
+    int size = estimator->size;
+    int bins = size / 2 + 1;
+    const int16_t *window = estimator->window->coefficients;
+
+    // Oldest sample first: the ring from the write position on, then wrapped.
+    for (int i = 0, j = estimator->write; i < size; i++) {
+        estimator->frame[i] = (int16_t)(((int32_t)estimator->ring[j] * window[i] + (1 << 14)) >> 15);
+        if (++j == size) {
+            j = 0;
+        }
+    }
+    int exponent = fft_plan_execute_q15(estimator->plan, estimator->frame, estimator->spectrum);
+
+    // Mean square per bin, one-sided: sum |X|^2 * 2^2e / (N sum w^2) in full scale^2.
+    const int16_t *y = estimator->spectrum;
+    float scale = ldexpf(Q15_SCALE * Q15_SCALE / (size * estimator->window->power_sum), 2 * exponent);
+    float *periodogram = estimator->periodogram;
+    periodogram[0] = scale * y[0] * y[0];
+    periodogram[bins - 1] = scale * y[1] * y[1];
+    for (int k = 1; k < bins - 1; k++) {
+        int32_t re = y[2 * k], im = y[2 * k + 1];
+        periodogram[k] = 2.0f * scale * (float)((uint32_t)(re * re) + (uint32_t)(im * im));
+    }
+
+    // Frame level and the strongest bin against the mean one, DC excluded.
+    float total = 0, peak = 0;
+    for (int k = 1; k < bins; k++) {
+        total += periodogram[k];
+        peak = fmaxf(peak, periodogram[k]);
+    }
+    float level = total > 0 ? 10.0f * log10f(total) : SILENT_FRAME_DB;
+    level = fmaxf(level, SILENT_FRAME_DB);
+    estimator->level_sum += level;
+    estimator->level_square_sum += level * level;
+    if (total > 0) {
+        estimator->peak_to_mean_sum += 10.0f * log10f(peak * (bins - 1) / total);
+    }
+
+    float bin_hz = (float)estimator->sample_rate / size;
+    for (int k = 0; k < bins; k++) {
+        float density = periodogram[k] / bin_hz;
+        estimator->psd[k] = (estimator->frames == 0)
+            ? density
+            : estimator->psd[k] + estimator->smoothing * (density - estimator->psd[k]);
+    }
+
+    add_bands(periodogram, bins, estimator->octave_edges, estimator->octave_sum, WELCH_OCTAVE_BANDS);
+    add_bands(periodogram, bins, estimator->third_octave_edges, estimator->third_octave_sum, WELCH_THIRD_OCTAVE_BANDS);
+    estimator->frames++;
+    estimator->second_frames++;
+}
+
+static int8_t clamp_db(float db) {
+    db = roundf(db);
+    return db < INT8_MIN ? INT8_MIN : (db > INT8_MAX ? INT8_MAX : (int8_t)db);
+}
+
+static int8_t band_db(float sum, uint32_t frames) {
+    if (frames == 0 || sum <= 0) {
+        return WELCH_BAND_FLOOR_DB;
+    }
+    // Relative to the mean square of a full-scale sine, 1/2.
+    return clamp_db(10.0f * log10f(2.0f * sum / frames));
+}
+
+static void complete_second(welch_psd_t *estimator) {
+    for (int b = 0; b < WELCH_OCTAVE_BANDS; b++) {
+        estimator->bands.octave_db[b] = band_db(estimator->octave_sum[b], estimator->second_frames);
+        estimator->octave_sum[b] = 0;
+    }
+    for (int b = 0; b < WELCH_THIRD_OCTAVE_BANDS; b++) {
+        estimator->bands.third_octave_db[b] = band_db(estimator->third_octave_sum[b], estimator->second_frames);
+        estimator->third_octave_sum[b] = 0;
+    }
+
+    uint32_t frames = estimator->second_frames;
+    float mean = frames > 0 ? estimator->level_sum / frames : 0;
+    float variance = frames > 0 ? estimator->level_square_sum / frames - mean * mean : 0;
+    estimator->bands.fluctuation_db = clamp_db(sqrtf(fmaxf(variance, 0)));
+    estimator->bands.peak_to_mean_db = clamp_db(frames > 0 ? estimator->peak_to_mean_sum / frames : 0);
+    estimator->level_sum = 0;
+    estimator->level_square_sum = 0;
+    estimator->peak_to_mean_sum = 0;
+
+    estimator->bands.seconds++;
+    estimator->second_frames = 0;
+    estimator->second_samples = 0;
+}
+
+void WelchPsd_Process(welch_psd_t *estimator, const int16_t *samples, size_t count) {
+    while (count > 0) {
+        // Copy up to the next frame, second or ring boundary.
+        size_t chunk = count;
+        int until_frame = estimator->hop - estimator->since_frame;
+        if (estimator->filled < estimator->size) {
+            until_frame = estimator->size - estimator->filled;
+        }
+        chunk = chunk < (size_t)until_frame ? chunk : (size_t)until_frame;
+        uint32_t until_second = estimator->sample_rate - estimator->second_samples;
+        chunk = chunk < until_second ? chunk : until_second;
+        chunk = chunk < (size_t)(estimator->size - estimator->write) ? chunk : (size_t)(estimator->size - estimator->write);
+
+        memcpy(estimator->ring + estimator->write, samples, chunk * sizeof(int16_t));
+        estimator->write = (estimator->write + chunk) % estimator->size;
+        samples += chunk;
+        count -= chunk;
+        estimator->second_samples += chunk;
+
+        if (estimator->filled < estimator->size) {
+            estimator->filled += chunk;
+            if (estimator->filled == estimator->size) {
+                run_frame(estimator);
+            }
+        } else {
+            estimator->since_frame += chunk;
+            if (estimator->since_frame == estimator->hop) {
+                estimator->since_frame = 0;
+                run_frame(estimator);
+            }
+        }
+
+        if (estimator->second_samples == estimator->sample_rate) {
+            complete_second(estimator);
+        }
+    }
+}
+
+welch_bands_t WelchPsd_Bands(const welch_psd_t *estimator) {
+    return estimator->bands;
+}
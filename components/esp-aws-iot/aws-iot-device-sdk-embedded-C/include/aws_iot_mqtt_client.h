@@ -64,6 +64,31 @@ extern "C" {
 /** Greatest packet identifier, per MQTT spec */
 #define MAX_PACKET_ID 65535
 
+#ifndef AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS
+/** Most payload segments aws_iot_mqtt_publishv takes; each costs an IoT_IOVec on the stack */
+#define AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS 8
+#endif
+
+#ifndef AWS_IOT_MQTT_PUBLISH_WINDOW
+/** Most QoS 1 publishes aws_iot_mqtt_publish_async keeps waiting for their PUBACK */
+#define AWS_IOT_MQTT_PUBLISH_WINDOW 8
+#endif
+
+#ifndef AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN
+/** Payload bytes handed to a streaming subscription per callback; the end of the read buffer holds them */
+#define AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN (AWS_IOT_MQTT_RX_BUF_LEN / 2)
+#endif
+
+#ifndef AWS_IOT_MQTT_TOPIC_INDEX_NODES
+/** Topic filter levels the subscription index holds; filters that do not fit are matched one by one */
+#define AWS_IOT_MQTT_TOPIC_INDEX_NODES (AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS * 4)
+#endif
+
+#ifndef AWS_IOT_MQTT_PUBLISH_MAX_RETRIES
+/** Retransmissions of an unacknowledged asynchronous publish before it fails */
+#define AWS_IOT_MQTT_PUBLISH_MAX_RETRIES 3
+#endif
+
 typedef struct _Client AWS_IoT_Client;
 
 /**
@@ -227,6 +252,19 @@ typedef enum _ClientState {
 typedef void (*pApplicationHandler_t)(AWS_IoT_Client *pClient, char *pTopicName, uint16_t topicNameLen,
 									  IoT_Publish_Message_Params *pParams, void *pClientData);
 
+/**
+ * @brief Application Streaming Callback Handler Type
+ *
+ * Defining a TYPE for definition of streaming callback function pointers.
+ * Called once per chunk of an incoming payload, in order. `pParams->payload`
+ * and `pParams->payloadLen` describe the chunk, which is only valid during the
+ * call; `payloadOffset` is its position in the payload of `payloadLen` bytes.
+ *
+ */
+typedef void (*pApplicationStreamHandler_t)(AWS_IoT_Client *pClient, char *pTopicName, uint16_t topicNameLen,
+											IoT_Publish_Message_Params *pParams, size_t payloadOffset,
+											size_t payloadLen, bool isFinal, void *pClientData);
+
 /**
  * @brief MQTT Message Handler
  *
@@ -240,9 +278,75 @@ typedef struct _MessageHandlers {
 	char resubscribed; ///< Whether this handler was successfully resubscribed in the reconnect workflow
 	QoS qos; ///< QoS of subscription
 	pApplicationHandler_t pApplicationHandler; ///< Application function to invoke
+	pApplicationStreamHandler_t pStreamHandler; ///< Application function to invoke per chunk instead, for a streaming subscription
 	void *pApplicationHandlerData; ///< Context to pass to application handler
 } MessageHandlers;   /* Message handlers are indexed by subscription topic */
 
+/**
+ * @brief Subscription Index Node
+ *
+ * One level of one or more topic filters. Filters sharing their first levels
+ * share the nodes for them.
+ *
+ */
+typedef struct _TopicIndexNode {
+	const char *pLevel; ///< Level of the filter, points into the topic name of a handler using this node
+	uint16_t levelLen; ///< Length of the level
+	uint16_t refCount; ///< Handlers whose filter passes through or ends at this node, 0 if the node is free
+	int16_t parent; ///< Node of the previous level, -1 for the root
+	int16_t plusChild; ///< Node of a '+' on the next level, -1 if none
+	int16_t hashChild; ///< Node of a trailing '#' on the next level, -1 if none
+	int16_t firstHandler; ///< First handler whose filter ends at this node, -1 if none
+} TopicIndexNode;
+
+/**
+ * @brief Subscription Index
+ *
+ * A tree of the subscribed topic filters, one level per node, that finds the
+ * handlers for an incoming topic without testing every filter. Literal levels
+ * are found through an open addressing table keyed by their parent and text.
+ *
+ */
+typedef struct _TopicIndex {
+	TopicIndexNode nodes[AWS_IOT_MQTT_TOPIC_INDEX_NODES]; ///< Node 0 is the root, above the first level
+	int16_t levelTable[AWS_IOT_MQTT_TOPIC_INDEX_NODES * 2]; ///< Nodes of literal levels, -1 for an empty slot
+	int16_t handlerNode[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS]; ///< Node each handler's filter ends at, -1 if not indexed
+	int16_t nextHandler[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS]; ///< Next handler ending at the same node, -1 if none
+	uint16_t freeNodes; ///< Nodes not in use
+	uint16_t unindexedHandlers; ///< Handlers left out for lack of nodes
+} TopicIndex;
+
+/**
+ * @brief Publish Completion Callback Handler Type
+ *
+ * Called once for every QoS 1 message of aws_iot_mqtt_publish_async, with SUCCESS
+ * when its PUBACK arrived or the error that ended it.
+ *
+ */
+typedef void (*pPublishCompleteHandler_t)(AWS_IoT_Client *pClient, uint16_t packetId, IoT_Error_t status,
+										  void *pCompleteHandlerData);
+
+/**
+ * @brief Asynchronous Publish In Flight
+ *
+ * A QoS 1 publish that was sent and is waiting for its PUBACK.
+ * The topic and payload are not copied; they belong to the application.
+ *
+ */
+typedef struct _PublishInFlight {
+	bool inUse; ///< Whether this entry holds a publish
+	uint16_t packetId; ///< Packet identifier the PUBACK will carry
+	uint8_t isRetained; ///< Retained flag of the message
+	uint8_t retransmitCount; ///< How many times the message was sent again with the DUP flag
+	const char *pTopicName; ///< Topic name of the message
+	uint16_t topicNameLen; ///< Length of topic name
+	const unsigned char *pPayload; ///< Payload of the message
+	size_t payloadLen; ///< Length of payload
+	Timer retransmitTimer; ///< Expires when the message is due to be sent again
+	pPublishCompleteHandler_t pCompleteHandler; ///< Application function to invoke on completion
+	void *pCompleteHandlerData; ///< Context to pass to completion handler
+} PublishInFlight;
+
 /**
  * @brief MQTT Client Status
  *
@@ -278,6 +382,10 @@ typedef struct _ClientData {
 	size_t writeBufSize; ///< Size of this client's outgoing data buffer
 	size_t readBufSize; ///< Size of this client's incoming data buffer
 	size_t readBufIndex; ///< Current offset into the incoming data buffer
+	size_t rxStreamedLen; ///< Payload bytes of the PUBLISH being streamed that were read
+	bool isRxStreaming; ///< Whether the PUBLISH being read is streamed to its handlers in chunks
+	bool isCorked; ///< Whether the network holds outgoing packets back, see aws_iot_mqtt_cork
+	Timer corkTimer; ///< Deadline for sending the packets held back
 	unsigned char writeBuf[AWS_IOT_MQTT_TX_BUF_LEN]; ///< Buffer for outgoing data
 	unsigned char readBuf[AWS_IOT_MQTT_RX_BUF_LEN]; ///< Buffer for incoming data
 
@@ -291,6 +399,8 @@ typedef struct _ClientData {
 	IoT_Client_Connect_Params options; ///< Options passed when the client was initialized
 
 	MessageHandlers messageHandlers[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS]; ///< Callbacks for incoming messages
+	TopicIndex topicIndex; ///< Finds the message handlers for an incoming topic
+	PublishInFlight publishesInFlight[AWS_IOT_MQTT_PUBLISH_WINDOW]; ///< Asynchronous publishes waiting for a PUBACK
 	iot_disconnect_handler disconnectHandler; ///< Callback when a disconnection is detected
 	void *disconnectHandlerData; ///< Context for disconnect handler
 } ClientData;
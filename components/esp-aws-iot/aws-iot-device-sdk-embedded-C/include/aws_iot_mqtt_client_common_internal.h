@@ -74,6 +74,9 @@ typedef enum msgTypes {
 #define MQTT_HEADER_FIELD_QOS(_byte)	((_byte & (3 << 1)) >> 1) /**< QoS */
 #define MQTT_HEADER_FIELD_RETAIN(_byte)	((_byte & (1 << 0)) >> 0) /**< Retain flag */
 
+/* Largest remaining length four bytes can encode, MQTT v3.1.1 Specification 2.2.3 */
+#define MQTT_MAX_REMAINING_LENGTH 268435455
+
 /**
  * Bitfields for the MQTT header byte.
  */
@@ -105,6 +108,8 @@ void aws_iot_mqtt_internal_write_utf8_string(unsigned char **pptr, const char *s
 
 IoT_Error_t aws_iot_mqtt_internal_flushBuffers( AWS_IoT_Client *pClient );
 IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t length, Timer *pTimer);
+IoT_Error_t aws_iot_mqtt_internal_send_packetv(AWS_IoT_Client *pClient, IoT_IOVec *pSegments, size_t segmentCount,
+											 Timer *pTimer);
 IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTimer, uint8_t *pPacketType);
 IoT_Error_t aws_iot_mqtt_internal_wait_for_read(AWS_IoT_Client *pClient, uint8_t packetType, Timer *pTimer);
 IoT_Error_t aws_iot_mqtt_internal_serialize_zero(unsigned char *pTxBuf, size_t txBufLen,
@@ -114,6 +119,15 @@ IoT_Error_t aws_iot_mqtt_internal_deserialize_publish(uint8_t *dup, QoS *qos,
 													  char **pTopicName, uint16_t *topicNameLen,
 													  unsigned char **payload, size_t *payloadLen,
 													  unsigned char *pRxBuf, size_t rxBufLen);
+IoT_Error_t aws_iot_mqtt_internal_handle_puback(AWS_IoT_Client *pClient, uint8_t *pPacketType);
+IoT_Error_t aws_iot_mqtt_internal_retransmit_publishes(AWS_IoT_Client *pClient);
+void aws_iot_mqtt_internal_fail_publishes(AWS_IoT_Client *pClient, IoT_Error_t status);
+
+void aws_iot_mqtt_internal_topic_index_init(AWS_IoT_Client *pClient);
+void aws_iot_mqtt_internal_topic_index_add(AWS_IoT_Client *pClient, uint32_t handlerIndex);
+void aws_iot_mqtt_internal_topic_index_remove(AWS_IoT_Client *pClient, uint32_t handlerIndex);
+uint32_t aws_iot_mqtt_internal_topic_index_match(AWS_IoT_Client *pClient, const char *pTopicName,
+												 uint16_t topicNameLen, uint16_t *pHandlerIndexes);
 
 IoT_Error_t aws_iot_mqtt_set_client_state(AWS_IoT_Client *pClient, ClientState expectedCurrentState,
 										  ClientState newState);
@@ -66,11 +66,15 @@ extern "C" {
  * - @functionname{mqtt_function_free}
  * - @functionname{mqtt_function_connect}
  * - @functionname{mqtt_function_publish}
+ * - @functionname{mqtt_function_cork}
+ * - @functionname{mqtt_function_uncork}
  * - @functionname{mqtt_function_subscribe}
+ * - @functionname{mqtt_function_subscribe_stream}
  * - @functionname{mqtt_function_resubscribe}
  * - @functionname{mqtt_function_unsubscribe}
  * - @functionname{mqtt_function_disconnect}
  * - @functionname{mqtt_function_yield}
+ * - @functionname{mqtt_function_get_next_yield_ms}
  * - @functionname{mqtt_function_attempt_reconnect}
  * - @functionname{mqtt_function_get_next_packet_id}
  * - @functionname{mqtt_function_set_connect_params}
@@ -88,11 +92,15 @@ extern "C" {
  * @functionpage{aws_iot_mqtt_free,mqtt,free}
  * @functionpage{aws_iot_mqtt_connect,mqtt,connect}
  * @functionpage{aws_iot_mqtt_publish,mqtt,publish}
+ * @functionpage{aws_iot_mqtt_cork,mqtt,cork}
+ * @functionpage{aws_iot_mqtt_uncork,mqtt,uncork}
  * @functionpage{aws_iot_mqtt_subscribe,mqtt,subscribe}
+ * @functionpage{aws_iot_mqtt_subscribe_stream,mqtt,subscribe_stream}
  * @functionpage{aws_iot_mqtt_resubscribe,mqtt,resubscribe}
  * @functionpage{aws_iot_mqtt_unsubscribe,mqtt,unsubscribe}
  * @functionpage{aws_iot_mqtt_disconnect,mqtt,disconnect}
  * @functionpage{aws_iot_mqtt_yield,mqtt,yield}
+ * @functionpage{aws_iot_mqtt_get_next_yield_ms,mqtt,get_next_yield_ms}
  * @functionpage{aws_iot_mqtt_attempt_reconnect,mqtt,attempt_reconnect}
  */
 
@@ -166,6 +174,101 @@ IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName
 								 IoT_Publish_Message_Params *pParams);
 /* @[declare_mqtt_publish] */
 
+/**
+ * @brief Publish an MQTT message whose payload is a list of segments.
+ *
+ * Works like @ref mqtt_function_publish, but the payload is not copied into the
+ * client's write buffer: only the fixed header, topic and packet identifier are
+ * serialized there, and the payload segments are handed to the network layer's
+ * writev as they are. The message is therefore not limited by `AWS_IOT_MQTT_TX_BUF_LEN`,
+ * only its header is.
+ *
+ * @param pClient MQTT client context
+ * @param pTopicName Topic name to publish to
+ * @param topicNameLen Length of the topic name
+ * @param pParams Publish message parameters; `payload` and `payloadLen` are not used
+ * @param pPayload The payload segments, in order. They stay owned by the caller and
+ * only need to be valid until the call returns
+ * @param payloadCount Number of payload segments, at most `AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS`
+ *
+ * @return `IoT_Error_t`: See `aws_iot_error.h`
+ */
+/* @[declare_mqtt_publishv] */
+IoT_Error_t aws_iot_mqtt_publishv(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+								  IoT_Publish_Message_Params *pParams, const IoT_IOVec *pPayload,
+								  size_t payloadCount);
+/* @[declare_mqtt_publishv] */
+
+/**
+ * @brief Publish an MQTT message without waiting for its PUBACK.
+ *
+ * Sends the message like @ref mqtt_function_publish and returns once it was
+ * passed to the TLS layer, with its packet identifier in `pParams->id`. Up to
+ * `AWS_IOT_MQTT_PUBLISH_WINDOW` QoS 1 messages can wait for their PUBACK at the
+ * same time, so several publishes share one round trip to the server.
+ *
+ * PUBACKs are matched by packet identifier while the client reads from the
+ * network, usually in @ref mqtt_function_yield, which then calls pCompleteHandler.
+ * A message still unacknowledged after `mqttCommandTimeout_ms` is sent again with
+ * the DUP flag set; after `AWS_IOT_MQTT_PUBLISH_MAX_RETRIES` retransmissions it
+ * completes with `MQTT_REQUEST_TIMEOUT_ERROR`. Messages still in flight when the
+ * client disconnects complete with `NETWORK_DISCONNECTED_ERROR`. A QoS 0 message
+ * is complete once it is sent, and its handler is not called.
+ *
+ * @param pClient MQTT client context
+ * @param pTopicName Topic name to publish to
+ * @param topicNameLen Length of the topic name
+ * @param pParams Publish message parameters
+ * @param pCompleteHandler Called when a QoS 1 message completes, may be NULL
+ * @param pCompleteHandlerData Context passed to pCompleteHandler
+ *
+ * @warning The topic name and payload are not copied. For QoS 1 they must stay
+ * valid until pCompleteHandler is called.
+ *
+ * @return `IoT_Error_t`: See `aws_iot_error.h`. `LIMIT_EXCEEDED_ERROR` if the
+ * in-flight window is full; yield to collect PUBACKs and try again.
+ */
+/* @[declare_mqtt_publish_async] */
+IoT_Error_t aws_iot_mqtt_publish_async(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+									   IoT_Publish_Message_Params *pParams, pPublishCompleteHandler_t pCompleteHandler,
+									   void *pCompleteHandlerData);
+/* @[declare_mqtt_publish_async] */
+
+/**
+ * @brief Combine the packets sent from now on into as few TLS records as possible.
+ *
+ * Packets are held back by the network layer until @ref mqtt_function_uncork,
+ * or until the first @ref mqtt_function_yield after `timeout_ms`. For example,
+ * the PUBACK of an incoming message and the reply published from its callback
+ * then go out in one TLS record and usually one TCP segment.
+ *
+ * Calls that wait for a reply from the server, such as
+ * @ref mqtt_function_subscribe, uncork before they wait. Corking an already
+ * corked client keeps the earlier deadline. If the network layer has no cork
+ * function, packets are sent as they come.
+ *
+ * @param[in] pClient MQTT client context
+ * @param[in] timeout_ms Longest time to hold packets back
+ *
+ * @return `IoT_Error_t`: See `aws_iot_error.h`
+ */
+/* @[declare_mqtt_cork] */
+IoT_Error_t aws_iot_mqtt_cork(AWS_IoT_Client *pClient, uint32_t timeout_ms);
+/* @[declare_mqtt_cork] */
+
+/**
+ * @brief Send the packets held back since @ref mqtt_function_cork.
+ *
+ * Does nothing if the client is not corked.
+ *
+ * @param[in] pClient MQTT client context
+ *
+ * @return `IoT_Error_t`: See `aws_iot_error.h`
+ */
+/* @[declare_mqtt_uncork] */
+IoT_Error_t aws_iot_mqtt_uncork(AWS_IoT_Client *pClient);
+/* @[declare_mqtt_uncork] */
+
 /**
  * @brief Subscribe to an MQTT topic.
  *
@@ -177,6 +280,11 @@ IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName
  * @ref mqtt_function_yield must always be called regularly if any subscriptions
  * are active.
  *
+ * @note Topic filters follow MQTT v3.1.1 section 4.7: a trailing `#` also
+ * matches the level above it, and wildcards in the first level do not match
+ * topics starting with `$`. Each subscription whose filter matches an incoming
+ * topic has its callback invoked once.
+ *
  * @param[in] pClient MQTT client context
  * @param[in] pTopicName Topic for subscription
  * @param[in] topicNameLen Length of topic
@@ -195,6 +303,40 @@ IoT_Error_t aws_iot_mqtt_subscribe(AWS_IoT_Client *pClient, const char *pTopicNa
 								   QoS qos, pApplicationHandler_t pApplicationHandler, void *pApplicationHandlerData);
 /* @[declare_mqtt_subscribe] */
 
+/**
+ * @brief Subscribe to an MQTT topic, receiving payloads in chunks.
+ *
+ * Works like @ref mqtt_function_subscribe, but messages on a matching topic may
+ * be larger than `AWS_IOT_MQTT_RX_BUF_LEN`. Their payload is handed to the
+ * callback as it is read from the network, in chunks of
+ * `AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN` bytes, the last one possibly shorter.
+ * Messages that fit the read buffer are handed over in the same chunks.
+ *
+ * A QoS 1 message that did not fit the read buffer is acknowledged after its
+ * final chunk. If it also matches a subscription made with
+ * @ref mqtt_function_subscribe, that subscription does not receive it.
+ *
+ * @note The callback must not call the client. The topic name and variable
+ * header of a large message must fit in the read buffer before the chunk.
+ *
+ * @param[in] pClient MQTT client context
+ * @param[in] pTopicName Topic for subscription
+ * @param[in] topicNameLen Length of topic
+ * @param[in] qos Quality of service for subscription
+ * @param[in] pStreamHandler Callback function for each chunk of the incoming messages
+ * @param[in] pStreamHandlerData Data passed to the callback
+ *
+ * @return `IoT_Error_t`: See `aws_iot_error.h`
+ *
+ * @attention The `pTopicName` parameter is not copied. It must remain valid for the duration
+ * of the subscription (until @ref mqtt_function_unsubscribe) is called.
+ */
+/* @[declare_mqtt_subscribe_stream] */
+IoT_Error_t aws_iot_mqtt_subscribe_stream(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+										  QoS qos, pApplicationStreamHandler_t pStreamHandler,
+										  void *pStreamHandlerData);
+/* @[declare_mqtt_subscribe_stream] */
+
 /**
  * @brief Resubscribe to topic filter subscriptions in a previous MQTT session.
  *
@@ -277,6 +419,26 @@ IoT_Error_t aws_iot_mqtt_disconnect(AWS_IoT_Client *pClient);
 IoT_Error_t aws_iot_mqtt_yield(AWS_IoT_Client *pClient, uint32_t timeout_ms);
 /* @[declare_mqtt_yield] */
 
+/**
+ * @brief Time until @ref mqtt_function_yield has timed work to do.
+ *
+ * For callers that wait for the network to become readable (e.g. with select())
+ * before yielding, instead of yielding periodically. Besides reading incoming
+ * messages, yield must run once this time has passed: to send a keep-alive ping,
+ * detect a missing ping response, retransmit an asynchronous publish, send the
+ * packets held back by @ref mqtt_function_cork or attempt an automatic reconnect.
+ *
+ * @param[in] pClient MQTT client context
+ *
+ * @return Milliseconds until yield is due, 0 if it is due now and `UINT32_MAX`
+ * if nothing is scheduled.
+ *
+ * @warning Do not call this function if @ref mqtt_function_yield is in progress.
+ */
+/* @[declare_mqtt_get_next_yield_ms] */
+uint32_t aws_iot_mqtt_get_next_yield_ms(AWS_IoT_Client *pClient);
+/* @[declare_mqtt_get_next_yield_ms] */
+
 /**
  * @brief Attempt to reconnect with the MQTT server.
  *
@@ -137,6 +137,18 @@ IoT_Error_t aws_iot_shadow_connect(AWS_IoT_Client *pClient, const ShadowConnectP
  */
 IoT_Error_t aws_iot_shadow_yield(AWS_IoT_Client *pClient, uint32_t timeout);
 
+/**
+ * @brief Time until aws_iot_shadow_yield has timed work to do
+ *
+ * Like aws_iot_mqtt_get_next_yield_ms, and also counts the timeouts of the Shadow actions
+ * waiting for their response. Lets a task sleep until the connection is readable or this
+ * time has passed instead of yielding periodically.
+ *
+ * @param pClient	MQTT Client used as the protocol layer
+ * @return Milliseconds until yield is due, 0 if it is due now and UINT32_MAX if nothing is scheduled
+ */
+uint32_t aws_iot_shadow_get_next_yield_ms(AWS_IoT_Client *pClient);
+
 /**
  * @brief Disconnect from the AWS IoT Thing Shadow service over MQTT
  *
@@ -45,6 +45,7 @@ void addToAckWaitList(uint8_t indexAckWaitList, const char *pThingName, ShadowAc
 					  uint32_t timeout_seconds);
 bool getNextFreeIndexOfAckWaitList(uint8_t *pIndex);
 void HandleExpiredResponseCallbacks(void);
+uint32_t getNextResponseTimeoutMs(void);
 void initDeltaTokens(void);
 IoT_Error_t registerJsonTokenOnDelta(jsonStruct_t *pStruct);
 
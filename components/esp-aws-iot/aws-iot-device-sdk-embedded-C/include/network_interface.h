@@ -57,6 +57,29 @@ typedef struct {
 	bool ServerVerificationFlag;        ///< Boolean.  True = perform server certificate hostname validation.  False = skip validation \b NOT recommended.
 } TLSConnectParams;
 
+/**
+ * @brief Scatter-Gather Segment
+ *
+ * One contiguous piece of an outgoing message written with the network's writev function.
+ * The bytes are not copied; they only need to stay valid for the duration of the write.
+ */
+typedef struct {
+	const unsigned char *pBase;    ///< Start of the segment
+	size_t len;                    ///< Length of the segment in bytes
+} IoT_IOVec;
+
+/**
+ * @brief Network Write Counters
+ *
+ * Kept by network layers that implement cork, to show how many TLS records the
+ * MQTT packets take.
+ */
+typedef struct {
+	uint32_t messages;    ///< Writes asked of the network layer; a list of segments counts once
+	uint32_t records;     ///< TLS records the writes were sent in
+	uint32_t wireBytes;   ///< Bytes of those records, including record headers and MACs
+} IoT_Network_Stats;
+
 /**
  * @brief Network Structure
  *
@@ -67,12 +90,16 @@ struct Network {
 
 	IoT_Error_t (*read)(Network *, unsigned char *, size_t, Timer *, size_t *);    ///< Function pointer pointing to the network function to read from the network
 	IoT_Error_t (*write)(Network *, unsigned char *, size_t, Timer *, size_t *);    ///< Function pointer pointing to the network function to write to the network
+	IoT_Error_t (*writev)(Network *, const IoT_IOVec *, size_t, Timer *, size_t *);    ///< Function pointer pointing to the network function to write a list of segments to the network, in order. May be NULL, then the MQTT client writes the segments one by one
+	IoT_Error_t (*cork)(Network *);    ///< Function pointer pointing to the network function to hold writes back until uncork, so that they are combined into as few TLS records as possible. May be NULL, then writes are sent as they come
+	IoT_Error_t (*uncork)(Network *, Timer *);    ///< Function pointer pointing to the network function to send the writes held back since cork. May be NULL if cork is
 	IoT_Error_t (*disconnect)(Network *);    ///< Function pointer pointing to the network function to disconnect from the network
 	IoT_Error_t (*isConnected)(Network *);    ///< Function pointer pointing to the network function to check if TLS is connected
 	IoT_Error_t (*destroy)(Network *);        ///< Function pointer pointing to the network function to destroy the network object
 
 	TLSConnectParams tlsConnectParams;        ///< TLSConnect params structure containing the common connection parameters
 	TLSDataParams tlsDataParams;            ///< TLSData params structure containing the connection data parameters that are specific to the library being used
+	IoT_Network_Stats stats;                ///< Write counters since the Network was initialized, all zero if the network layer does not keep them
 };
 
 /**
@@ -120,6 +147,41 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *TLSParams);
  */
 IoT_Error_t iot_tls_write(Network *, unsigned char *, size_t, Timer *, size_t *);
 
+/**
+ * @brief Write a list of segments to the network socket, in order
+ *
+ * Sends the segments as one stream without first copying them into a single buffer.
+ * Short segments may be gathered so that they do not each go out as their own TLS record.
+ *
+ * @param Network - Pointer to a Network struct defining the network interface.
+ * @param IoT_IOVec pointer - segments to write
+ * @param size_t - number of segments
+ * @param Timer * - operation timer
+ * @param size_t - pointer to store the number of bytes written, counted across the segments
+ * @return IoT_Error_t - successful write or TLS error code
+ */
+IoT_Error_t iot_tls_writev(Network *, const IoT_IOVec *, size_t, Timer *, size_t *);
+
+/**
+ * @brief Hold writes back until iot_tls_uncork
+ *
+ * Packets written in the meantime are combined into as few TLS records as the
+ * cork buffer allows. A write that does not fit sends what is held back first.
+ *
+ * @param Network - Pointer to a Network struct defining the network interface.
+ * @return IoT_Error_t - successful cork or TLS error code
+ */
+IoT_Error_t iot_tls_cork(Network *);
+
+/**
+ * @brief Send the writes held back since iot_tls_cork and stop holding them back
+ *
+ * @param Network - Pointer to a Network struct defining the network interface.
+ * @param Timer * - operation timer
+ * @return IoT_Error_t - successful write or TLS error code
+ */
+IoT_Error_t iot_tls_uncork(Network *, Timer *);
+
 /**
  * @brief Read bytes from the network socket
  *
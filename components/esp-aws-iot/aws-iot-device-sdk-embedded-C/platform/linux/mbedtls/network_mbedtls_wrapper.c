@@ -83,6 +83,7 @@ IoT_Error_t iot_tls_init(Network *pNetwork, char *pRootCALocation, char *pDevice
 	pNetwork->connect = iot_tls_connect;
 	pNetwork->read = iot_tls_read;
 	pNetwork->write = iot_tls_write;
+	pNetwork->writev = iot_tls_writev;
 	pNetwork->disconnect = iot_tls_disconnect;
 	pNetwork->isConnected = iot_tls_is_connected;
 	pNetwork->destroy = iot_tls_destroy;
@@ -321,6 +322,50 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
 	return SUCCESS;
 }
 
+/* Segments up to this long are gathered and written together, so that an MQTT
+ * header and a short payload do not each go out as their own TLS record. */
+#define IOT_SSL_WRITEV_GATHER_LEN 128
+
+IoT_Error_t iot_tls_writev(Network *pNetwork, const IoT_IOVec *pSegments, size_t segmentCount, Timer *timer,
+						   size_t *written_len) {
+	unsigned char gather[IOT_SSL_WRITEV_GATHER_LEN];
+	size_t gathered = 0;
+	size_t written = 0;
+	size_t segment_written;
+	size_t i;
+	IoT_Error_t rc = SUCCESS;
+
+	for(i = 0; i < segmentCount && SUCCESS == rc; i++) {
+		const IoT_IOVec *pSegment = &pSegments[i];
+
+		if(pSegment->len > sizeof(gather) - gathered && gathered > 0) {
+			rc = iot_tls_write(pNetwork, gather, gathered, timer, &segment_written);
+			written += segment_written;
+			gathered = 0;
+			if(SUCCESS != rc) {
+				break;
+			}
+		}
+
+		if(pSegment->len <= sizeof(gather) - gathered) {
+			memcpy(gather + gathered, pSegment->pBase, pSegment->len);
+			gathered += pSegment->len;
+		} else {
+			/* Long segments go straight to mbedtls_ssl_write, which encrypts them into its own record buffer */
+			rc = iot_tls_write(pNetwork, (unsigned char *) pSegment->pBase, pSegment->len, timer, &segment_written);
+			written += segment_written;
+		}
+	}
+
+	if(SUCCESS == rc && gathered > 0) {
+		rc = iot_tls_write(pNetwork, gather, gathered, timer, &segment_written);
+		written += segment_written;
+	}
+
+	*written_len = written;
+	return rc;
+}
+
 IoT_Error_t iot_tls_read(Network *pNetwork, unsigned char *pMsg, size_t len, Timer *timer, size_t *read_len) {
 	mbedtls_ssl_context *ssl = &(pNetwork->tlsDataParams.ssl);
 	size_t rxLen = 0;
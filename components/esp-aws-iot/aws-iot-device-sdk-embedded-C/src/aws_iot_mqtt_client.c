@@ -247,9 +247,15 @@ IoT_Error_t aws_iot_mqtt_init(AWS_IoT_Client *pClient, const IoT_Client_Init_Par
 	for(i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++i) {
 		pClient->clientData.messageHandlers[i].topicName = NULL;
 		pClient->clientData.messageHandlers[i].pApplicationHandler = NULL;
+		pClient->clientData.messageHandlers[i].pStreamHandler = NULL;
 		pClient->clientData.messageHandlers[i].pApplicationHandlerData = NULL;
 		pClient->clientData.messageHandlers[i].qos = QOS0;
 	}
+	aws_iot_mqtt_internal_topic_index_init(pClient);
+
+	for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; ++i) {
+		pClient->clientData.publishesInFlight[i].inUse = false;
+	}
 
 	pClient->clientData.packetTimeoutMs = pInitParams->mqttPacketTimeout_ms;
 	pClient->clientData.commandTimeoutMs = pInitParams->mqttCommandTimeout_ms;
@@ -287,6 +293,15 @@ IoT_Error_t aws_iot_mqtt_init(AWS_IoT_Client *pClient, const IoT_Client_Init_Par
 
 	pClient->clientStatus.isPingOutstanding = 0;
 	pClient->clientStatus.isAutoReconnectEnabled = pInitParams->enableAutoReconnect;
+	pClient->clientData.isCorked = false;
+
+	/* Optional network functions, set by network layers that have them */
+	pClient->networkStack.cork = NULL;
+	pClient->networkStack.uncork = NULL;
+	pClient->networkStack.writev = NULL;
+	pClient->networkStack.stats.messages = 0;
+	pClient->networkStack.stats.records = 0;
+	pClient->networkStack.stats.wireBytes = 0;
 
 	rc = iot_tls_init(&(pClient->networkStack), pInitParams->pRootCALocation, pInitParams->pDeviceCertLocation,
 					  pInitParams->pDevicePrivateKeyLocation, pInitParams->pHostURL, pInitParams->port,
@@ -384,6 +399,71 @@ IoT_Error_t aws_iot_mqtt_set_disconnect_handler(AWS_IoT_Client *pClient, iot_dis
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+IoT_Error_t aws_iot_mqtt_cork(AWS_IoT_Client *pClient, uint32_t timeout_ms) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+	if(NULL == pClient) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(!aws_iot_mqtt_is_client_connected(pClient)) {
+		FUNC_EXIT_RC(NETWORK_DISCONNECTED_ERROR);
+	}
+
+	if(pClient->clientData.isCorked || NULL == pClient->networkStack.cork || NULL == pClient->networkStack.uncork) {
+		FUNC_EXIT_RC(SUCCESS);
+	}
+
+	rc = pClient->networkStack.cork(&(pClient->networkStack));
+	if(SUCCESS == rc) {
+		pClient->clientData.isCorked = true;
+		init_timer(&(pClient->clientData.corkTimer));
+		countdown_ms(&(pClient->clientData.corkTimer), timeout_ms);
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_mqtt_uncork(AWS_IoT_Client *pClient) {
+	Timer timer;
+	IoT_Error_t rc;
+#ifdef _ENABLE_THREAD_SUPPORT_
+	IoT_Error_t unlockRc;
+#endif
+
+	FUNC_ENTRY;
+	if(NULL == pClient) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(!pClient->clientData.isCorked) {
+		FUNC_EXIT_RC(SUCCESS);
+	}
+	pClient->clientData.isCorked = false;
+
+	init_timer(&timer);
+	countdown_ms(&timer, pClient->clientData.commandTimeoutMs);
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	rc = aws_iot_mqtt_client_lock_mutex(pClient, &(pClient->clientData.tls_write_mutex));
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+#endif
+
+	rc = pClient->networkStack.uncork(&(pClient->networkStack), &timer);
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	unlockRc = aws_iot_mqtt_client_unlock_mutex(pClient, &(pClient->clientData.tls_write_mutex));
+	if(SUCCESS != unlockRc) {
+		FUNC_EXIT_RC(unlockRc);
+	}
+#endif
+
+	FUNC_EXIT_RC(rc);
+}
+
 uint32_t aws_iot_mqtt_get_network_disconnected_count(AWS_IoT_Client *pClient) {
 	return pClient->clientData.counterNetworkDisconnected;
 }
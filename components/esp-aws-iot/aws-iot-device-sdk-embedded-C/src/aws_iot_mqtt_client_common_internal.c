@@ -359,6 +359,114 @@ IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t le
 	FUNC_EXIT_RC(rc);
 }
 
+/**
+ * @brief Writes segments through the network's writev, or one by one if it has none
+ */
+static IoT_Error_t _aws_iot_mqtt_internal_write_segments(AWS_IoT_Client *pClient, const IoT_IOVec *pSegments,
+														 size_t segmentCount, Timer *pTimer, size_t *pWrittenLen) {
+	size_t i, writtenLen;
+	IoT_Error_t rc = SUCCESS;
+
+	if(NULL != pClient->networkStack.writev) {
+		return pClient->networkStack.writev(&(pClient->networkStack), pSegments, segmentCount, pTimer, pWrittenLen);
+	}
+
+	*pWrittenLen = 0;
+	for(i = 0; i < segmentCount && SUCCESS == rc; i++) {
+		writtenLen = 0;
+		rc = pClient->networkStack.write(&(pClient->networkStack), (unsigned char *) pSegments[i].pBase,
+										 pSegments[i].len, pTimer, &writtenLen);
+		*pWrittenLen += writtenLen;
+		if(writtenLen < pSegments[i].len) {
+			break;
+		}
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Send a packet made of segments, without copying them into the write buffer
+ *
+ * Unlike aws_iot_mqtt_internal_send_packet the packet is not limited by the size
+ * of the client's write buffer.
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pSegments The segments of the packet, in order. Advanced past the bytes sent
+ * @param segmentCount Number of segments
+ * @param pTimer Timer for the send
+ *
+ * @return An IoT Error Type defining successful/failed send
+ */
+IoT_Error_t aws_iot_mqtt_internal_send_packetv(AWS_IoT_Client *pClient, IoT_IOVec *pSegments, size_t segmentCount,
+											 Timer *pTimer) {
+	size_t length, sent, sentLen, i;
+	IoT_Error_t rc = FAILURE;
+#ifdef _ENABLE_THREAD_SUPPORT_
+	IoT_Error_t unlockRc;
+#endif
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient || NULL == pSegments || NULL == pTimer) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	length = 0;
+	for(i = 0; i < segmentCount; i++) {
+		length += pSegments[i].len;
+	}
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	rc = aws_iot_mqtt_client_lock_mutex(pClient, &(pClient->clientData.tls_write_mutex));
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+#endif
+
+	sent = 0;
+
+	while(sent < length && !has_timer_expired(pTimer)) {
+		sentLen = 0;
+		rc = _aws_iot_mqtt_internal_write_segments(pClient, pSegments, segmentCount, pTimer, &sentLen);
+		sent += sentLen;
+
+		/* skip what was written, in case the write stopped part way */
+		while(segmentCount > 0 && sentLen >= pSegments->len) {
+			sentLen -= pSegments->len;
+			pSegments++;
+			segmentCount--;
+		}
+		if(segmentCount > 0) {
+			pSegments->pBase += sentLen;
+			pSegments->len -= sentLen;
+		}
+
+		if(SUCCESS != rc) {
+			/* there was an error writing the data */
+			break;
+		}
+	}
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	unlockRc = aws_iot_mqtt_client_unlock_mutex(pClient, &(pClient->clientData.tls_write_mutex));
+	if(SUCCESS != unlockRc) {
+		FUNC_EXIT_RC(unlockRc);
+	}
+#endif
+
+	if(sent == length) {
+		FUNC_EXIT_RC(SUCCESS);
+	}
+
+	if(SUCCESS == rc) {
+		/* the timer ran out between writes */
+		rc = NETWORK_SSL_WRITE_TIMEOUT_ERROR;
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
 static IoT_Error_t _aws_iot_mqtt_internal_readWrapper( AWS_IoT_Client *pClient, size_t offset, size_t size, Timer *pTimer, size_t * read_len ) {
     IoT_Error_t rc;
     int byteToRead;
@@ -419,7 +527,160 @@ static IoT_Error_t _aws_iot_mqtt_internal_decode_packet_remaining_len(AWS_IoT_Cl
 	FUNC_EXIT_RC(rc);
 }
 
-static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, Timer *pTimer, uint8_t *pPacketType) {
+/* Warns if the PUBACK isn't sent; the server will send the PUBLISH again in that case. */
+static void _aws_iot_mqtt_internal_send_puback(AWS_IoT_Client *pClient, uint16_t packetId) {
+	uint32_t len = 0;
+	IoT_Error_t rc;
+	Timer sendTimer;
+
+	/* Initialize timer for sending PUBACK. */
+	init_timer(&sendTimer);
+	countdown_ms(&sendTimer, pClient->clientData.commandTimeoutMs);
+
+	rc = aws_iot_mqtt_internal_serialize_ack(pClient->clientData.writeBuf,
+		pClient->clientData.writeBufSize, PUBACK, 0, packetId, &len);
+
+	if(SUCCESS == rc) {
+		rc = aws_iot_mqtt_internal_send_packet(pClient, len, &sendTimer);
+
+		if(SUCCESS != rc) {
+			IOT_WARN("Failed to send PUBACK");
+		}
+	} else {
+		IOT_WARN("Failed to generate PUBACK");
+	}
+}
+
+/* Hands a payload that is in memory to a streaming handler, in the chunks a streamed one would take */
+static void _aws_iot_mqtt_internal_deliver_chunks(AWS_IoT_Client *pClient, MessageHandlers *pHandler,
+												  char *pTopicName, uint16_t topicNameLen,
+												  IoT_Publish_Message_Params *pMessageParams) {
+	IoT_Publish_Message_Params chunk = *pMessageParams;
+	size_t offset = 0;
+
+	do {
+		chunk.payload = (unsigned char *) pMessageParams->payload + offset;
+		chunk.payloadLen = pMessageParams->payloadLen - offset;
+		if(AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN < chunk.payloadLen) {
+			chunk.payloadLen = AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN;
+		}
+		pHandler->pStreamHandler(pClient, pTopicName, topicNameLen, &chunk, offset, pMessageParams->payloadLen,
+								 offset + chunk.payloadLen == pMessageParams->payloadLen,
+								 pHandler->pApplicationHandlerData);
+		offset += chunk.payloadLen;
+	} while(offset < pMessageParams->payloadLen);
+}
+
+/**
+ * @brief A chunk of a streamed PUBLISH
+ *
+ * Read while the read mutex is held and handed to the streaming handlers after
+ * it is released. The topic name and the chunk are in the read buffer.
+ */
+typedef struct {
+	char *pTopicName; ///< Topic name of the message
+	uint16_t topicNameLen; ///< Length of the topic name
+	IoT_Publish_Message_Params msg; ///< Flags and id of the message; the payload fields describe the chunk
+	size_t offset; ///< Position of the chunk in the payload
+	size_t payloadLen; ///< Length of the whole payload
+} StreamChunk;
+
+/**
+ * @brief Read the next chunk of a PUBLISH too long for the read buffer
+ *
+ * The fixed and variable header stay at the start of the read buffer and the
+ * payload passes through its last AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN bytes, one
+ * chunk per call. When a read comes up short, the next call picks the packet
+ * up where it stopped, as for packets that fit the buffer.
+ *
+ * @param pClient MQTT client
+ * @param offset Length of the fixed header, which is in the read buffer
+ * @param rem_len Remaining length of the packet
+ * @param pTimer Amount of time allowed to read packet
+ * @param pChunk Set to the chunk that was read
+ * @param pIsStreamed Set once a chunk was read. Left false with SUCCESS if no
+ *     streaming subscription takes the packet; the rest of it is unread.
+ *
+ * @return IoT_Error_t of read status
+ */
+static IoT_Error_t _aws_iot_mqtt_internal_stream_publish(AWS_IoT_Client *pClient, size_t offset, size_t rem_len,
+														 Timer *pTimer, StreamChunk *pChunk, bool *pIsStreamed) {
+	const size_t chunkStart = pClient->clientData.readBufSize - AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN;
+	unsigned char *pBuf = pClient->clientData.readBuf;
+	uint16_t matches[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	uint32_t matchCount, itr;
+	bool hasStreamHandler;
+	size_t headerLen, chunkLen, read_len;
+	MQTTHeader header = {0};
+	IoT_Error_t rc;
+
+	rc = _aws_iot_mqtt_internal_readWrapper(pClient, offset, 2, pTimer, &read_len);
+	if(SUCCESS != rc) {
+		return rc;
+	}
+
+	header.byte = pBuf[0];
+	pChunk->msg.qos = (QoS) MQTT_HEADER_FIELD_QOS(header.byte);
+	pChunk->msg.isDup = MQTT_HEADER_FIELD_DUP(header.byte);
+	pChunk->msg.isRetained = MQTT_HEADER_FIELD_RETAIN(header.byte);
+	pChunk->topicNameLen = (uint16_t) ((pBuf[offset] << 8) | pBuf[offset + 1]);
+	headerLen = offset + 2 + pChunk->topicNameLen + (QOS0 == pChunk->msg.qos ? 0 : 2);
+	if(headerLen > chunkStart || headerLen - offset > rem_len) {
+		return SUCCESS;
+	}
+
+	rc = _aws_iot_mqtt_internal_readWrapper(pClient, offset + 2, headerLen - offset - 2, pTimer, &read_len);
+	if(SUCCESS != rc) {
+		return rc;
+	}
+
+	pChunk->pTopicName = (char *) &pBuf[offset + 2];
+	pChunk->msg.id = (QOS0 == pChunk->msg.qos) ? 0 : (uint16_t) ((pBuf[headerLen - 2] << 8) | pBuf[headerLen - 1]);
+	pChunk->payloadLen = rem_len - (headerLen - offset);
+
+	if(!pClient->clientData.isRxStreaming) {
+		/* Only streaming subscriptions can take it */
+		matchCount = aws_iot_mqtt_internal_topic_index_match(pClient, pChunk->pTopicName, pChunk->topicNameLen,
+															 matches);
+		hasStreamHandler = false;
+		for(itr = 0; itr < matchCount && !hasStreamHandler; ++itr) {
+			hasStreamHandler = (NULL != pClient->clientData.messageHandlers[matches[itr]].pStreamHandler);
+		}
+		if(!hasStreamHandler) {
+			return SUCCESS;
+		}
+
+		pClient->clientData.isRxStreaming = true;
+		pClient->clientData.readBufIndex = chunkStart;
+	}
+
+	chunkLen = pChunk->payloadLen - pClient->clientData.rxStreamedLen;
+	if(AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN < chunkLen) {
+		chunkLen = AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN;
+	}
+
+	rc = _aws_iot_mqtt_internal_readWrapper(pClient, chunkStart, chunkLen, pTimer, &read_len);
+	if(SUCCESS != rc || read_len != chunkLen) {
+		return (SUCCESS != rc) ? rc : FAILURE;
+	}
+
+	pChunk->msg.payload = &pBuf[chunkStart];
+	pChunk->msg.payloadLen = chunkLen;
+	pChunk->offset = pClient->clientData.rxStreamedLen;
+
+	/* The next chunk is read over this one, as a complete packet is by the next packet */
+	pClient->clientData.rxStreamedLen += chunkLen;
+	pClient->clientData.readBufIndex = chunkStart;
+	if(pClient->clientData.rxStreamedLen == pChunk->payloadLen) {
+		aws_iot_mqtt_internal_flushBuffers(pClient);
+	}
+
+	*pIsStreamed = true;
+	return SUCCESS;
+}
+
+static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, Timer *pTimer, uint8_t *pPacketType,
+													  StreamChunk *pChunk, bool *pIsStreamed) {
 	size_t rem_len, total_bytes_read, bytes_to_be_read, read_len;
 	IoT_Error_t rc;
     size_t offset = 0;
@@ -432,6 +693,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, T
 	total_bytes_read = 0;
 	bytes_to_be_read = 0;
 	read_len = 0;
+	*pIsStreamed = false;
 
     rc = _aws_iot_mqtt_internal_readWrapper( pClient, offset, 1, pTimer, &read_len );
 	/* 1. read the header byte.  This has the packet type in it */
@@ -447,9 +709,24 @@ static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, T
 		return rc;
 	}
 
-	/* if the buffer is too short then the message will be dropped silently */
+	/* if the buffer is too short then the message will be dropped silently,
+	 * unless it is a PUBLISH for a streaming subscription */
 	if((rem_len + offset) >= pClient->clientData.readBufSize) {
-		bytes_to_be_read = pClient->clientData.readBufSize;
+		header.byte = pClient->clientData.readBuf[0];
+		if(PUBLISH == MQTT_HEADER_FIELD_TYPE(header.byte)) {
+			rc = _aws_iot_mqtt_internal_stream_publish(pClient, offset, rem_len, pTimer, pChunk, pIsStreamed);
+			if(SUCCESS != rc || *pIsStreamed) {
+				*pPacketType = PUBLISH;
+				return rc;
+			}
+		}
+
+		/* Part of the variable header may be read already */
+		total_bytes_read = pClient->clientData.readBufIndex - offset;
+		bytes_to_be_read = rem_len - total_bytes_read;
+		if(bytes_to_be_read > pClient->clientData.readBufSize) {
+			bytes_to_be_read = pClient->clientData.readBufSize;
+		}
 		do {
 			rc = pClient->networkStack.read(&(pClient->networkStack), pClient->clientData.readBuf, bytes_to_be_read,
 											pTimer, &read_len);
@@ -491,49 +768,12 @@ static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, T
 	FUNC_EXIT_RC(rc);
 }
 
-// assume topic filter and name is in correct format
-// # can only be at end
-// + and # can only be next to separator
-static bool _aws_iot_mqtt_internal_is_topic_matched(char *pTopicFilter, char *pTopicName, uint16_t topicNameLen) {
-
-	char *curf, *curn, *curn_end;
-
-	if(NULL == pTopicFilter || NULL == pTopicName) {
-		return false;
-	}
-
-	curf = pTopicFilter;
-	curn = pTopicName;
-	curn_end = curn + topicNameLen;
-
-	while(*curf && (curn < curn_end)) {
-		if(*curn == '/' && *curf != '/') {
-			break;
-		}
-		if(*curf != '+' && *curf != '#' && *curf != *curn) {
-			break;
-		}
-		if(*curf == '+') {
-			/* skip until we meet the next separator, or end of string */
-			char *nextpos = curn + 1;
-			while(nextpos < curn_end && *nextpos != '/')
-				nextpos = ++curn + 1;
-		} else if(*curf == '#') {
-			/* skip until end of string */
-			curn = curn_end - 1;
-		}
-
-		curf++;
-		curn++;
-	};
-
-	return (curn == curn_end) && (*curf == '\0');
-}
-
 static IoT_Error_t _aws_iot_mqtt_internal_deliver_message(AWS_IoT_Client *pClient, char *pTopicName,
 														  uint16_t topicNameLen,
 														  IoT_Publish_Message_Params *pMessageParams) {
-	uint32_t itr;
+	uint16_t matches[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	uint32_t matchCount, itr;
+	MessageHandlers *pHandler;
 	IoT_Error_t rc;
 	ClientState clientState;
 
@@ -549,40 +789,66 @@ static IoT_Error_t _aws_iot_mqtt_internal_deliver_message(AWS_IoT_Client *pClien
 	clientState = aws_iot_mqtt_get_client_state(pClient);
 	aws_iot_mqtt_set_client_state(pClient, clientState, CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN);
 
-	/* Find the right message handler - indexed by topic */
-	for(itr = 0; itr < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++itr) {
-		if(NULL != pClient->clientData.messageHandlers[itr].topicName) {
-			if(((topicNameLen == pClient->clientData.messageHandlers[itr].topicNameLen)
-				&&
-				(strncmp(pTopicName, (char *) pClient->clientData.messageHandlers[itr].topicName, topicNameLen) == 0))
-			   || _aws_iot_mqtt_internal_is_topic_matched((char *) pClient->clientData.messageHandlers[itr].topicName,
-														  pTopicName, topicNameLen)) {
-				if(NULL != pClient->clientData.messageHandlers[itr].pApplicationHandler) {
-					pClient->clientData.messageHandlers[itr].pApplicationHandler(pClient, pTopicName, topicNameLen,
-																				 pMessageParams,
-																				 pClient->clientData.messageHandlers[itr].pApplicationHandlerData);
-				}
-			}
+	/* Find the right message handlers - indexed by topic */
+	matchCount = aws_iot_mqtt_internal_topic_index_match(pClient, pTopicName, topicNameLen, matches);
+	for(itr = 0; itr < matchCount; ++itr) {
+		pHandler = &pClient->clientData.messageHandlers[matches[itr]];
+		/* An earlier callback may have unsubscribed it */
+		if(NULL != pHandler->topicName && NULL != pHandler->pStreamHandler) {
+			_aws_iot_mqtt_internal_deliver_chunks(pClient, pHandler, pTopicName, topicNameLen, pMessageParams);
+		} else if(NULL != pHandler->topicName && NULL != pHandler->pApplicationHandler) {
+			pHandler->pApplicationHandler(pClient, pTopicName, topicNameLen, pMessageParams,
+										  pHandler->pApplicationHandlerData);
+		}
+	}
+	rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN, clientState);
+
+	FUNC_EXIT_RC(rc);
+}
+
+/* Hands a chunk read by _aws_iot_mqtt_internal_stream_publish to the streaming handlers,
+ * and acknowledges the message once its final chunk was handed over */
+static IoT_Error_t _aws_iot_mqtt_internal_deliver_streamed_chunk(AWS_IoT_Client *pClient, StreamChunk *pChunk) {
+	uint16_t matches[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	uint32_t matchCount, itr;
+	MessageHandlers *pHandler;
+	bool isFinal = (pChunk->offset + pChunk->msg.payloadLen == pChunk->payloadLen);
+	IoT_Error_t rc;
+	ClientState clientState;
+
+	FUNC_ENTRY;
+
+	/* As for _aws_iot_mqtt_internal_deliver_message, yield cannot be called while the handlers run */
+	clientState = aws_iot_mqtt_get_client_state(pClient);
+	aws_iot_mqtt_set_client_state(pClient, clientState, CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN);
+
+	matchCount = aws_iot_mqtt_internal_topic_index_match(pClient, pChunk->pTopicName, pChunk->topicNameLen, matches);
+	for(itr = 0; itr < matchCount; ++itr) {
+		pHandler = &pClient->clientData.messageHandlers[matches[itr]];
+		if(NULL != pHandler->topicName && NULL != pHandler->pStreamHandler) {
+			pHandler->pStreamHandler(pClient, pChunk->pTopicName, pChunk->topicNameLen, &(pChunk->msg),
+									 pChunk->offset, pChunk->payloadLen, isFinal, pHandler->pApplicationHandlerData);
 		}
 	}
 	rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN, clientState);
 
+	if(isFinal && QOS1 == pChunk->msg.qos) {
+		_aws_iot_mqtt_internal_send_puback(pClient, pChunk->msg.id);
+	}
+
 	FUNC_EXIT_RC(rc);
 }
 
 static IoT_Error_t _aws_iot_mqtt_internal_handle_publish(AWS_IoT_Client *pClient) {
 	char *topicName;
 	uint16_t topicNameLen;
-	uint32_t len;
 	IoT_Error_t rc;
 	IoT_Publish_Message_Params msg;
-	Timer sendTimer;
 
 	FUNC_ENTRY;
 
 	topicName = NULL;
 	topicNameLen = 0;
-	len = 0;
 
 	rc = aws_iot_mqtt_internal_deserialize_publish(&msg.isDup, &msg.qos, &msg.isRetained,
 												   &msg.id, &topicName, &topicNameLen,
@@ -596,24 +862,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_handle_publish(AWS_IoT_Client *pClient
 
 	/* Send acknowledgement of QoS 1 message. */
 	if(QOS1 == msg.qos) {
-		/* Initialize timer for sending PUBACK. */
-		init_timer(&sendTimer);
-		countdown_ms(&sendTimer, pClient->clientData.commandTimeoutMs);
-
-		/* Generate and send a PUBACK. Warn if the PUBACK isn't sent; the server
-		will send the PUBLISH again in that case. */
-		rc = aws_iot_mqtt_internal_serialize_ack(pClient->clientData.writeBuf,
-			pClient->clientData.writeBufSize, PUBACK, 0, msg.id, &len);
-
-		if(SUCCESS == rc) {
-			rc = aws_iot_mqtt_internal_send_packet(pClient, len, &sendTimer);
-
-			if(SUCCESS != rc) {
-				IOT_WARN("Failed to send PUBACK");
-			}
-		} else {
-			IOT_WARN("Failed to generate PUBACK");
-		}
+		_aws_iot_mqtt_internal_send_puback(pClient, msg.id);
 	}
 
 	rc = _aws_iot_mqtt_internal_deliver_message(pClient, topicName, topicNameLen, &msg);
@@ -635,6 +884,8 @@ static IoT_Error_t _aws_iot_mqtt_internal_handle_publish(AWS_IoT_Client *pClient
  */
 IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTimer, uint8_t *pPacketType) {
 	IoT_Error_t rc;
+	StreamChunk chunk;
+	bool isStreamed;
 
 #ifdef _ENABLE_THREAD_SUPPORT_
 	IoT_Error_t threadRc;
@@ -652,7 +903,7 @@ IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTi
 #endif
 
 	/* read the socket, see what work is due */
-	rc = _aws_iot_mqtt_internal_read_packet(pClient, pTimer, pPacketType);
+	rc = _aws_iot_mqtt_internal_read_packet(pClient, pTimer, pPacketType, &chunk, &isStreamed);
 
 #ifdef _ENABLE_THREAD_SUPPORT_
 	threadRc = aws_iot_mqtt_client_unlock_mutex(pClient, &(pClient->clientData.tls_read_mutex));
@@ -670,13 +921,21 @@ IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTi
 
 	switch(*pPacketType) {
 		case CONNACK:
-		case PUBACK:
 		case SUBACK:
 		case UNSUBACK:
 			/* SDK is blocking, these responses will be forwarded to calling function to process */
 			break;
+		case PUBACK:
+			/* Completes an asynchronous publish, or is forwarded like the others */
+			rc = aws_iot_mqtt_internal_handle_puback(pClient, pPacketType);
+			break;
 		case PUBLISH: {
-			rc = _aws_iot_mqtt_internal_handle_publish(pClient);
+			/* A streamed PUBLISH comes one chunk per read */
+			if(isStreamed) {
+				rc = _aws_iot_mqtt_internal_deliver_streamed_chunk(pClient, &chunk);
+			} else {
+				rc = _aws_iot_mqtt_internal_handle_publish(pClient);
+			}
 			break;
 		}
 		case PUBREC:
@@ -708,6 +967,8 @@ IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTi
  */
 IoT_Error_t aws_iot_mqtt_internal_flushBuffers( AWS_IoT_Client *pClient ) {
     pClient->clientData.readBufIndex = 0;
+    pClient->clientData.rxStreamedLen = 0;
+    pClient->clientData.isRxStreaming = false;
     return SUCCESS;
 }
 
@@ -731,6 +992,12 @@ IoT_Error_t aws_iot_mqtt_internal_wait_for_read(AWS_IoT_Client *pClient, uint8_t
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
+	/* The server cannot reply to a request that is held back */
+	rc = aws_iot_mqtt_uncork(pClient);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+
 	read_packet_type = 0;
 	do {
 		if(has_timer_expired(pTimer)) {
@@ -391,6 +391,9 @@ static IoT_Error_t _aws_iot_mqtt_internal_connect(AWS_IoT_Client *pClient, const
 		}
 	}
 
+	/* A new connection starts uncorked */
+	pClient->clientData.isCorked = false;
+
 	rc = pClient->networkStack.connect(&(pClient->networkStack), NULL);
 	if(SUCCESS != rc) {
 		/* TLS Connect failed, return error */
@@ -513,14 +516,19 @@ static IoT_Error_t _aws_iot_mqtt_internal_disconnect(AWS_IoT_Client *pClient) {
 	init_timer(&timer);
 	countdown_ms(&timer, pClient->clientData.commandTimeoutMs);
 
-	/* send the disconnect packet */
+	/* send the disconnect packet, along with anything held back */
 	if(serialized_len > 0) {
 		(void)aws_iot_mqtt_internal_send_packet(pClient, serialized_len, &timer);
 	}
+	(void)aws_iot_mqtt_uncork(pClient);
 
 	/* Clean network stack */
 	pClient->networkStack.disconnect(&(pClient->networkStack));
 	rc = pClient->networkStack.destroy(&(pClient->networkStack));
+
+	/* PUBACKs can no longer arrive for the publishes still in flight */
+	aws_iot_mqtt_internal_fail_publishes(pClient, NETWORK_DISCONNECTED_ERROR);
+
 	if(SUCCESS != rc) {
 		/* TLS Destroy failed, return error */
 		FUNC_EXIT_RC(FAILURE);
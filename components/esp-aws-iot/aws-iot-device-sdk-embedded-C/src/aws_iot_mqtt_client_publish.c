@@ -69,8 +69,9 @@ static IoT_Error_t _aws_iot_mqtt_read_string_with_len(char **stringVar, uint16_t
 }
 
 /**
-  * Serializes the supplied publish data into the supplied buffer, ready for sending
-  * @param pTxBuf the buffer into which the packet will be serialized
+  * Serializes the fixed header, topic and packet identifier of a publish into the supplied buffer.
+  * The payload is not written; it follows the header on the wire.
+  * @param pTxBuf the buffer into which the header will be serialized
   * @param txBufLen the length in bytes of the supplied buffer
   * @param dup uint8_t - the MQTT dup flag
   * @param qos QoS - the MQTT QoS value
@@ -78,27 +79,30 @@ static IoT_Error_t _aws_iot_mqtt_read_string_with_len(char **stringVar, uint16_t
   * @param packetId uint16_t - the MQTT packet identifier
   * @param pTopicName char * - the MQTT topic in the publish
   * @param topicNameLen uint16_t - the length of the Topic Name
-  * @param pPayload byte buffer - the MQTT publish payload
   * @param payloadLen size_t - the length of the MQTT payload
-  * @param pSerializedLen uint32_t - pointer to the variable that stores serialized len
+  * @param pSerializedLen uint32_t - pointer to the variable that stores the header len
   *
   * @return An IoT Error Type defining successful/failed call
   */
-static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBuf, size_t txBufLen, uint8_t dup,
-															QoS qos, uint8_t retained, uint16_t packetId,
-															const char *pTopicName, uint16_t topicNameLen,
-															const unsigned char *pPayload, size_t payloadLen,
-															uint32_t *pSerializedLen) {
+static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish_header(unsigned char *pTxBuf, size_t txBufLen, uint8_t dup,
+																   QoS qos, uint8_t retained, uint16_t packetId,
+																   const char *pTopicName, uint16_t topicNameLen,
+																   size_t payloadLen, uint32_t *pSerializedLen) {
 	unsigned char *ptr;
 	uint32_t rem_len;
 	IoT_Error_t rc;
 	MQTTHeader header = {0};
 
 	FUNC_ENTRY;
-	if(NULL == pTxBuf || NULL == pPayload || NULL == pSerializedLen) {
+	if(NULL == pTxBuf || NULL == pSerializedLen) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
+	/* MQTT v3.1.1 Specification 2.2.3, the remaining length takes at most four bytes */
+	if(payloadLen > (size_t) (MQTT_MAX_REMAINING_LENGTH - topicNameLen - 4)) {
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+
 	ptr = pTxBuf;
 	rem_len = 0;
 
@@ -106,7 +110,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBu
 	if(qos > 0) {
 		rem_len += 2; /* packetId */
 	}
-	if(aws_iot_mqtt_internal_get_final_packet_length_from_remaining_length(rem_len) > txBufLen) {
+	if(aws_iot_mqtt_internal_get_final_packet_length_from_remaining_length(rem_len) - payloadLen > txBufLen) {
 		FUNC_EXIT_RC(MQTT_TX_BUFFER_TOO_SHORT_ERROR);
 	}
 
@@ -124,14 +128,56 @@ static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBu
 		aws_iot_mqtt_internal_write_uint_16(&ptr, packetId);
 	}
 
-	memcpy(ptr, pPayload, payloadLen);
-	ptr += payloadLen;
-
 	*pSerializedLen = (uint32_t) (ptr - pTxBuf);
 
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+/**
+  * Serializes the supplied publish data into the supplied buffer, ready for sending
+  * @param pTxBuf the buffer into which the packet will be serialized
+  * @param txBufLen the length in bytes of the supplied buffer
+  * @param dup uint8_t - the MQTT dup flag
+  * @param qos QoS - the MQTT QoS value
+  * @param retained uint8_t - the MQTT retained flag
+  * @param packetId uint16_t - the MQTT packet identifier
+  * @param pTopicName char * - the MQTT topic in the publish
+  * @param topicNameLen uint16_t - the length of the Topic Name
+  * @param pPayload byte buffer - the MQTT publish payload
+  * @param payloadLen size_t - the length of the MQTT payload
+  * @param pSerializedLen uint32_t - pointer to the variable that stores serialized len
+  *
+  * @return An IoT Error Type defining successful/failed call
+  */
+static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBuf, size_t txBufLen, uint8_t dup,
+															QoS qos, uint8_t retained, uint16_t packetId,
+															const char *pTopicName, uint16_t topicNameLen,
+															const unsigned char *pPayload, size_t payloadLen,
+															uint32_t *pSerializedLen) {
+	uint32_t headerLen = 0;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+	if(NULL == pTxBuf || NULL == pPayload || NULL == pSerializedLen) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	rc = _aws_iot_mqtt_internal_serialize_publish_header(pTxBuf, txBufLen, dup, qos, retained, packetId,
+														  pTopicName, topicNameLen, payloadLen, &headerLen);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+	if(headerLen + payloadLen > txBufLen) {
+		FUNC_EXIT_RC(MQTT_TX_BUFFER_TOO_SHORT_ERROR);
+	}
+
+	memcpy(pTxBuf + headerLen, pPayload, payloadLen);
+
+	*pSerializedLen = (uint32_t) (headerLen + payloadLen);
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
 /**
   * Serializes the ack packet into the supplied buffer.
   * @param pTxBuf the buffer into which the packet will be serialized
@@ -177,6 +223,55 @@ IoT_Error_t aws_iot_mqtt_internal_serialize_ack(unsigned char *pTxBuf, size_t tx
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+/**
+ * @brief Waits for the PUBACK of a QoS 1 publish and deserializes it
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pTimer Timer of the publish
+ *
+ * @return An IoT Error Type defining successful/failed wait
+ */
+static IoT_Error_t _aws_iot_mqtt_internal_wait_for_puback(AWS_IoT_Client *pClient, Timer *pTimer) {
+	uint16_t packet_id;
+	unsigned char dup, type;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	rc = aws_iot_mqtt_internal_wait_for_read(pClient, PUBACK, pTimer);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+
+	rc = aws_iot_mqtt_internal_deserialize_ack(&type, &dup, &packet_id, pClient->clientData.readBuf,
+											   pClient->clientData.readBufSize);
+	FUNC_EXIT_RC(rc);
+}
+
+/**
+ * @brief Returns the next packet identifier that no asynchronous publish is using
+ *
+ * @param pClient Reference to the IoT Client
+ *
+ * @return The packet identifier
+ */
+static uint16_t _aws_iot_mqtt_internal_get_free_packet_id(AWS_IoT_Client *pClient) {
+	uint16_t packetId;
+	size_t i;
+
+	do {
+		packetId = aws_iot_mqtt_get_next_packet_id(pClient);
+		for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+			if(pClient->clientData.publishesInFlight[i].inUse &&
+			   packetId == pClient->clientData.publishesInFlight[i].packetId) {
+				break;
+			}
+		}
+	} while(i < AWS_IOT_MQTT_PUBLISH_WINDOW);
+
+	return packetId;
+}
+
 /**
  * @brief Publish an MQTT message on a topic
  *
@@ -198,8 +293,6 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 												  uint16_t topicNameLen, IoT_Publish_Message_Params *pParams) {
 	Timer timer;
 	uint32_t len = 0;
-	uint16_t packet_id;
-	unsigned char dup, type;
 	IoT_Error_t rc;
 
 	FUNC_ENTRY;
@@ -208,7 +301,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 	countdown_ms(&timer, pClient->clientData.commandTimeoutMs);
 
 	if(QOS1 == pParams->qos) {
-		pParams->id = aws_iot_mqtt_get_next_packet_id(pClient);
+		pParams->id = _aws_iot_mqtt_internal_get_free_packet_id(pClient);
 	}
 
 	rc = _aws_iot_mqtt_internal_serialize_publish(pClient->clientData.writeBuf, pClient->clientData.writeBufSize, 0,
@@ -227,13 +320,73 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 
 	/* Wait for ack if QoS1 */
 	if(QOS1 == pParams->qos) {
-		rc = aws_iot_mqtt_internal_wait_for_read(pClient, PUBACK, &timer);
+		rc = _aws_iot_mqtt_internal_wait_for_puback(pClient, &timer);
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
 		}
+	}
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+/**
+ * @brief Publish an MQTT message made of payload segments on a topic
+ *
+ * Like _aws_iot_mqtt_internal_publish, but only the header is serialized into the
+ * client's write buffer; the payload segments are handed to the network layer as they are.
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pTopicName Topic Name to publish to
+ * @param topicNameLen Length of the topic name
+ * @param pParams Pointer to Publish Message parameters, the payload fields are not used
+ * @param pPayload The payload segments
+ * @param payloadCount Number of payload segments
+ *
+ * @return An IoT Error Type defining successful/failed publish
+ */
+static IoT_Error_t _aws_iot_mqtt_internal_publishv(AWS_IoT_Client *pClient, const char *pTopicName,
+												   uint16_t topicNameLen, IoT_Publish_Message_Params *pParams,
+												   const IoT_IOVec *pPayload, size_t payloadCount) {
+	Timer timer;
+	uint32_t len = 0;
+	size_t payloadLen = 0;
+	size_t i;
+	IoT_IOVec segments[AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS + 1];
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	for(i = 0; i < payloadCount; i++) {
+		payloadLen += pPayload[i].len;
+		segments[i + 1] = pPayload[i];
+	}
 
-		rc = aws_iot_mqtt_internal_deserialize_ack(&type, &dup, &packet_id, pClient->clientData.readBuf,
-												   pClient->clientData.readBufSize);
+	init_timer(&timer);
+	countdown_ms(&timer, pClient->clientData.commandTimeoutMs);
+
+	if(QOS1 == pParams->qos) {
+		pParams->id = _aws_iot_mqtt_internal_get_free_packet_id(pClient);
+	}
+
+	rc = _aws_iot_mqtt_internal_serialize_publish_header(pClient->clientData.writeBuf,
+														  pClient->clientData.writeBufSize, 0, pParams->qos,
+														  pParams->isRetained, pParams->id, pTopicName, topicNameLen,
+														  payloadLen, &len);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+	segments[0].pBase = pClient->clientData.writeBuf;
+	segments[0].len = len;
+
+	/* send the publish packet */
+	rc = aws_iot_mqtt_internal_send_packetv(pClient, segments, payloadCount + 1, &timer);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+
+	/* Wait for ack if QoS1 */
+	if(QOS1 == pParams->qos) {
+		rc = _aws_iot_mqtt_internal_wait_for_puback(pClient, &timer);
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
 		}
@@ -242,17 +395,201 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 	FUNC_EXIT_RC(SUCCESS);
 }
 
-IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
-								 IoT_Publish_Message_Params *pParams) {
-	IoT_Error_t rc, pubRc;
+/**
+ * @brief Sends an asynchronous publish that is in flight
+ *
+ * The header is serialized into the client's write buffer, the payload is sent from
+ * the application's buffer. Restarts the retransmit timer of the publish.
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pInFlight The publish to send
+ * @param dup uint8_t - the MQTT dup flag, set when the message is sent again
+ *
+ * @return An IoT Error Type defining successful/failed send
+ */
+static IoT_Error_t _aws_iot_mqtt_internal_send_in_flight(AWS_IoT_Client *pClient, PublishInFlight *pInFlight,
+														 uint8_t dup) {
+	Timer timer;
+	uint32_t len = 0;
+	IoT_IOVec segments[2];
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	init_timer(&timer);
+	countdown_ms(&timer, pClient->clientData.commandTimeoutMs);
+
+	rc = _aws_iot_mqtt_internal_serialize_publish_header(pClient->clientData.writeBuf,
+														  pClient->clientData.writeBufSize, dup, QOS1,
+														  pInFlight->isRetained, pInFlight->packetId,
+														  pInFlight->pTopicName, pInFlight->topicNameLen,
+														  pInFlight->payloadLen, &len);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+	segments[0].pBase = pClient->clientData.writeBuf;
+	segments[0].len = len;
+	segments[1].pBase = pInFlight->pPayload;
+	segments[1].len = pInFlight->payloadLen;
+
+	rc = aws_iot_mqtt_internal_send_packetv(pClient, segments, (0 < pInFlight->payloadLen) ? 2 : 1, &timer);
+	countdown_ms(&(pInFlight->retransmitTimer), pClient->clientData.commandTimeoutMs);
+
+	FUNC_EXIT_RC(rc);
+}
+
+/**
+ * @brief Ends an asynchronous publish and calls its completion handler
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pInFlight The publish that completed
+ * @param status SUCCESS if it was acknowledged, otherwise the error that ended it
+ *
+ * @return An IoT Error Type defining successful/failed client state change
+ */
+static IoT_Error_t _aws_iot_mqtt_internal_complete_publish(AWS_IoT_Client *pClient, PublishInFlight *pInFlight,
+														   IoT_Error_t status) {
+	pPublishCompleteHandler_t pCompleteHandler = pInFlight->pCompleteHandler;
+	void *pCompleteHandlerData = pInFlight->pCompleteHandlerData;
+	uint16_t packetId = pInFlight->packetId;
 	ClientState clientState;
+	IoT_Error_t rc = SUCCESS;
 
 	FUNC_ENTRY;
 
-	if(NULL == pClient || NULL == pTopicName || 0 == topicNameLen || NULL == pParams) {
-		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	/* Free the entry first, the handler may publish again */
+	pInFlight->inUse = false;
+
+	if(NULL != pCompleteHandler) {
+		/* As for message handlers, yield cannot be called while the handler runs */
+		clientState = aws_iot_mqtt_get_client_state(pClient);
+		aws_iot_mqtt_set_client_state(pClient, clientState, CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN);
+		pCompleteHandler(pClient, packetId, status, pCompleteHandlerData);
+		rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN, clientState);
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
+/**
+ * @brief Sends a QoS 1 publish without waiting for its PUBACK
+ *
+ * Not meant to be called directly as it doesn't do validations or client state changes
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pParams Pointer to Publish Message parameters, the packet identifier is returned in it
+ * @param pInFlight A free in-flight entry, already holding the message; it is used if the send succeeds
+ *
+ * @return An IoT Error Type defining successful/failed publish
+ */
+static IoT_Error_t _aws_iot_mqtt_internal_publish_async(AWS_IoT_Client *pClient, IoT_Publish_Message_Params *pParams,
+														PublishInFlight *pInFlight) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	pParams->id = _aws_iot_mqtt_internal_get_free_packet_id(pClient);
+	pInFlight->packetId = pParams->id;
+	pInFlight->retransmitCount = 0;
+	init_timer(&(pInFlight->retransmitTimer));
+
+	rc = _aws_iot_mqtt_internal_send_in_flight(pClient, pInFlight, 0);
+	if(SUCCESS == rc) {
+		pInFlight->inUse = true;
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_mqtt_internal_handle_puback(AWS_IoT_Client *pClient, uint8_t *pPacketType) {
+	uint16_t packetId;
+	unsigned char dup, type;
+	size_t i;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	rc = aws_iot_mqtt_internal_deserialize_ack(&type, &dup, &packetId, pClient->clientData.readBuf,
+											   pClient->clientData.readBufSize);
+	if(SUCCESS != rc) {
+		/* Left for a blocking publish to report */
+		FUNC_EXIT_RC(SUCCESS);
+	}
+
+	for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+		if(pClient->clientData.publishesInFlight[i].inUse &&
+		   packetId == pClient->clientData.publishesInFlight[i].packetId) {
+			/* Consumed here, so that a blocking publish keeps waiting for its own PUBACK */
+			*pPacketType = 0;
+			rc = _aws_iot_mqtt_internal_complete_publish(pClient, &(pClient->clientData.publishesInFlight[i]), SUCCESS);
+			FUNC_EXIT_RC(rc);
+		}
 	}
 
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+IoT_Error_t aws_iot_mqtt_internal_retransmit_publishes(AWS_IoT_Client *pClient) {
+	PublishInFlight *pInFlight;
+	size_t i;
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+
+	for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW && SUCCESS == rc; i++) {
+		pInFlight = &(pClient->clientData.publishesInFlight[i]);
+		if(!pInFlight->inUse || !has_timer_expired(&(pInFlight->retransmitTimer))) {
+			continue;
+		}
+
+		if(AWS_IOT_MQTT_PUBLISH_MAX_RETRIES <= pInFlight->retransmitCount) {
+			rc = _aws_iot_mqtt_internal_complete_publish(pClient, pInFlight, MQTT_REQUEST_TIMEOUT_ERROR);
+		} else {
+			pInFlight->retransmitCount++;
+			rc = _aws_iot_mqtt_internal_send_in_flight(pClient, pInFlight, 1);
+		}
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
+void aws_iot_mqtt_internal_fail_publishes(AWS_IoT_Client *pClient, IoT_Error_t status) {
+	PublishInFlight *pInFlight;
+	size_t i;
+
+	FUNC_ENTRY;
+
+	for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+		pInFlight = &(pClient->clientData.publishesInFlight[i]);
+		if(!pInFlight->inUse) {
+			continue;
+		}
+
+		/* The client is no longer connected, so a handler that publishes again is refused */
+		pInFlight->inUse = false;
+		if(NULL != pInFlight->pCompleteHandler) {
+			pInFlight->pCompleteHandler(pClient, pInFlight->packetId, status, pInFlight->pCompleteHandlerData);
+		}
+	}
+
+	FUNC_EXIT;
+}
+
+/**
+ * @brief Runs a publish in the CONNECTED_PUBLISH_IN_PROGRESS state
+ *
+ * Shared by the publish APIs: pPayload is set for aws_iot_mqtt_publishv and
+ * pInFlight for a QoS 1 aws_iot_mqtt_publish_async.
+ */
+static IoT_Error_t _aws_iot_mqtt_publish_in_state(AWS_IoT_Client *pClient, const char *pTopicName,
+												  uint16_t topicNameLen, IoT_Publish_Message_Params *pParams,
+												  const IoT_IOVec *pPayload, size_t payloadCount,
+												  PublishInFlight *pInFlight) {
+	IoT_Error_t rc, pubRc;
+	ClientState clientState;
+
+	FUNC_ENTRY;
+
 	if(!aws_iot_mqtt_is_client_connected(pClient)) {
 		FUNC_EXIT_RC(NETWORK_DISCONNECTED_ERROR);
 	}
@@ -267,7 +604,13 @@ IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName
 		FUNC_EXIT_RC(rc);
 	}
 
-	pubRc = _aws_iot_mqtt_internal_publish(pClient, pTopicName, topicNameLen, pParams);
+	if(NULL != pInFlight) {
+		pubRc = _aws_iot_mqtt_internal_publish_async(pClient, pParams, pInFlight);
+	} else if(NULL == pPayload) {
+		pubRc = _aws_iot_mqtt_internal_publish(pClient, pTopicName, topicNameLen, pParams);
+	} else {
+		pubRc = _aws_iot_mqtt_internal_publishv(pClient, pTopicName, topicNameLen, pParams, pPayload, payloadCount);
+	}
 
 	rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_PUBLISH_IN_PROGRESS, clientState);
 	if(SUCCESS == pubRc && SUCCESS != rc) {
@@ -277,6 +620,92 @@ IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName
 	FUNC_EXIT_RC(pubRc);
 }
 
+IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+								 IoT_Publish_Message_Params *pParams) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient || NULL == pTopicName || 0 == topicNameLen || NULL == pParams) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	rc = _aws_iot_mqtt_publish_in_state(pClient, pTopicName, topicNameLen, pParams, NULL, 0, NULL);
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_mqtt_publishv(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+								  IoT_Publish_Message_Params *pParams, const IoT_IOVec *pPayload,
+								  size_t payloadCount) {
+	size_t i;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient || NULL == pTopicName || 0 == topicNameLen || NULL == pParams || NULL == pPayload) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(payloadCount > AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS) {
+		FUNC_EXIT_RC(LIMIT_EXCEEDED_ERROR);
+	}
+
+	for(i = 0; i < payloadCount; i++) {
+		if(NULL == pPayload[i].pBase && 0 != pPayload[i].len) {
+			FUNC_EXIT_RC(NULL_VALUE_ERROR);
+		}
+	}
+
+	rc = _aws_iot_mqtt_publish_in_state(pClient, pTopicName, topicNameLen, pParams, pPayload, payloadCount, NULL);
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_mqtt_publish_async(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+									   IoT_Publish_Message_Params *pParams, pPublishCompleteHandler_t pCompleteHandler,
+									   void *pCompleteHandlerData) {
+	PublishInFlight *pInFlight = NULL;
+	size_t i;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient || NULL == pTopicName || 0 == topicNameLen || NULL == pParams) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(NULL == pParams->payload && 0 != pParams->payloadLen) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	/* There is nothing to wait for at QoS 0 */
+	if(QOS0 == pParams->qos) {
+		rc = _aws_iot_mqtt_publish_in_state(pClient, pTopicName, topicNameLen, pParams, NULL, 0, NULL);
+		FUNC_EXIT_RC(rc);
+	}
+
+	for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+		if(!pClient->clientData.publishesInFlight[i].inUse) {
+			pInFlight = &(pClient->clientData.publishesInFlight[i]);
+			break;
+		}
+	}
+
+	if(NULL == pInFlight) {
+		FUNC_EXIT_RC(LIMIT_EXCEEDED_ERROR);
+	}
+
+	pInFlight->isRetained = pParams->isRetained;
+	pInFlight->pTopicName = pTopicName;
+	pInFlight->topicNameLen = topicNameLen;
+	pInFlight->pPayload = (const unsigned char *) pParams->payload;
+	pInFlight->payloadLen = pParams->payloadLen;
+	pInFlight->pCompleteHandler = pCompleteHandler;
+	pInFlight->pCompleteHandlerData = pCompleteHandlerData;
+
+	rc = _aws_iot_mqtt_publish_in_state(pClient, pTopicName, topicNameLen, pParams, NULL, 0, pInFlight);
+	FUNC_EXIT_RC(rc);
+}
+
 /**
   * Deserializes the supplied (wire) buffer into publish data
   * @param dup returned uint8_t - the MQTT dup flag
@@ -199,6 +199,8 @@ static uint32_t _aws_iot_mqtt_get_free_message_handler_index(AWS_IoT_Client *pCl
  *     no malloc are performed by the SDK
  * @param topicNameLen Length of the topic name
  * @param pApplicationHandler_t Reference to the handler function for this subscription
+ * @param pStreamHandler Reference to the handler function for a streaming subscription, used
+ *     instead of pApplicationHandler if not NULL
  * @param pApplicationHandlerData Point to data passed to the callback.
  *    pApplicationHandlerData also needs to be static in memory  since no malloc are performed by the SDK
  *
@@ -207,6 +209,7 @@ static uint32_t _aws_iot_mqtt_get_free_message_handler_index(AWS_IoT_Client *pCl
 static IoT_Error_t _aws_iot_mqtt_internal_subscribe(AWS_IoT_Client *pClient, const char *pTopicName,
 													uint16_t topicNameLen, QoS qos,
 													pApplicationHandler_t pApplicationHandler,
+													pApplicationStreamHandler_t pStreamHandler,
 													void *pApplicationHandlerData) {
 	uint16_t txPacketId, rxPacketId;
 	uint32_t serializedLen, indexOfFreeMessageHandler, count;
@@ -266,21 +269,25 @@ static IoT_Error_t _aws_iot_mqtt_internal_subscribe(AWS_IoT_Client *pClient, con
 			topicNameLen;
 	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].pApplicationHandler =
 			pApplicationHandler;
+	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].pStreamHandler =
+			pStreamHandler;
 	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].pApplicationHandlerData =
 			pApplicationHandlerData;
 	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].qos = qos;
+	aws_iot_mqtt_internal_topic_index_add(pClient, indexOfFreeMessageHandler);
 
 	FUNC_EXIT_RC(SUCCESS);
 }
 
-IoT_Error_t aws_iot_mqtt_subscribe(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
-								   QoS qos, pApplicationHandler_t pApplicationHandler, void *pApplicationHandlerData) {
+static IoT_Error_t _aws_iot_mqtt_subscribe(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+										   QoS qos, pApplicationHandler_t pApplicationHandler,
+										   pApplicationStreamHandler_t pStreamHandler, void *pApplicationHandlerData) {
 	ClientState clientState;
 	IoT_Error_t rc, subRc;
 
 	FUNC_ENTRY;
 
-	if(NULL == pClient || NULL == pTopicName || NULL == pApplicationHandler) {
+	if(NULL == pClient || NULL == pTopicName || (NULL == pApplicationHandler && NULL == pStreamHandler)) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
@@ -299,7 +306,7 @@ IoT_Error_t aws_iot_mqtt_subscribe(AWS_IoT_Client *pClient, const char *pTopicNa
 	}
 
 	subRc = _aws_iot_mqtt_internal_subscribe(pClient, pTopicName, topicNameLen, qos,
-											 pApplicationHandler, pApplicationHandlerData);
+											 pApplicationHandler, pStreamHandler, pApplicationHandlerData);
 
 	rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_SUBSCRIBE_IN_PROGRESS, clientState);
 	if(SUCCESS == subRc && SUCCESS != rc) {
@@ -309,6 +316,36 @@ IoT_Error_t aws_iot_mqtt_subscribe(AWS_IoT_Client *pClient, const char *pTopicNa
 	FUNC_EXIT_RC(subRc);
 }
 
+IoT_Error_t aws_iot_mqtt_subscribe(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+								   QoS qos, pApplicationHandler_t pApplicationHandler, void *pApplicationHandlerData) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pApplicationHandler) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	rc = _aws_iot_mqtt_subscribe(pClient, pTopicName, topicNameLen, qos, pApplicationHandler, NULL,
+								 pApplicationHandlerData);
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_mqtt_subscribe_stream(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
+										  QoS qos, pApplicationStreamHandler_t pStreamHandler,
+										  void *pStreamHandlerData) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pStreamHandler) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	rc = _aws_iot_mqtt_subscribe(pClient, pTopicName, topicNameLen, qos, NULL, pStreamHandler, pStreamHandlerData);
+	FUNC_EXIT_RC(rc);
+}
+
 /**
  * @brief Subscribe to an MQTT topic.
  *
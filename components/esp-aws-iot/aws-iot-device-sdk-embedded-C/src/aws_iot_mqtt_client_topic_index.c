@@ -0,0 +1,426 @@
+/**
+ * @file aws_iot_mqtt_client_topic_index.c
+ * @brief Index of the subscribed topic filters, used to dispatch incoming messages
+ *
+ * Each filter is a path of nodes from the root, one node per level, and
+ * filters with the same first levels share their nodes. A topic is matched by
+ * walking its levels down from the root, following the literal child, the
+ * '+' child and the '#' child of every node reached. The work depends on the
+ * length of the topic and on the filters it matches, not on how many filters
+ * are subscribed.
+ *
+ * Nodes come from a fixed pool in the client. A filter that does not fit is
+ * left out of the index and tested on its own for every incoming message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_mqtt_client_common_internal.h"
+
+#define TOPIC_INDEX_ROOT 0
+#define TOPIC_INDEX_NONE (-1)
+#define TOPIC_INDEX_TABLE_SIZE (AWS_IOT_MQTT_TOPIC_INDEX_NODES * 2)
+
+/* One level of a topic name or filter */
+typedef struct {
+	const char *pStart;
+	uint16_t len;
+	bool isLast;
+} TopicLevel;
+
+/* State of a topic lookup */
+typedef struct {
+	const TopicIndex *pIndex;
+	const char *pTopicEnd;
+	uint16_t *pHandlerIndexes;
+	uint32_t count;
+} TopicMatch;
+
+/* Filters are also compared as C strings by unsubscribe, so one ends at its first NUL */
+static uint16_t _aws_iot_mqtt_topic_filter_len(const MessageHandlers *pHandler) {
+	const char *pEnd = memchr(pHandler->topicName, '\0', pHandler->topicNameLen);
+
+	return (NULL == pEnd) ? pHandler->topicNameLen : (uint16_t) (pEnd - pHandler->topicName);
+}
+
+/* Reads the level starting at pCursor and returns the start of the next one */
+static const char *_aws_iot_mqtt_topic_next_level(const char *pCursor, const char *pEnd, TopicLevel *pLevel) {
+	const char *pSeparator = memchr(pCursor, '/', (size_t) (pEnd - pCursor));
+
+	pLevel->pStart = pCursor;
+	if(NULL == pSeparator) {
+		pLevel->len = (uint16_t) (pEnd - pCursor);
+		pLevel->isLast = true;
+		return pEnd;
+	}
+
+	pLevel->len = (uint16_t) (pSeparator - pCursor);
+	pLevel->isLast = false;
+	return pSeparator + 1;
+}
+
+static bool _aws_iot_mqtt_topic_level_is_plus(const TopicLevel *pLevel) {
+	return 1 == pLevel->len && '+' == pLevel->pStart[0];
+}
+
+/* '#' anywhere but the last level is taken literally, so that filter never matches */
+static bool _aws_iot_mqtt_topic_level_is_hash(const TopicLevel *pLevel) {
+	return pLevel->isLast && 1 == pLevel->len && '#' == pLevel->pStart[0];
+}
+
+/* FNV-1a over the parent node and the text of the level */
+static uint32_t _aws_iot_mqtt_topic_index_home_slot(int16_t parent, const char *pLevel, uint16_t levelLen) {
+	uint32_t hash = 2166136261u;
+	uint16_t i;
+
+	hash = (hash ^ (uint16_t) parent) * 16777619u;
+	for(i = 0; i < levelLen; i++) {
+		hash = (hash ^ (unsigned char) pLevel[i]) * 16777619u;
+	}
+
+	return hash % TOPIC_INDEX_TABLE_SIZE;
+}
+
+/* The table is at most half full, so a probe always reaches an empty slot */
+static int16_t _aws_iot_mqtt_topic_index_find_level(const TopicIndex *pIndex, int16_t parent, const char *pLevel,
+													uint16_t levelLen) {
+	uint32_t slot = _aws_iot_mqtt_topic_index_home_slot(parent, pLevel, levelLen);
+	const TopicIndexNode *pNode;
+	int16_t node;
+
+	while(TOPIC_INDEX_NONE != (node = pIndex->levelTable[slot])) {
+		pNode = &pIndex->nodes[node];
+		if(parent == pNode->parent && levelLen == pNode->levelLen && 0 == memcmp(pLevel, pNode->pLevel, levelLen)) {
+			return node;
+		}
+		slot = (slot + 1) % TOPIC_INDEX_TABLE_SIZE;
+	}
+
+	return TOPIC_INDEX_NONE;
+}
+
+static int16_t _aws_iot_mqtt_topic_index_find_child(const TopicIndex *pIndex, int16_t parent,
+													const TopicLevel *pLevel) {
+	if(_aws_iot_mqtt_topic_level_is_plus(pLevel)) {
+		return pIndex->nodes[parent].plusChild;
+	}
+	if(_aws_iot_mqtt_topic_level_is_hash(pLevel)) {
+		return pIndex->nodes[parent].hashChild;
+	}
+	return _aws_iot_mqtt_topic_index_find_level(pIndex, parent, pLevel->pStart, pLevel->len);
+}
+
+/* The caller made sure a node is free */
+static int16_t _aws_iot_mqtt_topic_index_add_child(TopicIndex *pIndex, int16_t parent, const TopicLevel *pLevel) {
+	TopicIndexNode *pNode;
+	uint32_t slot;
+	int16_t node;
+
+	for(node = TOPIC_INDEX_ROOT + 1; 0 < pIndex->nodes[node].refCount; node++) { }
+
+	pNode = &pIndex->nodes[node];
+	pNode->pLevel = pLevel->pStart;
+	pNode->levelLen = pLevel->len;
+	pNode->parent = parent;
+	pNode->plusChild = TOPIC_INDEX_NONE;
+	pNode->hashChild = TOPIC_INDEX_NONE;
+	pNode->firstHandler = TOPIC_INDEX_NONE;
+	pIndex->freeNodes--;
+
+	if(_aws_iot_mqtt_topic_level_is_plus(pLevel)) {
+		pIndex->nodes[parent].plusChild = node;
+	} else if(_aws_iot_mqtt_topic_level_is_hash(pLevel)) {
+		pIndex->nodes[parent].hashChild = node;
+	} else {
+		slot = _aws_iot_mqtt_topic_index_home_slot(parent, pLevel->pStart, pLevel->len);
+		while(TOPIC_INDEX_NONE != pIndex->levelTable[slot]) {
+			slot = (slot + 1) % TOPIC_INDEX_TABLE_SIZE;
+		}
+		pIndex->levelTable[slot] = node;
+	}
+
+	return node;
+}
+
+static void _aws_iot_mqtt_topic_index_remove_node(TopicIndex *pIndex, int16_t node) {
+	const TopicIndexNode *pNode = &pIndex->nodes[node];
+	TopicIndexNode *pParent = &pIndex->nodes[pNode->parent];
+	const TopicIndexNode *pMoved;
+	uint32_t slot, gap, home;
+
+	pIndex->freeNodes++;
+
+	if(node == pParent->plusChild) {
+		pParent->plusChild = TOPIC_INDEX_NONE;
+		return;
+	}
+	if(node == pParent->hashChild) {
+		pParent->hashChild = TOPIC_INDEX_NONE;
+		return;
+	}
+
+	gap = _aws_iot_mqtt_topic_index_home_slot(pNode->parent, pNode->pLevel, pNode->levelLen);
+	while(node != pIndex->levelTable[gap]) {
+		gap = (gap + 1) % TOPIC_INDEX_TABLE_SIZE;
+	}
+	pIndex->levelTable[gap] = TOPIC_INDEX_NONE;
+
+	/* Move later entries of the probe sequence back into the gap, unless
+	 * their home slot lies after the gap, where a lookup starts past it */
+	for(slot = (gap + 1) % TOPIC_INDEX_TABLE_SIZE; TOPIC_INDEX_NONE != pIndex->levelTable[slot];
+		slot = (slot + 1) % TOPIC_INDEX_TABLE_SIZE) {
+		pMoved = &pIndex->nodes[pIndex->levelTable[slot]];
+		home = _aws_iot_mqtt_topic_index_home_slot(pMoved->parent, pMoved->pLevel, pMoved->levelLen);
+		if((gap < slot) ? (home <= gap || home > slot) : (home <= gap && home > slot)) {
+			pIndex->levelTable[gap] = pIndex->levelTable[slot];
+			pIndex->levelTable[slot] = TOPIC_INDEX_NONE;
+			gap = slot;
+		}
+	}
+}
+
+/* Tests a filter that is not in the index, with the same rules as the index */
+static bool _aws_iot_mqtt_topic_filter_matches(const char *pFilter, uint16_t filterLen, const char *pTopicName,
+											   uint16_t topicNameLen, bool wildcards) {
+	const char *pFilterEnd = pFilter + filterLen;
+	const char *pTopicEnd = pTopicName + topicNameLen;
+	TopicLevel filterLevel, topicLevel;
+	bool topicDone = false;
+
+	do {
+		pFilter = _aws_iot_mqtt_topic_next_level(pFilter, pFilterEnd, &filterLevel);
+		if(_aws_iot_mqtt_topic_level_is_hash(&filterLevel)) {
+			return wildcards;
+		}
+		if(topicDone) {
+			return false;
+		}
+
+		pTopicName = _aws_iot_mqtt_topic_next_level(pTopicName, pTopicEnd, &topicLevel);
+		topicDone = topicLevel.isLast;
+		if(_aws_iot_mqtt_topic_level_is_plus(&filterLevel)) {
+			if(!wildcards) {
+				return false;
+			}
+		} else if(filterLevel.len != topicLevel.len
+				  || 0 != memcmp(filterLevel.pStart, topicLevel.pStart, filterLevel.len)) {
+			return false;
+		}
+		wildcards = true;
+	} while(!filterLevel.isLast);
+
+	return topicDone;
+}
+
+static void _aws_iot_mqtt_topic_index_collect(TopicMatch *pMatch, int16_t node) {
+	int16_t handler;
+
+	for(handler = pMatch->pIndex->nodes[node].firstHandler; TOPIC_INDEX_NONE != handler;
+		handler = pMatch->pIndex->nextHandler[handler]) {
+		pMatch->pHandlerIndexes[pMatch->count++] = (uint16_t) handler;
+	}
+}
+
+/* pCursor is the topic level below the node, NULL once every level is matched.
+ * A node is only reached through its parent, so none is visited twice. */
+static void _aws_iot_mqtt_topic_index_match_below(TopicMatch *pMatch, int16_t node, const char *pCursor,
+												  bool wildcards) {
+	const TopicIndexNode *pNode = &pMatch->pIndex->nodes[node];
+	const char *pNext;
+	TopicLevel level;
+	int16_t child;
+
+	/* A trailing '#' also matches the level above it, MQTT v3.1.1 4.7.1.2 */
+	if(wildcards && TOPIC_INDEX_NONE != pNode->hashChild) {
+		_aws_iot_mqtt_topic_index_collect(pMatch, pNode->hashChild);
+	}
+	if(NULL == pCursor) {
+		_aws_iot_mqtt_topic_index_collect(pMatch, node);
+		return;
+	}
+
+	pNext = _aws_iot_mqtt_topic_next_level(pCursor, pMatch->pTopicEnd, &level);
+	if(level.isLast) {
+		pNext = NULL;
+	}
+
+	child = _aws_iot_mqtt_topic_index_find_level(pMatch->pIndex, node, level.pStart, level.len);
+	if(TOPIC_INDEX_NONE != child) {
+		_aws_iot_mqtt_topic_index_match_below(pMatch, child, pNext, true);
+	}
+	if(wildcards && TOPIC_INDEX_NONE != pNode->plusChild) {
+		_aws_iot_mqtt_topic_index_match_below(pMatch, pNode->plusChild, pNext, true);
+	}
+}
+
+void aws_iot_mqtt_internal_topic_index_init(AWS_IoT_Client *pClient) {
+	TopicIndex *pIndex = &pClient->clientData.topicIndex;
+	TopicIndexNode *pRoot = &pIndex->nodes[TOPIC_INDEX_ROOT];
+	uint32_t i;
+
+	for(i = 0; i < AWS_IOT_MQTT_TOPIC_INDEX_NODES; ++i) {
+		pIndex->nodes[i].refCount = 0;
+	}
+	for(i = 0; i < TOPIC_INDEX_TABLE_SIZE; ++i) {
+		pIndex->levelTable[i] = TOPIC_INDEX_NONE;
+	}
+	for(i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++i) {
+		pIndex->handlerNode[i] = TOPIC_INDEX_NONE;
+		pIndex->nextHandler[i] = TOPIC_INDEX_NONE;
+	}
+
+	pRoot->pLevel = NULL;
+	pRoot->levelLen = 0;
+	pRoot->parent = TOPIC_INDEX_NONE;
+	pRoot->plusChild = TOPIC_INDEX_NONE;
+	pRoot->hashChild = TOPIC_INDEX_NONE;
+	pRoot->firstHandler = TOPIC_INDEX_NONE;
+
+	pIndex->freeNodes = AWS_IOT_MQTT_TOPIC_INDEX_NODES - 1;
+	pIndex->unindexedHandlers = 0;
+}
+
+void aws_iot_mqtt_internal_topic_index_add(AWS_IoT_Client *pClient, uint32_t handlerIndex) {
+	TopicIndex *pIndex = &pClient->clientData.topicIndex;
+	const MessageHandlers *pHandler = &pClient->clientData.messageHandlers[handlerIndex];
+	const char *pFilterEnd = pHandler->topicName + _aws_iot_mqtt_topic_filter_len(pHandler);
+	const char *pCursor;
+	TopicLevel level;
+	uint32_t missing = 0;
+	int16_t node, child;
+
+	/* Count the levels without a node first, so a filter is indexed whole or not at all */
+	node = TOPIC_INDEX_ROOT;
+	pCursor = pHandler->topicName;
+	do {
+		pCursor = _aws_iot_mqtt_topic_next_level(pCursor, pFilterEnd, &level);
+		child = (TOPIC_INDEX_NONE == node) ? TOPIC_INDEX_NONE
+										   : _aws_iot_mqtt_topic_index_find_child(pIndex, node, &level);
+		if(TOPIC_INDEX_NONE == child) {
+			missing++;
+		}
+		node = child;
+	} while(!level.isLast);
+
+	if(missing > pIndex->freeNodes) {
+		IOT_WARN("No room to index topic filter %.*s, it is tested on every message",
+				 (int) (pFilterEnd - pHandler->topicName), pHandler->topicName);
+		pIndex->handlerNode[handlerIndex] = TOPIC_INDEX_NONE;
+		pIndex->unindexedHandlers++;
+		return;
+	}
+
+	node = TOPIC_INDEX_ROOT;
+	pCursor = pHandler->topicName;
+	do {
+		pCursor = _aws_iot_mqtt_topic_next_level(pCursor, pFilterEnd, &level);
+		child = _aws_iot_mqtt_topic_index_find_child(pIndex, node, &level);
+		if(TOPIC_INDEX_NONE == child) {
+			child = _aws_iot_mqtt_topic_index_add_child(pIndex, node, &level);
+		}
+		pIndex->nodes[child].refCount++;
+		node = child;
+	} while(!level.isLast);
+
+	pIndex->nextHandler[handlerIndex] = pIndex->nodes[node].firstHandler;
+	pIndex->nodes[node].firstHandler = (int16_t) handlerIndex;
+	pIndex->handlerNode[handlerIndex] = node;
+}
+
+/* Call before the handler's topic name is cleared */
+void aws_iot_mqtt_internal_topic_index_remove(AWS_IoT_Client *pClient, uint32_t handlerIndex) {
+	TopicIndex *pIndex = &pClient->clientData.topicIndex;
+	const MessageHandlers *pHandlers = pClient->clientData.messageHandlers;
+	const char *pFilter = pHandlers[handlerIndex].topicName;
+	const char *pFilterEnd = pFilter + _aws_iot_mqtt_topic_filter_len(&pHandlers[handlerIndex]);
+	int16_t node = pIndex->handlerNode[handlerIndex];
+	int16_t *pLink;
+	int16_t parent;
+	uint32_t itr;
+
+	if(TOPIC_INDEX_NONE == node) {
+		pIndex->unindexedHandlers--;
+		return;
+	}
+
+	for(pLink = &pIndex->nodes[node].firstHandler; (int16_t) handlerIndex != *pLink;
+		pLink = &pIndex->nextHandler[*pLink]) { }
+	*pLink = pIndex->nextHandler[handlerIndex];
+	pIndex->handlerNode[handlerIndex] = TOPIC_INDEX_NONE;
+
+	while(TOPIC_INDEX_ROOT != node) {
+		parent = pIndex->nodes[node].parent;
+		if(0 == --pIndex->nodes[node].refCount) {
+			_aws_iot_mqtt_topic_index_remove_node(pIndex, node);
+		}
+		node = parent;
+	}
+
+	/* Nodes still in use may have taken their level from this filter. The
+	 * application may reuse its memory now, so point them at the same level
+	 * of another filter through them: the path from the root is the same, and
+	 * so is the text up to there. */
+	for(itr = 0; itr < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++itr) {
+		for(node = pIndex->handlerNode[itr]; TOPIC_INDEX_NONE != node && TOPIC_INDEX_ROOT != node;
+			node = pIndex->nodes[node].parent) {
+			if(pIndex->nodes[node].pLevel >= pFilter && pIndex->nodes[node].pLevel <= pFilterEnd) {
+				pIndex->nodes[node].pLevel = pHandlers[itr].topicName + (pIndex->nodes[node].pLevel - pFilter);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Finds the handlers whose topic filter matches a topic name
+ *
+ * Wildcards in the first level of a filter do not match topic names starting
+ * with '$', MQTT v3.1.1 4.7.2.
+ *
+ * @param pHandlerIndexes Receives the indexes of the matching handlers, in
+ *     ascending order. Room for AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS entries.
+ *
+ * @return Number of matching handlers
+ */
+uint32_t aws_iot_mqtt_internal_topic_index_match(AWS_IoT_Client *pClient, const char *pTopicName,
+												 uint16_t topicNameLen, uint16_t *pHandlerIndexes) {
+	const MessageHandlers *pHandlers = pClient->clientData.messageHandlers;
+	bool wildcards = (0 == topicNameLen || '$' != pTopicName[0]);
+	TopicMatch match;
+	uint32_t itr, pos;
+	uint16_t handlerIndex;
+
+	match.pIndex = &pClient->clientData.topicIndex;
+	match.pTopicEnd = pTopicName + topicNameLen;
+	match.pHandlerIndexes = pHandlerIndexes;
+	match.count = 0;
+
+	_aws_iot_mqtt_topic_index_match_below(&match, TOPIC_INDEX_ROOT, pTopicName, wildcards);
+
+	if(0 < match.pIndex->unindexedHandlers) {
+		for(itr = 0; itr < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++itr) {
+			if(NULL != pHandlers[itr].topicName && TOPIC_INDEX_NONE == match.pIndex->handlerNode[itr]
+			   && _aws_iot_mqtt_topic_filter_matches(pHandlers[itr].topicName,
+													 _aws_iot_mqtt_topic_filter_len(&pHandlers[itr]), pTopicName,
+													 topicNameLen, wildcards)) {
+				pHandlerIndexes[match.count++] = (uint16_t) itr;
+			}
+		}
+	}
+
+	/* Handlers are called in the order of their slots, as when each filter was tested in turn */
+	for(itr = 1; itr < match.count; ++itr) {
+		handlerIndex = pHandlerIndexes[itr];
+		for(pos = itr; 0 < pos && pHandlerIndexes[pos - 1] > handlerIndex; --pos) {
+			pHandlerIndexes[pos] = pHandlerIndexes[pos - 1];
+		}
+		pHandlerIndexes[pos] = handlerIndex;
+	}
+
+	return match.count;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -48,6 +48,7 @@ static void _aws_iot_mqtt_force_client_disconnect(AWS_IoT_Client *pClient) {
 	pClient->clientStatus.clientState = CLIENT_STATE_DISCONNECTED_ERROR;
 	pClient->networkStack.disconnect(&(pClient->networkStack));
 	pClient->networkStack.destroy(&(pClient->networkStack));
+	aws_iot_mqtt_internal_fail_publishes(pClient, NETWORK_DISCONNECTED_ERROR);
 }
 
 static IoT_Error_t _aws_iot_mqtt_handle_disconnect(AWS_IoT_Client *pClient) {
@@ -232,7 +233,14 @@ static IoT_Error_t _aws_iot_mqtt_internal_yield(AWS_IoT_Client *pClient, uint32_
 		yieldRc = aws_iot_mqtt_internal_cycle_read(pClient, &timer, &packet_type);
 		if(SUCCESS == yieldRc) {
 			yieldRc = _aws_iot_mqtt_keep_alive(pClient);
-		} else {
+		}
+		if(SUCCESS == yieldRc) {
+			yieldRc = aws_iot_mqtt_internal_retransmit_publishes(pClient);
+		}
+		if(SUCCESS == yieldRc && pClient->clientData.isCorked && has_timer_expired(&(pClient->clientData.corkTimer))) {
+			yieldRc = aws_iot_mqtt_uncork(pClient);
+		}
+		if(SUCCESS != yieldRc) {
 			// SSL read and write errors are terminal, connection must be closed and retried
 			if(NETWORK_SSL_READ_ERROR == yieldRc || NETWORK_SSL_WRITE_ERROR == yieldRc || NETWORK_SSL_WRITE_TIMEOUT_ERROR == yieldRc) {
 				yieldRc = _aws_iot_mqtt_handle_disconnect(pClient);
@@ -319,6 +327,52 @@ IoT_Error_t aws_iot_mqtt_yield(AWS_IoT_Client *pClient, uint32_t timeout_ms) {
 	FUNC_EXIT_RC(yieldRc);
 }
 
+uint32_t aws_iot_mqtt_get_next_yield_ms(AWS_IoT_Client *pClient) {
+	ClientState clientState;
+	uint32_t nextMs = UINT32_MAX;
+	uint32_t leftMs;
+	size_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient) {
+		FUNC_EXIT_RC(0);
+	}
+
+	clientState = aws_iot_mqtt_get_client_state(pClient);
+	if(CLIENT_STATE_PENDING_RECONNECT == clientState) {
+		leftMs = left_ms(&(pClient->reconnectDelayTimer));
+		FUNC_EXIT_RC(leftMs);
+	}
+	if(!aws_iot_mqtt_is_client_connected(pClient) || CLIENT_STATE_CONNECTED_RESUBSCRIBE_IN_PROGRESS == clientState) {
+		/* Let yield report the state or carry on resubscribing */
+		FUNC_EXIT_RC(0);
+	}
+
+	if(0 != pClient->clientData.keepAliveInterval) {
+		nextMs = pClient->clientStatus.isPingOutstanding ? left_ms(&(pClient->pingRespTimer))
+														 : left_ms(&(pClient->pingReqTimer));
+	}
+
+	if(pClient->clientData.isCorked) {
+		leftMs = left_ms(&(pClient->clientData.corkTimer));
+		if(leftMs < nextMs) {
+			nextMs = leftMs;
+		}
+	}
+
+	for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+		if(pClient->clientData.publishesInFlight[i].inUse) {
+			leftMs = left_ms(&(pClient->clientData.publishesInFlight[i].retransmitTimer));
+			if(leftMs < nextMs) {
+				nextMs = leftMs;
+			}
+		}
+	}
+
+	FUNC_EXIT_RC(nextMs);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -167,6 +167,18 @@ IoT_Error_t aws_iot_shadow_yield(AWS_IoT_Client *pClient, uint32_t timeout) {
 	return aws_iot_mqtt_yield(pClient, timeout);
 }
 
+uint32_t aws_iot_shadow_get_next_yield_ms(AWS_IoT_Client *pClient) {
+	uint32_t mqttMs, responseMs;
+
+	if(NULL == pClient) {
+		return 0;
+	}
+
+	mqttMs = aws_iot_mqtt_get_next_yield_ms(pClient);
+	responseMs = getNextResponseTimeoutMs();
+	return (responseMs < mqttMs) ? responseMs : mqttMs;
+}
+
 IoT_Error_t aws_iot_shadow_disconnect(AWS_IoT_Client *pClient) {
 	return aws_iot_mqtt_disconnect(pClient);
 }
@@ -86,6 +86,21 @@ bool shadowDiscardOldDeltaFlag = true;
 static void AckStatusCallback(AWS_IoT_Client *pClient, char *topicName,
 							  uint16_t topicNameLen, IoT_Publish_Message_Params *params, void *pData);
 
+uint32_t getNextResponseTimeoutMs(void) {
+	uint32_t nextMs = UINT32_MAX;
+	uint32_t leftMs;
+	uint8_t i;
+	for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
+		if(!AckWaitList[i].isFree) {
+			leftMs = left_ms(&(AckWaitList[i].timer));
+			if(leftMs < nextMs) {
+				nextMs = leftMs;
+			}
+		}
+	}
+	return nextMs;
+}
+
 static void shadow_delta_callback(AWS_IoT_Client *pClient, char *topicName,
 								  uint16_t topicNameLen, IoT_Publish_Message_Params *params, void *pData);
 
@@ -406,6 +421,7 @@ IoT_Error_t publishToShadowAction(const char *pThingName, ShadowActions_t action
 	IoT_Error_t ret_val = SUCCESS;
 	char TemporaryTopicName[MAX_SHADOW_TOPIC_LENGTH_BYTES];
 	IoT_Publish_Message_Params msgParams;
+	IoT_IOVec document;
 
 	if(NULL == pThingName || NULL == pJsonDocumentToBeSent) {
 		return NULL_VALUE_ERROR;
@@ -417,7 +433,12 @@ IoT_Error_t publishToShadowAction(const char *pThingName, ShadowActions_t action
 	msgParams.isRetained = 0;
 	msgParams.payloadLen = strlen(pJsonDocumentToBeSent);
 	msgParams.payload = (char *) pJsonDocumentToBeSent;
-	ret_val = aws_iot_mqtt_publish(pMqttClient, TemporaryTopicName, (uint16_t) strlen(TemporaryTopicName), &msgParams);
+
+	/* The document goes out from the caller's buffer; only the header needs the TX buffer */
+	document.pBase = (const unsigned char *) pJsonDocumentToBeSent;
+	document.len = msgParams.payloadLen;
+	ret_val = aws_iot_mqtt_publishv(pMqttClient, TemporaryTopicName, (uint16_t) strlen(TemporaryTopicName), &msgParams,
+									&document, 1);
 
 	return ret_val;
 }
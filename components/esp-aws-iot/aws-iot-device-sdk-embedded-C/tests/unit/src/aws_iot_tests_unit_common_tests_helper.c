@@ -24,6 +24,7 @@
 
 #include "aws_iot_mqtt_client_interface.h"
 #include "aws_iot_log.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
 #include "aws_iot_tests_unit_helper_functions.h"
 
 static IoT_Client_Init_Params initParams;
@@ -52,6 +53,67 @@ static void iot_tests_unit_common_subscribe_callback_handler(AWS_IoT_Client *pCl
 	}
 }
 
+#define STREAM_TEST_PAYLOAD_LEN 65536
+
+static unsigned char streamRxBuf[STREAM_TEST_PAYLOAD_LEN + 64];
+static size_t streamNextOffset;
+static size_t streamTotalLen;
+static uint32_t streamChunkCount;
+static uint32_t streamFinalCount;
+static bool streamIsIntact;
+
+static void iot_tests_unit_common_stream_callback_handler(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
+														  IoT_Publish_Message_Params *params, size_t payloadOffset,
+														  size_t payloadLen, bool isFinal, void *pData) {
+	unsigned char *tmp = params->payload;
+	size_t i;
+
+	IOT_UNUSED(pData);
+
+	if(16 != topicNameLen || 0 != strncmp("limitTest/topic1", topicName, topicNameLen)
+	   || payloadOffset != streamNextOffset || (!isFinal && AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN != params->payloadLen)) {
+		streamIsIntact = false;
+	}
+	/* Like message handlers, chunk handlers run with yield locked out */
+	if(CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN != aws_iot_mqtt_get_client_state(pClient)) {
+		streamIsIntact = false;
+	}
+	for(i = 0; i < params->payloadLen; i++) {
+		if(tmp[i] != (unsigned char) ((payloadOffset + i) % 251)) {
+			streamIsIntact = false;
+		}
+	}
+
+	streamNextOffset += params->payloadLen;
+	streamTotalLen = payloadLen;
+	streamChunkCount++;
+	if(isFinal) {
+		streamFinalCount++;
+		streamNextOffset = 0;
+	}
+}
+
+/* Writes a PUBLISH on limitTest/topic1 whose payload counts up modulo 251, returns its length */
+static size_t iot_tests_unit_common_build_publish(unsigned char *buf, QoS qos, size_t payloadLen) {
+	size_t cursor = 0, i;
+
+	buf[cursor++] = (unsigned char) (0x30 | ((qos << 1) & 0xF));
+	encodeRemainingLength(buf, &cursor, 2 + 16 + (QOS0 == qos ? 0 : 2) + payloadLen);
+	buf[cursor++] = 0;
+	buf[cursor++] = 16;
+	memcpy(&buf[cursor], "limitTest/topic1", 16);
+	cursor += 16;
+	if(QOS0 != qos) {
+		buf[cursor++] = 2;
+		buf[cursor++] = 3;
+	}
+	for(i = 0; i < payloadLen; i++) {
+		buf[cursor++] = (unsigned char) (i % 251);
+	}
+
+	return cursor;
+}
+
 TEST_GROUP_C_SETUP(CommonTests) {
 	ResetTLSBuffer();
 	InitMQTTParamsSetup(&initParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, NULL);
@@ -184,3 +246,46 @@ TEST_C(CommonTests, BigMQTTRxMessageReadNextMessage) {
 	CHECK_EQUAL_C_INT(rc, SUCCESS);
 	CHECK_EQUAL_C_STRING("XXX", cbBuffer);
 }
+
+/**
+ * A message many times the read buffer reaches a streaming subscription in
+ * order, chunk by chunk, and the message after it is read as usual.
+ */
+TEST_C(CommonTests, BigMQTTRxMessageStreamed) {
+	IoT_Error_t rc = FAILURE;
+	size_t len;
+
+	IOT_DEBUG("\n-->Running CommonTests - Stream Large Incoming Message \n");
+
+	setTLSRxBufferForSuback("limitTest/topic1", 16, QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe_stream(&iotClient, "limitTest/topic1", 16, QOS1,
+									   iot_tests_unit_common_stream_callback_handler, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	len = iot_tests_unit_common_build_publish(streamRxBuf, QOS1, STREAM_TEST_PAYLOAD_LEN);
+	len += iot_tests_unit_common_build_publish(&streamRxBuf[len], QOS0, 3);
+
+	ResetTLSBuffer();
+	RxBuffer.pBuffer = streamRxBuf;
+	RxBuffer.BufMaxSize = sizeof(streamRxBuf);
+	RxBuffer.len = len;
+	RxBuffer.NoMsgFlag = false;
+
+	streamNextOffset = 0;
+	streamChunkCount = 0;
+	streamFinalCount = 0;
+	streamIsIntact = true;
+
+	rc = aws_iot_mqtt_yield(&iotClient, 1000);
+
+	RxBuffer.pBuffer = RxBuf;
+	RxBuffer.BufMaxSize = TLSMaxBufferSize;
+
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(1, streamIsIntact);
+	CHECK_EQUAL_C_INT(2, streamFinalCount);
+	CHECK_EQUAL_C_INT(STREAM_TEST_PAYLOAD_LEN / AWS_IOT_MQTT_RX_STREAM_CHUNK_LEN + 1, streamChunkCount);
+	/* The small message last */
+	CHECK_EQUAL_C_INT(3, streamTotalLen);
+	CHECK_EQUAL_C_INT(1, isLastTLSTxMessagePuback());
+}
@@ -46,3 +46,15 @@ TEST_GROUP_C_WRAPPER(PublishTests, publishQoS1Success10msDelayedPuback)
 TEST_GROUP_C_WRAPPER(PublishTests, publishQoS0NoPubackSuccess)
 /* E:10 - Publish with QoS1 send success, Puback received */
 TEST_GROUP_C_WRAPPER(PublishTests, publishQoS1Success)
+/* E:11 - Publishv with Null/empty segments or too many of them */
+TEST_GROUP_C_WRAPPER(PublishTests, publishvInvalidSegments)
+/* E:12 - Publishv QoS0 of a payload larger than the TX buffer */
+TEST_GROUP_C_WRAPPER(PublishTests, publishvQoS0LargerThanTxBuffer)
+/* E:13 - Publishv with QoS1 send success, Puback received */
+TEST_GROUP_C_WRAPPER(PublishTests, publishvQoS1Success)
+/* E:14 - Async publish with QoS1 completes when its Puback arrives */
+TEST_GROUP_C_WRAPPER(PublishTests, publishAsyncQoS1CompletesOnPuback)
+/* E:15 - Async publish with a full in-flight window */
+TEST_GROUP_C_WRAPPER(PublishTests, publishAsyncWindowFull)
+/* E:16 - Async publish without Puback is sent again with DUP, then times out */
+TEST_GROUP_C_WRAPPER(PublishTests, publishAsyncRetransmitsWithDup)
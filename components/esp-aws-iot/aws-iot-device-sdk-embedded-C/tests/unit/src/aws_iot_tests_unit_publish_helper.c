@@ -24,6 +24,7 @@
 
 #include "aws_iot_mqtt_client_interface.h"
 #include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
 #include "aws_iot_log.h"
 
 static IoT_Client_Init_Params initParams;
@@ -203,3 +204,207 @@ TEST_C(PublishTests, publishQoS1Success) {
 
 	IOT_DEBUG("-->Success - E:10 - Publish with QoS1 send success, Puback received \n");
 }
+
+/* E:11 - Publishv with Null/empty segments or too many of them */
+TEST_C(PublishTests, publishvInvalidSegments) {
+	IoT_Error_t rc = SUCCESS;
+	IoT_IOVec segments[AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS + 1];
+	size_t i;
+
+	IOT_DEBUG("-->Running Publish Tests - E:11 - Publishv with Null/empty segments or too many of them \n");
+
+	for(i = 0; i < AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS + 1; i++) {
+		segments[i].pBase = (const unsigned char *) cPayload;
+		segments[i].len = 1;
+	}
+
+	rc = aws_iot_mqtt_publishv(&iotClient, subTopic, subTopicLen, &testPubMsgParams, NULL, 1);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, rc);
+
+	segments[1].pBase = NULL;
+	rc = aws_iot_mqtt_publishv(&iotClient, subTopic, subTopicLen, &testPubMsgParams, segments, 2);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, rc);
+	segments[1].pBase = (const unsigned char *) cPayload;
+
+	rc = aws_iot_mqtt_publishv(&iotClient, subTopic, subTopicLen, &testPubMsgParams, segments,
+							   AWS_IOT_MQTT_MAX_PUBLISH_SEGMENTS + 1);
+	CHECK_EQUAL_C_INT(LIMIT_EXCEEDED_ERROR, rc);
+
+	IOT_DEBUG("-->Success - E:11 - Publishv with Null/empty segments or too many of them \n");
+}
+
+/* E:12 - Publishv QoS0 of a payload larger than the TX buffer */
+TEST_C(PublishTests, publishvQoS0LargerThanTxBuffer) {
+	IoT_Error_t rc = SUCCESS;
+	static unsigned char payload[3 * AWS_IOT_MQTT_TX_BUF_LEN];
+	IoT_IOVec segments[3];
+	size_t i;
+
+	IOT_DEBUG("-->Running Publish Tests - E:12 - Publishv QoS0 of a payload larger than the TX buffer \n");
+
+	for(i = 0; i < sizeof(payload); i++) {
+		payload[i] = (unsigned char) ('a' + i % 26);
+	}
+	for(i = 0; i < 3; i++) {
+		segments[i].pBase = &payload[i * AWS_IOT_MQTT_TX_BUF_LEN];
+		segments[i].len = AWS_IOT_MQTT_TX_BUF_LEN;
+	}
+
+	/* The same payload does not fit the TX buffer in one piece */
+	testPubMsgParams.qos = QOS0;
+	testPubMsgParams.payload = payload;
+	testPubMsgParams.payloadLen = sizeof(payload);
+	rc = aws_iot_mqtt_publish(&iotClient, subTopic, subTopicLen, &testPubMsgParams);
+	CHECK_EQUAL_C_INT(MQTT_TX_BUFFER_TOO_SHORT_ERROR, rc);
+
+	rc = aws_iot_mqtt_publishv(&iotClient, subTopic, subTopicLen, &testPubMsgParams, segments, 3);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(4, lastWritevSegmentCount);
+	CHECK_EQUAL_C_INT(subTopicLen, lastPublishMessageTopicLen);
+	CHECK_EQUAL_C_STRING(subTopic, LastPublishMessageTopic);
+	CHECK_EQUAL_C_INT(sizeof(payload), lastPublishMessagePayloadLen);
+	CHECK_C(0 == memcmp(payload, LastPublishMessagePayload, sizeof(payload)));
+
+	IOT_DEBUG("-->Success - E:12 - Publishv QoS0 of a payload larger than the TX buffer \n");
+}
+
+/* E:13 - Publishv with QoS1 send success, Puback received */
+TEST_C(PublishTests, publishvQoS1Success) {
+	IoT_Error_t rc = SUCCESS;
+	IoT_IOVec segments[2];
+
+	IOT_DEBUG("-->Running Publish Tests - E:13 - Publishv with QoS1 send success, Puback received \n");
+
+	segments[0].pBase = (const unsigned char *) "{\"batch\":";
+	segments[0].len = 9;
+	segments[1].pBase = (const unsigned char *) "[1,2,3]}";
+	segments[1].len = 8;
+
+	setTLSRxBufferForPuback();
+	rc = aws_iot_mqtt_publishv(&iotClient, subTopic, subTopicLen, &testPubMsgParams, segments, 2);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING("{\"batch\":[1,2,3]}", LastPublishMessagePayload);
+
+	IOT_DEBUG("-->Success - E:13 - Publishv with QoS1 send success, Puback received \n");
+}
+
+static uint16_t asyncCompletedId;
+static IoT_Error_t asyncCompletedStatus;
+static int asyncCompletedCount;
+
+static void asyncPublishComplete(AWS_IoT_Client *pClient, uint16_t packetId, IoT_Error_t status, void *pData) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(pData);
+	asyncCompletedId = packetId;
+	asyncCompletedStatus = status;
+	asyncCompletedCount++;
+}
+
+static void setTLSRxBufferForPubackWithId(uint16_t packetId) {
+	ResetTLSBuffer();
+	RxBuffer.pBuffer[0] = (unsigned char) (0x40);
+	RxBuffer.pBuffer[1] = (unsigned char) (0x02);
+	RxBuffer.pBuffer[2] = (unsigned char) (packetId >> 8);
+	RxBuffer.pBuffer[3] = (unsigned char) (packetId & 0xFF);
+	RxBuffer.len = 4;
+	RxBuffer.NoMsgFlag = false;
+}
+
+/* E:14 - Async publish with QoS1 completes when its Puback arrives */
+TEST_C(PublishTests, publishAsyncQoS1CompletesOnPuback) {
+	IoT_Error_t rc = SUCCESS;
+
+	IOT_DEBUG("-->Running Publish Tests - E:14 - Async publish with QoS1 completes when its Puback arrives \n");
+
+	asyncCompletedCount = 0;
+	rc = aws_iot_mqtt_publish_async(&iotClient, subTopic, subTopicLen, &testPubMsgParams, asyncPublishComplete, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING(cPayload, LastPublishMessagePayload);
+	CHECK_EQUAL_C_INT(0, asyncCompletedCount);
+
+	/* A PUBACK for another packet is not taken as this one's */
+	setTLSRxBufferForPubackWithId((uint16_t) (testPubMsgParams.id + 1));
+	rc = aws_iot_mqtt_yield(&iotClient, 10);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(0, asyncCompletedCount);
+
+	setTLSRxBufferForPubackWithId(testPubMsgParams.id);
+	rc = aws_iot_mqtt_yield(&iotClient, 10);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(1, asyncCompletedCount);
+	CHECK_EQUAL_C_INT(testPubMsgParams.id, asyncCompletedId);
+	CHECK_EQUAL_C_INT(SUCCESS, asyncCompletedStatus);
+
+	IOT_DEBUG("-->Success - E:14 - Async publish with QoS1 completes when its Puback arrives \n");
+}
+
+/* E:15 - Async publish with a full in-flight window */
+TEST_C(PublishTests, publishAsyncWindowFull) {
+	IoT_Error_t rc = SUCCESS;
+	uint16_t firstId = 0;
+	int i;
+
+	IOT_DEBUG("-->Running Publish Tests - E:15 - Async publish with a full in-flight window \n");
+
+	asyncCompletedCount = 0;
+	for(i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+		rc = aws_iot_mqtt_publish_async(&iotClient, subTopic, subTopicLen, &testPubMsgParams, asyncPublishComplete,
+										NULL);
+		CHECK_EQUAL_C_INT(SUCCESS, rc);
+		if(0 == i) {
+			firstId = testPubMsgParams.id;
+		}
+	}
+	rc = aws_iot_mqtt_publish_async(&iotClient, subTopic, subTopicLen, &testPubMsgParams, asyncPublishComplete, NULL);
+	CHECK_EQUAL_C_INT(LIMIT_EXCEEDED_ERROR, rc);
+
+	/* QoS0 does not take a place in the window */
+	testPubMsgParams.qos = QOS0;
+	rc = aws_iot_mqtt_publish_async(&iotClient, subTopic, subTopicLen, &testPubMsgParams, asyncPublishComplete, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	testPubMsgParams.qos = QOS1;
+
+	setTLSRxBufferForPubackWithId(firstId);
+	rc = aws_iot_mqtt_yield(&iotClient, 10);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(1, asyncCompletedCount);
+	CHECK_EQUAL_C_INT(firstId, asyncCompletedId);
+
+	rc = aws_iot_mqtt_publish_async(&iotClient, subTopic, subTopicLen, &testPubMsgParams, asyncPublishComplete, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	IOT_DEBUG("-->Success - E:15 - Async publish with a full in-flight window \n");
+}
+
+/* E:16 - Async publish without Puback is sent again with DUP, then times out */
+TEST_C(PublishTests, publishAsyncRetransmitsWithDup) {
+	IoT_Error_t rc = SUCCESS;
+	int retransmits = 0;
+	int i;
+
+	IOT_DEBUG("-->Running Publish Tests - E:16 - Async publish without Puback is sent again with DUP, then times out \n");
+
+	iotClient.clientData.commandTimeoutMs = 20;
+	asyncCompletedCount = 0;
+	rc = aws_iot_mqtt_publish_async(&iotClient, subTopic, subTopicLen, &testPubMsgParams, asyncPublishComplete, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(0, TxBuffer.pBuffer[0] & 0x08);
+
+	for(i = 0; i < 20 && 0 == asyncCompletedCount; i++) {
+		TxBuffer.pBuffer[0] = 0;
+		rc = aws_iot_mqtt_yield(&iotClient, 25);
+		CHECK_EQUAL_C_INT(SUCCESS, rc);
+		if(0 != TxBuffer.pBuffer[0]) {
+			CHECK_EQUAL_C_INT(0x3A, TxBuffer.pBuffer[0]);
+			CHECK_EQUAL_C_STRING(cPayload, LastPublishMessagePayload);
+			retransmits++;
+		}
+	}
+
+	CHECK_EQUAL_C_INT(AWS_IOT_MQTT_PUBLISH_MAX_RETRIES, retransmits);
+	CHECK_EQUAL_C_INT(1, asyncCompletedCount);
+	CHECK_EQUAL_C_INT(testPubMsgParams.id, asyncCompletedId);
+	CHECK_EQUAL_C_INT(MQTT_REQUEST_TIMEOUT_ERROR, asyncCompletedStatus);
+
+	IOT_DEBUG("-->Success - E:16 - Async publish without Puback is sent again with DUP, then times out \n");
+}
@@ -77,3 +77,12 @@ TEST_GROUP_C_WRAPPER(SubscribeTests, subscribeTopicHashkeyMustBeTheLastFail)
 TEST_GROUP_C_WRAPPER(SubscribeTests, subscribeTopicWithPluskeySuccess)
 /* C:22 - Subscribe with '+' as last character in topic name, Success */
 TEST_GROUP_C_WRAPPER(SubscribeTests, subscribeTopicPluskeyComesLastSuccess)
+
+/* C:23 - Subscribe with '#', parent level matches too, '+' needs a level */
+TEST_GROUP_C_WRAPPER(SubscribeTests, subscribeTopicHashkeyMatchesParentLevel)
+/* C:24 - Subscribe with wildcard first level, no match for topics starting with '$' */
+TEST_GROUP_C_WRAPPER(SubscribeTests, subscribeTopicWildcardSkipsDollarTopics)
+/* C:25 - Subscribe, overlapping filters, each called once, unsubscribe leaves the others */
+TEST_GROUP_C_WRAPPER(SubscribeTests, subscribeOverlappingFiltersThenUnsubscribeOne)
+/* C:26 - Subscribe, filter with more levels than the index holds, still matched */
+TEST_GROUP_C_WRAPPER(SubscribeTests, subscribeFilterTooDeepForIndexSuccess)
@@ -604,3 +604,157 @@ TEST_C(SubscribeTests, subscribeTopicPluskeyComesLastSuccess) {
 
 	IOT_DEBUG("-->Success - C:22 - Subscribe with '+' as last character in topic name, Success \n");
 }
+
+/* C:23 - Subscribe with '#', parent level matches too, '+' needs a level */
+TEST_C(SubscribeTests, subscribeTopicHashkeyMatchesParentLevel) {
+	IoT_Error_t rc = SUCCESS;
+	char expectedCallbackString[100] = "New message: parent level";
+
+	IOT_DEBUG("-->Running Subscribe Tests - C:23 - Subscribe with '#', parent level matches too, '+' needs a level \n");
+
+	setTLSRxBufferForSuback("sdk/Test/#", strlen("sdk/Test/#"), QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "sdk/Test/#", strlen("sdk/Test/#"), QOS1,
+								iot_subscribe_callback_handler1, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	setTLSRxBufferForSuback("sdk/Test/+", strlen("sdk/Test/+"), QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "sdk/Test/+", strlen("sdk/Test/+"), QOS1,
+								iot_subscribe_callback_handler2, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic(subTopic, subTopicLen, QOS1, testPubMsgParams, expectedCallbackString);
+	snprintf(CallbackMsgString1, 100, "NOT_VISITED");
+	snprintf(CallbackMsgString2, 100, "NOT_VISITED");
+
+	rc = aws_iot_mqtt_yield(&iotClient, 1000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString1);
+	CHECK_EQUAL_C_STRING("NOT_VISITED", CallbackMsgString2);
+
+	IOT_DEBUG("-->Success - C:23 - Subscribe with '#', parent level matches too, '+' needs a level \n");
+}
+
+/* C:24 - Subscribe with wildcard first level, no match for topics starting with '$' */
+TEST_C(SubscribeTests, subscribeTopicWildcardSkipsDollarTopics) {
+	IoT_Error_t rc = SUCCESS;
+	char expectedCallbackString[100] = "New message: reserved topic";
+
+	IOT_DEBUG("-->Running Subscribe Tests - C:24 - Subscribe with wildcard first level, no match for topics starting with '$' \n");
+
+	setTLSRxBufferForSuback("#", strlen("#"), QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "#", strlen("#"), QOS1, iot_subscribe_callback_handler1, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	setTLSRxBufferForSuback("$aws/things/+/shadow", strlen("$aws/things/+/shadow"), QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "$aws/things/+/shadow", strlen("$aws/things/+/shadow"), QOS1,
+								iot_subscribe_callback_handler2, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic("$aws/things/hho/shadow", strlen("$aws/things/hho/shadow"), QOS1,
+										   testPubMsgParams, expectedCallbackString);
+	snprintf(CallbackMsgString1, 100, "NOT_VISITED");
+	snprintf(CallbackMsgString2, 100, "NOT_VISITED");
+
+	rc = aws_iot_mqtt_yield(&iotClient, 1000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING("NOT_VISITED", CallbackMsgString1);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString2);
+
+	IOT_DEBUG("-->Success - C:24 - Subscribe with wildcard first level, no match for topics starting with '$' \n");
+}
+
+/* C:25 - Subscribe, overlapping filters, each called once, unsubscribe leaves the others */
+TEST_C(SubscribeTests, subscribeOverlappingFiltersThenUnsubscribeOne) {
+	IoT_Error_t rc = SUCCESS;
+	char expectedCallbackString[100] = "New message: overlapping";
+
+	IOT_DEBUG("-->Running Subscribe Tests - C:25 - Subscribe, overlapping filters, each called once, unsubscribe leaves the others \n");
+
+	setTLSRxBufferForSuback("sdk/Test/a/b", strlen("sdk/Test/a/b"), QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "sdk/Test/a/b", strlen("sdk/Test/a/b"), QOS1,
+								iot_subscribe_callback_handler1, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	setTLSRxBufferForSuback("sdk/Test/+/b", strlen("sdk/Test/+/b"), QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "sdk/Test/+/b", strlen("sdk/Test/+/b"), QOS1,
+								iot_subscribe_callback_handler2, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	setTLSRxBufferForSuback("sdk/Test/a/#", strlen("sdk/Test/a/#"), QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "sdk/Test/a/#", strlen("sdk/Test/a/#"), QOS1,
+								iot_subscribe_callback_handler3, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic("sdk/Test/a/b", strlen("sdk/Test/a/b"), QOS1, testPubMsgParams,
+										   expectedCallbackString);
+	snprintf(CallbackMsgString1, 100, "NOT_VISITED");
+	snprintf(CallbackMsgString2, 100, "NOT_VISITED");
+	snprintf(CallbackMsgString3, 100, "NOT_VISITED");
+
+	rc = aws_iot_mqtt_yield(&iotClient, 1000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString1);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString2);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString3);
+
+	ResetTLSBuffer();
+	setTLSRxBufferForUnsuback();
+	rc = aws_iot_mqtt_unsubscribe(&iotClient, "sdk/Test/a/#", (uint16_t) strlen("sdk/Test/a/#"));
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic("sdk/Test/a/b", strlen("sdk/Test/a/b"), QOS1, testPubMsgParams,
+										   expectedCallbackString);
+	snprintf(CallbackMsgString1, 100, "NOT_VISITED");
+	snprintf(CallbackMsgString2, 100, "NOT_VISITED");
+	snprintf(CallbackMsgString3, 100, "NOT_VISITED");
+
+	rc = aws_iot_mqtt_yield(&iotClient, 1000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString1);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString2);
+	CHECK_EQUAL_C_STRING("NOT_VISITED", CallbackMsgString3);
+
+	IOT_DEBUG("-->Success - C:25 - Subscribe, overlapping filters, each called once, unsubscribe leaves the others \n");
+}
+
+/* C:26 - Subscribe, filter with more levels than the index holds, still matched */
+TEST_C(SubscribeTests, subscribeFilterTooDeepForIndexSuccess) {
+	IoT_Error_t rc = SUCCESS;
+	char expectedCallbackString[100] = "New message: deep topic";
+	static char deepTopic[3 * AWS_IOT_MQTT_TOPIC_INDEX_NODES];
+	size_t len = 0;
+	int level;
+
+	IOT_DEBUG("-->Running Subscribe Tests - C:26 - Subscribe, filter with more levels than the index holds, still matched \n");
+
+	for(level = 0; level < AWS_IOT_MQTT_TOPIC_INDEX_NODES; level++) {
+		len += snprintf(deepTopic + len, sizeof(deepTopic) - len, "%s%c", level ? "/" : "", 'a' + level % 26);
+	}
+
+	setTLSRxBufferForSuback(deepTopic, len, QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, deepTopic, (uint16_t) len, QOS1, iot_subscribe_callback_handler1, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic(deepTopic, len, QOS1, testPubMsgParams, expectedCallbackString);
+	snprintf(CallbackMsgString1, 100, "NOT_VISITED");
+
+	rc = aws_iot_mqtt_yield(&iotClient, 1000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString1);
+
+	// A shorter topic with the same first levels is not a match
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic(deepTopic, len - 2, QOS1, testPubMsgParams, expectedCallbackString);
+	snprintf(CallbackMsgString1, 100, "NOT_VISITED");
+
+	rc = aws_iot_mqtt_yield(&iotClient, 1000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING("NOT_VISITED", CallbackMsgString1);
+
+	IOT_DEBUG("-->Success - C:26 - Subscribe, filter with more levels than the index holds, still matched \n");
+}
@@ -55,3 +55,5 @@ TEST_GROUP_C_WRAPPER(YieldTests, resubscribeSuccessfulReconnect)
 
 /* G:13 - Delayed Ping response. */
 TEST_GROUP_C_WRAPPER(YieldTests, delayedPingResponse)
+/* G:14 - Time to next yield follows the keep-alive timers */
+TEST_GROUP_C_WRAPPER(YieldTests, nextYieldFollowsKeepAlive)
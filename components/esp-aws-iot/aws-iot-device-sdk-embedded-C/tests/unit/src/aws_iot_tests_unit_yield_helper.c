@@ -491,3 +491,30 @@ TEST_C(YieldTests, delayedPingResponse)
 
 	IOT_DEBUG("-->Success - G:13 - Delayed Ping response. \n");
 }
+
+/* G:14 - Time to next yield follows the keep-alive timers */
+TEST_C(YieldTests, nextYieldFollowsKeepAlive) {
+	IoT_Error_t rc = FAILURE;
+	uint32_t nextMs;
+	uint32_t keepAliveMs = iotClient.clientData.keepAliveInterval * 1000;
+
+	IOT_DEBUG("-->Running Yield Tests - G:14 - Time to next yield follows the keep-alive timers \n");
+
+	CHECK_EQUAL_C_INT(0, aws_iot_mqtt_get_next_yield_ms(NULL));
+
+	/* Just connected, the first ping request is a keep-alive interval away */
+	nextMs = aws_iot_mqtt_get_next_yield_ms(&iotClient);
+	CHECK_C(keepAliveMs - 1000 < nextMs && nextMs <= keepAliveMs);
+
+	sleep(iotClient.clientData.keepAliveInterval);
+	CHECK_EQUAL_C_INT(0, aws_iot_mqtt_get_next_yield_ms(&iotClient));
+	rc = aws_iot_mqtt_yield(&iotClient, 100);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(true, isLastTLSTxMessagePingreq());
+
+	/* Now waiting for the ping response */
+	nextMs = aws_iot_mqtt_get_next_yield_ms(&iotClient);
+	CHECK_C(keepAliveMs - 1000 < nextMs && nextMs <= keepAliveMs);
+
+	IOT_DEBUG("-->Success - G:14 - Time to next yield follows the keep-alive timers \n");
+}
@@ -27,6 +27,7 @@ IoT_Error_t iot_tls_init(Network *pNetwork, char *pRootCALocation, char *pDevice
 	pNetwork->connect = iot_tls_connect;
 	pNetwork->read = iot_tls_read;
 	pNetwork->write = iot_tls_write;
+	pNetwork->writev = iot_tls_writev;
 	pNetwork->disconnect = iot_tls_disconnect;
 	pNetwork->isConnected = iot_tls_is_connected;
 	pNetwork->destroy = iot_tls_destroy;
@@ -77,7 +78,7 @@ static size_t iot_tls_mqtt_read_variable_length_int(const unsigned char *buffer,
 	size_t pos = startPos;
 	size_t multiplier = 1;
 	do {
-		result = (buffer[pos] & 0x7f) * multiplier;
+		result += (buffer[pos] & 0x7f) * multiplier;
 		multiplier *= 0x80;
 		pos++;
 	} while ((buffer[pos - 1] & 0x80) && pos - startPos < 4);
@@ -156,7 +157,7 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
 			payloadStart += 2;
 		}
 
-		lastPublishMessagePayloadLen = mqttPacketLength - payloadStart + 2; /* + 2 as the first two bytes don't count towards the length */
+		lastPublishMessagePayloadLen = mqttPacketLength - payloadStart + variableHeaderStart; /* the fixed header doesn't count towards the length */
 		memcpy(LastPublishMessagePayload, TxBuffer.pBuffer + payloadStart, lastPublishMessagePayloadLen);
 		LastPublishMessagePayload[lastPublishMessagePayloadLen] = 0;
 	}
@@ -164,6 +165,25 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
 	return status;
 }
 
+IoT_Error_t iot_tls_writev(Network *pNetwork, const IoT_IOVec *pSegments, size_t segmentCount, Timer *timer,
+						   size_t *written_len) {
+	static unsigned char gathered[TLSMaxBufferSize];
+	size_t len = 0;
+	size_t i;
+
+	/* Record the segments as one write, so that the packet is parsed the same way */
+	for(i = 0; i < segmentCount; i++) {
+		if(len + pSegments[i].len > sizeof(gathered)) {
+			return NETWORK_SSL_WRITE_ERROR;
+		}
+		memcpy(gathered + len, pSegments[i].pBase, pSegments[i].len);
+		len += pSegments[i].len;
+	}
+	lastWritevSegmentCount = segmentCount;
+
+	return iot_tls_write(pNetwork, gathered, len, timer, written_len);
+}
+
 static unsigned char isTimerExpired(struct timeval target_time) {
 	unsigned char ret_val = 0;
 	struct timeval now, result;
@@ -195,8 +215,8 @@ IoT_Error_t iot_tls_read(Network *pNetwork, unsigned char *pMsg, size_t len, Tim
 		return status;
 	}
 
-	if(RxIndex > TLSMaxBufferSize - 1) {
-		RxIndex = TLSMaxBufferSize - 1;
+	if(RxIndex > RxBuffer.BufMaxSize - 1) {
+		RxIndex = RxBuffer.BufMaxSize - 1;
 	}
 
 	if(RxBuffer.len <= RxIndex || !isTimerExpired(RxBuffer.expiry_time)) {
@@ -34,6 +34,7 @@ char LastPublishMessageTopic[TLSMaxBufferSize];
 size_t lastPublishMessageTopicLen;
 char LastPublishMessagePayload[TLSMaxBufferSize];
 size_t lastPublishMessagePayloadLen;
+size_t lastWritevSegmentCount;
 
 TlsBuffer RxBuffer = {.pBuffer = RxBuf,.len = 512, .NoMsgFlag=1, .expiry_time = {0, 0}, .BufMaxSize = TLSMaxBufferSize, .mockedError = SUCCESS};
 TlsBuffer TxBuffer = {.pBuffer = TxBuf,.len = 512, .NoMsgFlag=1, .expiry_time = {0, 0}, .BufMaxSize = TLSMaxBufferSize, .mockedError = SUCCESS};
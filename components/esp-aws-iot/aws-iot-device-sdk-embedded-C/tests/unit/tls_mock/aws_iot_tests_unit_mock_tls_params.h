@@ -58,6 +58,7 @@ extern char LastPublishMessageTopic[TLSMaxBufferSize];
 extern size_t lastPublishMessageTopicLen;
 extern char LastPublishMessagePayload[TLSMaxBufferSize];
 extern size_t lastPublishMessagePayloadLen;
+extern size_t lastWritevSegmentCount;
 
 extern char hostAddress[512];
 extern uint16_t port;
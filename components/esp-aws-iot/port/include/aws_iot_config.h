@@ -40,6 +40,7 @@
 #define AWS_IOT_MQTT_TX_BUF_LEN CONFIG_AWS_IOT_MQTT_TX_BUF_LEN ///< Any time a message is sent out through the MQTT layer. The message is copied into this buffer anytime a publish is done. This will also be used in the case of Thing Shadow
 #define AWS_IOT_MQTT_RX_BUF_LEN CONFIG_AWS_IOT_MQTT_RX_BUF_LEN ///< Any message that comes into the device should be less than this buffer size. If a received message is bigger than this buffer size the message will be dropped.
 #define AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS CONFIG_AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS ///< Maximum number of topic filters the MQTT client can handle at any given time. This should be increased appropriately when using Thing Shadow
+#define AWS_IOT_MQTT_PUBLISH_WINDOW CONFIG_AWS_IOT_MQTT_PUBLISH_WINDOW ///< Maximum number of QoS 1 publishes of aws_iot_mqtt_publish_async waiting for their PUBACK
 
 // Thing Shadow specific configs
 #ifdef CONFIG_AWS_IOT_OVERRIDE_THING_SHADOW_RX_BUFFER
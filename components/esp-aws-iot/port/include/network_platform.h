@@ -33,28 +33,125 @@
 #include "mbedtls/debug.h"
 #include "mbedtls/timing.h"
 
+#include "timer_interface.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief TLS Connection Parameters
+ * Decrypted bytes the reader holds. The MQTT client reads a packet a few bytes
+ * at a time; this lets one mbedtls_ssl_read serve all the packets of a record.
+ */
+#ifndef IOT_SSL_READ_BUF_LEN
+#define IOT_SSL_READ_BUF_LEN 256
+#endif
+
+/**
+ * Packets written between iot_tls_cork and iot_tls_uncork are gathered here
+ * and sent as one record. Fits a PUBACK and a typical shadow update.
+ */
+#ifndef IOT_SSL_CORK_BUF_LEN
+#define IOT_SSL_CORK_BUF_LEN 1024
+#endif
+
+/**
+ * @brief Handshake counters
  *
- * Defines a type containing TLS specific parameters to be passed down to the
- * TLS networking layer to create a TLS secured socket.
+ * Kept across reconnects, to show how often the saved session is resumed and
+ * what it saves.
  */
-typedef struct _TLSDataParams {
+typedef struct {
+    uint32_t handshakes;          ///< Successful handshakes
+    uint32_t resumed;             ///< Of those, the ones that resumed the saved session
+    uint32_t lastHandshakeMs;     ///< Duration of the last handshake
+    uint32_t fullHandshakeMs;     ///< Total duration of the full handshakes
+    uint32_t resumedHandshakeMs;  ///< Total duration of the resumed handshakes
+} TLSHandshakeStats;
+
+/**
+ * @brief Credentials and SSL config shared by the connections of a Network
+ *
+ * Loaded by iot_tls_init, so that a reconnect only sets up a new SSL context
+ * and socket. Loaded again if the connect parameters they came from change.
+ */
+typedef struct {
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context ctr_drbg;
-    mbedtls_ssl_context ssl;
     mbedtls_ssl_config conf;
-    uint32_t flags;
     mbedtls_x509_crt cacert;
     mbedtls_x509_crt clicert;
     mbedtls_pk_context pkey;
+    const char *pRootCALocation;            ///< Connect parameters the credentials were loaded for
+    const char *pDeviceCertLocation;
+    const char *pDevicePrivateKeyLocation;
+    const char *pDestinationURL;            ///< A session is only offered to the server it came from
+    uint16_t DestinationPort;
+    bool ServerVerificationFlag;
+    bool ready;                             ///< The contexts above are initialized and loaded
+} TLSCredentials;
+
+/**
+ * @brief TLS Connection Parameters
+ *
+ * Defines a type containing TLS specific parameters to be passed down to the
+ * TLS networking layer to create a TLS secured socket.
+ */
+typedef struct _TLSDataParams {
+    TLSCredentials credentials;
+    mbedtls_ssl_context ssl;
+    uint32_t flags;
     mbedtls_net_context server_fd;
+    unsigned char rx_buf[IOT_SSL_READ_BUF_LEN];
+    size_t rx_head;
+    size_t rx_len;
+    uint32_t read_deadline_ticks; ///< Tick at which the deadline the read timeout was set for ends
+    unsigned char tx_buf[IOT_SSL_CORK_BUF_LEN];
+    size_t tx_len;
+    bool corked;
+    mbedtls_ssl_session session;  ///< Last negotiated session, offered on the next connect
+    bool has_session;
+    bool peer_cert_verified;      ///< Set when the handshake went through the server's certificate, i.e. was not resumed
+    TLSHandshakeStats handshake_stats;
 }TLSDataParams;
 
+/**
+ * @brief Socket of the TLS connection, to wait for it with select()
+ *
+ * @return The socket, -1 if not connected
+ */
+int iot_tls_get_socket(TLSDataParams *pTlsDataParams);
+
+/**
+ * @brief Number of bytes decrypted but not read yet
+ *
+ * select() does not see these, so check them before waiting on the socket.
+ */
+size_t iot_tls_get_bytes_avail(TLSDataParams *pTlsDataParams);
+
+/**
+ * @brief Frees the credentials iot_tls_init loaded
+ *
+ * iot_tls_destroy keeps them for the next connect. Should the Network connect
+ * again, they are loaded again; the saved session is kept.
+ */
+void iot_tls_free_credentials(TLSDataParams *pTlsDataParams);
+
+/**
+ * @brief Frees the credentials and the saved session, all that a Network keeps
+ * between connects
+ *
+ * Call this once the Network is not going to connect again. iot_tls_init
+ * starts over without looking at what was there, so a used Network is freed
+ * with this before it is initialized again.
+ */
+void iot_tls_free(TLSDataParams *pTlsDataParams);
+
+/**
+ * @brief Handshake durations and session resumption hits since iot_tls_init
+ */
+const TLSHandshakeStats *iot_tls_get_handshake_stats(TLSDataParams *pTlsDataParams);
+
 #define IOTSDKC_NETWORK_MBEDTLS_PLATFORM_H_H
 
 #ifdef __cplusplus
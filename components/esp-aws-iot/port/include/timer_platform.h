@@ -30,7 +30,6 @@ extern "C" {
 struct Timer {
     uint32_t start_ticks;
     uint32_t timeout_ticks;
-    uint32_t last_polled_ticks;
 };
 
 #ifdef __cplusplus
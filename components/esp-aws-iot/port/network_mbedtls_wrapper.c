@@ -36,6 +36,12 @@
 
 #include "esp_log.h"
 #include "esp_vfs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef CONFIG_AWS_IOT_TLS_SESSION_NVS
+#include "nvs.h"
+#endif
 
 static const char *TAG = "aws_iot";
 
@@ -49,7 +55,12 @@ static const char *TAG = "aws_iot";
  */
 static int _iot_tls_verify_cert(void *data, mbedtls_x509_crt *crt, int depth, uint32_t *flags) {
     char buf[256];
-    ((void) data);
+    TLSDataParams *tlsDataParams = (TLSDataParams *) data;
+
+    /* Only a full handshake has the server's certificate to verify */
+    if (depth == 0) {
+        tlsDataParams->peer_cert_verified = true;
+    }
 
     if (LOG_LOCAL_LEVEL >= ESP_LOG_DEBUG) {
         ESP_LOGD(TAG, "Verify requested for (Depth %d):", depth);
@@ -66,6 +77,158 @@ static int _iot_tls_verify_cert(void *data, mbedtls_x509_crt *crt, int depth, ui
     return 0;
 }
 
+#ifdef CONFIG_AWS_IOT_TLS_SESSION_NVS
+#define IOT_SSL_NVS_NAMESPACE "aws_iot_tls"
+#define IOT_SSL_NVS_SESSION_KEY "session"
+#define IOT_SSL_NVS_TICKET_KEY "ticket"
+#define IOT_SSL_NVS_SESSION_VERSION 1
+
+/*
+ * What resuming a session needs, as saved in NVS. mbedtls_ssl_session_save
+ * only came with mbedTLS 2.19. The server's certificate is left out: it was
+ * verified when the session was negotiated and is not sent again on resumption.
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t id_len;
+    uint8_t mfl_code;
+    uint8_t trunc_hmac;
+    uint8_t encrypt_then_mac;
+    int32_t ciphersuite;
+    int32_t compression;
+    uint32_t verify_result;
+    uint32_t ticket_lifetime;
+    int64_t start;
+    unsigned char id[32];
+    unsigned char master[48];
+} _iot_tls_saved_session;
+
+static void _iot_tls_load_session(TLSDataParams *tlsDataParams) {
+    mbedtls_ssl_session *session = &(tlsDataParams->session);
+    _iot_tls_saved_session saved;
+    size_t size = sizeof(saved);
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    if (nvs_open(IOT_SSL_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    err = nvs_get_blob(handle, IOT_SSL_NVS_SESSION_KEY, &saved, &size);
+    if (err != ESP_OK || size != sizeof(saved) || saved.version != IOT_SSL_NVS_SESSION_VERSION
+        || saved.id_len > sizeof(session->id)) {
+        nvs_close(handle);
+        return;
+    }
+
+    mbedtls_ssl_session_free(session);
+    session->ciphersuite = saved.ciphersuite;
+    session->compression = saved.compression;
+    session->id_len = saved.id_len;
+    memcpy(session->id, saved.id, sizeof(session->id));
+    memcpy(session->master, saved.master, sizeof(session->master));
+    session->verify_result = saved.verify_result;
+#if defined(MBEDTLS_HAVE_TIME)
+    session->start = (mbedtls_time_t) saved.start;
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    session->mfl_code = saved.mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    session->trunc_hmac = saved.trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    session->encrypt_then_mac = saved.encrypt_then_mac;
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    if (nvs_get_blob(handle, IOT_SSL_NVS_TICKET_KEY, NULL, &size) == ESP_OK && size > 0
+        && (session->ticket = mbedtls_calloc(1, size)) != NULL) {
+        if (nvs_get_blob(handle, IOT_SSL_NVS_TICKET_KEY, session->ticket, &size) == ESP_OK) {
+            session->ticket_len = size;
+            session->ticket_lifetime = saved.ticket_lifetime;
+        } else {
+            mbedtls_free(session->ticket);
+            session->ticket = NULL;
+        }
+    }
+#endif
+    nvs_close(handle);
+
+    tlsDataParams->has_session = true;
+    ESP_LOGI(TAG, "Restored the TLS session from NVS");
+}
+
+static void _iot_tls_save_session(TLSDataParams *tlsDataParams) {
+    const mbedtls_ssl_session *session = &(tlsDataParams->session);
+    _iot_tls_saved_session saved;
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    memset(&saved, 0, sizeof(saved));
+    saved.version = IOT_SSL_NVS_SESSION_VERSION;
+    saved.ciphersuite = session->ciphersuite;
+    saved.compression = session->compression;
+    saved.id_len = session->id_len;
+    memcpy(saved.id, session->id, sizeof(saved.id));
+    memcpy(saved.master, session->master, sizeof(saved.master));
+    saved.verify_result = session->verify_result;
+#if defined(MBEDTLS_HAVE_TIME)
+    saved.start = (int64_t) session->start;
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    saved.mfl_code = session->mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    saved.trunc_hmac = session->trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    saved.encrypt_then_mac = session->encrypt_then_mac;
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    saved.ticket_lifetime = session->ticket_lifetime;
+#endif
+
+    err = nvs_open(IOT_SSL_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, IOT_SSL_NVS_SESSION_KEY, &saved, sizeof(saved));
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+        if (err == ESP_OK && session->ticket != NULL) {
+            err = nvs_set_blob(handle, IOT_SSL_NVS_TICKET_KEY, session->ticket, session->ticket_len);
+        } else if (err == ESP_OK) {
+            nvs_erase_key(handle, IOT_SSL_NVS_TICKET_KEY);
+        }
+#endif
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Could not save the TLS session: %s", esp_err_to_name(err));
+    }
+}
+
+static void _iot_tls_erase_session(void) {
+    nvs_handle_t handle;
+
+    if (nvs_open(IOT_SSL_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+}
+#endif
+
+/* Forgets the saved session, so that the next connect does a full handshake */
+static void _iot_tls_forget_session(TLSDataParams *tlsDataParams) {
+    mbedtls_ssl_session_free(&(tlsDataParams->session));
+    mbedtls_ssl_session_init(&(tlsDataParams->session));
+    tlsDataParams->has_session = false;
+#ifdef CONFIG_AWS_IOT_TLS_SESSION_NVS
+    _iot_tls_erase_session();
+#endif
+}
+
 static void _iot_tls_set_connect_params(Network *pNetwork, const char *pRootCALocation, const char *pDeviceCertLocation,
                                  const char *pDevicePrivateKeyLocation, const char *pDestinationURL,
                                  uint16_t destinationPort, uint32_t timeout_ms, bool ServerVerificationFlag) {
@@ -78,65 +241,43 @@ static void _iot_tls_set_connect_params(Network *pNetwork, const char *pRootCALo
     pNetwork->tlsConnectParams.ServerVerificationFlag = ServerVerificationFlag;
 }
 
-IoT_Error_t iot_tls_init(Network *pNetwork, const char *pRootCALocation, const char *pDeviceCertLocation,
-                         const char *pDevicePrivateKeyLocation, const char *pDestinationURL,
-                         uint16_t destinationPort, uint32_t timeout_ms, bool ServerVerificationFlag) {
-    _iot_tls_set_connect_params(pNetwork, pRootCALocation, pDeviceCertLocation, pDevicePrivateKeyLocation,
-                                pDestinationURL, destinationPort, timeout_ms, ServerVerificationFlag);
-
-    pNetwork->connect = iot_tls_connect;
-    pNetwork->read = iot_tls_read;
-    pNetwork->write = iot_tls_write;
-    pNetwork->disconnect = iot_tls_disconnect;
-    pNetwork->isConnected = iot_tls_is_connected;
-    pNetwork->destroy = iot_tls_destroy;
-
-    pNetwork->tlsDataParams.flags = 0;
-
-    return SUCCESS;
-}
-
-IoT_Error_t iot_tls_is_connected(Network *pNetwork) {
-    /* Use this to add implementation which can check for physical layer disconnect */
-    return NETWORK_PHYSICAL_LAYER_CONNECTED;
-}
-
-IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
+/*
+ * Loads what stays the same from one connection to the next: the seeded DRBG,
+ * the CA chain, the device certificate and key and the SSL config that holds
+ * them. On the ATECC608 the certificate is rebuilt from several I2C reads, so
+ * this is only done again once iot_tls_free_credentials threw it away.
+ */
+static IoT_Error_t _iot_tls_load_credentials(Network *pNetwork) {
     int ret = SUCCESS;
-    TLSDataParams *tlsDataParams = NULL;
-    char portBuffer[6];
-    char info_buf[256];
-
-    if(NULL == pNetwork) {
-        return NULL_VALUE_ERROR;
-    }
-
-    if(NULL != params) {
-        _iot_tls_set_connect_params(pNetwork, params->pRootCALocation, params->pDeviceCertLocation,
-                                    params->pDevicePrivateKeyLocation, params->pDestinationURL,
-                                    params->DestinationPort, params->timeout_ms, params->ServerVerificationFlag);
-    }
+    TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
+    TLSCredentials *credentials = &(tlsDataParams->credentials);
 
-    tlsDataParams = &(pNetwork->tlsDataParams);
-
-    mbedtls_net_init(&(tlsDataParams->server_fd));
-    mbedtls_ssl_init(&(tlsDataParams->ssl));
-    mbedtls_ssl_config_init(&(tlsDataParams->conf));
+    mbedtls_ssl_config_init(&(credentials->conf));
 
 #ifdef CONFIG_MBEDTLS_DEBUG
-    mbedtls_esp_enable_debug_log(&(tlsDataParams->conf), 4);
+    mbedtls_esp_enable_debug_log(&(credentials->conf), 4);
 #endif
 
-    mbedtls_ctr_drbg_init(&(tlsDataParams->ctr_drbg));
-    mbedtls_x509_crt_init(&(tlsDataParams->cacert));
-    mbedtls_x509_crt_init(&(tlsDataParams->clicert));
-    mbedtls_pk_init(&(tlsDataParams->pkey));
+    mbedtls_ctr_drbg_init(&(credentials->ctr_drbg));
+    mbedtls_x509_crt_init(&(credentials->cacert));
+    mbedtls_x509_crt_init(&(credentials->clicert));
+    mbedtls_pk_init(&(credentials->pkey));
+
+    /* From here on a failure leaves everything initialized, for iot_tls_free_credentials */
+    credentials->ready = true;
+    credentials->pRootCALocation = pNetwork->tlsConnectParams.pRootCALocation;
+    credentials->pDeviceCertLocation = pNetwork->tlsConnectParams.pDeviceCertLocation;
+    credentials->pDevicePrivateKeyLocation = pNetwork->tlsConnectParams.pDevicePrivateKeyLocation;
+    credentials->pDestinationURL = pNetwork->tlsConnectParams.pDestinationURL;
+    credentials->DestinationPort = pNetwork->tlsConnectParams.DestinationPort;
+    credentials->ServerVerificationFlag = pNetwork->tlsConnectParams.ServerVerificationFlag;
 
     ESP_LOGD(TAG, "Seeding the random number generator...");
-    mbedtls_entropy_init(&(tlsDataParams->entropy));
-    if((ret = mbedtls_ctr_drbg_seed(&(tlsDataParams->ctr_drbg), mbedtls_entropy_func, &(tlsDataParams->entropy),
+    mbedtls_entropy_init(&(credentials->entropy));
+    if((ret = mbedtls_ctr_drbg_seed(&(credentials->ctr_drbg), mbedtls_entropy_func, &(credentials->entropy),
                                     (const unsigned char *) TAG, strlen(TAG))) != 0) {
         ESP_LOGE(TAG, "failed! mbedtls_ctr_drbg_seed returned -0x%x", -ret);
+        iot_tls_free_credentials(tlsDataParams);
         return NETWORK_MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
     }
 
@@ -148,15 +289,16 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
        neither of which can start with a slash. */
     if (pNetwork->tlsConnectParams.pRootCALocation[0] == '/') {
         ESP_LOGD(TAG, "Loading CA root certificate from file ...");
-        ret = mbedtls_x509_crt_parse_file(&(tlsDataParams->cacert), pNetwork->tlsConnectParams.pRootCALocation);
+        ret = mbedtls_x509_crt_parse_file(&(credentials->cacert), pNetwork->tlsConnectParams.pRootCALocation);
     } else {
         ESP_LOGD(TAG, "Loading embedded CA root certificate ...");
-        ret = mbedtls_x509_crt_parse(&(tlsDataParams->cacert), (const unsigned char *)pNetwork->tlsConnectParams.pRootCALocation,
+        ret = mbedtls_x509_crt_parse(&(credentials->cacert), (const unsigned char *)pNetwork->tlsConnectParams.pRootCALocation,
                                  strlen(pNetwork->tlsConnectParams.pRootCALocation)+1);
     }
 
     if(ret < 0) {
         ESP_LOGE(TAG, "failed!  mbedtls_x509_crt_parse returned -0x%x while parsing root cert", -ret);
+        iot_tls_free_credentials(tlsDataParams);
         return NETWORK_X509_ROOT_CRT_PARSE_ERROR;
     }
     ESP_LOGD(TAG, "ok (%d skipped)", ret);
@@ -170,7 +312,7 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
 
         if (ret == 0) {            
             ESP_LOGI(TAG, "Attempting to use device certificate from ATECC608");
-            ret = atca_mbedtls_cert_add(&(tlsDataParams->clicert), cert_def);
+            ret = atca_mbedtls_cert_add(&(credentials->clicert), cert_def);
 
         } else {
             ESP_LOGE(TAG, "failed! could not load cert from ATECC608, tng_get_device_cert_def returned %02x", ret);
@@ -179,16 +321,17 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
 #endif
     if (pNetwork->tlsConnectParams.pDeviceCertLocation[0] == '/') {
         ESP_LOGD(TAG, "Loading client cert from file...");
-        ret = mbedtls_x509_crt_parse_file(&(tlsDataParams->clicert),
+        ret = mbedtls_x509_crt_parse_file(&(credentials->clicert),
                                           pNetwork->tlsConnectParams.pDeviceCertLocation);
     } else {
         ESP_LOGD(TAG, "Loading embedded client certificate...");
-        ret = mbedtls_x509_crt_parse(&(tlsDataParams->clicert),
+        ret = mbedtls_x509_crt_parse(&(credentials->clicert),
                                      (const unsigned char *)pNetwork->tlsConnectParams.pDeviceCertLocation,
                                      strlen(pNetwork->tlsConnectParams.pDeviceCertLocation)+1);
     }
     if(ret != 0) {
         ESP_LOGE(TAG, "failed!  mbedtls_x509_crt_parse returned -0x%x while parsing device cert", -ret);
+        iot_tls_free_credentials(tlsDataParams);
         return NETWORK_X509_DEVICE_CRT_PARSE_ERROR;
     }
 
@@ -201,7 +344,7 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
             ret = NETWORK_PK_PRIVATE_KEY_PARSE_ERROR;
         } else {
             ESP_LOGD(TAG, "Using ATECC608 key from slot %d", slot_id);
-            ret = atca_mbedtls_pk_init(&(tlsDataParams->pkey), slot_id);
+            ret = atca_mbedtls_pk_init(&(credentials->pkey), slot_id);
             if (ret != 0) {
                 ESP_LOGE(TAG, "failed !  atca_mbedtls_pk_init returned %02x", ret);
             }
@@ -210,82 +353,183 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
 #endif
     if (pNetwork->tlsConnectParams.pDevicePrivateKeyLocation[0] == '/') {
         ESP_LOGD(TAG, "Loading client private key from file...");
-        ret = mbedtls_pk_parse_keyfile(&(tlsDataParams->pkey),
+        ret = mbedtls_pk_parse_keyfile(&(credentials->pkey),
                                        pNetwork->tlsConnectParams.pDevicePrivateKeyLocation,
                                        "");
     } else {
         ESP_LOGD(TAG, "Loading embedded client private key...");
-        ret = mbedtls_pk_parse_key(&(tlsDataParams->pkey),
+        ret = mbedtls_pk_parse_key(&(credentials->pkey),
                                    (const unsigned char *)pNetwork->tlsConnectParams.pDevicePrivateKeyLocation,
                                    strlen(pNetwork->tlsConnectParams.pDevicePrivateKeyLocation)+1,
                                    (const unsigned char *)"", 0);
     }
     if(ret != 0) {
         ESP_LOGE(TAG, "failed!  mbedtls_pk_parse_key returned -0x%x while parsing private key", -ret);
+        iot_tls_free_credentials(tlsDataParams);
         return NETWORK_PK_PRIVATE_KEY_PARSE_ERROR;
     }
 
-    /* Done parsing certs */
-    ESP_LOGD(TAG, "ok");
-    snprintf(portBuffer, 6, "%d", pNetwork->tlsConnectParams.DestinationPort);
-    ESP_LOGD(TAG, "Connecting to %s/%s...", pNetwork->tlsConnectParams.pDestinationURL, portBuffer);
-    if((ret = mbedtls_net_connect(&(tlsDataParams->server_fd), pNetwork->tlsConnectParams.pDestinationURL,
-                                  portBuffer, MBEDTLS_NET_PROTO_TCP)) != 0) {
-        ESP_LOGE(TAG, "failed! mbedtls_net_connect returned -0x%x", -ret);
-        switch(ret) {
-            case MBEDTLS_ERR_NET_SOCKET_FAILED:
-                return NETWORK_ERR_NET_SOCKET_FAILED;
-            case MBEDTLS_ERR_NET_UNKNOWN_HOST:
-                return NETWORK_ERR_NET_UNKNOWN_HOST;
-            case MBEDTLS_ERR_NET_CONNECT_FAILED:
-            default:
-                return NETWORK_ERR_NET_CONNECT_FAILED;
-        };
-    }
-
-    ret = mbedtls_net_set_block(&(tlsDataParams->server_fd));
-    if(ret != 0) {
-        ESP_LOGE(TAG, "failed! net_set_(non)block() returned -0x%x", -ret);
-        return SSL_CONNECTION_ERROR;
-    } ESP_LOGD(TAG, "ok");
-
     ESP_LOGD(TAG, "Setting up the SSL/TLS structure...");
-    if((ret = mbedtls_ssl_config_defaults(&(tlsDataParams->conf), MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+    if((ret = mbedtls_ssl_config_defaults(&(credentials->conf), MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
                                           MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
         ESP_LOGE(TAG, "failed! mbedtls_ssl_config_defaults returned -0x%x", -ret);
+        iot_tls_free_credentials(tlsDataParams);
         return SSL_CONNECTION_ERROR;
     }
 
-    mbedtls_ssl_conf_verify(&(tlsDataParams->conf), _iot_tls_verify_cert, NULL);
+    mbedtls_ssl_conf_verify(&(credentials->conf), _iot_tls_verify_cert, tlsDataParams);
 
     if(pNetwork->tlsConnectParams.ServerVerificationFlag == true) {
-        mbedtls_ssl_conf_authmode(&(tlsDataParams->conf), MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_authmode(&(credentials->conf), MBEDTLS_SSL_VERIFY_REQUIRED);
     } else {
-        mbedtls_ssl_conf_authmode(&(tlsDataParams->conf), MBEDTLS_SSL_VERIFY_OPTIONAL);
+        mbedtls_ssl_conf_authmode(&(credentials->conf), MBEDTLS_SSL_VERIFY_OPTIONAL);
     }
-    mbedtls_ssl_conf_rng(&(tlsDataParams->conf), mbedtls_ctr_drbg_random, &(tlsDataParams->ctr_drbg));
+    mbedtls_ssl_conf_rng(&(credentials->conf), mbedtls_ctr_drbg_random, &(credentials->ctr_drbg));
 
-    mbedtls_ssl_conf_ca_chain(&(tlsDataParams->conf), &(tlsDataParams->cacert), NULL);
-    ret = mbedtls_ssl_conf_own_cert(&(tlsDataParams->conf), &(tlsDataParams->clicert), &(tlsDataParams->pkey));
+    mbedtls_ssl_conf_ca_chain(&(credentials->conf), &(credentials->cacert), NULL);
+    ret = mbedtls_ssl_conf_own_cert(&(credentials->conf), &(credentials->clicert), &(credentials->pkey));
     if(ret != 0) {
         ESP_LOGE(TAG, "failed! mbedtls_ssl_conf_own_cert returned %d", ret);
+        iot_tls_free_credentials(tlsDataParams);
         return SSL_CONNECTION_ERROR;
     }
 
-    mbedtls_ssl_conf_read_timeout(&(tlsDataParams->conf), pNetwork->tlsConnectParams.timeout_ms);
-
 #ifdef CONFIG_MBEDTLS_SSL_ALPN
     /* Use the AWS IoT ALPN extension for MQTT, if port 443 is requested */
     if (pNetwork->tlsConnectParams.DestinationPort == 443) {
-        const char *alpnProtocols[] = { "x-amzn-mqtt-ca", NULL };
-        if ((ret = mbedtls_ssl_conf_alpn_protocols(&(tlsDataParams->conf), alpnProtocols)) != 0) {
+        /* The config keeps a pointer to the list */
+        static const char *alpnProtocols[] = { "x-amzn-mqtt-ca", NULL };
+        if ((ret = mbedtls_ssl_conf_alpn_protocols(&(credentials->conf), alpnProtocols)) != 0) {
             ESP_LOGE(TAG, "failed! mbedtls_ssl_conf_alpn_protocols returned -0x%x", -ret);
+            iot_tls_free_credentials(tlsDataParams);
             return SSL_CONNECTION_ERROR;
         }
     }
 #endif
 
-    if((ret = mbedtls_ssl_setup(&(tlsDataParams->ssl), &(tlsDataParams->conf))) != 0) {
+    /* Done parsing certs */
+    ESP_LOGD(TAG, "ok");
+    return SUCCESS;
+}
+
+/* Whether the credentials were loaded for the connect parameters as they are now */
+static bool _iot_tls_credentials_match(Network *pNetwork) {
+    const TLSCredentials *credentials = &(pNetwork->tlsDataParams.credentials);
+
+    return credentials->pRootCALocation == pNetwork->tlsConnectParams.pRootCALocation
+        && credentials->pDeviceCertLocation == pNetwork->tlsConnectParams.pDeviceCertLocation
+        && credentials->pDevicePrivateKeyLocation == pNetwork->tlsConnectParams.pDevicePrivateKeyLocation
+        && credentials->pDestinationURL == pNetwork->tlsConnectParams.pDestinationURL
+        && credentials->DestinationPort == pNetwork->tlsConnectParams.DestinationPort
+        && credentials->ServerVerificationFlag == pNetwork->tlsConnectParams.ServerVerificationFlag;
+}
+
+IoT_Error_t iot_tls_init(Network *pNetwork, const char *pRootCALocation, const char *pDeviceCertLocation,
+                         const char *pDevicePrivateKeyLocation, const char *pDestinationURL,
+                         uint16_t destinationPort, uint32_t timeout_ms, bool ServerVerificationFlag) {
+    IoT_Error_t ret;
+
+    _iot_tls_set_connect_params(pNetwork, pRootCALocation, pDeviceCertLocation, pDevicePrivateKeyLocation,
+                                pDestinationURL, destinationPort, timeout_ms, ServerVerificationFlag);
+
+    pNetwork->connect = iot_tls_connect;
+    pNetwork->read = iot_tls_read;
+    pNetwork->write = iot_tls_write;
+    pNetwork->writev = iot_tls_writev;
+    pNetwork->cork = iot_tls_cork;
+    pNetwork->uncork = iot_tls_uncork;
+    pNetwork->disconnect = iot_tls_disconnect;
+    pNetwork->isConnected = iot_tls_is_connected;
+    pNetwork->destroy = iot_tls_destroy;
+
+    pNetwork->tlsDataParams.flags = 0;
+    mbedtls_ssl_session_init(&(pNetwork->tlsDataParams.session));
+    pNetwork->tlsDataParams.has_session = false;
+    memset(&(pNetwork->tlsDataParams.handshake_stats), 0, sizeof(pNetwork->tlsDataParams.handshake_stats));
+    pNetwork->tlsDataParams.credentials.ready = false;
+
+    /* Should this fail, the first connect tries again and reports it */
+    ret = _iot_tls_load_credentials(pNetwork);
+    if (ret != SUCCESS) {
+        ESP_LOGW(TAG, "Could not load the credentials (%d), the first connect tries again", ret);
+    }
+    return SUCCESS;
+}
+
+IoT_Error_t iot_tls_is_connected(Network *pNetwork) {
+    /* Use this to add implementation which can check for physical layer disconnect */
+    return NETWORK_PHYSICAL_LAYER_CONNECTED;
+}
+
+IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
+    int ret = SUCCESS;
+    TLSDataParams *tlsDataParams = NULL;
+    char portBuffer[6];
+    char info_buf[256];
+    TickType_t handshakeStart;
+    uint32_t handshakeMs;
+    bool resumed;
+
+    if(NULL == pNetwork) {
+        return NULL_VALUE_ERROR;
+    }
+
+    if(NULL != params) {
+        _iot_tls_set_connect_params(pNetwork, params->pRootCALocation, params->pDeviceCertLocation,
+                                    params->pDevicePrivateKeyLocation, params->pDestinationURL,
+                                    params->DestinationPort, params->timeout_ms, params->ServerVerificationFlag);
+    }
+
+    tlsDataParams = &(pNetwork->tlsDataParams);
+
+    if(tlsDataParams->credentials.ready && !_iot_tls_credentials_match(pNetwork)) {
+        /* The saved session belongs to the old identity */
+        ESP_LOGI(TAG, "Connect parameters changed, reloading the credentials");
+        iot_tls_free_credentials(tlsDataParams);
+        if(tlsDataParams->has_session) {
+            _iot_tls_forget_session(tlsDataParams);
+        }
+    }
+    if(!tlsDataParams->credentials.ready) {
+        ret = _iot_tls_load_credentials(pNetwork);
+        if(ret != SUCCESS) {
+            return (IoT_Error_t) ret;
+        }
+    }
+
+    mbedtls_net_init(&(tlsDataParams->server_fd));
+    mbedtls_ssl_init(&(tlsDataParams->ssl));
+
+    snprintf(portBuffer, 6, "%d", pNetwork->tlsConnectParams.DestinationPort);
+    ESP_LOGD(TAG, "Connecting to %s/%s...", pNetwork->tlsConnectParams.pDestinationURL, portBuffer);
+    if((ret = mbedtls_net_connect(&(tlsDataParams->server_fd), pNetwork->tlsConnectParams.pDestinationURL,
+                                  portBuffer, MBEDTLS_NET_PROTO_TCP)) != 0) {
+        ESP_LOGE(TAG, "failed! mbedtls_net_connect returned -0x%x", -ret);
+        switch(ret) {
+            case MBEDTLS_ERR_NET_SOCKET_FAILED:
+                return NETWORK_ERR_NET_SOCKET_FAILED;
+            case MBEDTLS_ERR_NET_UNKNOWN_HOST:
+                return NETWORK_ERR_NET_UNKNOWN_HOST;
+            case MBEDTLS_ERR_NET_CONNECT_FAILED:
+            default:
+                return NETWORK_ERR_NET_CONNECT_FAILED;
+        };
+    }
+
+    ret = mbedtls_net_set_block(&(tlsDataParams->server_fd));
+    if(ret != 0) {
+        ESP_LOGE(TAG, "failed! net_set_(non)block() returned -0x%x", -ret);
+        return SSL_CONNECTION_ERROR;
+    } ESP_LOGD(TAG, "ok");
+
+    mbedtls_ssl_conf_read_timeout(&(tlsDataParams->credentials.conf), pNetwork->tlsConnectParams.timeout_ms);
+    tlsDataParams->read_deadline_ticks = 0;
+    tlsDataParams->rx_head = 0;
+    tlsDataParams->rx_len = 0;
+    tlsDataParams->tx_len = 0;
+    tlsDataParams->corked = false;
+
+    if((ret = mbedtls_ssl_setup(&(tlsDataParams->ssl), &(tlsDataParams->credentials.conf))) != 0) {
         ESP_LOGE(TAG, "failed! mbedtls_ssl_setup returned -0x%x", -ret);
         return SSL_CONNECTION_ERROR;
     }
@@ -298,18 +542,49 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
                         mbedtls_net_recv_timeout);
     ESP_LOGD(TAG, "ok");
 
+#ifdef CONFIG_AWS_IOT_TLS_SESSION_NVS
+    if(!tlsDataParams->has_session) {
+        _iot_tls_load_session(tlsDataParams);
+    }
+#endif
+    /* Offer the last session; the server falls back to a full handshake if it no longer knows it */
+    if(tlsDataParams->has_session) {
+        if((ret = mbedtls_ssl_set_session(&(tlsDataParams->ssl), &(tlsDataParams->session))) != 0) {
+            ESP_LOGW(TAG, "mbedtls_ssl_set_session returned -0x%x, doing a full handshake", -ret);
+            _iot_tls_forget_session(tlsDataParams);
+        }
+    }
+
     ESP_LOGD(TAG, "SSL state connect : %d ", tlsDataParams->ssl.state);
     ESP_LOGD(TAG, "Performing the SSL/TLS handshake...");
+    tlsDataParams->peer_cert_verified = false;
+    handshakeStart = xTaskGetTickCount();
     while((ret = mbedtls_ssl_handshake(&(tlsDataParams->ssl))) != 0) {
         if(ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
             ESP_LOGE(TAG, "failed! mbedtls_ssl_handshake returned -0x%x", -ret);
             if(ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) {
                 ESP_LOGE(TAG, "    Unable to verify the server's certificate. ");
             }
+            /* Should the saved session be what the server objects to, the next attempt goes without it */
+            if(tlsDataParams->has_session) {
+                _iot_tls_forget_session(tlsDataParams);
+            }
             return SSL_CONNECTION_ERROR;
         }
     }
 
+    handshakeMs = (xTaskGetTickCount() - handshakeStart) * portTICK_PERIOD_MS;
+    resumed = tlsDataParams->has_session && !tlsDataParams->peer_cert_verified;
+    tlsDataParams->handshake_stats.handshakes++;
+    tlsDataParams->handshake_stats.lastHandshakeMs = handshakeMs;
+    if(resumed) {
+        tlsDataParams->handshake_stats.resumed++;
+        tlsDataParams->handshake_stats.resumedHandshakeMs += handshakeMs;
+    } else {
+        tlsDataParams->handshake_stats.fullHandshakeMs += handshakeMs;
+    }
+    ESP_LOGI(TAG, "%s handshake took %u ms", resumed ? "Resumed" : "Full", handshakeMs);
+
     ESP_LOGD(TAG, "ok    [ Protocol is %s ]    [ Ciphersuite is %s ]", mbedtls_ssl_get_version(&(tlsDataParams->ssl)),
           mbedtls_ssl_get_ciphersuite(&(tlsDataParams->ssl)));
     if((ret = mbedtls_ssl_get_record_expansion(&(tlsDataParams->ssl))) >= 0) {
@@ -343,14 +618,34 @@ IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
         }
     }
 
+    if(ret == SUCCESS) {
+        /* Also picks up a new ticket the server may have sent with a resumed handshake */
+        if(mbedtls_ssl_get_session(&(tlsDataParams->ssl), &(tlsDataParams->session)) == 0) {
+            tlsDataParams->has_session = true;
+#ifdef CONFIG_AWS_IOT_TLS_SESSION_NVS
+            /* Flash is only written for a new session, not for every reconnect */
+            if(!resumed) {
+                _iot_tls_save_session(tlsDataParams);
+            }
+#endif
+        } else {
+            _iot_tls_forget_session(tlsDataParams);
+        }
+    } else if(tlsDataParams->has_session) {
+        _iot_tls_forget_session(tlsDataParams);
+    }
+
     return (IoT_Error_t) ret;
 }
 
-IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Timer *timer, size_t *written_len) {
+/* Each mbedtls_ssl_write sends at most one record */
+static IoT_Error_t _iot_tls_send(Network *pNetwork, const unsigned char *pMsg, size_t len, Timer *timer,
+                                 size_t *written_len) {
     size_t written_so_far;
     bool isErrorFlag = false;
     int frags, ret = 0;
     TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
+    int expansion = mbedtls_ssl_get_record_expansion(&(tlsDataParams->ssl));
 
     for(written_so_far = 0, frags = 0;
         written_so_far < len && !has_timer_expired(timer); written_so_far += ret, frags++) {
@@ -367,6 +662,10 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
         if(isErrorFlag) {
             break;
         }
+        if(ret > 0) {
+            pNetwork->stats.records++;
+            pNetwork->stats.wireBytes += ret + MAX(expansion, 0);
+        }
     }
 
     *written_len = written_so_far;
@@ -380,43 +679,188 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
     return SUCCESS;
 }
 
+/* Sends what the cork buffer holds. What a failed write left unsent is dropped with the connection. */
+static IoT_Error_t _iot_tls_flush(Network *pNetwork, Timer *timer) {
+    TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
+    size_t written;
+    IoT_Error_t rc = SUCCESS;
+
+    if(tlsDataParams->tx_len > 0) {
+        rc = _iot_tls_send(pNetwork, tlsDataParams->tx_buf, tlsDataParams->tx_len, timer, &written);
+        tlsDataParams->tx_len = 0;
+    }
+
+    return rc;
+}
+
+/* Adds a write to the cork buffer, sending what it holds first if the write does not fit */
+static IoT_Error_t _iot_tls_stage(Network *pNetwork, const unsigned char *pMsg, size_t len, Timer *timer,
+                                  size_t *written_len) {
+    TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
+    IoT_Error_t rc;
+
+    *written_len = 0;
+    if(len > sizeof(tlsDataParams->tx_buf) - tlsDataParams->tx_len) {
+        rc = _iot_tls_flush(pNetwork, timer);
+        if(SUCCESS != rc) {
+            return rc;
+        }
+    }
+
+    if(len > sizeof(tlsDataParams->tx_buf)) {
+        return _iot_tls_send(pNetwork, pMsg, len, timer, written_len);
+    }
+
+    memcpy(tlsDataParams->tx_buf + tlsDataParams->tx_len, pMsg, len);
+    tlsDataParams->tx_len += len;
+    *written_len = len;
+    return SUCCESS;
+}
+
+IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Timer *timer, size_t *written_len) {
+    pNetwork->stats.messages++;
+
+    if(pNetwork->tlsDataParams.corked) {
+        return _iot_tls_stage(pNetwork, pMsg, len, timer, written_len);
+    }
+
+    return _iot_tls_send(pNetwork, pMsg, len, timer, written_len);
+}
+
+/* Segments up to this long are gathered and written together, so that an MQTT
+ * header and a short payload do not each go out as their own TLS record. */
+#define IOT_SSL_WRITEV_GATHER_LEN 128
+
+IoT_Error_t iot_tls_writev(Network *pNetwork, const IoT_IOVec *pSegments, size_t segmentCount, Timer *timer,
+                           size_t *written_len) {
+    unsigned char gather[IOT_SSL_WRITEV_GATHER_LEN];
+    size_t gathered = 0;
+    size_t written = 0;
+    size_t segment_written;
+    size_t i;
+    IoT_Error_t rc = SUCCESS;
+
+    pNetwork->stats.messages++;
+
+    if(pNetwork->tlsDataParams.corked) {
+        for(i = 0; i < segmentCount && SUCCESS == rc; i++) {
+            rc = _iot_tls_stage(pNetwork, pSegments[i].pBase, pSegments[i].len, timer, &segment_written);
+            written += segment_written;
+        }
+
+        *written_len = written;
+        return rc;
+    }
+
+    for(i = 0; i < segmentCount && SUCCESS == rc; i++) {
+        const IoT_IOVec *pSegment = &pSegments[i];
+
+        if(pSegment->len > sizeof(gather) - gathered && gathered > 0) {
+            rc = _iot_tls_send(pNetwork, gather, gathered, timer, &segment_written);
+            written += segment_written;
+            gathered = 0;
+            if(SUCCESS != rc) {
+                break;
+            }
+        }
+
+        if(pSegment->len <= sizeof(gather) - gathered) {
+            memcpy(gather + gathered, pSegment->pBase, pSegment->len);
+            gathered += pSegment->len;
+        } else {
+            /* Long segments go straight to mbedtls_ssl_write, which encrypts them into its own record buffer */
+            rc = _iot_tls_send(pNetwork, pSegment->pBase, pSegment->len, timer, &segment_written);
+            written += segment_written;
+        }
+    }
+
+    if(SUCCESS == rc && gathered > 0) {
+        rc = _iot_tls_send(pNetwork, gather, gathered, timer, &segment_written);
+        written += segment_written;
+    }
+
+    *written_len = written;
+    return rc;
+}
+
+IoT_Error_t iot_tls_cork(Network *pNetwork) {
+    pNetwork->tlsDataParams.corked = true;
+    return SUCCESS;
+}
+
+IoT_Error_t iot_tls_uncork(Network *pNetwork, Timer *timer) {
+    pNetwork->tlsDataParams.corked = false;
+    return _iot_tls_flush(pNetwork, timer);
+}
+
+/*
+ * Make sure we never block on read for longer than the timer has left, but
+ * also that we don't block indefinitely (ie read_timeout > 0). The timeout is
+ * set again for a new deadline, or once the time left drops below it.
+ */
+static void _iot_tls_set_read_timeout(Network *pNetwork, Timer *timer) {
+    TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
+    mbedtls_ssl_config *conf = &(tlsDataParams->credentials.conf);
+    uint32_t deadline_ticks = timer->start_ticks + timer->timeout_ticks;
+    uint32_t timeout_ms = MAX(1, MIN(pNetwork->tlsConnectParams.timeout_ms, left_ms(timer)));
+
+    if (deadline_ticks != tlsDataParams->read_deadline_ticks || timeout_ms < conf->read_timeout) {
+        mbedtls_ssl_conf_read_timeout(conf, timeout_ms);
+        tlsDataParams->read_deadline_ticks = deadline_ticks;
+    }
+}
+
 IoT_Error_t iot_tls_read(Network *pNetwork, unsigned char *pMsg, size_t len, Timer *timer, size_t *read_len) {
     TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
     mbedtls_ssl_context *ssl = &(tlsDataParams->ssl);
-    mbedtls_ssl_config *ssl_conf = &(tlsDataParams->conf);
-    uint32_t read_timeout;
     size_t rxLen = 0;
+    size_t copyLen;
     int ret;
 
-    read_timeout = ssl_conf->read_timeout;
-
     while (len > 0) {
+        if (tlsDataParams->rx_len > 0) {
+            copyLen = MIN(len, tlsDataParams->rx_len);
+            memcpy(pMsg, tlsDataParams->rx_buf + tlsDataParams->rx_head, copyLen);
+            tlsDataParams->rx_head += copyLen;
+            tlsDataParams->rx_len -= copyLen;
+            rxLen += copyLen;
+            pMsg += copyLen;
+            len -= copyLen;
+            continue;
+        }
 
-        /* Make sure we never block on read for longer than timer has left,
-         but also that we don't block indefinitely (ie read_timeout > 0) */
-        mbedtls_ssl_conf_read_timeout(ssl_conf, MAX(1, MIN(read_timeout, left_ms(timer))));
-
-        ret = mbedtls_ssl_read(ssl, pMsg, len);
+        _iot_tls_set_read_timeout(pNetwork, timer);
 
-        /* Restore the old timeout */
-        mbedtls_ssl_conf_read_timeout(ssl_conf, read_timeout);
+        if (len >= sizeof(tlsDataParams->rx_buf)) {
+            /* Not worth the copy, the packet body goes straight to the caller */
+            ret = mbedtls_ssl_read(ssl, pMsg, len);
+            if (ret > 0) {
+                rxLen += ret;
+                pMsg += ret;
+                len -= ret;
+            }
+        } else {
+            /* Only refilled once drained, so the buffered bytes always start at rx_head */
+            ret = mbedtls_ssl_read(ssl, tlsDataParams->rx_buf, sizeof(tlsDataParams->rx_buf));
+            if (ret > 0) {
+                tlsDataParams->rx_head = 0;
+                tlsDataParams->rx_len = ret;
+            }
+        }
 
-        if (ret > 0) {
-            rxLen += ret;
-            pMsg += ret;
-            len -= ret;
-        } else if (ret == 0 || (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != MBEDTLS_ERR_SSL_TIMEOUT)) {
+        if (ret == 0 || (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != MBEDTLS_ERR_SSL_TIMEOUT)) {
             return NETWORK_SSL_READ_ERROR;
         }
 
         // Evaluate timeout after the read to make sure read is done at least once
-        if (has_timer_expired(timer)) {
+        if (has_timer_expired(timer) && tlsDataParams->rx_len == 0) {
             break;
         }
     }
 
+    // The client keeps what was read of a packet and reads the rest later
+    *read_len = rxLen;
     if (len == 0) {
-        *read_len = rxLen;
         return SUCCESS;
     }
 
@@ -440,18 +884,47 @@ IoT_Error_t iot_tls_disconnect(Network *pNetwork) {
     return SUCCESS;
 }
 
+/* The credentials and the saved session outlive the connection, for the next connect to reuse */
 IoT_Error_t iot_tls_destroy(Network *pNetwork) {
     TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
 
     mbedtls_net_free(&(tlsDataParams->server_fd));
-
-    mbedtls_x509_crt_free(&(tlsDataParams->clicert));
-    mbedtls_x509_crt_free(&(tlsDataParams->cacert));
-    mbedtls_pk_free(&(tlsDataParams->pkey));
     mbedtls_ssl_free(&(tlsDataParams->ssl));
-    mbedtls_ssl_config_free(&(tlsDataParams->conf));
-    mbedtls_ctr_drbg_free(&(tlsDataParams->ctr_drbg));
-    mbedtls_entropy_free(&(tlsDataParams->entropy));
 
     return SUCCESS;
 }
+
+void iot_tls_free_credentials(TLSDataParams *pTlsDataParams) {
+    TLSCredentials *credentials = &(pTlsDataParams->credentials);
+
+    if(!credentials->ready) {
+        return;
+    }
+
+    mbedtls_x509_crt_free(&(credentials->clicert));
+    mbedtls_x509_crt_free(&(credentials->cacert));
+    mbedtls_pk_free(&(credentials->pkey));
+    mbedtls_ssl_config_free(&(credentials->conf));
+    mbedtls_ctr_drbg_free(&(credentials->ctr_drbg));
+    mbedtls_entropy_free(&(credentials->entropy));
+    credentials->ready = false;
+}
+
+void iot_tls_free(TLSDataParams *pTlsDataParams) {
+    iot_tls_free_credentials(pTlsDataParams);
+    mbedtls_ssl_session_free(&(pTlsDataParams->session));
+    mbedtls_ssl_session_init(&(pTlsDataParams->session));
+    pTlsDataParams->has_session = false;
+}
+
+int iot_tls_get_socket(TLSDataParams *pTlsDataParams) {
+    return pTlsDataParams->server_fd.fd;
+}
+
+size_t iot_tls_get_bytes_avail(TLSDataParams *pTlsDataParams) {
+    return pTlsDataParams->rx_len + mbedtls_ssl_get_bytes_avail(&(pTlsDataParams->ssl));
+}
+
+const TLSHandshakeStats *iot_tls_get_handshake_stats(TLSDataParams *pTlsDataParams) {
+    return &(pTlsDataParams->handshake_stats);
+}
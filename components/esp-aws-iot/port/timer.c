@@ -34,25 +34,12 @@ const static char *TAG = "aws_timer";
 
 bool has_timer_expired(Timer *timer) {
     uint32_t now = xTaskGetTickCount();
-    bool expired = (now - timer->start_ticks) >= timer->timeout_ticks;
-
-    /* AWS IoT SDK isn't very RTOS friendly because it polls for "done
-       timers" a lot without ever sleeping on them. So we hack in some
-       amount of sleeping here: if it seems like the caller is polling
-       an unexpired timer in a tight loop then we delay a tick to let
-       things progress elsewhere.
-    */
-    if(!expired && now == timer->last_polled_ticks) {
-        vTaskDelay(1);
-    }
-    timer->last_polled_ticks = now;
-    return expired;
+    return (now - timer->start_ticks) >= timer->timeout_ticks;
 }
 
 void countdown_ms(Timer *timer, uint32_t timeout) {
     timer->start_ticks = xTaskGetTickCount();
     timer->timeout_ticks = timeout / portTICK_PERIOD_MS;
-    timer->last_polled_ticks = 0;
 }
 
 uint32_t left_ms(Timer *timer) {
@@ -75,7 +62,6 @@ void countdown_sec(Timer *timer, uint32_t timeout) {
 void init_timer(Timer *timer) {
     timer->start_ticks = 0;
     timer->timeout_ticks = 0;
-    timer->last_polled_ticks = 0;
 }
 
 #ifdef __cplusplus
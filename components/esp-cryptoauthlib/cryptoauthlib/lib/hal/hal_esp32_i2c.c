@@ -51,6 +51,8 @@ ATCA_STATUS hal_i2c_init(void *hal, ATCAIfaceCfg *cfg)
     if (i2c_device_bus == NULL) {
         return ATCA_COMM_FAIL;
     } else {
+        // TLS handshakes wait on the ATECC608; serve it before other devices on the bus.
+        i2c_device_set_priority(i2c_device_bus, I2C_PRIORITY_HIGH);
         return ATCA_SUCCESS;
     }
 }
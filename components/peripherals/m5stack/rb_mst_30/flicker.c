@@ -0,0 +1,145 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flicker.h"
+
+// Candidates tried around the FFT peak, in steps of a twentieth of a bin.
+#define REFINE_STEPS 10
+#define REFINE_STEP_BINS 0.05f
+
+static const flicker_readout_t steady = { 0 };
+
+bool Flicker_Init(flicker_analyzer_t *analyzer, int size) {
+    memset(analyzer, 0, sizeof(*analyzer));
+    analyzer->size = size;
+    analyzer->plan = fft_plan_acquire(size, FFT_REAL, FFT_FORWARD);
+    analyzer->window = malloc(size * sizeof(float));
+    analyzer->windowed = malloc(size * sizeof(float));
+    analyzer->spectrum = malloc(size * sizeof(float));
+    if (analyzer->plan == NULL || analyzer->window == NULL || analyzer->windowed == NULL
+            || analyzer->spectrum == NULL) {
+        Flicker_Free(analyzer);
+        return false;
+    }
+
+    for (int n = 0; n < size; n++) {
+        analyzer->window[n] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * n / size);
+        analyzer->window_sum += analyzer->window[n];
+    }
+    return true;
+}
+
+void Flicker_Free(flicker_analyzer_t *analyzer) {
+    if (analyzer->plan != NULL) {
+        fft_plan_release(analyzer->plan);
+    }
+    free(analyzer->window);
+    free(analyzer->windowed);
+    free(analyzer->spectrum);
+    analyzer->plan = NULL;
+    analyzer->window = analyzer->windowed = analyzer->spectrum = NULL;
+}
+
+static float power(const float *spectrum, int k) {
+    return spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+}
+
+// Averages the burst over one cycle of `cycles_per_sample`; returns the
+// number of points of the cycle that got samples.
+static int fold(const float *light, int size, float cycles_per_sample, float *cycle) {
+    float sums[FLICKER_FOLD_BINS] = { 0 };
+    int counts[FLICKER_FOLD_BINS] = { 0 };
+    float phase = 0;
+    for (int n = 0; n < size; n++) {
+        int bin = (int)(phase * FLICKER_FOLD_BINS);
+        sums[bin] += light[n];
+        counts[bin]++;
+        phase += cycles_per_sample;
+        phase -= floorf(phase);
+    }
+
+    int points = 0;
+    for (int b = 0; b < FLICKER_FOLD_BINS; b++) {
+        if (counts[b] > 0) {
+            cycle[points++] = sums[b] / counts[b];
+        }
+    }
+    return points;
+}
+
+static float variance(const float *values, int count) {
+    float sum = 0, square_sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += values[i];
+        square_sum += values[i] * values[i];
+    }
+    float mean = sum / count;
+    return square_sum / count - mean * mean;
+}
+
+flicker_readout_t Flicker_Analyze(flicker_analyzer_t *analyzer, const float *light, float sample_rate) {
+    int size = analyzer->size;
+    float mean = 0;
+    for (int n = 0; n < size; n++) {
+        mean += light[n];
+    }
+    mean /= size;
+    if (mean <= 0) {
+        return steady;
+    }
+
+    for (int n = 0; n < size; n++) {
+        analyzer->windowed[n] = (light[n] - mean) * analyzer->window[n];
+    }
+    fft_plan_execute(analyzer->plan, analyzer->windowed, analyzer->spectrum);
+
+    float bin_hz = sample_rate / size;
+    int first = (int)ceilf(FLICKER_MIN_HZ / bin_hz);
+    int peak = 0;
+    for (int k = first > 1 ? first : 1; k < size / 2; k++) {
+        if (peak == 0 || power(analyzer->spectrum, k) > power(analyzer->spectrum, peak)) {
+            peak = k;
+        }
+    }
+    float amplitude = 2.0f * sqrtf(power(analyzer->spectrum, peak)) / analyzer->window_sum;
+    if (peak == 0 || amplitude < FLICKER_MIN_MODULATION * mean) {
+        return steady;
+    }
+
+    // The FFT peak is a few tenths of a bin off; over a whole burst that is
+    // enough to smear the folded cycle, so keep the sharpest fold near it.
+    float cycle[FLICKER_FOLD_BINS];
+    float best_bins = peak;
+    float best_variance = -1;
+    for (int step = -REFINE_STEPS; step <= REFINE_STEPS; step++) {
+        float bins = peak + step * REFINE_STEP_BINS;
+        int points = fold(light, size, bins / size, cycle);
+        float v = variance(cycle, points);
+        if (v > best_variance) {
+            best_variance = v;
+            best_bins = bins;
+        }
+    }
+
+    int points = fold(light, size, best_bins / size, cycle);
+    float low = cycle[0], high = cycle[0], cycle_mean = 0;
+    for (int i = 0; i < points; i++) {
+        low = fminf(low, cycle[i]);
+        high = fmaxf(high, cycle[i]);
+        cycle_mean += cycle[i];
+    }
+    cycle_mean /= points;
+
+    float above = 0;
+    for (int i = 0; i < points; i++) {
+        above += fmaxf(cycle[i] - cycle_mean, 0);
+    }
+
+    flicker_readout_t result = {
+        .percent = (high + low > 0) ? 100.0f * (high - low) / (high + low) : 0,
+        .index = above / (cycle_mean * points),
+        .frequency_hz = best_bins * bin_hz,
+    };
+    return result;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file flicker.h
+ * @brief Flicker metrics of a burst of light samples: percent flicker,
+ * flicker index (IES) and the dominant flicker frequency.
+ *
+ * The dominant frequency is the strongest peak of a Hann windowed FFT above
+ * `FLICKER_MIN_HZ`, refined by folding the burst at nearby frequencies and
+ * keeping the one whose folded cycle varies most. The burst folded at that
+ * frequency averages out the ADC noise over every cycle it holds, and the
+ * metrics are taken from that averaged cycle:
+ *
+ *     percent flicker = 100 * (max - min) / (max + min)
+ *     flicker index   = area above the mean / total area
+ *
+ * Light that varies by less than `FLICKER_MIN_MODULATION` of its mean at
+ * the dominant frequency is steady and reads 0 on all three.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "fft.h"
+
+/** Lowest flicker frequency looked for; slower changes are not flicker. */
+#define FLICKER_MIN_HZ 20.0f
+
+/** Amplitude at the dominant frequency, as a fraction of the mean, below which light is steady. */
+#define FLICKER_MIN_MODULATION 0.005f
+
+/** Points of the averaged cycle. */
+#define FLICKER_FOLD_BINS 16
+
+typedef struct {
+    float percent;       // 0 (steady) to 100 (light goes fully off)
+    float index;         // 0 (steady) to 1
+    float frequency_hz;  // 0 for steady light
+} flicker_readout_t;
+
+typedef struct {
+    int size;
+    fft_plan_t *plan;
+    float *window;
+    float *windowed;
+    float *spectrum;
+    float window_sum;
+} flicker_analyzer_t;
+
+/**
+ * @brief Sets up the analysis of bursts of `size` samples, a power of two.
+ *
+ * @return false if the FFT plan or buffers cannot be allocated.
+ */
+bool Flicker_Init(flicker_analyzer_t *analyzer, int size);
+
+/** @brief Releases what `Flicker_Init` acquired. */
+void Flicker_Free(flicker_analyzer_t *analyzer);
+
+/**
+ * @brief Measures the flicker of a burst.
+ *
+ * @param light `size` samples of a quantity proportional to the light, e.g. lux.
+ * @param sample_rate the rate the burst was actually taken at, in Hz.
+ */
+flicker_readout_t Flicker_Analyze(flicker_analyzer_t *analyzer, const float *light, float sample_rate);
@@ -0,0 +1,16 @@
+#include <math.h>
+
+#include "photoresistor.h"
+
+float Photoresistor_MilliVoltsToLux(const photoresistor_curve_t *curve, uint32_t millivolts) {
+    if (millivolts >= curve->supply_millivolts) {
+        return 0;
+    }
+    if (millivolts == 0) {
+        return PHOTORESISTOR_MAX_LUX;
+    }
+
+    float ohms = (float)curve->series_ohms * millivolts / (curve->supply_millivolts - millivolts);
+    float lux = 10.0f * powf(curve->ohms_at_10_lux / ohms, 1.0f / curve->gamma);
+    return fminf(lux, PHOTORESISTOR_MAX_LUX);
+}
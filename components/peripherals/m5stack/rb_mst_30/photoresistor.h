@@ -0,0 +1,35 @@
+/**
+ * @file photoresistor.h
+ * @brief Conversion of a photoresistor voltage divider reading to lux.
+ *
+ * The photoresistor (LDR) sits on the low side of the divider, so the
+ * voltage rises as it gets darker:
+ *
+ *     V = Vsupply * R_ldr / (R_ldr + R_series)
+ *
+ * and its resistance follows the usual power law of illuminance:
+ *
+ *     R_ldr = R_10lux * (lux / 10) ^ -gamma
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/** Upper bound returned when the divider reads (close to) 0 mV. */
+#define PHOTORESISTOR_MAX_LUX 100000.0f
+
+/** Describes the divider and the photoresistor's response curve. */
+typedef struct {
+    uint32_t supply_millivolts;
+    uint32_t series_ohms;
+    uint32_t ohms_at_10_lux;
+    float gamma;
+} photoresistor_curve_t;
+
+/**
+ * @brief Converts the divider voltage to an illuminance.
+ *
+ * @return the illuminance in lux, between 0 (dark) and PHOTORESISTOR_MAX_LUX.
+ */
+float Photoresistor_MilliVoltsToLux(const photoresistor_curve_t *curve, uint32_t millivolts);
@@ -1,50 +1,141 @@
+#include <stdatomic.h>
+
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "core2forAWS.h"
-
-#define VIN 3300
+#include "photoresistor.h"
+#include "rb_mst_30.h"
 
 
-static const char *TAG = "M5S-RB-MST-30"; 
-static SemaphoreHandle_t thread_mutex; 
+static const char *TAG = "M5S-RB-MST-30";
 static uint32_t reportedIntensityMilliVolts;
 
+static const photoresistor_curve_t curve = {
+    .supply_millivolts = CONFIG_M5S_RBMST30_SUPPLY_MILLIVOLTS,
+    .series_ohms = CONFIG_M5S_RBMST30_SERIES_OHMS,
+    .ohms_at_10_lux = CONFIG_M5S_RBMST30_OHMS_AT_10_LUX,
+    .gamma = CONFIG_M5S_RBMST30_GAMMA_X100 / 100.0f,
+};
 
-void M5S_RBMST30_UpdateTask() {
-    esp_err_t err = Core2ForAWS_Port_PinMode(PORT_B_ADC_PIN, ADC);
+// Set while a flicker burst owns the ADC.
+static atomic_bool burstActive;
 
-    if (err != ESP_OK) {
-        ESP_LOGW(TAG, "Could not connect to Port B with ESP_ERROR: %d", err);
-    } else {
-        ESP_LOGI(TAG, "Successfully connected Light Sensor to Port B.");
+#if CONFIG_M5S_RBMST30_FLICKER
+#define FLICKER_BURST_SAMPLES 512
+
+// Written by the esp_timer callback while burstActive, read by
+// M5S_RBMST30_FlickerPoll once burstDone. No burst starts while burstDone.
+static uint16_t burstRaw[FLICKER_BURST_SAMPLES];
+static size_t burstCount;
+static int64_t burstStartUs;
+static int64_t burstEndUs;
+static atomic_bool burstDone;
+static esp_timer_handle_t burstTimer;
+
+// Only touched by M5S_RBMST30_FlickerPoll and the getter, on the same task.
+static float burstLux[FLICKER_BURST_SAMPLES];
+static flicker_analyzer_t analyzer;
+static bool analyzerReady;
+static flicker_readout_t reportedFlicker;
+static uint32_t secondsSinceBurst;
+
+static void sample_burst(void *arg) {
+    uint32_t raw = Core2ForAWS_Port_B_ADC_ReadRaw();
+    // A failed read (-1) repeats the previous sample.
+    if (raw > 4095) {
+        raw = (burstCount > 0) ? burstRaw[burstCount - 1] : 0;
+    }
+    if (burstCount == 0) {
+        burstStartUs = esp_timer_get_time();
+    }
+    burstRaw[burstCount++] = raw;
+
+    if (burstCount == FLICKER_BURST_SAMPLES) {
+        burstEndUs = esp_timer_get_time();
+        esp_timer_stop(burstTimer);
+        atomic_store(&burstDone, true);
+        // The ADC is free again; M5S_RBMST30_Poll need not wait for the analysis.
+        atomic_store(&burstActive, false);
+    }
+}
+
+static void flicker_init() {
+    const esp_timer_create_args_t timerArgs = {
+        .callback = sample_burst,
+        .name = "flicker_burst",
+    };
+    analyzerReady = Flicker_Init(&analyzer, FLICKER_BURST_SAMPLES)
+        && esp_timer_create(&timerArgs, &burstTimer) == ESP_OK;
+    if (!analyzerReady) {
+        ESP_LOGE(TAG, "Couldn't set up the flicker measurement.");
+    }
+}
+
+static void analyze_burst() {
+    // The timer may run a little off its period; use the rate it achieved.
+    float sampleRate = CONFIG_M5S_RBMST30_FLICKER_SAMPLE_RATE;
+    if (burstEndUs > burstStartUs) {
+        sampleRate = (FLICKER_BURST_SAMPLES - 1) * 1e6f / (float)(burstEndUs - burstStartUs);
+    }
+    for (size_t i = 0; i < FLICKER_BURST_SAMPLES; i++) {
+        burstLux[i] = Photoresistor_MilliVoltsToLux(&curve, Core2ForAWS_Port_B_ADC_RawToMilliVolts(burstRaw[i]));
     }
+    reportedFlicker = Flicker_Analyze(&analyzer, burstLux, sampleRate);
+}
 
-    for(;;) {
-        xSemaphoreTake(thread_mutex, portMAX_DELAY);
-        // Need to adjust photoresistance raw value to a more useful human measure (lu)
-        // https://www.aranacorp.com/en/luminosity-measurement-with-a-photoresistor/
-        reportedIntensityMilliVolts = Core2ForAWS_Port_B_ADC_ReadMilliVolts();
-        xSemaphoreGive(thread_mutex);
+void M5S_RBMST30_FlickerPoll(void *context) {
+    if (!analyzerReady) {
+        return;
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+    if (atomic_load(&burstDone)) {
+        analyze_burst();
+        atomic_store(&burstDone, false);
+        secondsSinceBurst = 0;
+    } else if (!atomic_load(&burstActive) && ++secondsSinceBurst >= CONFIG_M5S_RBMST30_FLICKER_PERIOD_SEC) {
+        burstCount = 0;
+        atomic_store(&burstActive, true);
+        if (esp_timer_start_periodic(burstTimer, 1000000 / CONFIG_M5S_RBMST30_FLICKER_SAMPLE_RATE) != ESP_OK) {
+            atomic_store(&burstActive, false);
+            secondsSinceBurst = 0;
+        }
     }
+}
 
-    vTaskDelete(NULL);
+flicker_readout_t M5S_RBMST30_ReadFlicker() {
+    return reportedFlicker;
 }
+#endif
 
 void M5S_RBMST30_Init() {
-    thread_mutex = xSemaphoreCreateMutex();
-    xTaskCreatePinnedToCore(
-        M5S_RBMST30_UpdateTask, "M5S_RBMST30_TASK", 1024*4, NULL, 1, NULL, 1);
+    esp_err_t err = Core2ForAWS_Port_PinMode(PORT_B_ADC_PIN, ADC);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Could not connect to Port B with ESP_ERROR: %d", err);
+    } else {
+        ESP_LOGI(TAG, "Successfully connected Light Sensor to Port B.");
+        #if CONFIG_M5S_RBMST30_FLICKER
+        flicker_init();
+        #endif
+    }
+}
+
+void M5S_RBMST30_Poll(void *context) {
+    // The flicker burst needs evenly spaced reads; keep the last value meanwhile.
+    if (atomic_load(&burstActive)) {
+        return;
+    }
+    reportedIntensityMilliVolts = Core2ForAWS_Port_B_ADC_ReadMilliVoltsOversampled(
+        CONFIG_M5S_RBMST30_OVERSAMPLING, CONFIG_M5S_RBMST30_TRIM);
 }
 
 uint32_t M5S_RBMST30_ReadMilliVolts() {
-    xSemaphoreTake(thread_mutex, portMAX_DELAY);
-    uint32_t result = reportedIntensityMilliVolts;
-    xSemaphoreGive(thread_mutex);
-    return result;
+    return reportedIntensityMilliVolts;
 }
 
+uint32_t M5S_RBMST30_ReadLux() {
+    // https://www.aranacorp.com/en/luminosity-measurement-with-a-photoresistor/
+    return (uint32_t)(Photoresistor_MilliVoltsToLux(&curve, reportedIntensityMilliVolts) + 0.5f);
+}
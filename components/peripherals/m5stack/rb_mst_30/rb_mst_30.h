@@ -7,20 +7,69 @@
 #pragma once
 
 #include <ctype.h>
+#include <stdint.h>
+
+#if CONFIG_M5S_RBMST30_FLICKER
+#include "flicker.h"
+#endif
 
 /**
  * @brief Initializes the RBMST30 using ADC read rotocol.
  * 
- * @note Creates a FreeRTOS task with the name `M5S_RBMST30_Task`.
- * 
- * The FreeRTOS task performs a passive read of the light sensor at a set 
- * sampling rate, storing the latest value.
+ * The light sensor is read passively by calling `M5S_RBMST30_Poll` at a set 
+ * sampling rate, which stores the latest value.
  */
 void M5S_RBMST30_Init();
 
+/**
+ * @brief Samples the light sensor (an oversampled burst of ADC reads) and
+ * stores the value for later reads. Skipped while a flicker burst is being
+ * captured.
+ * 
+ * @note Meant to be run periodically as a sensor scheduler read callback.
+ * 
+ * @param context unused.
+ */
+void M5S_RBMST30_Poll(void *context);
+
 /**
  * @brief Reads the latest value returned by the light sensor (if any).
  * 
+ * @note Not synchronized with `M5S_RBMST30_Poll`; call it from the same task.
+ * 
  * @return The latest value returned by the light sensor.
 */
-uint32_t M5S_RBMST30_ReadMilliVolts();
\ No newline at end of file
+uint32_t M5S_RBMST30_ReadMilliVolts();
+
+/**
+ * @brief Converts the latest light sensor value to an illuminance, using the
+ * photoresistor curve from the project configuration.
+ * 
+ * @note Not synchronized with `M5S_RBMST30_Poll`; call it from the same task.
+ * 
+ * @return The latest illuminance in lux.
+*/
+uint32_t M5S_RBMST30_ReadLux();
+#if CONFIG_M5S_RBMST30_FLICKER
+/**
+ * @brief Starts a flicker burst every `CONFIG_M5S_RBMST30_FLICKER_PERIOD_SEC`
+ * seconds and analyzes it once it is complete.
+ *
+ * A burst is 512 ADC reads paced by a periodic `esp_timer` at
+ * `CONFIG_M5S_RBMST30_FLICKER_SAMPLE_RATE`, about a quarter of a second at
+ * 2 kHz. The reads run on the esp_timer task and only store the raw code;
+ * the conversion to lux and the analysis run here.
+ *
+ * @note Meant to be run once a second as a sensor scheduler read callback.
+ *
+ * @param context unused.
+ */
+void M5S_RBMST30_FlickerPoll(void *context);
+
+/**
+ * @brief Reads the flicker of the last analyzed burst (all 0 before one).
+ *
+ * @note Not synchronized with `M5S_RBMST30_FlickerPoll`; call it from the same task.
+ */
+flicker_readout_t M5S_RBMST30_ReadFlicker();
+#endif
@@ -0,0 +1,56 @@
+#include "sgp30.h"
+
+#define CRC8_POLYNOMIAL 0x31
+#define CRC8_INIT 0xFF
+
+uint8_t SGP30_Crc8(const uint8_t *data, size_t length) {
+    uint8_t crc = CRC8_INIT;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ CRC8_POLYNOMIAL) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void SGP30_EncodeCommand(uint16_t command, uint8_t *frame) {
+    frame[0] = command >> 8;
+    frame[1] = command & 0xFF;
+}
+
+static void encode_word(uint16_t word, uint8_t *frame) {
+    frame[0] = word >> 8;
+    frame[1] = word & 0xFF;
+    frame[2] = SGP30_Crc8(frame, 2);
+}
+
+bool SGP30_DecodeWords(const uint8_t *frame, size_t count, uint16_t *words) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *word = frame + i * SGP30_WORD_SIZE;
+        if (SGP30_Crc8(word, 2) != word[2]) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *word = frame + i * SGP30_WORD_SIZE;
+        words[i] = (uint16_t)(word[0] << 8) | word[1];
+    }
+    return true;
+}
+
+bool SGP30_DecodeAirQuality(const uint8_t *frame, sgp30_air_quality_t *result) {
+    uint16_t words[2];
+    if (!SGP30_DecodeWords(frame, 2, words)) {
+        return false;
+    }
+    result->eCO2 = words[0];
+    result->tvoc = words[1];
+    return true;
+}
+
+void SGP30_EncodeSetBaseline(const sgp30_air_quality_t *baseline, uint8_t *frame) {
+    SGP30_EncodeCommand(SGP30_CMD_SET_BASELINE, frame);
+    encode_word(baseline->tvoc, frame + 2);
+    encode_word(baseline->eCO2, frame + 2 + SGP30_WORD_SIZE);
+}
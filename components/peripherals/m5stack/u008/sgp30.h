@@ -0,0 +1,68 @@
+/**
+ * @file sgp30.h
+ * @brief Commands and frame encoding of the Sensirion SGP30 gas sensor that
+ * is inside the M5Stack u008 unit.
+ *
+ * Every 16-bit word the SGP30 sends or receives is big-endian and followed
+ * by a CRC-8 (polynomial 0x31, initialization 0xFF), so a reply of N words
+ * is 3 * N bytes.
+ *
+ * @note See the SGP30 datasheet, section 6 "Digital Interface Description".
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SGP30_I2C_ADDRESS 0x58
+
+#define SGP30_CMD_INIT_AIR_QUALITY 0x2003
+#define SGP30_CMD_MEASURE_AIR_QUALITY 0x2008
+#define SGP30_CMD_GET_BASELINE 0x2015
+#define SGP30_CMD_SET_BASELINE 0x201E
+
+/** Bytes in one word on the wire: the word itself and its CRC. */
+#define SGP30_WORD_SIZE 3
+
+/** Size of the measure and get baseline replies (two words). */
+#define SGP30_AIR_QUALITY_REPLY_SIZE (2 * SGP30_WORD_SIZE)
+
+/** Size of a set baseline command (the command and two words). */
+#define SGP30_SET_BASELINE_SIZE (2 + 2 * SGP30_WORD_SIZE)
+
+/** eCO2 (ppm) and TVOC (ppb), as measured or as an IAQ baseline. */
+typedef struct {
+    uint16_t eCO2;
+    uint16_t tvoc;
+} sgp30_air_quality_t;
+
+/** @brief Computes the CRC-8 of `length` bytes, e.g. of one word. */
+uint8_t SGP30_Crc8(const uint8_t *data, size_t length);
+
+/** @brief Writes the 2-byte big-endian command code into `frame`. */
+void SGP30_EncodeCommand(uint16_t command, uint8_t *frame);
+
+/**
+ * @brief Decodes `count` words, checking each one's CRC.
+ *
+ * @param[in] frame `count * SGP30_WORD_SIZE` received bytes.
+ *
+ * @return false if any word fails its CRC; `words` is then left untouched.
+ */
+bool SGP30_DecodeWords(const uint8_t *frame, size_t count, uint16_t *words);
+
+/**
+ * @brief Decodes a measure air quality or get baseline reply (eCO2 word
+ * first, then TVOC).
+ *
+ * @return false if the reply fails its CRC check.
+ */
+bool SGP30_DecodeAirQuality(const uint8_t *frame, sgp30_air_quality_t *result);
+
+/**
+ * @brief Builds a set baseline command. The baseline words go in the reverse
+ * order of the get baseline reply (TVOC first, then eCO2).
+ */
+void SGP30_EncodeSetBaseline(const sgp30_air_quality_t *baseline, uint8_t *frame);
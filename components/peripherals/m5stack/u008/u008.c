@@ -1,34 +1,116 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "nvs.h"
 
 #include "core2forAWS.h"
+#include "sgp30.h"
 #include "u008.h"
 
-#define WRITE_DELAY_MS 10
-
-// The device address, buad rate and commands related to the underlying SGP30
-// hardware were referenced from:
-// https://github.com/adafruit/Adafruit_SGP30/blob/master/Adafruit_SGP30.cpp
-#define DEVICE_ADDRESS 0x58
+// Commands need at most 10-12ms to complete before their reply can be read
+#define COMMAND_DELAY_MS 12
 #define BAUD_RATE 115200
 
-static const uint8_t init_commands[] = {0x20, 0x03};
-static const uint8_t sensor_read_commands[] = {0x20, 0x08};
+// The SGP30 needs 12 hours of operation to establish a baseline from
+// scratch; once it has one, it is saved every hour so it can be restored
+// after a reboot (see the SGP30 datasheet, section 3.2).
+#define BASELINE_WARMUP_POLLS (12 * 60 * 60)
+#define BASELINE_SAVE_POLLS (60 * 60)
+#define NVS_NAMESPACE "u008"
+#define NVS_BASELINE_KEY "iaq_baseline"
 
 static const char *TAG = "M5S-U008";
-static SemaphoreHandle_t thread_mutex;
+static I2CDevice_t port_A_peripheral;
+static bool measurementPending;
+static bool baselineValid;
+static uint32_t pollCount;
 static m5s_u008_readout_t reportedReadout;
 
-void M5S_U008_UpdateReadoutTask() {
+static esp_err_t write_command(uint16_t command) {
+    uint8_t frame[2];
+    SGP30_EncodeCommand(command, frame);
+    return Core2ForAWS_Port_A_I2C_Write(port_A_peripheral, I2C_NO_REG, frame, sizeof(frame));
+}
+
+// Reads a two word reply, checking its CRCs.
+static esp_err_t read_air_quality(sgp30_air_quality_t *result) {
+    uint8_t reply[SGP30_AIR_QUALITY_REPLY_SIZE];
+    esp_err_t err = Core2ForAWS_Port_A_I2C_Read(port_A_peripheral, I2C_NO_REG, reply, sizeof(reply));
+    if (err) {
+        return err;
+    }
+    return SGP30_DecodeAirQuality(reply, result) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+static bool load_baseline(sgp30_air_quality_t *baseline) {
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    size_t size = sizeof(*baseline);
+    esp_err_t err = nvs_get_blob(handle, NVS_BASELINE_KEY, baseline, &size);
+    nvs_close(handle);
+    return err == ESP_OK && size == sizeof(*baseline);
+}
+
+static void save_baseline() {
+    sgp30_air_quality_t baseline;
+    esp_err_t err = write_command(SGP30_CMD_GET_BASELINE);
+    if (!err) {
+        vTaskDelay(pdMS_TO_TICKS(COMMAND_DELAY_MS));
+        err = read_air_quality(&baseline);
+    }
+    if (err) {
+        ESP_LOGW(TAG, "Could not read the IAQ baseline: %s", esp_err_to_name(err));
+        return;
+    }
+
+    nvs_handle_t handle;
+    err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (!err) {
+        err = nvs_set_blob(handle, NVS_BASELINE_KEY, &baseline, sizeof(baseline));
+        if (!err) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    if (err) {
+        ESP_LOGW(TAG, "Could not save the IAQ baseline: %s", esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "Saved IAQ baseline {eCO2:0x%04x tvoc:0x%04x}", baseline.eCO2, baseline.tvoc);
+    }
+}
+
+static void restore_baseline() {
+    sgp30_air_quality_t baseline;
+    if (!load_baseline(&baseline)) {
+        ESP_LOGI(TAG, "No IAQ baseline saved, readings settle after 12 hours.");
+        return;
+    }
+
+    uint8_t frame[SGP30_SET_BASELINE_SIZE];
+    SGP30_EncodeSetBaseline(&baseline, frame);
+    esp_err_t err = Core2ForAWS_Port_A_I2C_Write(port_A_peripheral, I2C_NO_REG, frame, sizeof(frame));
+    if (err) {
+        ESP_LOGW(TAG, "Could not restore the IAQ baseline: %s", esp_err_to_name(err));
+        return;
+    }
+    vTaskDelay(pdMS_TO_TICKS(COMMAND_DELAY_MS));
+
+    baselineValid = true;
+    ESP_LOGI(TAG, "Restored IAQ baseline {eCO2:0x%04x tvoc:0x%04x}", baseline.eCO2, baseline.tvoc);
+}
+
+void M5S_U008_Init() {
     // Initialize peripheral device with the expected buad_rate.
-    I2CDevice_t port_A_peripheral = 
-        Core2ForAWS_Port_A_I2C_Begin(DEVICE_ADDRESS, BAUD_RATE);
+    port_A_peripheral = Core2ForAWS_Port_A_I2C_Begin(SGP30_I2C_ADDRESS, BAUD_RATE);
+    measurementPending = false;
+    baselineValid = false;
+    pollCount = 0;
     
-    // Initialize the sensor to get non-zero readings.
-    esp_err_t init_err = Core2ForAWS_Port_A_I2C_Write(
-        port_A_peripheral, I2C_NO_REG, &init_commands, 2);
+    // Start the air quality algorithm, then hand it the last known baseline.
+    esp_err_t init_err = write_command(SGP30_CMD_INIT_AIR_QUALITY);
 
     if (init_err) {
         ESP_LOGW(
@@ -36,57 +118,46 @@ void M5S_U008_UpdateReadoutTask() {
             "Initialization of %s peripheral failed with error: %s",
             TAG,
             esp_err_to_name(init_err));
-    } else {
-        ESP_LOGI(TAG, "Successfully connected Gas Sensor to Port A.");
+        return;
     }
 
-    // TODO: May need to follow the Adafruit example and issue the baselining
-    // command + perform those operations before looping over the read/write.
-
-    for(;;){
-        // Issue command for TVOC and eCO2 readings
-        esp_err_t write_err = 
-            Core2ForAWS_Port_A_I2C_Write(
-                port_A_peripheral, I2C_NO_REG, &sensor_read_commands, 2);
-        if(!write_err) {
-            // A minute delay to give the sensor time to respond to the command
-            // before reading the result
-            vTaskDelay(pdMS_TO_TICKS(WRITE_DELAY_MS));
-            
-            uint8_t reply[2];
-            esp_err_t read_err = 
-                Core2ForAWS_Port_A_I2C_Read(port_A_peripheral, I2C_NO_REG, &reply, 2);
-            
-            if(!read_err) {
-                xSemaphoreTake(thread_mutex, portMAX_DELAY);
-                reportedReadout.tvoc = reply[0];
-                reportedReadout.eC02 = reply[1];
-                xSemaphoreGive(thread_mutex);
-            } else {
-                ESP_LOGW(TAG, "CO2 Read Error: %s", esp_err_to_name(read_err));
-            }
+    ESP_LOGI(TAG, "Successfully connected Gas Sensor to Port A.");
+    vTaskDelay(pdMS_TO_TICKS(COMMAND_DELAY_MS));
+    restore_baseline();
+}
+
+void M5S_U008_Poll(void *context) {
+    // The result of the command issued on the previous poll has long been
+    // ready, so read it before issuing the next one instead of waiting for it.
+    if (measurementPending) {
+        sgp30_air_quality_t result;
+        esp_err_t read_err = read_air_quality(&result);
+        
+        if(!read_err) {
+            reportedReadout.tvoc = result.tvoc;
+            reportedReadout.eC02 = result.eCO2;
         } else {
-            ESP_LOGW(TAG, "CO2 Write Error: %s", esp_err_to_name(write_err));
+            ESP_LOGW(TAG, "CO2 Read Error: %s", esp_err_to_name(read_err));
         }
+        measurementPending = false;
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
+    pollCount++;
+    if (!baselineValid && pollCount >= BASELINE_WARMUP_POLLS) {
+        baselineValid = true;
+    }
+    if (baselineValid && pollCount % BASELINE_SAVE_POLLS == 0) {
+        save_baseline();
     }
-    
-    Core2ForAWS_Port_A_I2C_Close(port_A_peripheral);
-    vTaskDelete(NULL);
-}
 
-void M5S_U008_Init() {
-    thread_mutex = xSemaphoreCreateMutex();
-    xTaskCreatePinnedToCore(
-        M5S_U008_UpdateReadoutTask, "M5S_U008_Task", 1024*2, NULL, 1, NULL, 1);
+    // Issue command for TVOC and eCO2 readings
+    esp_err_t write_err = write_command(SGP30_CMD_MEASURE_AIR_QUALITY);
+    measurementPending = !write_err;
+    if (write_err) {
+        ESP_LOGW(TAG, "CO2 Write Error: %s", esp_err_to_name(write_err));
+    }
 }
 
 m5s_u008_readout_t M5S_U008_GetLatestReadout() {
-    xSemaphoreTake(thread_mutex, portMAX_DELAY);
-    m5s_u008_readout_t result; 
-    result.tvoc = reportedReadout.tvoc;
-    result.eC02 = reportedReadout.eC02;
-    xSemaphoreGive(thread_mutex);
-    return result;
-}
\ No newline at end of file
+    return reportedReadout;
+}
@@ -10,25 +10,44 @@
 
 #pragma once
 #include <ctype.h>
+#include <stdint.h>
 
-/** Represents a labeled readout from this sensor. */
+/** Represents a labeled readout from this sensor (TVOC in ppb, eCO2 in ppm). */
 typedef struct {
-    uint8_t tvoc;
-    uint8_t eC02;
+    uint16_t tvoc;
+    uint16_t eC02;
 } m5s_u008_readout_t;
 
 /**
  * @brief Initializes the sensor using I2C.
  * 
- * @note Creates a FreeRTOS task with the name `M5S_U008_Task`.
+ * Readings are taken by calling `M5S_U008_Poll` once per second, which is the
+ * measurement rate the sensor expects.
  * 
- * The created FreeRTOS task performs a period write command + subsequent read.
+ * @note NVS must be initialized first: the IAQ baseline saved on a previous
+ * boot is restored so readings are valid right away, instead of after the
+ * sensor's 12 hour warm-up.
 */
 void M5S_U008_Init();
 
+/**
+ * @brief Reads the result of the previous measurement command and issues the
+ * next one.
+ * 
+ * @note Meant to be run every second as a sensor scheduler read callback. The
+ * first poll only starts a measurement. Replies that fail their CRC check are
+ * dropped. Once the sensor has a valid IAQ baseline, it is saved to NVS every
+ * hour.
+ * 
+ * @param context unused.
+*/
+void M5S_U008_Poll(void *context);
+
 /**
  * @brief Read the latest set of values returned from this sensor.
  * 
+ * @note Not synchronized with `M5S_U008_Poll`; call it from the same task.
+ * 
  * @returns the latest set of readouts from this sensor.
 */
 m5s_u008_readout_t M5S_U008_GetLatestReadout();
@@ -0,0 +1,151 @@
+/**
+ * @file adc_filter_test.c
+ * @brief Host tests for the oversampled light-sensor acquisition math: burst
+ * decimation, the ADC calibration lookup table and the photoresistor curve.
+ *
+ * The raw traces are generated with a fixed seed to mimic what GPIO36 reads
+ * on the device: Gaussian noise of ~15 codes plus occasional spikes of a few
+ * hundred codes.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "adc_filter.h"
+#include "photoresistor.h"
+#include "check.h"
+#include "test_util.h"
+
+#define BURST 16
+#define TRIM 4
+#define READINGS 2000
+
+static test_rng_t rng = { 2024 };
+
+// One raw read of a level `code`, with the noise and spikes of the ESP32 ADC.
+static uint16_t noisy_read(double code) {
+    double value = code + 15.0 * test_gaussian(&rng);
+    if (test_uniform(&rng) < 0.03) {
+        value += (test_uniform(&rng) < 0.5 ? -1 : 1) * (200 + 300 * test_uniform(&rng));
+    }
+    if (value < 0) {
+        value = 0;
+    }
+    if (value > ADC_CAL_LUT_MAX_RAW) {
+        value = ADC_CAL_LUT_MAX_RAW;
+    }
+    return (uint16_t)lround(value);
+}
+
+// Shape of the ESP32 11 dB calibration: linear up to code 2880, then the
+// response flattens out towards 3.1 V.
+static uint32_t model_millivolts(uint32_t raw, void *context) {
+    double mv = 142 + raw * 0.8;
+    if (raw > 2880) {
+        double over = raw - 2880;
+        mv -= over * over * 0.00022;
+    }
+    return (uint32_t)lround(mv);
+}
+
+static void test_median_and_trimmed_mean(void) {
+    uint16_t odd[] = { 9, 1, 5, 3, 7 };
+    CHECK(AdcFilter_Median(odd, 5) == 5);
+
+    uint16_t even[] = { 4, 1, 3, 2 };
+    CHECK(AdcFilter_Median(even, 4) == 3);
+
+    uint16_t spiky[] = { 100, 4000, 101, 99, 0, 100, 102, 98 };
+    CHECK(AdcFilter_TrimmedMean(spiky, 8, 2) == 100);
+
+    uint16_t plain[] = { 10, 20, 30, 41 };
+    CHECK(AdcFilter_TrimmedMean(plain, 4, 0) == 25);
+
+    // Trimming everything falls back to the median.
+    uint16_t small[] = { 7, 1, 3 };
+    CHECK(AdcFilter_TrimmedMean(small, 3, 2) == 3);
+
+    CHECK(AdcFilter_Median(small, 0) == 0);
+}
+
+static void test_lut_matches_calibration(void) {
+    adc_cal_lut_t lut;
+    AdcCalLut_Build(&lut, model_millivolts, NULL);
+
+    int max_error = 0;
+    for (uint32_t raw = 0; raw <= ADC_CAL_LUT_MAX_RAW; raw++) {
+        int error = abs((int)AdcCalLut_ToMilliVolts(&lut, raw) - (int)model_millivolts(raw, NULL));
+        if (error > max_error) {
+            max_error = error;
+        }
+    }
+    printf("lut: %d entries, max error %d mV\n", ADC_CAL_LUT_SIZE, max_error);
+    CHECK(max_error <= 1);
+
+    CHECK(AdcCalLut_ToMilliVolts(&lut, 0) == model_millivolts(0, NULL));
+    CHECK(AdcCalLut_ToMilliVolts(&lut, ADC_CAL_LUT_MAX_RAW) == model_millivolts(ADC_CAL_LUT_MAX_RAW, NULL));
+    CHECK(AdcCalLut_ToMilliVolts(&lut, 5000) == model_millivolts(ADC_CAL_LUT_MAX_RAW, NULL));
+}
+
+// Compares single reads against oversampled bursts on a constant level.
+static void test_oversampling_trace(double level) {
+    double single_sq = 0, burst_sq = 0, burst_max = 0;
+
+    for (int i = 0; i < READINGS; i++) {
+        double single = noisy_read(level) - level;
+        single_sq += single * single;
+
+        uint16_t burst[BURST];
+        for (int s = 0; s < BURST; s++) {
+            burst[s] = noisy_read(level);
+        }
+        double error = fabs(AdcFilter_TrimmedMean(burst, BURST, TRIM) - level);
+        burst_sq += error * error;
+        if (error > burst_max) {
+            burst_max = error;
+        }
+    }
+
+    double single_rms = sqrt(single_sq / READINGS);
+    double burst_rms = sqrt(burst_sq / READINGS);
+    printf("level %4.0f: single read rms %.1f codes, %d/%d trimmed mean rms %.1f (max %.1f)\n",
+        level, single_rms, BURST, TRIM, burst_rms, burst_max);
+    CHECK(burst_rms * 4 < single_rms);
+    // Spikes never make it through the trim.
+    CHECK(burst_max < 40);
+}
+
+static void test_photoresistor_curve(void) {
+    const photoresistor_curve_t curve = {
+        .supply_millivolts = 3300,
+        .series_ohms = 10000,
+        .ohms_at_10_lux = 15000,
+        .gamma = 0.7f,
+    };
+
+    // 1980 mV is where the photoresistor reads its 10 lux resistance.
+    CHECK(fabsf(Photoresistor_MilliVoltsToLux(&curve, 1980) - 10.0f) < 0.01f);
+    CHECK(Photoresistor_MilliVoltsToLux(&curve, 3300) == 0);
+    CHECK(Photoresistor_MilliVoltsToLux(&curve, 4000) == 0);
+    CHECK(Photoresistor_MilliVoltsToLux(&curve, 0) == PHOTORESISTOR_MAX_LUX);
+
+    // Brighter light lowers the divider voltage.
+    float previous = PHOTORESISTOR_MAX_LUX;
+    for (uint32_t mv = 1; mv < 3300; mv += 7) {
+        float lux = Photoresistor_MilliVoltsToLux(&curve, mv);
+        CHECK(lux <= previous);
+        previous = lux;
+    }
+}
+
+int main(void) {
+    test_median_and_trimmed_mean();
+    test_lut_matches_calibration();
+    test_oversampling_trace(150);
+    test_oversampling_trace(1800);
+    test_oversampling_trace(3500);
+    test_photoresistor_curve();
+    printf("adc_filter_test: OK\n");
+    return 0;
+}
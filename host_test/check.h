@@ -0,0 +1,18 @@
+/**
+ * @file check.h
+ * @brief Assertion of the host tests and benchmarks: unlike assert(), it is
+ * kept in Release builds, and it exits with the failed condition and line.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                         \
+        }                                                                    \
+    } while (0)
@@ -0,0 +1,514 @@
+/**
+ * @file dsp_suite.c
+ * @brief Host regression suite and benchmark of the sound sensor's DSP.
+ *
+ * - Every FFT size the plans support, real and complex, forward and
+ *   backward, and the Q15 real FFT, against a naive DFT in double, with the
+ *   largest and RMS errors relative to the RMS of the reference.
+ * - Throughput of each of them, in transforms per second and ns per sample.
+ * - The whole sound sensor (capture task, frame ring, A-weighted meter,
+ *   Welch bands, classifier) fed canned PCM through the stubbed microphone,
+ *   with the levels, bands and noise type it reports for each fixture and
+ *   the cost of `SoundSensor_Poll` per sample.
+ *
+ * Results are printed, and written as JSON with `--json FILE`. `--quick`
+ * shortens the timing runs. Exits with 1 if any check fails.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fft.h"
+#include "idf_stubs.h"
+#include "sound_level.h"
+#include "sound_sensor.h"
+#include "sound_synth.h"
+#include "check.h"
+#include "test_util.h"
+
+#define MAX_SIZE 4096
+// Float transforms are exact to a few float epsilons times log2(n).
+#define MAX_FLOAT_ERROR 1e-5
+// Q15 keeps about 8 significant bits of full-scale noise (see fft_q15_test.c).
+#define MAX_Q15_ERROR (1.0 / 128)
+
+#define SAMPLE_RATE CONFIG_SOUND_SENSOR_SAMPLE_RATE
+#define FRAME_SAMPLES 512
+// Frames handed to the microphone between polls, half the frame ring.
+#define FEED_FRAMES 8
+// Whole seconds of whole frames: 125 frames at 16 kHz.
+#define FIXTURE_SECONDS 4
+#define FIXTURE_SAMPLES (FIXTURE_SECONDS * SAMPLE_RATE)
+
+typedef struct {
+    const char *name;
+    fft_type_t type;
+    fft_direction_t direction;
+    int size;
+    double max_error;
+    double rms_error;
+    double transforms_per_s;
+    double ns_per_sample;
+    bool pass;
+} fft_result_t;
+
+typedef struct {
+    const char *name;
+    sound_level_readout_t levels;
+    welch_bands_t bands;
+    sound_class_t noise_type;
+    int noise_type_seconds;  // seconds classified as the expected type
+    bool pass;
+} fixture_result_t;
+
+// Complex FFTs 4 to 4096, real ones 8 to 4096, both directions, and Q15.
+#define MAX_FFT_RESULTS 64
+static fft_result_t fft_results[MAX_FFT_RESULTS];
+static int fft_result_count;
+static fixture_result_t fixture_results[16];
+static int fixture_count;
+static double poll_ns_per_sample;
+static bool quick;
+
+static float input[2 * MAX_SIZE];
+static float output[2 * MAX_SIZE];
+static float scratch[2 * MAX_SIZE];
+static int16_t q15_input[MAX_SIZE];
+static int16_t q15_output[MAX_SIZE];
+static double reference[2 * MAX_SIZE];
+static double cos_table[MAX_SIZE];
+static double sin_table[MAX_SIZE];
+static int16_t fixture[FIXTURE_SAMPLES];
+
+static test_rng_t rng = { 20211 };
+
+static void make_twiddles(int n) {
+    for (int k = 0; k < n; k++) {
+        cos_table[k] = cos(2 * M_PI * k / n);
+        sin_table[k] = sin(2 * M_PI * k / n);
+    }
+}
+
+// X[k] = sum x[j] e^(-2 pi i jk / n), and the inverse with a 1/n.
+static void naive_complex_dft(const float *x, double *y, int n, bool inverse) {
+    double sign = inverse ? 1 : -1;
+    for (int k = 0; k < n; k++) {
+        double re = 0, im = 0;
+        for (int j = 0; j < n; j++) {
+            int t = (int)(((long)j * k) % n);
+            re += x[2 * j] * cos_table[t] - sign * x[2 * j + 1] * sin_table[t];
+            im += x[2 * j + 1] * cos_table[t] + sign * x[2 * j] * sin_table[t];
+        }
+        y[2 * k] = inverse ? re / n : re;
+        y[2 * k + 1] = inverse ? im / n : im;
+    }
+}
+
+// The real FFT's packed layout: DC, Nyquist, then re/im of bins 1 to n/2 - 1.
+static void naive_real_dft(const float *x, double *y, int n) {
+    for (int k = 0; k <= n / 2; k++) {
+        double re = 0, im = 0;
+        for (int j = 0; j < n; j++) {
+            int t = (int)(((long)j * k) % n);
+            re += x[j] * cos_table[t];
+            im -= x[j] * sin_table[t];
+        }
+        if (k == 0) {
+            y[0] = re;
+        } else if (k == n / 2) {
+            y[1] = re;
+        } else {
+            y[2 * k] = re;
+            y[2 * k + 1] = im;
+        }
+    }
+}
+
+// The real signal whose packed spectrum is x.
+static void naive_real_idft(const float *x, double *y, int n) {
+    for (int j = 0; j < n; j++) {
+        double sum = x[0] + ((j & 1) ? -x[1] : x[1]);
+        for (int k = 1; k < n / 2; k++) {
+            int t = (int)(((long)j * k) % n);
+            sum += 2 * (x[2 * k] * cos_table[t] - x[2 * k + 1] * sin_table[t]);
+        }
+        y[j] = sum / n;
+    }
+}
+
+// Largest and RMS error relative to the RMS of the reference.
+// The actual values are floats, or Q15 values times q_scale.
+static void compare(const double *expected, const float *actual_f, const int16_t *actual_q,
+        double q_scale, int count, fft_result_t *result) {
+    double max_error = 0, error_sum = 0, reference_sum = 0;
+    for (int i = 0; i < count; i++) {
+        double actual = actual_f != NULL ? actual_f[i] : actual_q[i] * q_scale;
+        double error = fabs(actual - expected[i]);
+        max_error = fmax(max_error, error);
+        error_sum += error * error;
+        reference_sum += expected[i] * expected[i];
+    }
+    double rms = sqrt(reference_sum / count);
+    result->max_error = rms > 0 ? max_error / rms : max_error;
+    result->rms_error = rms > 0 ? sqrt(error_sum / count) / rms : sqrt(error_sum / count);
+}
+
+// Runs the transform until the time budget is spent, in doubling batches.
+static void time_plan(const fft_plan_t *plan, fft_result_t *result) {
+    int floats = (plan->type == FFT_COMPLEX) ? 2 * plan->size : plan->size;
+    double budget_ns = quick ? 2e6 : 20e6;
+    long transforms = 0;
+    long batch = 1;
+    double elapsed = 0;
+    volatile float sink = 0;
+
+    while (elapsed < budget_ns) {
+        double start = test_now_ns();
+        for (long i = 0; i < batch; i++) {
+            // The transforms may work in place on their input; start from the same one.
+            memcpy(scratch, input, floats * sizeof(float));
+            if (plan->type == FFT_REAL_Q15) {
+                fft_plan_execute_q15(plan, q15_input, q15_output);
+                sink += q15_output[2];
+            } else {
+                fft_plan_execute(plan, scratch, output);
+                sink += output[2];
+            }
+        }
+        elapsed += test_now_ns() - start;
+        transforms += batch;
+        batch *= 2;
+    }
+    result->transforms_per_s = transforms * 1e9 / elapsed;
+    result->ns_per_sample = elapsed / transforms / plan->size;
+}
+
+static void check_float_fft(fft_type_t type, fft_direction_t direction, int n) {
+    fft_result_t *result = &fft_results[fft_result_count++];
+    fft_plan_t *plan = fft_plan_acquire(n, type, direction);
+    CHECK(plan != NULL);
+
+    bool complex = (type == FFT_COMPLEX);
+    int floats = complex ? 2 * n : n;
+    result->name = complex ? "complex" : "real";
+    result->type = type;
+    result->direction = direction;
+    result->size = n;
+
+    // Unit variance noise, in the time or the packed frequency domain.
+    for (int i = 0; i < floats; i++) {
+        input[i] = (float)(2 * test_uniform(&rng) - 1);
+    }
+    if (complex) {
+        naive_complex_dft(input, reference, n, direction == FFT_BACKWARD);
+    } else if (direction == FFT_FORWARD) {
+        naive_real_dft(input, reference, n);
+    } else {
+        naive_real_idft(input, reference, n);
+    }
+
+    memcpy(scratch, input, floats * sizeof(float));
+    fft_plan_execute(plan, scratch, output);
+    compare(reference, output, NULL, 0, floats, result);
+    result->pass = result->rms_error <= MAX_FLOAT_ERROR;
+
+    time_plan(plan, result);
+    fft_plan_release(plan);
+}
+
+static void check_q15_fft(int n) {
+    fft_result_t *result = &fft_results[fft_result_count++];
+    fft_plan_t *plan = fft_plan_acquire(n, FFT_REAL_Q15, FFT_FORWARD);
+    CHECK(plan != NULL);
+    result->name = "q15";
+    result->type = FFT_REAL_Q15;
+    result->direction = FFT_FORWARD;
+    result->size = n;
+
+    // Full-scale noise, the worst case for the fixed point rounding.
+    for (int i = 0; i < n; i++) {
+        q15_input[i] = (int16_t)lrint(32767 * (2 * test_uniform(&rng) - 1));
+        input[i] = q15_input[i];
+    }
+    naive_real_dft(input, reference, n);
+    int exponent = fft_plan_execute_q15(plan, q15_input, q15_output);
+    compare(reference, NULL, q15_output, ldexp(1.0, exponent), n, result);
+    result->pass = result->rms_error <= MAX_Q15_ERROR;
+
+    time_plan(plan, result);
+    fft_plan_release(plan);
+}
+
+static void check_ffts(void) {
+    for (int n = 4; n <= MAX_SIZE; n *= 2) {
+        make_twiddles(n);
+        check_float_fft(FFT_COMPLEX, FFT_FORWARD, n);
+        check_float_fft(FFT_COMPLEX, FFT_BACKWARD, n);
+        if (fft_size_supported(n, FFT_REAL)) {
+            check_float_fft(FFT_REAL, FFT_FORWARD, n);
+            check_float_fft(FFT_REAL, FFT_BACKWARD, n);
+            check_q15_fft(n);
+        }
+    }
+
+    // The sizes the transforms cannot do are refused, not run.
+    CHECK(fft_plan_acquire(2, FFT_COMPLEX, FFT_FORWARD) == NULL);
+    CHECK(fft_plan_acquire(4, FFT_REAL, FFT_FORWARD) == NULL);
+    CHECK(fft_plan_acquire(4, FFT_REAL_Q15, FFT_FORWARD) == NULL);
+    CHECK(fft_init(4, FFT_REAL, FFT_FORWARD, NULL, NULL) == NULL);
+    CHECK(fft_plan_acquire(48, FFT_COMPLEX, FFT_FORWARD) == NULL);
+
+    printf("%-8s %-9s %5s %11s %11s %14s %9s\n",
+        "fft", "direction", "size", "max error", "rms error", "transforms/s", "ns/sample");
+    for (int i = 0; i < fft_result_count; i++) {
+        const fft_result_t *r = &fft_results[i];
+        printf("%-8s %-9s %5d %11.2e %11.2e %14.0f %9.2f%s\n", r->name,
+            r->direction == FFT_FORWARD ? "forward" : "backward", r->size,
+            r->max_error, r->rms_error, r->transforms_per_s, r->ns_per_sample, r->pass ? "" : "  FAIL");
+    }
+}
+
+// Sound sensor fixtures. Levels are for the -22 dBFS microphone the suite
+// configures: a -20 dBFS sine at 1 kHz reads 96 dBA.
+#define TONE_DBFS -20.0
+#define TONE_DBA 96.0f
+
+static void make_tone(float frequency_hz, double dbfs, float on_fraction) {
+    double amplitude = 32768 * pow(10, dbfs / 20);
+    for (int n = 0; n < FIXTURE_SAMPLES; n++) {
+        bool on = (n % SAMPLE_RATE) < on_fraction * SAMPLE_RATE;
+        fixture[n] = on ? (int16_t)lrint(amplitude * sin(2 * M_PI * frequency_hz * n / SAMPLE_RATE)) : 0;
+    }
+}
+
+static void make_white_noise(double peak) {
+    for (int n = 0; n < FIXTURE_SAMPLES; n++) {
+        fixture[n] = (int16_t)lrint(peak * (2 * test_uniform(&rng) - 1));
+    }
+}
+
+static void make_synth(sound_class_t label, uint32_t seed) {
+    for (int s = 0; s < FIXTURE_SECONDS; s++) {
+        SoundSynth_Example(label, seed + s, SAMPLE_RATE, &fixture[s * SAMPLE_RATE]);
+    }
+}
+
+// Feeds the fixture through the microphone, polling like the sensor
+// scheduler, and records what the sensor reports for its last second.
+static fixture_result_t *run_fixture(const char *name, sound_class_t expected_type) {
+    static uint32_t fed_frames;
+    static double poll_ns;
+    static long polled_samples;
+    fixture_result_t *result = &fixture_results[fixture_count++];
+    uint32_t classified_seconds = SoundSensor_GetBands().seconds;
+    result->name = name;
+
+    for (int offset = 0; offset < FIXTURE_SAMPLES; offset += FEED_FRAMES * FRAME_SAMPLES) {
+        int frames = (FIXTURE_SAMPLES - offset) / FRAME_SAMPLES;
+        if (frames > FEED_FRAMES) {
+            frames = FEED_FRAMES;
+        }
+        IdfStub_FeedMicrophone(&fixture[offset], frames * FRAME_SAMPLES);
+        fed_frames += frames;
+        while (SoundSensor_GetCaptureStats().pending_frames < (uint32_t)frames) {
+            struct timespec pause = { .tv_nsec = 100000 };
+            nanosleep(&pause, NULL);
+        }
+
+        double start = test_now_ns();
+        SoundSensor_Poll(NULL);
+        poll_ns += test_now_ns() - start;
+        polled_samples += frames * FRAME_SAMPLES;
+
+        welch_bands_t bands = SoundSensor_GetBands();
+        if (bands.seconds != classified_seconds) {
+            classified_seconds = bands.seconds;
+            result->noise_type_seconds += (SoundSensor_GetNoiseType().label == expected_type);
+        }
+    }
+
+    sound_capture_stats_t stats = SoundSensor_GetCaptureStats();
+    CHECK(stats.frames == fed_frames && stats.dropped_frames == 0 && stats.pending_frames == 0);
+    poll_ns_per_sample = poll_ns / polled_samples;
+
+    result->levels = SoundSensor_GetLevels();
+    result->bands = SoundSensor_GetBands();
+    result->noise_type = SoundSensor_GetNoiseType().label;
+    return result;
+}
+
+static int octave_band(float center_hz) {
+    for (int b = 0; b < WELCH_OCTAVE_BANDS; b++) {
+        if (fabsf(welch_octave_centers_hz[b] - center_hz) < 1) {
+            return b;
+        }
+    }
+    CHECK(false);
+    return -1;
+}
+
+static int third_octave_band(float center_hz) {
+    for (int b = 0; b < WELCH_THIRD_OCTAVE_BANDS; b++) {
+        if (fabsf(welch_third_octave_centers_hz[b] - center_hz) < 1) {
+            return b;
+        }
+    }
+    CHECK(false);
+    return -1;
+}
+
+static bool near(float value, float expected, float tolerance) {
+    return fabsf(value - expected) <= tolerance;
+}
+
+static void check_sound_sensor(void) {
+    // The same meter design as the sensor's, to look up its weighting.
+    static sound_level_t weighting;
+    SoundLevel_Init(&weighting, SAMPLE_RATE, CONFIG_SOUND_SENSOR_MIC_SENSITIVITY_DBFS);
+
+    SoundSensor_Init(1);
+    CHECK(IdfStub_MicrophoneRate() == SAMPLE_RATE);
+    fixture_result_t *r;
+
+    memset(fixture, 0, sizeof(fixture));
+    r = run_fixture("silence", SOUND_CLASS_QUIET);
+    r->pass = r->levels.laeq_1s == SOUND_LEVEL_FLOOR_DB && r->noise_type == SOUND_CLASS_QUIET;
+
+    make_tone(1000, TONE_DBFS, 1);
+    r = run_fixture("sine 1 kHz -20 dBFS", SOUND_CLASS_COUNT);
+    r->pass = near(r->levels.laeq_1s, TONE_DBA, 0.1f) && near(r->levels.lafmax, TONE_DBA, 0.1f)
+        && near(r->bands.third_octave_db[third_octave_band(1000)], TONE_DBFS, 1);
+
+    // At 31 Hz per bin the window spreads a 100 Hz tone across the 63 and
+    // 125 Hz octaves; together they hold all of it.
+    make_tone(100, TONE_DBFS, 1);
+    r = run_fixture("sine 100 Hz -20 dBFS", SOUND_CLASS_COUNT);
+    float low_octaves_db = 10 * log10f(powf(10, r->bands.octave_db[octave_band(63)] / 10.0f)
+        + powf(10, r->bands.octave_db[octave_band(125)] / 10.0f));
+    r->pass = near(r->levels.laeq_1s, TONE_DBA + SoundLevel_WeightingDb(&weighting, 100), 0.2f)
+        && near(low_octaves_db, TONE_DBFS, 1);
+
+    // A quarter of each second on: 6 dB under the tone, and a fast maximum
+    // of 1 - e^-2 of its power.
+    make_tone(1000, TONE_DBFS, 0.25f);
+    r = run_fixture("1 kHz bursts 250 ms/s", SOUND_CLASS_COUNT);
+    r->pass = near(r->levels.laeq_1s, TONE_DBA - 6.02f, 0.2f)
+        && r->levels.lafmax > TONE_DBA - 1 && r->levels.lafmax < TONE_DBA + 0.1f;
+
+    // Uniform noise: the mean square over the A-weighting averaged across the band.
+    const double peak = 3277;
+    double weight_sum = 0;
+    const int points = 4000;
+    for (int i = 0; i < points; i++) {
+        float frequency = (i + 0.5f) * SAMPLE_RATE / 2 / points;
+        weight_sum += pow(10, SoundLevel_WeightingDb(&weighting, frequency) / 10);
+    }
+    double mean_square = (peak / 32768) * (peak / 32768) / 3;
+    float expected = (float)(94 - CONFIG_SOUND_SENSOR_MIC_SENSITIVITY_DBFS
+        + 10 * log10(mean_square / 0.5) + 10 * log10(weight_sum / points));
+    make_white_noise(peak);
+    r = run_fixture("white noise", SOUND_CLASS_COUNT);
+    r->pass = near(r->levels.laeq_1s, expected, 0.3f);
+
+    // Noise types: most of the seconds of each are recognised.
+    static const struct {
+        const char *name;
+        sound_class_t label;
+    } synths[] = {
+        { "synth speech", SOUND_CLASS_SPEECH },
+        { "synth hvac", SOUND_CLASS_HVAC },
+        { "synth keyboard", SOUND_CLASS_KEYBOARD },
+        { "synth music", SOUND_CLASS_MUSIC },
+    };
+    for (size_t i = 0; i < sizeof(synths) / sizeof(synths[0]); i++) {
+        make_synth(synths[i].label, 9000 + 100 * i);
+        r = run_fixture(synths[i].name, synths[i].label);
+        r->pass = r->noise_type_seconds >= FIXTURE_SECONDS - 1;
+    }
+
+    printf("\n%-22s %8s %8s %9s %-9s\n", "fixture", "LAeq", "LAFmax", "1 kHz 1/3", "noise");
+    for (int i = 0; i < fixture_count; i++) {
+        r = &fixture_results[i];
+        printf("%-22s %8.2f %8.2f %9d %-9s%s\n", r->name, r->levels.laeq_1s, r->levels.lafmax,
+            r->bands.third_octave_db[third_octave_band(1000)], SoundClassifier_Name(r->noise_type),
+            r->pass ? "" : "  FAIL");
+    }
+    printf("SoundSensor_Poll: %.1f ns per sample\n", poll_ns_per_sample);
+}
+
+static bool write_json(const char *path, bool pass) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"pass\": %s,\n  \"fft\": [\n", pass ? "true" : "false");
+    for (int i = 0; i < fft_result_count; i++) {
+        const fft_result_t *r = &fft_results[i];
+        fprintf(file, "    {\"type\": \"%s\", \"direction\": \"%s\", \"size\": %d, "
+            "\"max_error\": %.3e, \"rms_error\": %.3e, \"transforms_per_s\": %.0f, "
+            "\"ns_per_sample\": %.3f, \"pass\": %s}%s\n",
+            r->name, r->direction == FFT_FORWARD ? "forward" : "backward", r->size,
+            r->max_error, r->rms_error, r->transforms_per_s, r->ns_per_sample,
+            r->pass ? "true" : "false", i + 1 < fft_result_count ? "," : "");
+    }
+
+    fprintf(file, "  ],\n  \"sound_sensor\": {\n    \"ns_per_sample\": %.3f,\n    \"fixtures\": [\n",
+        poll_ns_per_sample);
+    for (int i = 0; i < fixture_count; i++) {
+        const fixture_result_t *r = &fixture_results[i];
+        fprintf(file, "      {\"name\": \"%s\", \"laeq_1s\": %.2f, \"lafmax\": %.2f, \"octave_db\": [",
+            r->name, r->levels.laeq_1s, r->levels.lafmax);
+        for (int b = 0; b < WELCH_OCTAVE_BANDS; b++) {
+            fprintf(file, "%s%d", b > 0 ? ", " : "", r->bands.octave_db[b]);
+        }
+        fprintf(file, "], \"third_octave_db\": [");
+        for (int b = 0; b < WELCH_THIRD_OCTAVE_BANDS; b++) {
+            fprintf(file, "%s%d", b > 0 ? ", " : "", r->bands.third_octave_db[b]);
+        }
+        fprintf(file, "], \"noise_type\": \"%s\", \"expected_type_seconds\": %d, \"pass\": %s}%s\n",
+            SoundClassifier_Name(r->noise_type), r->noise_type_seconds,
+            r->pass ? "true" : "false", i + 1 < fixture_count ? "," : "");
+    }
+    fprintf(file, "    ]\n  }\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char **argv) {
+    const char *json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else {
+            fprintf(stderr, "usage: %s [--json FILE] [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    check_ffts();
+    check_sound_sensor();
+
+    bool pass = true;
+    for (int i = 0; i < fft_result_count; i++) {
+        pass = pass && fft_results[i].pass;
+    }
+    for (int i = 0; i < fixture_count; i++) {
+        pass = pass && fixture_results[i].pass;
+    }
+    if (json_path != NULL && !write_json(json_path, pass)) {
+        fprintf(stderr, "Couldn't write %s\n", json_path);
+        return 1;
+    }
+    if (!pass) {
+        fprintf(stderr, "dsp_suite: FAILED\n");
+        return 1;
+    }
+    printf("dsp_suite: OK\n");
+    return 0;
+}
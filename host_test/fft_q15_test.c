@@ -0,0 +1,194 @@
+/**
+ * @file fft_q15_test.c
+ * @brief Host tests for the Q15 real FFT against the float rfft, and a
+ * benchmark of both for sizes 128 to 4096.
+ *
+ * Error bounds, for every output component of an n point FFT:
+ * - |float - q15 * 2^e| is at most 4 * log2(n) units of 2^e, the weight of
+ *   the Q15 output's last bit. Rounding errors add up over the stages, so
+ *   full-scale white noise comes closest (about 32 LSB at n = 4096).
+ * - The error is at most 2^-7 of the largest output component, and 2^-11 of
+ *   it for tones and impulses, whose energy is in a few bins.
+ * Float rfft output is exact to about 2^-20 here and is used as the reference.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fft.h"
+#include "check.h"
+#include "test_util.h"
+
+#define MIN_SIZE 128
+#define MAX_SIZE 4096
+#define MAX_RELATIVE_ERROR (1.0 / 128)
+#define MAX_RELATIVE_ERROR_SPARSE (1.0 / 2048)
+#define BENCH_SAMPLES (1 << 22)
+
+static int16_t samples[MAX_SIZE];
+static int16_t q15_output[MAX_SIZE];
+static float float_input[MAX_SIZE];
+static float float_output[MAX_SIZE];
+
+static test_rng_t rng = { 12345 };
+
+typedef enum {
+    SIGNAL_FULL_SCALE_NOISE,
+    SIGNAL_QUIET_TONES,
+    SIGNAL_LOUD_TONE,
+    SIGNAL_IMPULSE,
+    SIGNAL_SILENCE,
+    SIGNAL_COUNT
+} signal_t;
+
+static const char *signal_names[SIGNAL_COUNT] = {
+    "full-scale noise", "quiet tones", "loud tone", "impulse", "silence"
+};
+
+static void make_signal(signal_t signal, int n) {
+    for (int i = 0; i < n; i++) {
+        switch (signal) {
+            case SIGNAL_FULL_SCALE_NOISE:
+                samples[i] = test_uniform_int(&rng, 32767);
+                break;
+            case SIGNAL_QUIET_TONES:
+                samples[i] = (int16_t)lrintf(200.0f * sinf(6.2831853f * 5 * i / n)
+                    + 80.0f * cosf(6.2831853f * (n / 8 + 3) * i / n)) + test_uniform_int(&rng, 3);
+                break;
+            case SIGNAL_LOUD_TONE:
+                samples[i] = (int16_t)lrintf(32000.0f * sinf(6.2831853f * 17 * i / n));
+                break;
+            case SIGNAL_IMPULSE:
+                samples[i] = (i == 3) ? INT16_MIN : 0;
+                break;
+            default:
+                samples[i] = 0;
+                break;
+        }
+    }
+}
+
+// Returns the largest error in units of 2^e.
+static double compare(int n, fft_plan_t *float_plan, fft_plan_t *q15_plan, double *relative) {
+    for (int i = 0; i < n; i++) {
+        float_input[i] = samples[i];
+    }
+    fft_plan_execute(float_plan, float_input, float_output);
+    int exponent = fft_plan_execute_q15(q15_plan, samples, q15_output);
+    CHECK(exponent >= 0 && exponent <= 16);
+
+    double scale = ldexp(1.0, exponent);
+    double max_error = 0;
+    double max_value = 0;
+    for (int i = 0; i < n; i++) {
+        double error = fabs(float_output[i] - q15_output[i] * scale);
+        if (error > max_error) {
+            max_error = error;
+        }
+        if (fabs(float_output[i]) > max_value) {
+            max_value = fabs(float_output[i]);
+        }
+    }
+    *relative = max_value > 0 ? max_error / max_value : 0;
+    return max_error / scale;
+}
+
+static void test_matches_float_rfft(void) {
+    for (int n = MIN_SIZE; n <= MAX_SIZE; n *= 2) {
+        fft_plan_t *float_plan = fft_plan_acquire(n, FFT_REAL, FFT_FORWARD);
+        fft_plan_t *q15_plan = fft_plan_acquire(n, FFT_REAL_Q15, FFT_FORWARD);
+        CHECK(float_plan != NULL && q15_plan != NULL);
+
+        for (int signal = 0; signal < SIGNAL_COUNT; signal++) {
+            double relative;
+            make_signal(signal, n);
+            double error = compare(n, float_plan, q15_plan, &relative);
+            printf("n=%4d %-16s max error %5.2f LSB (%.1e of the peak)\n", n, signal_names[signal], error, relative);
+            CHECK(error <= 4 * log2(n));
+            CHECK(relative <= (signal == SIGNAL_FULL_SCALE_NOISE ? MAX_RELATIVE_ERROR : MAX_RELATIVE_ERROR_SPARSE));
+        }
+
+        fft_plan_release(float_plan);
+        fft_plan_release(q15_plan);
+    }
+}
+
+static void test_finds_the_tone(void) {
+    const int n = 512;
+    fft_plan_t *plan = fft_plan_acquire(n, FFT_REAL_Q15, FFT_FORWARD);
+    make_signal(SIGNAL_LOUD_TONE, n);
+    int exponent = fft_plan_execute_q15(plan, samples, q15_output);
+
+    // A sine of amplitude A at bin 17 has a magnitude of A * n / 2 there.
+    double re = ldexp(q15_output[2 * 17], exponent);
+    double im = ldexp(q15_output[2 * 17 + 1], exponent);
+    CHECK(fabs(sqrt(re * re + im * im) - 32000.0 * n / 2) < 32000.0 * n / 2 * 1e-3);
+    fft_plan_release(plan);
+}
+
+static void test_silence_stays_exact(void) {
+    const int n = 256;
+    fft_plan_t *plan = fft_plan_acquire(n, FFT_REAL_Q15, FFT_FORWARD);
+    make_signal(SIGNAL_SILENCE, n);
+    CHECK(fft_plan_execute_q15(plan, samples, q15_output) == 0);
+    for (int i = 0; i < n; i++) {
+        CHECK(q15_output[i] == 0);
+    }
+    fft_plan_release(plan);
+}
+
+static void test_rejects_backward_plans(void) {
+    CHECK(fft_plan_acquire(512, FFT_REAL_Q15, FFT_BACKWARD) == NULL);
+}
+
+// fft_init has no float buffers to give a Q15 transform
+static void test_rejects_q15_configs(void) {
+    CHECK(fft_init(512, FFT_REAL_Q15, FFT_FORWARD, NULL, NULL) == NULL);
+}
+
+static void bench_sizes(void) {
+    printf("\n%6s %16s %16s\n", "size", "float us/frame", "Q15 us/frame");
+    for (int n = MIN_SIZE; n <= MAX_SIZE; n *= 2) {
+        fft_plan_t *float_plan = fft_plan_acquire(n, FFT_REAL, FFT_FORWARD);
+        fft_plan_t *q15_plan = fft_plan_acquire(n, FFT_REAL_Q15, FFT_FORWARD);
+        int frames = BENCH_SAMPLES / n;
+        float sink = 0;
+        make_signal(SIGNAL_FULL_SCALE_NOISE, n);
+
+        // The float path includes the int16 to float conversion it needs.
+        double start = test_now_s();
+        for (int frame = 0; frame < frames; frame++) {
+            for (int i = 0; i < n; i++) {
+                float_input[i] = samples[i];
+            }
+            fft_plan_execute(float_plan, float_input, float_output);
+            sink += float_output[2];
+        }
+        double float_us = (test_now_s() - start) * 1e6 / frames;
+
+        start = test_now_s();
+        for (int frame = 0; frame < frames; frame++) {
+            fft_plan_execute_q15(q15_plan, samples, q15_output);
+            sink += q15_output[2];
+        }
+        double q15_us = (test_now_s() - start) * 1e6 / frames;
+
+        CHECK(sink != 0);
+        printf("%6d %16.2f %16.2f\n", n, float_us, q15_us);
+        fft_plan_release(float_plan);
+        fft_plan_release(q15_plan);
+    }
+}
+
+int main(void) {
+    test_matches_float_rfft();
+    test_finds_the_tone();
+    test_silence_stays_exact();
+    test_rejects_backward_plans();
+    test_rejects_q15_configs();
+    bench_sizes();
+    printf("fft_q15_test: OK\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file frame_ring_test.c
+ * @brief Host tests for the sound sensor's zero-copy frame ring: single
+ * threaded semantics plus a producer/consumer stress test that checks every
+ * frame arrives whole, in order, or is counted as dropped.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_ring.h"
+#include "check.h"
+
+#define FRAME_SAMPLES 64
+#define STRESS_FRAMES 200000
+
+static int16_t storage[FRAME_RING_SLOTS * FRAME_SAMPLES];
+static frame_ring_t ring;
+static volatile int producer_done;
+
+static void fill(int16_t *frame, uint32_t number) {
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        frame[i] = (int16_t)(number * 31 + i);
+    }
+}
+
+static int is_frame(const int16_t *frame, uint32_t number) {
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        if (frame[i] != (int16_t)(number * 31 + i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_frames_are_handed_over_in_place(void) {
+    FrameRing_Init(&ring, storage, FRAME_SAMPLES);
+    CHECK(FrameRing_Peek(&ring) == NULL);
+    CHECK(FrameRing_Pending(&ring) == 0);
+
+    int16_t *written = FrameRing_WriteSlot(&ring);
+    CHECK(written >= storage && written < storage + FRAME_RING_SLOTS * FRAME_SAMPLES);
+    fill(written, 1);
+    CHECK(FrameRing_Commit(&ring));
+
+    const int16_t *read = FrameRing_Peek(&ring);
+    CHECK(read == written);
+    CHECK(FrameRing_Pending(&ring) == 1);
+    CHECK(FrameRing_WriteSlot(&ring) != written);
+    FrameRing_Release(&ring);
+    CHECK(FrameRing_Peek(&ring) == NULL);
+}
+
+static void test_full_ring_drops_the_new_frame(void) {
+    FrameRing_Init(&ring, storage, FRAME_SAMPLES);
+
+    for (uint32_t i = 0; i < FRAME_RING_SLOTS - 1; i++) {
+        fill(FrameRing_WriteSlot(&ring), i);
+        CHECK(FrameRing_Commit(&ring));
+    }
+    CHECK(FrameRing_Pending(&ring) == FRAME_RING_SLOTS - 1);
+
+    // The producer's slot is none of the pending ones and is reused.
+    int16_t *spare = FrameRing_WriteSlot(&ring);
+    fill(spare, 100);
+    CHECK(!FrameRing_Commit(&ring));
+    CHECK(!FrameRing_Commit(&ring));
+    CHECK(FrameRing_Dropped(&ring) == 2);
+    CHECK(FrameRing_WriteSlot(&ring) == spare);
+
+    for (uint32_t i = 0; i < FRAME_RING_SLOTS - 1; i++) {
+        const int16_t *frame = FrameRing_Peek(&ring);
+        CHECK(frame != spare && is_frame(frame, i));
+        FrameRing_Release(&ring);
+    }
+    CHECK(FrameRing_Commit(&ring));
+    CHECK(is_frame(FrameRing_Peek(&ring), 100));
+}
+
+static void *producer(void *arg) {
+    for (uint32_t number = 0; number < STRESS_FRAMES; number++) {
+        fill(FrameRing_WriteSlot(&ring), number);
+        FrameRing_Commit(&ring);
+        if (number % 64 == 0) {
+            sched_yield();
+        }
+    }
+    producer_done = 1;
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    uint32_t *received = arg;
+    int32_t last = -1;
+
+    for (;;) {
+        const int16_t *frame = FrameRing_Peek(&ring);
+        if (frame == NULL) {
+            if (producer_done && FrameRing_Peek(&ring) == NULL) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        // Frames arrive whole and in order; dropped numbers are skipped.
+        int found = 0;
+        for (uint32_t candidate = last + 1; candidate < STRESS_FRAMES && !found; candidate++) {
+            if (is_frame(frame, candidate)) {
+                last = candidate;
+                found = 1;
+            }
+        }
+        CHECK(found);
+        FrameRing_Release(&ring);
+        (*received)++;
+    }
+    return NULL;
+}
+
+static void test_concurrent_producer_and_consumer(void) {
+    pthread_t producer_thread, consumer_thread;
+    uint32_t received = 0;
+
+    FrameRing_Init(&ring, storage, FRAME_SAMPLES);
+    producer_done = 0;
+    CHECK(pthread_create(&consumer_thread, NULL, consumer, &received) == 0);
+    CHECK(pthread_create(&producer_thread, NULL, producer, NULL) == 0);
+    pthread_join(producer_thread, NULL);
+    pthread_join(consumer_thread, NULL);
+
+    printf("%u frames received, %u dropped\n", received, FrameRing_Dropped(&ring));
+    CHECK(received > 0);
+    CHECK(received + FrameRing_Dropped(&ring) == STRESS_FRAMES);
+}
+
+int main(void) {
+    test_frames_are_handed_over_in_place();
+    test_full_ring_drops_the_new_frame();
+    test_concurrent_producer_and_consumer();
+    printf("frame_ring_test: OK\n");
+    return 0;
+}
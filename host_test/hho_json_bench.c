@@ -0,0 +1,232 @@
+/**
+ * @file hho_json_bench.c
+ * @brief Checks that the table-driven reported state serializer produces the
+ * same document as `aws_iot_shadow_add_reported`, then compares their speed
+ * on the shadow update the firmware sends.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aws_iot_config.h"
+#include "aws_iot_shadow_json.h"
+#include "jsmn.h"
+
+#include "hho_json.h"
+#include "hho_measures_table.h"
+#include "check.h"
+#include "test_util.h"
+
+#define DOCUMENT_SIZE 4608
+#define MAX_TOKENS 256
+#define ITERATIONS 200000
+
+// Defined by the MQTT client in the firmware, used for the client token.
+char mqttClientID[MAX_SIZE_OF_UNIQUE_CLIENT_ID_BYTES] = "0123ee45e8d77fa901";
+
+#define MEASURE_FIELD(id, field, type, ...) type field;
+static struct {
+    HHO_MEASURES(MEASURE_FIELD)
+} measures;
+static char notifications[200];
+static uint8_t notificationCount;
+static char stats[4096];
+
+#define REPORTED_FIELD(id, field, type, key, jsonType, ...) \
+    HHO_JSON_FIELD(key, jsonType, &measures.field),
+static const hho_json_field_t reportedFields[] = {
+    HHO_MEASURES(REPORTED_FIELD)
+    HHO_JSON_FIELD("notifications", SHADOW_JSON_STRING, notifications),
+    HHO_JSON_FIELD("notificationCount", SHADOW_JSON_INT8, &notificationCount),
+    HHO_JSON_FIELD("stats", SHADOW_JSON_OBJECT, stats),
+};
+#define REPORTED_FIELD_COUNT (sizeof(reportedFields) / sizeof(reportedFields[0]))
+
+// The same fields as SDK handlers, as the firmware declared them before.
+#define SDK_HANDLER(id, field, type, key, jsonType, ...) \
+    { key, &measures.field, sizeof(type), jsonType, NULL },
+static jsonStruct_t handlers[] = {
+    HHO_MEASURES(SDK_HANDLER)
+    { "notifications", notifications, sizeof(notifications), SHADOW_JSON_STRING, NULL },
+    { "notificationCount", &notificationCount, sizeof(uint8_t), SHADOW_JSON_INT8, NULL },
+    { "stats", stats, sizeof(stats), SHADOW_JSON_OBJECT, NULL },
+};
+
+static IoT_Error_t sdk_add_reported(char *document, size_t size) {
+    _Static_assert(sizeof(handlers) / sizeof(handlers[0]) == 14, "update the argument list");
+    return aws_iot_shadow_add_reported(document, size, 14,
+        &handlers[0], &handlers[1], &handlers[2], &handlers[3], &handlers[4],
+        &handlers[5], &handlers[6], &handlers[7], &handlers[8], &handlers[9],
+        &handlers[10], &handlers[11], &handlers[12], &handlers[13]);
+}
+
+static IoT_Error_t table_add_reported(char *document, size_t size) {
+    return HHO_Json_AddReported(document, size, reportedFields, REPORTED_FIELD_COUNT);
+}
+
+static void set_measures(float temperature, float noise, uint32_t light, uint16_t tvoc, uint16_t eCO2, float activity) {
+    measures.temperature = temperature;
+    measures.noiseLevel = noise;
+    measures.noisePeak = noise + 6.5f;
+    measures.noiseType = (uint8_t)((int)noise % 5);
+    measures.lightIntensity = light;
+    measures.flickerPercent = noise / 4;
+    measures.flickerIndex = noise / 400;
+    measures.flickerFrequency = (uint16_t)(light % 2 ? 120 : 100);
+    measures.tvoc = tvoc;
+    measures.eC02 = eCO2;
+    measures.activity = activity;
+}
+
+static void set_stats(void) {
+    // A 10 s window closed for every measure, as reported most of the time.
+    size_t len = snprintf(stats, sizeof(stats), "{\"10s\":{");
+    const char *keys[] = { "temperature", "noiseLevel", "noisePeak", "noiseType", "lightIntensity",
+        "flickerPercent", "flickerIndex", "flickerFrequency", "tvoc", "eCO2", "activity" };
+    for (int i = 0; i < 11; i++) {
+        len += snprintf(stats + len, sizeof(stats) - len,
+            "%s\"%s\":{\"start\":1230000,\"n\":10,\"min\":12.25,\"max\":80.50,\"mean\":43.10,\"var\":3.125,\"p90\":71.00}",
+            i > 0 ? "," : "", keys[i]);
+    }
+    snprintf(stats + len, sizeof(stats) - len, "}}");
+}
+
+static int parse(const char *document, jsmntok_t *tokens) {
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    int count = jsmn_parse(&parser, document, strlen(document), tokens, MAX_TOKENS);
+    CHECK(count > 0);
+    return count;
+}
+
+// Compares two documents token by token; numbers may differ by the rounding
+// to 2 decimals.
+static void check_equivalent(const char *expected, const char *actual) {
+    jsmntok_t expectedTokens[MAX_TOKENS];
+    jsmntok_t actualTokens[MAX_TOKENS];
+    int count = parse(expected, expectedTokens);
+    CHECK(parse(actual, actualTokens) == count);
+
+    for (int i = 0; i < count; i++) {
+        const jsmntok_t *e = &expectedTokens[i];
+        const jsmntok_t *a = &actualTokens[i];
+        CHECK(e->type == a->type);
+        CHECK(e->size == a->size);
+        if (e->type == JSMN_OBJECT) {
+            continue;
+        }
+
+        const char *eText = expected + e->start;
+        const char *aText = actual + a->start;
+        int eLength = e->end - e->start;
+        int aLength = a->end - a->start;
+        char *end;
+        double eValue = strtod(eText, &end);
+        if (e->type == JSMN_PRIMITIVE && end == eText + eLength) {
+            double aValue = strtod(aText, &end);
+            CHECK(end == aText + aLength);
+            CHECK(fabs(eValue - aValue) <= 0.005 + 1e-9 * fabs(eValue));
+        } else {
+            CHECK(eLength == aLength && memcmp(eText, aText, eLength) == 0);
+        }
+    }
+}
+
+static void build(char *document, IoT_Error_t (*add_reported)(char *, size_t)) {
+    CHECK(aws_iot_shadow_init_json_document(document, DOCUMENT_SIZE) == SUCCESS);
+    CHECK(add_reported(document, DOCUMENT_SIZE) == SUCCESS);
+    CHECK(aws_iot_finalize_json_document(document, DOCUMENT_SIZE) == SUCCESS);
+}
+
+static void test_same_document(void) {
+    static char expected[DOCUMENT_SIZE];
+    static char actual[DOCUMENT_SIZE];
+
+    struct { float temperature; float noise; uint32_t light; uint16_t tvoc; uint16_t eCO2; float activity; } cases[] = {
+        { 71.6f, 45.2f, 245, 120, 400, 1.25f },
+        { 0, 0, 0, 0, 0, 0 },
+        { -3.999f, 0.005f, 4000000000u, 65535, 65535, 0.004f },
+        { 98.125f, 112.75f, 1, 60000, 400, 1234567.5f },
+    };
+    strcpy(notifications, "Open a window,Take a break");
+    notificationCount = 2;
+    set_stats();
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        set_measures(cases[c].temperature, cases[c].noise, cases[c].light, cases[c].tvoc, cases[c].eCO2, cases[c].activity);
+        build(expected, sdk_add_reported);
+        build(actual, table_add_reported);
+        // The client tokens differ by the counter only.
+        strcpy(strrchr(expected, '-'), "-0\"}");
+        strcpy(strrchr(actual, '-'), "-0\"}");
+        check_equivalent(expected, actual);
+    }
+}
+
+static void test_exact_formatting(void) {
+    static char document[DOCUMENT_SIZE];
+    const int8_t negative = -128;
+    const float nan = NAN;
+    const double tiny = -0.001;
+    const bool yes = true;
+    const hho_json_field_t fields[] = {
+        HHO_JSON_FIELD("a", SHADOW_JSON_INT8, &negative),
+        HHO_JSON_FIELD("b", SHADOW_JSON_FLOAT, &nan),
+        HHO_JSON_FIELD("c", SHADOW_JSON_DOUBLE, &tiny),
+        HHO_JSON_FIELD("d", SHADOW_JSON_BOOL, &yes),
+    };
+
+    CHECK(aws_iot_shadow_init_json_document(document, DOCUMENT_SIZE) == SUCCESS);
+    CHECK(HHO_Json_AddReported(document, DOCUMENT_SIZE, fields, 4) == SUCCESS);
+    CHECK(strcmp(document, "{\"state\":{\"reported\":{\"a\":-128,\"b\":null,\"c\":0.00,\"d\":true},") == 0);
+}
+
+static void test_truncation_leaves_document(void) {
+    char document[64];
+    CHECK(aws_iot_shadow_init_json_document(document, sizeof(document)) == SUCCESS);
+    char before[64];
+    strcpy(before, document);
+
+    CHECK(HHO_Json_AddReported(document, sizeof(document), reportedFields, REPORTED_FIELD_COUNT)
+        == SHADOW_JSON_BUFFER_TRUNCATED);
+    CHECK(strcmp(document, before) == 0);
+
+    const hho_json_field_t missing = HHO_JSON_FIELD("missing", SHADOW_JSON_UINT8, NULL);
+    CHECK(HHO_Json_AddReported(document, sizeof(document), &missing, 1) == NULL_VALUE_ERROR);
+    CHECK(strcmp(document, before) == 0);
+}
+
+static double time_ns_per_document(IoT_Error_t (*add_reported)(char *, size_t)) {
+    static char document[DOCUMENT_SIZE];
+    double start = test_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        measures.noiseLevel = (float)(i & 127);
+        aws_iot_shadow_init_json_document(document, DOCUMENT_SIZE);
+        add_reported(document, DOCUMENT_SIZE);
+    }
+    return (test_now_ns() - start) / ITERATIONS;
+}
+
+static void bench_add_reported(void) {
+    set_measures(71.6f, 45.2f, 245, 120, 400, 1.25f);
+
+    // Warm up both paths, then time them.
+    time_ns_per_document(sdk_add_reported);
+    time_ns_per_document(table_add_reported);
+    double sdk = time_ns_per_document(sdk_add_reported);
+    double table = time_ns_per_document(table_add_reported);
+
+    printf("aws_iot_shadow_add_reported: %.0f ns/document\n", sdk);
+    printf("HHO_Json_AddReported:        %.0f ns/document (%.1fx)\n", table, sdk / table);
+}
+
+int main(void) {
+    test_same_document();
+    test_exact_formatting();
+    test_truncation_leaves_document();
+    bench_add_reported();
+    printf("hho_json_bench: OK\n");
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file i2c_arbiter_test.c
+ * @brief Host tests for the I2C port arbitration: the service order of the
+ * wait queue and when a port has to be reconfigured.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "i2c_arbiter.h"
+#include "check.h"
+
+static i2c_waiter_t waiter(uint8_t priority, bool has_deadline, uint32_t deadline) {
+    return (i2c_waiter_t){ .priority = priority, .has_deadline = has_deadline, .deadline = deadline };
+}
+
+static void test_priority_then_deadline_then_arrival(void) {
+    i2c_wait_queue_t queue = { NULL };
+    i2c_waiter_t low = waiter(0, true, 10);
+    i2c_waiter_t normal_late = waiter(1, true, 500);
+    i2c_waiter_t normal_none_first = waiter(1, false, 0);
+    i2c_waiter_t normal_none_second = waiter(1, false, 0);
+    i2c_waiter_t normal_early = waiter(1, true, 100);
+    i2c_waiter_t high = waiter(2, false, 0);
+
+    i2c_wait_queue_insert(&queue, &low);
+    i2c_wait_queue_insert(&queue, &normal_none_first);
+    i2c_wait_queue_insert(&queue, &normal_late);
+    i2c_wait_queue_insert(&queue, &normal_none_second);
+    i2c_wait_queue_insert(&queue, &high);
+    i2c_wait_queue_insert(&queue, &normal_early);
+
+    CHECK(i2c_wait_queue_pop(&queue) == &high);
+    CHECK(i2c_wait_queue_pop(&queue) == &normal_early);
+    CHECK(i2c_wait_queue_pop(&queue) == &normal_late);
+    CHECK(i2c_wait_queue_pop(&queue) == &normal_none_first);
+    CHECK(i2c_wait_queue_pop(&queue) == &normal_none_second);
+    CHECK(i2c_wait_queue_pop(&queue) == &low);
+    CHECK(i2c_wait_queue_pop(&queue) == NULL);
+}
+
+static void test_deadlines_across_tick_wraparound(void) {
+    i2c_wait_queue_t queue = { NULL };
+    i2c_waiter_t after_wrap = waiter(1, true, 5);
+    i2c_waiter_t before_wrap = waiter(1, true, 0xFFFFFFF0u);
+
+    i2c_wait_queue_insert(&queue, &after_wrap);
+    i2c_wait_queue_insert(&queue, &before_wrap);
+    CHECK(i2c_wait_queue_pop(&queue) == &before_wrap);
+    CHECK(i2c_wait_queue_pop(&queue) == &after_wrap);
+}
+
+static void test_remove_expired_waiter(void) {
+    i2c_wait_queue_t queue = { NULL };
+    i2c_waiter_t a = waiter(1, false, 0);
+    i2c_waiter_t b = waiter(1, false, 0);
+    i2c_waiter_t c = waiter(1, false, 0);
+
+    i2c_wait_queue_insert(&queue, &a);
+    i2c_wait_queue_insert(&queue, &b);
+    i2c_wait_queue_insert(&queue, &c);
+    CHECK(i2c_wait_queue_remove(&queue, &b));
+    CHECK(!i2c_wait_queue_remove(&queue, &b));
+    CHECK(i2c_wait_queue_pop(&queue) == &a);
+    CHECK(i2c_wait_queue_pop(&queue) == &c);
+    CHECK(i2c_wait_queue_pop(&queue) == NULL);
+}
+
+static void test_bus_config_change(void) {
+    i2c_bus_config_t applied = { .sda = 21, .scl = 22, .freq = 400000 };
+    i2c_bus_config_t same = applied;
+    i2c_bus_config_t slower = { .sda = 21, .scl = 22, .freq = 100000 };
+    i2c_bus_config_t other_pins = { .sda = 32, .scl = 33, .freq = 400000 };
+
+    CHECK(i2c_bus_config_change(NULL, &same) == I2C_BUS_REINSTALL);
+    CHECK(i2c_bus_config_change(&applied, &same) == I2C_BUS_UNCHANGED);
+    CHECK(i2c_bus_config_change(&applied, &slower) == I2C_BUS_SET_CLOCK);
+    CHECK(i2c_bus_config_change(&applied, &other_pins) == I2C_BUS_REINSTALL);
+}
+
+int main(void) {
+    test_priority_then_deadline_then_arrival();
+    test_deadlines_across_tick_wraparound();
+    test_remove_expired_waiter();
+    test_bus_config_change();
+    printf("i2c_arbiter_test: OK\n");
+    return 0;
+}
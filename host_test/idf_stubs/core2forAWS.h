@@ -0,0 +1,4 @@
+#pragma once
+
+// The sound sensor only uses the microphone part of the board support.
+#include "microphone.h"
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+typedef enum { I2S_NUM_0, I2S_NUM_1 } i2s_port_t;
+
+typedef enum {
+    I2S_EVENT_DMA_ERROR,
+    I2S_EVENT_TX_DONE,
+    I2S_EVENT_RX_DONE,
+} i2s_event_type_t;
+
+typedef struct {
+    i2s_event_type_t type;
+    size_t size;
+} i2s_event_t;
+
+/** Blocks until samples fed with IdfStub_FeedMicrophone cover the request. */
+esp_err_t i2s_read(i2s_port_t port, void *dest, size_t size, size_t *bytesRead, TickType_t wait);
@@ -0,0 +1,20 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Just enough of FreeRTOS for the sound sensor to build on the host;
+ * tasks are pthreads (see idf_stubs.c).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct idf_stub_queue *QueueHandle_t;
+
+/** Always empty: the stubbed I2S driver posts no events. */
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
@@ -0,0 +1,104 @@
+/**
+ * @file idf_stubs.c
+ * @brief Host stand-ins for the FreeRTOS, I2S and microphone calls of the
+ * sound sensor. Tasks run as detached pthreads; the microphone reads the
+ * samples the test feeds it.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/i2s.h"
+#include "microphone.h"
+#include "idf_stubs.h"
+
+static pthread_mutex_t micLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t micChanged = PTHREAD_COND_INITIALIZER;
+static const int16_t *micSamples;
+static size_t micRemaining;
+static uint32_t micRate;
+
+typedef struct {
+    TaskFunction_t task;
+    void *parameters;
+} task_start_t;
+
+static void *run_task(void *arg) {
+    task_start_t start = *(task_start_t *)arg;
+    free(arg);
+    start.task(start.parameters);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stackDepth,
+        void *parameters, UBaseType_t priority, TaskHandle_t *created, BaseType_t core) {
+    task_start_t *start = malloc(sizeof(*start));
+    pthread_t thread;
+    if (start == NULL) {
+        return pdFALSE;
+    }
+    start->task = task;
+    start->parameters = parameters;
+    if (pthread_create(&thread, NULL, run_task, start) != 0) {
+        free(start);
+        return pdFALSE;
+    }
+    pthread_detach(thread);
+    if (created != NULL) {
+        *created = NULL;
+    }
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec delay = { .tv_sec = ticks / 1000, .tv_nsec = (ticks % 1000) * 1000000L };
+    nanosleep(&delay, NULL);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+    return pdFALSE;
+}
+
+esp_err_t Microphone_InitWithConfig(const microphone_config_t *config, QueueHandle_t *events) {
+    micRate = config->sample_rate;
+    if (events != NULL) {
+        *events = NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2s_read(i2s_port_t port, void *dest, size_t size, size_t *bytesRead, TickType_t wait) {
+    size_t wanted = size / sizeof(int16_t);
+    pthread_mutex_lock(&micLock);
+    while (micRemaining < wanted) {
+        pthread_cond_wait(&micChanged, &micLock);
+    }
+    memcpy(dest, micSamples, wanted * sizeof(int16_t));
+    micSamples += wanted;
+    micRemaining -= wanted;
+    pthread_cond_broadcast(&micChanged);
+    pthread_mutex_unlock(&micLock);
+
+    *bytesRead = wanted * sizeof(int16_t);
+    return ESP_OK;
+}
+
+void IdfStub_FeedMicrophone(const int16_t *samples, size_t count) {
+    pthread_mutex_lock(&micLock);
+    while (micRemaining > 0) {
+        pthread_cond_wait(&micChanged, &micLock);
+    }
+    micSamples = samples;
+    micRemaining = count;
+    pthread_cond_broadcast(&micChanged);
+    pthread_mutex_unlock(&micLock);
+}
+
+uint32_t IdfStub_MicrophoneRate(void) {
+    return micRate;
+}
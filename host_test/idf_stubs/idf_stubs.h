@@ -0,0 +1,21 @@
+/**
+ * @file idf_stubs.h
+ * @brief Controls of the host stand-ins for the ESP-IDF pieces the sound
+ * sensor uses: the microphone's I2S driver reads what the test feeds it.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Queues samples for the stubbed `i2s_read`, which hands them out in
+ * the sizes it is asked for. Blocks while earlier samples are still queued.
+ *
+ * @note The samples are not copied; keep them until the next call.
+ */
+void IdfStub_FeedMicrophone(const int16_t *samples, size_t count);
+
+/** @brief Returns the sample rate the sound sensor configured the microphone with. */
+uint32_t IdfStub_MicrophoneRate(void);
@@ -0,0 +1,142 @@
+/**
+ * @file measure_stats_test.c
+ * @brief Host tests for the streaming window statistics: Welford moments and
+ * the P-square percentile against exact two-pass results, and tumbling window
+ * boundaries.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "measure_stats.h"
+#include "check.h"
+#include "test_util.h"
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    CHECK(fabs((double)(actual) - (double)(expected)) <= (tolerance))
+
+#define SAMPLES 10000
+
+static float values[SAMPLES];
+
+static int compare_floats(const void *a, const void *b) {
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static float exact_quantile(const float *data, int count, float p) {
+    float *sorted = malloc(count * sizeof(float));
+    memcpy(sorted, data, count * sizeof(float));
+    qsort(sorted, count, sizeof(float), compare_floats);
+    float result = sorted[(int)lroundf(p * (count - 1))];
+    free(sorted);
+    return result;
+}
+
+static test_rng_t rng = { 12345 };
+
+static void test_small_sample_percentile_is_exact(void) {
+    p2_quantile_t estimator;
+    P2Quantile_Init(&estimator, 0.5f);
+    CHECK(P2Quantile_Get(&estimator) == 0);
+
+    P2Quantile_Add(&estimator, 3);
+    P2Quantile_Add(&estimator, 1);
+    P2Quantile_Add(&estimator, 2);
+    CHECK(P2Quantile_Get(&estimator) == 2);
+}
+
+static void test_running_stats_match_two_pass(void) {
+    running_stats_t stats;
+    RunningStats_Init(&stats, 0.9f);
+
+    double sum = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        // Large offset: catches the cancellation of a naive sum-of-squares.
+        values[i] = 1000.0f + test_gaussian(&rng) * 2.0f;
+        RunningStats_Add(&stats, values[i]);
+        sum += values[i];
+    }
+
+    double mean = sum / SAMPLES;
+    double m2 = 0;
+    float min = values[0], max = values[0];
+    for (int i = 0; i < SAMPLES; i++) {
+        m2 += (values[i] - mean) * (values[i] - mean);
+        min = fminf(min, values[i]);
+        max = fmaxf(max, values[i]);
+    }
+
+    CHECK(stats.count == SAMPLES);
+    CHECK(stats.min == min);
+    CHECK(stats.max == max);
+    printf("normal mean: welford %.5f exact %.5f\n", stats.mean, mean);
+    CHECK_NEAR(stats.mean, mean, 1e-2);
+    CHECK_NEAR(RunningStats_Variance(&stats), m2 / (SAMPLES - 1), 4.0 * 0.01);
+
+    float p90 = P2Quantile_Get(&stats.percentile);
+    float exact = exact_quantile(values, SAMPLES, 0.9f);
+    printf("normal p90: p2 %.4f exact %.4f\n", p90, exact);
+    CHECK_NEAR(p90, exact, 0.05 * 2.0);
+}
+
+static void test_percentile_on_skewed_data(void) {
+    const float quantiles[] = { 0.1f, 0.5f, 0.9f, 0.99f };
+
+    for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+        p2_quantile_t estimator;
+        P2Quantile_Init(&estimator, quantiles[q]);
+        for (int i = 0; i < SAMPLES; i++) {
+            // Exponential distribution, mean 10: a long tail like noise spikes.
+            values[i] = -10.0f * logf(test_uniform(&rng));
+            P2Quantile_Add(&estimator, values[i]);
+        }
+        float exact = exact_quantile(values, SAMPLES, quantiles[q]);
+        float estimate = P2Quantile_Get(&estimator);
+        printf("exponential p%.0f: p2 %.4f exact %.4f\n", quantiles[q] * 100, estimate, exact);
+        CHECK(fabsf(estimate - exact) <= 0.05f * exact + 0.1f);
+    }
+}
+
+static void test_tumbling_window_boundaries(void) {
+    tumbling_window_t window;
+    TumblingWindow_Init(&window, 10000, 0.9f);
+
+    // Two windows of 1 Hz samples starting mid-window, then a gap.
+    hho_sample_t sample;
+    bool closed = false;
+    for (uint32_t t = 5000; t < 20000; t += 1000) {
+        sample.timestamp_ms = t;
+        sample.value = t / 1000.0f;
+        closed = TumblingWindow_Add(&window, &sample);
+        CHECK(closed == (t == 10000));
+    }
+    CHECK(window.has_last);
+    CHECK(window.last.window_start_ms == 0);
+    CHECK(window.last.count == 5);
+    CHECK(window.last.min == 5);
+    CHECK(window.last.max == 9);
+    CHECK(window.last.mean == 7);
+    CHECK_NEAR(window.last.variance, 2.5, 1e-6);
+
+    sample.timestamp_ms = 45000;
+    sample.value = 0;
+    CHECK(TumblingWindow_Add(&window, &sample));
+    CHECK(window.last.window_start_ms == 10000);
+    CHECK(window.last.count == 10);
+    CHECK(window.last.mean == 14.5f);
+    CHECK(window.window_start_ms == 40000);
+    CHECK(window.current.count == 1);
+}
+
+int main(void) {
+    test_small_sample_percentile_is_exact();
+    test_running_stats_match_two_pass();
+    test_percentile_on_skewed_data();
+    test_tumbling_window_boundaries();
+    printf("measure_stats_test: OK\n");
+    return 0;
+}
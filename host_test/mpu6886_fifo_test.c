@@ -0,0 +1,93 @@
+/**
+ * @file mpu6886_fifo_test.c
+ * @brief Host tests for the MPU6886 FIFO packet decoding and the activity
+ * metric on a still and a moving device.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpu6886_fifo.h"
+#include "check.h"
+#include "test_util.h"
+
+#define SAMPLE_RATE_HZ 50.0f
+#define CUTOFF_HZ 0.5f
+
+static test_rng_t rng = { 12345 };
+
+static void test_decode_packet(void) {
+    const uint8_t packet[MPU6886_FIFO_PACKET_SIZE] = {
+        0x10, 0x00,     // ax = 4096
+        0xF0, 0x00,     // ay = -4096
+        0x00, 0x01,     // az = 1
+        0x0C, 0xC4,     // temp = 3268 -> 35 C
+        0x80, 0x00,     // gx = -32768
+        0x7F, 0xFF,     // gy = 32767
+        0xFF, 0xFF,     // gz = -1
+    };
+    mpu6886_fifo_sample_t sample;
+    MPU6886_DecodeFifoPacket(packet, &sample);
+
+    CHECK(sample.ax == 4096);
+    CHECK(sample.ay == -4096);
+    CHECK(sample.az == 1);
+    CHECK(sample.temp == 3268);
+    CHECK(sample.gx == -32768);
+    CHECK(sample.gy == 32767);
+    CHECK(sample.gz == -1);
+    CHECK(fabsf(MPU6886_TempAdcToCelsius(sample.temp) - 35.0f) < 1e-3f);
+}
+
+static void test_still_device_reads_noise_floor(void) {
+    mpu6886_activity_t activity;
+    MPU6886_Activity_Init(&activity, SAMPLE_RATE_HZ, CUTOFF_HZ);
+    CHECK(MPU6886_Activity_TakeRms(&activity) == 0);
+
+    // Tilted under gravity, with +-1 mg of uniform noise per axis.
+    for (int i = 0; i < 500; i++) {
+        MPU6886_Activity_Add(&activity,
+            0.2f + (test_uniform(&rng) - 0.5f) * 0.002f,
+            -0.1f + (test_uniform(&rng) - 0.5f) * 0.002f,
+            0.97f + (test_uniform(&rng) - 0.5f) * 0.002f);
+    }
+    float rms = MPU6886_Activity_TakeRms(&activity);
+    printf("still: %.5f g\n", rms);
+    CHECK(rms < 0.002f);
+}
+
+static void test_motion_is_detected(void) {
+    mpu6886_activity_t activity;
+    MPU6886_Activity_Init(&activity, SAMPLE_RATE_HZ, CUTOFF_HZ);
+
+    // Settle on gravity, then a 2 Hz 0.1 g vibration on X.
+    for (int i = 0; i < 100; i++) {
+        MPU6886_Activity_Add(&activity, 0, 0, 1);
+    }
+    MPU6886_Activity_TakeRms(&activity);
+    for (int i = 0; i < 500; i++) {
+        float x = 0.1f * sinf(6.2831853f * 2.0f * i / SAMPLE_RATE_HZ);
+        MPU6886_Activity_Add(&activity, x, 0, 1);
+    }
+    float rms = MPU6886_Activity_TakeRms(&activity);
+    printf("2 Hz 0.1 g vibration: %.5f g\n", rms);
+    // A sine's RMS is amplitude / sqrt(2); the filter passes 2 Hz almost fully.
+    CHECK(fabsf(rms - 0.0707f) < 0.005f);
+
+    // A slow tilt is filtered out like gravity.
+    for (int i = 0; i < 500; i++) {
+        MPU6886_Activity_Add(&activity, 0.3f * i / 500.0f, 0, 1);
+    }
+    rms = MPU6886_Activity_TakeRms(&activity);
+    printf("slow tilt: %.5f g\n", rms);
+    CHECK(rms < 0.02f);
+}
+
+int main(void) {
+    test_decode_packet();
+    test_still_device_reads_noise_floor();
+    test_motion_is_detected();
+    printf("mpu6886_fifo_test: OK\n");
+    return 0;
+}
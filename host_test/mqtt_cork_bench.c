@@ -0,0 +1,302 @@
+/**
+ * @file mqtt_cork_bench.c
+ * @brief Counts the records and bytes the AWS IoT MQTT client puts on the
+ * wire while answering shadow-style deltas from a stand-in broker on the
+ * loopback interface. Each QoS 1 delta gets a PUBACK and a reported update;
+ * sent as they are written that is two records, corked around the yield and
+ * the reply one. The loopback network layer counts a record per send and adds
+ * the framing of a TLS 1.2 AES-GCM record to the wire bytes. Also checks that
+ * a subscribe still gets its SUBACK while corked and that a cork left open is
+ * flushed by yield once its deadline passes.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "aws_iot_config.h"
+#include "aws_iot_mqtt_client_interface.h"
+#include "check.h"
+#include "test_util.h"
+
+#define DELTAS 64
+#define DELTA_LEN 96
+#define REPORT_LEN 160
+#define CORK_MS 50
+#define DEADLINE_CORK_MS 5
+#define COMMAND_TIMEOUT_MS 500
+// Framing the loopback layer adds to each record
+#define RECORD_OVERHEAD 29
+#define DELTA_TOPIC "hho/bench/shadow/delta"
+#define REPORT_TOPIC "hho/bench/shadow/update"
+
+typedef struct {
+    int listenFd;
+    uint16_t port;
+    // Counted by the broker thread, read after it is joined
+    int deltas;
+    int pubacks;
+    int reports;
+    pthread_t thread;
+} broker_t;
+
+static unsigned char report[REPORT_LEN];
+
+static void send_all(int fd, const unsigned char *data, size_t len) {
+    while (len > 0) {
+        ssize_t ret = send(fd, data, len, MSG_NOSIGNAL);
+        if (ret <= 0) {
+            return;
+        }
+        data += ret;
+        len -= (size_t)ret;
+    }
+}
+
+static void send_delta(int fd, uint16_t id) {
+    unsigned char packet[2 + 2 + sizeof(DELTA_TOPIC) - 1 + 2 + DELTA_LEN];
+    size_t pos = 0;
+
+    packet[pos++] = 0x32;
+    packet[pos++] = (unsigned char)(sizeof(packet) - 2);
+    packet[pos++] = 0;
+    packet[pos++] = (unsigned char)(sizeof(DELTA_TOPIC) - 1);
+    memcpy(packet + pos, DELTA_TOPIC, sizeof(DELTA_TOPIC) - 1);
+    pos += sizeof(DELTA_TOPIC) - 1;
+    packet[pos++] = id >> 8;
+    packet[pos++] = id & 0xFF;
+    memset(packet + pos, 'd', DELTA_LEN);
+    send_all(fd, packet, sizeof(packet));
+}
+
+// Serves one client connection: CONNACK, SUBACK, PINGRESP, and the next
+// delta once the previous one is acknowledged and answered.
+static void *broker_run(void *arg) {
+    broker_t *broker = arg;
+    static unsigned char rx[16384];
+    size_t rxLen = 0;
+    int open = 1;
+    int subscribed = 0;
+    int one = 1;
+    int fd = accept(broker->listenFd, NULL, NULL);
+    CHECK(fd >= 0);
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    while (open) {
+        ssize_t ret = recv(fd, rx + rxLen, sizeof(rx) - rxLen, 0);
+        if (ret <= 0) {
+            break;
+        }
+        rxLen += (size_t)ret;
+
+        // Handle every complete packet in the buffer
+        for (;;) {
+            size_t pos = 1, remaining = 0, multiplier = 1;
+            while (pos < rxLen && pos < 5) {
+                remaining += (rx[pos] & 0x7F) * multiplier;
+                multiplier *= 128;
+                if ((rx[pos++] & 0x80) == 0) {
+                    break;
+                }
+            }
+            if (rxLen < 2 || (rx[pos - 1] & 0x80) != 0 || rxLen < pos + remaining) {
+                break;
+            }
+
+            unsigned char type = rx[0] >> 4;
+            if (type == 1) {
+                static const unsigned char connack[] = { 0x20, 0x02, 0x00, 0x00 };
+                send_all(fd, connack, sizeof(connack));
+            } else if (type == 8) {
+                unsigned char suback[] = { 0x90, 0x03, rx[pos], rx[pos + 1], 0x01 };
+                send_all(fd, suback, sizeof(suback));
+                subscribed = 1;
+            } else if (type == 4) {
+                broker->pubacks++;
+            } else if (type == 3) {
+                broker->reports++;
+            } else if (type == 12) {
+                static const unsigned char pingresp[] = { 0xD0, 0x00 };
+                send_all(fd, pingresp, sizeof(pingresp));
+            } else if (type == 14) {
+                open = 0;
+            }
+
+            memmove(rx, rx + pos + remaining, rxLen - pos - remaining);
+            rxLen -= pos + remaining;
+        }
+
+        if (subscribed && broker->deltas < DELTAS
+            && broker->pubacks == broker->deltas && broker->reports >= broker->deltas) {
+            broker->deltas++;
+            send_delta(fd, (uint16_t)broker->deltas);
+        }
+    }
+
+    close(fd);
+    return NULL;
+}
+
+static void broker_listen(broker_t *broker) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addrLen = sizeof(addr);
+
+    broker->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(broker->listenFd >= 0);
+    CHECK(bind(broker->listenFd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    CHECK(listen(broker->listenFd, 1) == 0);
+    CHECK(getsockname(broker->listenFd, (struct sockaddr *)&addr, &addrLen) == 0);
+    broker->port = ntohs(addr.sin_port);
+}
+
+static void on_delta(AWS_IoT_Client *client, char *topic, uint16_t topicLen,
+        IoT_Publish_Message_Params *params, void *data) {
+    (*(int *)data)++;
+}
+
+static void session_start(broker_t *broker, AWS_IoT_Client *client, int cork, int *received) {
+    IoT_Client_Init_Params initParams = iotClientInitParamsDefault;
+    IoT_Client_Connect_Params connectParams = iotClientConnectParamsDefault;
+
+    broker->deltas = 0;
+    broker->pubacks = 0;
+    broker->reports = 0;
+    CHECK(pthread_create(&broker->thread, NULL, broker_run, broker) == 0);
+
+    initParams.enableAutoReconnect = false;
+    initParams.pHostURL = AWS_IOT_MQTT_HOST;
+    initParams.port = broker->port;
+    initParams.pRootCALocation = "";
+    initParams.pDeviceCertLocation = "";
+    initParams.pDevicePrivateKeyLocation = "";
+    initParams.mqttCommandTimeout_ms = COMMAND_TIMEOUT_MS;
+    CHECK(aws_iot_mqtt_init(client, &initParams) == SUCCESS);
+
+    connectParams.pClientID = AWS_IOT_MQTT_CLIENT_ID;
+    connectParams.clientIDLen = (uint16_t)strlen(AWS_IOT_MQTT_CLIENT_ID);
+    CHECK(aws_iot_mqtt_connect(client, &connectParams) == SUCCESS);
+
+    // Waiting for the SUBACK must send the SUBSCRIBE held back by the cork
+    if (cork) {
+        CHECK(aws_iot_mqtt_cork(client, CORK_MS) == SUCCESS);
+    }
+    CHECK(aws_iot_mqtt_subscribe(client, DELTA_TOPIC, strlen(DELTA_TOPIC), QOS1, on_delta, received) == SUCCESS);
+    CHECK(aws_iot_mqtt_uncork(client) == SUCCESS);
+}
+
+static void session_end(broker_t *broker, AWS_IoT_Client *client) {
+    CHECK(aws_iot_mqtt_disconnect(client) == SUCCESS);
+    pthread_join(broker->thread, NULL);
+}
+
+static void publish_report(AWS_IoT_Client *client) {
+    IoT_Publish_Message_Params params;
+
+    memset(&params, 0, sizeof(params));
+    params.qos = QOS0;
+    params.payload = report;
+    params.payloadLen = sizeof(report);
+    CHECK(aws_iot_mqtt_publish(client, REPORT_TOPIC, strlen(REPORT_TOPIC), &params) == SUCCESS);
+}
+
+// Answers every delta with a PUBACK and a report; returns what they put on the wire.
+static IoT_Network_Stats run_deltas(broker_t *broker, int cork) {
+    AWS_IoT_Client client;
+    IoT_Network_Stats before, stats;
+    int received = 0;
+
+    session_start(broker, &client, cork, &received);
+    before = client.networkStack.stats;
+    for (int i = 0; i < DELTAS; i++) {
+        if (cork) {
+            CHECK(aws_iot_mqtt_cork(&client, CORK_MS) == SUCCESS);
+        }
+        // The PUBACK is written by the yield that reads the delta
+        while (received == i) {
+            CHECK(aws_iot_mqtt_yield(&client, 1) == SUCCESS);
+        }
+        publish_report(&client);
+        if (cork) {
+            CHECK(aws_iot_mqtt_uncork(&client) == SUCCESS);
+        }
+    }
+    stats.messages = client.networkStack.stats.messages - before.messages;
+    stats.records = client.networkStack.stats.records - before.records;
+    stats.wireBytes = client.networkStack.stats.wireBytes - before.wireBytes;
+
+    session_end(broker, &client);
+    CHECK(broker->deltas == DELTAS);
+    CHECK(broker->pubacks == DELTAS);
+    CHECK(broker->reports == DELTAS);
+    return stats;
+}
+
+// Leaves a cork open and checks that yield sends the report once it expires.
+static void run_deadline(broker_t *broker) {
+    AWS_IoT_Client client;
+    int received = 0;
+
+    session_start(broker, &client, 0, &received);
+    uint32_t records = client.networkStack.stats.records;
+    CHECK(aws_iot_mqtt_cork(&client, DEADLINE_CORK_MS) == SUCCESS);
+    publish_report(&client);
+    CHECK(client.networkStack.stats.records == records);
+    CHECK(aws_iot_mqtt_get_next_yield_ms(&client) <= DEADLINE_CORK_MS);
+
+    int64_t start = test_now_ns();
+    while (client.networkStack.stats.records == records) {
+        CHECK(aws_iot_mqtt_yield(&client, 1) == SUCCESS);
+        CHECK(test_now_ns() - start < COMMAND_TIMEOUT_MS * 1000000LL);
+    }
+    double heldMs = (test_now_ns() - start) / 1e6;
+    printf("expired cork:       report sent after %.1f ms (deadline %d ms)\n", heldMs, DEADLINE_CORK_MS);
+    CHECK(heldMs >= DEADLINE_CORK_MS - 1);
+
+    // The broker has answered the subscription with the first delta meanwhile
+    while (received == 0) {
+        CHECK(aws_iot_mqtt_yield(&client, 1) == SUCCESS);
+    }
+    session_end(broker, &client);
+    CHECK(broker->reports == 1);
+    CHECK(broker->pubacks == 1);
+}
+
+static void print_stats(const char *label, const IoT_Network_Stats *stats) {
+    printf("%-19s %u messages in %3u records, %.2f records/message, %u bytes on the wire\n",
+        label, stats->messages, stats->records, (double)stats->records / stats->messages, stats->wireBytes);
+}
+
+int main(void) {
+    broker_t broker;
+
+    for (size_t i = 0; i < sizeof(report); i++) {
+        report[i] = (unsigned char)('a' + i % 26);
+    }
+    broker_listen(&broker);
+
+    IoT_Network_Stats plain = run_deltas(&broker, 0);
+    print_stats("uncorked:", &plain);
+    CHECK(plain.messages == DELTAS * 2);
+    CHECK(plain.records == DELTAS * 2);
+
+    IoT_Network_Stats corked = run_deltas(&broker, 1);
+    print_stats("corked:", &corked);
+    CHECK(corked.messages == DELTAS * 2);
+    CHECK(corked.records == DELTAS);
+    // Same payload, one record's framing saved per delta
+    CHECK(plain.wireBytes - corked.wireBytes == DELTAS * RECORD_OVERHEAD);
+    printf("saved:              %u bytes (%.1f%%)\n", plain.wireBytes - corked.wireBytes,
+        100.0 * (plain.wireBytes - corked.wireBytes) / plain.wireBytes);
+
+    run_deadline(&broker);
+
+    close(broker.listenFd);
+    printf("mqtt_cork_bench: OK\n");
+    return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file aws_iot_config.h
+ * @brief AWS IoT SDK configuration for the host MQTT benchmarks.
+ *
+ * Follows the esp-aws-iot port's configuration with the values of the
+ * app's sdkconfig.defaults, but single threaded and without logging.
+ */
+
+#ifndef _AWS_IOT_CONFIG_H_
+#define _AWS_IOT_CONFIG_H_
+
+#include "aws_iot_log.h"
+
+#define AWS_IOT_MQTT_HOST              "127.0.0.1"
+#define AWS_IOT_MQTT_PORT              1883
+#define AWS_IOT_MQTT_CLIENT_ID         "hho-host-bench"
+#define AWS_IOT_MY_THING_NAME          "hho-host-bench"
+
+// MQTT PubSub
+#define AWS_IOT_MQTT_TX_BUF_LEN 512
+#define AWS_IOT_MQTT_RX_BUF_LEN 4096
+#ifndef AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS
+#define AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS 5
+#endif
+#define AWS_IOT_MQTT_PUBLISH_WINDOW 8
+
+// Auto Reconnect specific config
+#define AWS_IOT_MQTT_MIN_RECONNECT_WAIT_INTERVAL 1000
+#define AWS_IOT_MQTT_MAX_RECONNECT_WAIT_INTERVAL 128000
+
+#endif /* _AWS_IOT_CONFIG_H_ */
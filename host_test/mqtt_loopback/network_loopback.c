@@ -0,0 +1,253 @@
+/**
+ * @file network_loopback.c
+ * @brief Plain TCP implementation of the AWS IoT SDK network interface, for
+ * running the MQTT client on the host against a stand-in broker. Reads and
+ * writes keep the timeout and return code conventions of the Linux mbedTLS
+ * wrapper; writev maps onto sendmsg. Cork holds writes back like the device's
+ * wrapper does, and each sendmsg is counted in the write counters as if it
+ * were one TLS record.
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "network_interface.h"
+
+#define LOOPBACK_MAX_IOV 16
+
+// Record header, explicit nonce and tag of TLS 1.2 with AES-GCM, as AWS IoT negotiates it
+#define LOOPBACK_RECORD_OVERHEAD 29
+
+static int wait_for(int fd, short events, Timer *timer) {
+    struct pollfd pfd = { .fd = fd, .events = events };
+    int ret = poll(&pfd, 1, (int)left_ms(timer));
+    return ret > 0 && (pfd.revents & (events | POLLERR | POLLHUP));
+}
+
+IoT_Error_t iot_tls_init(Network *pNetwork, const char *pRootCALocation, const char *pDeviceCertLocation,
+        const char *pDevicePrivateKeyLocation, const char *pDestinationURL,
+        uint16_t destinationPort, uint32_t timeout_ms, bool ServerVerificationFlag) {
+    pNetwork->tlsConnectParams.pRootCALocation = pRootCALocation;
+    pNetwork->tlsConnectParams.pDeviceCertLocation = pDeviceCertLocation;
+    pNetwork->tlsConnectParams.pDevicePrivateKeyLocation = pDevicePrivateKeyLocation;
+    pNetwork->tlsConnectParams.pDestinationURL = pDestinationURL;
+    pNetwork->tlsConnectParams.DestinationPort = destinationPort;
+    pNetwork->tlsConnectParams.timeout_ms = timeout_ms;
+    pNetwork->tlsConnectParams.ServerVerificationFlag = ServerVerificationFlag;
+
+    pNetwork->connect = iot_tls_connect;
+    pNetwork->read = iot_tls_read;
+    pNetwork->write = iot_tls_write;
+    pNetwork->writev = iot_tls_writev;
+    pNetwork->cork = iot_tls_cork;
+    pNetwork->uncork = iot_tls_uncork;
+    pNetwork->disconnect = iot_tls_disconnect;
+    pNetwork->isConnected = iot_tls_is_connected;
+    pNetwork->destroy = iot_tls_destroy;
+
+    pNetwork->tlsDataParams.fd = -1;
+    pNetwork->tlsDataParams.flags = 0;
+
+    return SUCCESS;
+}
+
+IoT_Error_t iot_tls_connect(Network *pNetwork, TLSConnectParams *params) {
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *addr;
+    char port[8];
+    int one = 1;
+    int fd;
+
+    if (params != NULL) {
+        pNetwork->tlsConnectParams = *params;
+    }
+
+    snprintf(port, sizeof(port), "%u", pNetwork->tlsConnectParams.DestinationPort);
+    if (getaddrinfo(pNetwork->tlsConnectParams.pDestinationURL, port, &hints, &addr) != 0) {
+        return NETWORK_ERR_NET_UNKNOWN_HOST;
+    }
+    fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(addr);
+        return NETWORK_ERR_NET_SOCKET_FAILED;
+    }
+    if (connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+        freeaddrinfo(addr);
+        close(fd);
+        return NETWORK_ERR_NET_CONNECT_FAILED;
+    }
+    freeaddrinfo(addr);
+
+    // MQTT packets are small; do not hold them back for coalescing
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    pNetwork->tlsDataParams.fd = fd;
+    pNetwork->tlsDataParams.txLen = 0;
+    pNetwork->tlsDataParams.corked = false;
+
+    return SUCCESS;
+}
+
+IoT_Error_t iot_tls_is_connected(Network *pNetwork) {
+    return pNetwork->tlsDataParams.fd >= 0 ? NETWORK_PHYSICAL_LAYER_CONNECTED : NETWORK_PHYSICAL_LAYER_DISCONNECTED;
+}
+
+static IoT_Error_t send_segments(Network *pNetwork, const IoT_IOVec *pSegments, size_t segmentCount, Timer *timer,
+        size_t *written_len) {
+    struct iovec iov[LOOPBACK_MAX_IOV];
+    struct msghdr msg = { .msg_iov = iov };
+    size_t first = 0;
+    size_t offset = 0;
+    size_t written = 0;
+    size_t i;
+    ssize_t ret;
+
+    while (first < segmentCount) {
+        msg.msg_iovlen = 0;
+        for (i = first; i < segmentCount && msg.msg_iovlen < LOOPBACK_MAX_IOV; i++) {
+            iov[msg.msg_iovlen].iov_base = (void *)(pSegments[i].pBase + (i == first ? offset : 0));
+            iov[msg.msg_iovlen].iov_len = pSegments[i].len - (i == first ? offset : 0);
+            msg.msg_iovlen++;
+        }
+
+        ret = sendmsg(pNetwork->tlsDataParams.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (ret < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                *written_len = written;
+                return NETWORK_SSL_WRITE_ERROR;
+            }
+            if (!wait_for(pNetwork->tlsDataParams.fd, POLLOUT, timer)) {
+                *written_len = written;
+                return NETWORK_SSL_WRITE_TIMEOUT_ERROR;
+            }
+            continue;
+        }
+
+        pNetwork->stats.records++;
+        pNetwork->stats.wireBytes += (uint32_t)ret + LOOPBACK_RECORD_OVERHEAD;
+        written += (size_t)ret;
+        offset += (size_t)ret;
+        while (first < segmentCount && offset >= pSegments[first].len) {
+            offset -= pSegments[first].len;
+            first++;
+        }
+    }
+
+    *written_len = written;
+    return SUCCESS;
+}
+
+static IoT_Error_t flush_cork(Network *pNetwork, Timer *timer) {
+    TLSDataParams *tls = &pNetwork->tlsDataParams;
+    IoT_IOVec segment = { .pBase = tls->txBuf, .len = tls->txLen };
+    size_t written;
+    IoT_Error_t rc = SUCCESS;
+
+    if (tls->txLen > 0) {
+        rc = send_segments(pNetwork, &segment, 1, timer, &written);
+        tls->txLen = 0;
+    }
+    return rc;
+}
+
+IoT_Error_t iot_tls_writev(Network *pNetwork, const IoT_IOVec *pSegments, size_t segmentCount, Timer *timer,
+        size_t *written_len) {
+    TLSDataParams *tls = &pNetwork->tlsDataParams;
+    size_t written = 0;
+    size_t segment_written;
+    IoT_Error_t rc = SUCCESS;
+
+    pNetwork->stats.messages++;
+    if (!tls->corked) {
+        return send_segments(pNetwork, pSegments, segmentCount, timer, written_len);
+    }
+
+    for (size_t i = 0; i < segmentCount && rc == SUCCESS; i++) {
+        if (pSegments[i].len > sizeof(tls->txBuf) - tls->txLen) {
+            rc = flush_cork(pNetwork, timer);
+            if (rc != SUCCESS) {
+                break;
+            }
+        }
+        if (pSegments[i].len > sizeof(tls->txBuf)) {
+            rc = send_segments(pNetwork, &pSegments[i], 1, timer, &segment_written);
+            written += segment_written;
+        } else {
+            memcpy(tls->txBuf + tls->txLen, pSegments[i].pBase, pSegments[i].len);
+            tls->txLen += pSegments[i].len;
+            written += pSegments[i].len;
+        }
+    }
+
+    *written_len = written;
+    return rc;
+}
+
+IoT_Error_t iot_tls_cork(Network *pNetwork) {
+    pNetwork->tlsDataParams.corked = true;
+    return SUCCESS;
+}
+
+IoT_Error_t iot_tls_uncork(Network *pNetwork, Timer *timer) {
+    pNetwork->tlsDataParams.corked = false;
+    return flush_cork(pNetwork, timer);
+}
+
+IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Timer *timer, size_t *written_len) {
+    IoT_IOVec segment = { .pBase = pMsg, .len = len };
+    return iot_tls_writev(pNetwork, &segment, 1, timer, written_len);
+}
+
+IoT_Error_t iot_tls_read(Network *pNetwork, unsigned char *pMsg, size_t len, Timer *timer, size_t *read_len) {
+    size_t rxLen = 0;
+    ssize_t ret;
+
+    while (len > 0) {
+        if (wait_for(pNetwork->tlsDataParams.fd, POLLIN, timer)) {
+            ret = recv(pNetwork->tlsDataParams.fd, pMsg, len, 0);
+            if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EINTR)) {
+                return NETWORK_SSL_READ_ERROR;
+            }
+            if (ret > 0) {
+                rxLen += (size_t)ret;
+                pMsg += ret;
+                len -= (size_t)ret;
+            }
+        }
+
+        // Evaluate timeout after the read to make sure read is done at least once
+        if (has_timer_expired(timer)) {
+            break;
+        }
+    }
+
+    // The client keeps what was read of a packet and reads the rest later
+    *read_len = rxLen;
+    if (len == 0) {
+        return SUCCESS;
+    }
+
+    return rxLen == 0 ? NETWORK_SSL_NOTHING_TO_READ : NETWORK_SSL_READ_TIMEOUT_ERROR;
+}
+
+IoT_Error_t iot_tls_disconnect(Network *pNetwork) {
+    if (pNetwork->tlsDataParams.fd >= 0) {
+        shutdown(pNetwork->tlsDataParams.fd, SHUT_RDWR);
+    }
+    return SUCCESS;
+}
+
+IoT_Error_t iot_tls_destroy(Network *pNetwork) {
+    if (pNetwork->tlsDataParams.fd >= 0) {
+        close(pNetwork->tlsDataParams.fd);
+        pNetwork->tlsDataParams.fd = -1;
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file network_platform.h
+ * @brief Connection state of the host loopback network layer.
+ *
+ * Takes the place of platform/linux/mbedtls/network_platform.h: the host
+ * benchmarks talk plain TCP to a stand-in broker, as mbedTLS is not part of
+ * this tree.
+ */
+
+#ifndef IOTSDKC_NETWORK_MBEDTLS_PLATFORM_H_H
+#define IOTSDKC_NETWORK_MBEDTLS_PLATFORM_H_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Writes held back between iot_tls_cork and iot_tls_uncork, as on the device */
+#define LOOPBACK_CORK_BUF_LEN 1024
+
+typedef struct _TLSDataParams {
+    int fd;            ///< Connected socket, -1 when closed
+    uint32_t flags;
+    unsigned char txBuf[LOOPBACK_CORK_BUF_LEN];
+    size_t txLen;
+    bool corked;
+} TLSDataParams;
+
+#endif //IOTSDKC_NETWORK_MBEDTLS_PLATFORM_H_H
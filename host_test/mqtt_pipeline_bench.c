@@ -0,0 +1,327 @@
+/**
+ * @file mqtt_pipeline_bench.c
+ * @brief Measures QoS 1 publish throughput of the AWS IoT MQTT client against
+ * a stand-in broker on the loopback interface, which acknowledges every
+ * publish one simulated round trip after receiving it. Compares
+ * `aws_iot_mqtt_publish`, which waits for each PUBACK, with
+ * `aws_iot_mqtt_publish_async` and its in-flight window, and checks that
+ * unacknowledged publishes are sent again with the DUP flag and fail when the
+ * client disconnects.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "aws_iot_config.h"
+#include "aws_iot_mqtt_client_interface.h"
+#include "check.h"
+#include "test_util.h"
+
+#define MESSAGES 64
+#define PAYLOAD_LEN 200
+#define ROUND_TRIP_MS 10
+#define COMMAND_TIMEOUT_MS 500
+#define DUP_TIMEOUT_MS 50
+#define DROPPED_PUBACKS 4
+#define MAX_PENDING_ACKS 256
+#define TOPIC "hho/bench/telemetry"
+
+typedef struct {
+    int listenFd;
+    uint16_t port;
+    // Ignore the first transmission of this many QoS 1 publishes
+    int dropFirst;
+    // Counted by the broker thread, read after it is joined
+    int publishes;
+    int duplicates;
+    pthread_t thread;
+} broker_t;
+
+typedef struct {
+    int succeeded;
+    int failed;
+} completions_t;
+
+static unsigned char payload[PAYLOAD_LEN];
+
+static void send_all(int fd, const unsigned char *data, size_t len) {
+    while (len > 0) {
+        ssize_t ret = send(fd, data, len, MSG_NOSIGNAL);
+        if (ret <= 0) {
+            return;
+        }
+        data += ret;
+        len -= (size_t)ret;
+    }
+}
+
+// Serves one client connection: CONNACK, PINGRESP and delayed PUBACKs.
+static void *broker_run(void *arg) {
+    broker_t *broker = arg;
+    static unsigned char rx[16384];
+    struct {
+        uint16_t id;
+        int64_t due;
+    } acks[MAX_PENDING_ACKS];
+    size_t rxLen = 0;
+    int ackHead = 0, ackTail = 0;
+    int dropped = 0;
+    int open = 1;
+    int one = 1;
+    int fd = accept(broker->listenFd, NULL, NULL);
+    CHECK(fd >= 0);
+    // Without this, Nagle holds back-to-back PUBACKs for the client's delayed ACK
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    while (open || ackHead != ackTail) {
+        int timeout = 100;
+        if (ackHead != ackTail) {
+            int64_t wait = acks[ackHead].due - test_now_ns();
+            timeout = wait > 0 ? (int)(wait / 1000000) + 1 : 0;
+        }
+
+        if (open) {
+            struct pollfd pfd = { .fd = fd, .events = POLLIN };
+            if (poll(&pfd, 1, timeout) > 0) {
+                ssize_t ret = recv(fd, rx + rxLen, sizeof(rx) - rxLen, 0);
+                if (ret <= 0) {
+                    open = 0;
+                } else {
+                    rxLen += (size_t)ret;
+                }
+            }
+        } else {
+            ackHead = ackTail;
+        }
+
+        // Handle every complete packet in the buffer
+        for (;;) {
+            size_t pos = 1, remaining = 0, multiplier = 1;
+            while (pos < rxLen && pos < 5) {
+                remaining += (rx[pos] & 0x7F) * multiplier;
+                multiplier *= 128;
+                if ((rx[pos++] & 0x80) == 0) {
+                    break;
+                }
+            }
+            if (rxLen < 2 || (rx[pos - 1] & 0x80) != 0 || rxLen < pos + remaining) {
+                break;
+            }
+
+            unsigned char type = rx[0] >> 4;
+            if (type == 1) {
+                static const unsigned char connack[] = { 0x20, 0x02, 0x00, 0x00 };
+                send_all(fd, connack, sizeof(connack));
+            } else if (type == 3 && ((rx[0] >> 1) & 3) == 1) {
+                size_t topicLen = ((size_t)rx[pos] << 8) | rx[pos + 1];
+                uint16_t id = (uint16_t)((rx[pos + 2 + topicLen] << 8) | rx[pos + 3 + topicLen]);
+                int dup = (rx[0] >> 3) & 1;
+                broker->publishes++;
+                broker->duplicates += dup;
+                if (!dup && dropped < broker->dropFirst) {
+                    dropped++;
+                } else {
+                    CHECK((ackTail + 1) % MAX_PENDING_ACKS != ackHead);
+                    acks[ackTail].id = id;
+                    acks[ackTail].due = test_now_ns() + ROUND_TRIP_MS * 1000000LL;
+                    ackTail = (ackTail + 1) % MAX_PENDING_ACKS;
+                }
+            } else if (type == 3) {
+                broker->publishes++;
+            } else if (type == 12) {
+                static const unsigned char pingresp[] = { 0xD0, 0x00 };
+                send_all(fd, pingresp, sizeof(pingresp));
+            } else if (type == 14) {
+                open = 0;
+            }
+
+            memmove(rx, rx + pos + remaining, rxLen - pos - remaining);
+            rxLen -= pos + remaining;
+        }
+
+        while (ackHead != ackTail && acks[ackHead].due <= test_now_ns()) {
+            unsigned char puback[] = { 0x40, 0x02, acks[ackHead].id >> 8, acks[ackHead].id & 0xFF };
+            send_all(fd, puback, sizeof(puback));
+            ackHead = (ackHead + 1) % MAX_PENDING_ACKS;
+        }
+    }
+
+    close(fd);
+    return NULL;
+}
+
+static void broker_listen(broker_t *broker) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addrLen = sizeof(addr);
+
+    broker->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(broker->listenFd >= 0);
+    CHECK(bind(broker->listenFd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    CHECK(listen(broker->listenFd, 1) == 0);
+    CHECK(getsockname(broker->listenFd, (struct sockaddr *)&addr, &addrLen) == 0);
+    broker->port = ntohs(addr.sin_port);
+}
+
+static void session_start(broker_t *broker, AWS_IoT_Client *client, int dropFirst, uint32_t commandTimeoutMs) {
+    IoT_Client_Init_Params initParams = iotClientInitParamsDefault;
+    IoT_Client_Connect_Params connectParams = iotClientConnectParamsDefault;
+
+    broker->dropFirst = dropFirst;
+    broker->publishes = 0;
+    broker->duplicates = 0;
+    CHECK(pthread_create(&broker->thread, NULL, broker_run, broker) == 0);
+
+    initParams.enableAutoReconnect = false;
+    initParams.pHostURL = AWS_IOT_MQTT_HOST;
+    initParams.port = broker->port;
+    initParams.pRootCALocation = "";
+    initParams.pDeviceCertLocation = "";
+    initParams.pDevicePrivateKeyLocation = "";
+    initParams.mqttCommandTimeout_ms = commandTimeoutMs;
+    CHECK(aws_iot_mqtt_init(client, &initParams) == SUCCESS);
+
+    connectParams.pClientID = AWS_IOT_MQTT_CLIENT_ID;
+    connectParams.clientIDLen = (uint16_t)strlen(AWS_IOT_MQTT_CLIENT_ID);
+    CHECK(aws_iot_mqtt_connect(client, &connectParams) == SUCCESS);
+}
+
+static void session_end(broker_t *broker, AWS_IoT_Client *client) {
+    CHECK(aws_iot_mqtt_disconnect(client) == SUCCESS);
+    pthread_join(broker->thread, NULL);
+}
+
+static void on_complete(AWS_IoT_Client *client, uint16_t packetId, IoT_Error_t status, void *data) {
+    completions_t *completions = data;
+    if (status == SUCCESS) {
+        completions->succeeded++;
+    } else {
+        completions->failed++;
+    }
+}
+
+static void publish_params(IoT_Publish_Message_Params *params) {
+    memset(params, 0, sizeof(*params));
+    params->qos = QOS1;
+    params->payload = payload;
+    params->payloadLen = sizeof(payload);
+}
+
+// Publishes `count` messages at QoS 1, one round trip each.
+static double run_blocking(broker_t *broker, int count) {
+    AWS_IoT_Client client;
+    IoT_Publish_Message_Params params;
+
+    session_start(broker, &client, 0, COMMAND_TIMEOUT_MS);
+    int64_t start = test_now_ns();
+    for (int i = 0; i < count; i++) {
+        publish_params(&params);
+        CHECK(aws_iot_mqtt_publish(&client, TOPIC, strlen(TOPIC), &params) == SUCCESS);
+    }
+    double seconds = (test_now_ns() - start) / 1e9;
+    session_end(broker, &client);
+    CHECK(broker->publishes == count);
+    return seconds;
+}
+
+// Publishes `count` messages at QoS 1, keeping the in-flight window full.
+static double run_async(broker_t *broker, int count, int dropFirst, uint32_t commandTimeoutMs,
+        completions_t *completions) {
+    AWS_IoT_Client client;
+    IoT_Publish_Message_Params params;
+    int sent = 0;
+
+    memset(completions, 0, sizeof(*completions));
+    session_start(broker, &client, dropFirst, commandTimeoutMs);
+    int64_t start = test_now_ns();
+    while (completions->succeeded + completions->failed < count) {
+        if (sent < count) {
+            publish_params(&params);
+            IoT_Error_t rc = aws_iot_mqtt_publish_async(&client, TOPIC, strlen(TOPIC), &params,
+                on_complete, completions);
+            if (rc == SUCCESS) {
+                sent++;
+                continue;
+            }
+            CHECK(rc == LIMIT_EXCEEDED_ERROR);
+        }
+        CHECK(aws_iot_mqtt_yield(&client, 1) == SUCCESS);
+    }
+    double seconds = (test_now_ns() - start) / 1e9;
+    session_end(broker, &client);
+    return seconds;
+}
+
+// Fills the window with publishes the broker does not acknowledge, publishes
+// once more with a blocking call and disconnects.
+static void check_disconnect(broker_t *broker) {
+    AWS_IoT_Client client;
+    IoT_Publish_Message_Params params;
+    uint16_t ids[AWS_IOT_MQTT_PUBLISH_WINDOW];
+    completions_t completions = { 0 };
+
+    session_start(broker, &client, AWS_IOT_MQTT_PUBLISH_WINDOW, COMMAND_TIMEOUT_MS);
+    for (int i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+        publish_params(&params);
+        CHECK(aws_iot_mqtt_publish_async(&client, TOPIC, strlen(TOPIC), &params, on_complete, &completions)
+            == SUCCESS);
+        ids[i] = params.id;
+    }
+
+    // The blocking publish must not take an id whose PUBACK an async publish waits for
+    publish_params(&params);
+    CHECK(aws_iot_mqtt_publish(&client, TOPIC, strlen(TOPIC), &params) == SUCCESS);
+    for (int i = 0; i < AWS_IOT_MQTT_PUBLISH_WINDOW; i++) {
+        CHECK(params.id != ids[i]);
+    }
+    CHECK(completions.succeeded == 0 && completions.failed == 0);
+
+    session_end(broker, &client);
+    CHECK(completions.failed == AWS_IOT_MQTT_PUBLISH_WINDOW);
+    publish_params(&params);
+    CHECK(aws_iot_mqtt_publish_async(&client, TOPIC, strlen(TOPIC), &params, on_complete, &completions)
+        == NETWORK_DISCONNECTED_ERROR);
+}
+
+int main(void) {
+    broker_t broker;
+    completions_t completions;
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (unsigned char)('a' + i % 26);
+    }
+    broker_listen(&broker);
+
+    double blocking = run_blocking(&broker, MESSAGES);
+    printf("blocking publish:   %d messages in %.3f s, %7.1f msg/s\n",
+        MESSAGES, blocking, MESSAGES / blocking);
+
+    double async = run_async(&broker, MESSAGES, 0, COMMAND_TIMEOUT_MS, &completions);
+    printf("async, window %2d:   %d messages in %.3f s, %7.1f msg/s\n",
+        AWS_IOT_MQTT_PUBLISH_WINDOW, MESSAGES, async, MESSAGES / async);
+    CHECK(completions.succeeded == MESSAGES);
+    CHECK(broker.publishes == MESSAGES);
+    CHECK(broker.duplicates == 0);
+    // The window allows 8 messages per round trip; ask for well under that.
+    CHECK(blocking / async > 3.0);
+
+    // The first transmissions go unacknowledged and must be sent again.
+    run_async(&broker, DROPPED_PUBACKS * 2, DROPPED_PUBACKS, DUP_TIMEOUT_MS, &completions);
+    printf("retransmitted:      %d of %d messages with DUP\n", broker.duplicates, DROPPED_PUBACKS * 2);
+    CHECK(completions.succeeded == DROPPED_PUBACKS * 2);
+    CHECK(broker.duplicates == DROPPED_PUBACKS);
+    CHECK(broker.publishes == DROPPED_PUBACKS * 3);
+
+    check_disconnect(&broker);
+
+    close(broker.listenFd);
+    printf("mqtt_pipeline_bench: OK\n");
+    return 0;
+}
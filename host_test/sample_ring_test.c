@@ -0,0 +1,189 @@
+/**
+ * @file sample_ring_test.c
+ * @brief Host tests for the lock-free HHO sample ring: single-threaded
+ * semantics plus a stress test with concurrent producers and consumers.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sample_ring.h"
+#include "check.h"
+
+#define STRESS_RINGS 4
+#define STRESS_CONSUMERS 3
+#define STRESS_SAMPLES 200000u
+#define VALUE_MASK 0xFFFFFu
+
+static sample_ring_t rings[STRESS_RINGS];
+static volatile int producers_done;
+
+static void test_empty_ring(void) {
+    sample_ring_t ring;
+    hho_sample_t out[4];
+    SampleRing_Init(&ring);
+
+    sample_cursor_t cursor = SampleRing_Cursor(&ring);
+    CHECK(!SampleRing_Latest(&ring, &out[0]));
+    CHECK(SampleRing_Read(&ring, &cursor, out, 4) == 0);
+    CHECK(cursor.dropped == 0);
+}
+
+static void test_reads_every_sample_in_order(void) {
+    sample_ring_t ring;
+    hho_sample_t out[SAMPLE_RING_CAPACITY];
+    SampleRing_Init(&ring);
+    sample_cursor_t cursor = SampleRing_Cursor(&ring);
+
+    for (uint32_t i = 0; i < 10; i++) {
+        SampleRing_Push(&ring, 1000 + i, i * 0.5f);
+    }
+
+    CHECK(SampleRing_Read(&ring, &cursor, out, 4) == 4);
+    CHECK(SampleRing_Read(&ring, &cursor, out + 4, SAMPLE_RING_CAPACITY) == 6);
+    for (uint32_t i = 0; i < 10; i++) {
+        CHECK(out[i].timestamp_ms == 1000 + i);
+        CHECK(out[i].value == i * 0.5f);
+    }
+    CHECK(SampleRing_Read(&ring, &cursor, out, 4) == 0);
+
+    CHECK(SampleRing_Latest(&ring, &out[0]));
+    CHECK(out[0].timestamp_ms == 1009);
+}
+
+static void test_overrun_counts_dropped_samples(void) {
+    sample_ring_t ring;
+    hho_sample_t out[SAMPLE_RING_CAPACITY];
+    SampleRing_Init(&ring);
+    sample_cursor_t cursor = SampleRing_Cursor(&ring);
+
+    uint32_t total = SAMPLE_RING_CAPACITY * 3 + 5;
+    for (uint32_t i = 0; i < total; i++) {
+        SampleRing_Push(&ring, i, (float)i);
+    }
+
+    size_t count = SampleRing_Read(&ring, &cursor, out, SAMPLE_RING_CAPACITY);
+    CHECK(count == SAMPLE_RING_CAPACITY);
+    CHECK(cursor.dropped == total - SAMPLE_RING_CAPACITY);
+    CHECK(out[0].timestamp_ms == total - SAMPLE_RING_CAPACITY);
+    CHECK(out[count - 1].timestamp_ms == total - 1);
+}
+
+static void test_independent_cursors(void) {
+    sample_ring_t ring;
+    hho_sample_t out[SAMPLE_RING_CAPACITY];
+    SampleRing_Init(&ring);
+    sample_cursor_t early = SampleRing_Cursor(&ring);
+
+    SampleRing_Push(&ring, 1, 1.0f);
+    sample_cursor_t late = SampleRing_Cursor(&ring);
+    SampleRing_Push(&ring, 2, 2.0f);
+
+    CHECK(SampleRing_Read(&ring, &early, out, SAMPLE_RING_CAPACITY) == 2);
+    CHECK(SampleRing_Read(&ring, &late, out, SAMPLE_RING_CAPACITY) == 1);
+    CHECK(out[0].timestamp_ms == 2);
+}
+
+static void *producer(void *arg) {
+    sample_ring_t *ring = arg;
+    for (uint32_t i = 0; i < STRESS_SAMPLES; i++) {
+        SampleRing_Push(ring, i, (float)(i & VALUE_MASK));
+        // Give consumers a chance to keep up some of the time, so both the
+        // in-order and the lapped read paths are exercised.
+        if ((i & 0xFF) == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    uint64_t read[STRESS_RINGS];
+    uint64_t dropped[STRESS_RINGS];
+} consumer_result_t;
+
+static void *consumer(void *arg) {
+    consumer_result_t *result = arg;
+    sample_cursor_t cursors[STRESS_RINGS] = {{0}};
+    int64_t last[STRESS_RINGS];
+    hho_sample_t out[16];
+
+    for (int r = 0; r < STRESS_RINGS; r++) {
+        last[r] = -1;
+    }
+
+    for (;;) {
+        int done = __atomic_load_n(&producers_done, __ATOMIC_ACQUIRE);
+        size_t total = 0;
+
+        for (int r = 0; r < STRESS_RINGS; r++) {
+            size_t count = SampleRing_Read(&rings[r], &cursors[r], out, 16);
+            for (size_t i = 0; i < count; i++) {
+                // Torn reads would pair a timestamp with another sample's value.
+                CHECK(out[i].value == (float)(out[i].timestamp_ms & VALUE_MASK));
+                CHECK((int64_t)out[i].timestamp_ms > last[r]);
+                last[r] = out[i].timestamp_ms;
+            }
+            result->read[r] += count;
+            total += count;
+        }
+
+        if (done && total == 0) {
+            break;
+        }
+    }
+
+    for (int r = 0; r < STRESS_RINGS; r++) {
+        result->dropped[r] = cursors[r].dropped;
+        CHECK(last[r] == STRESS_SAMPLES - 1);
+    }
+    return NULL;
+}
+
+static void test_concurrent_producers_and_consumers(void) {
+    pthread_t producers[STRESS_RINGS];
+    pthread_t consumers[STRESS_CONSUMERS];
+    consumer_result_t results[STRESS_CONSUMERS];
+    memset(results, 0, sizeof(results));
+
+    for (int r = 0; r < STRESS_RINGS; r++) {
+        SampleRing_Init(&rings[r]);
+    }
+
+    for (int c = 0; c < STRESS_CONSUMERS; c++) {
+        CHECK(pthread_create(&consumers[c], NULL, consumer, &results[c]) == 0);
+    }
+    for (int r = 0; r < STRESS_RINGS; r++) {
+        CHECK(pthread_create(&producers[r], NULL, producer, &rings[r]) == 0);
+    }
+    for (int r = 0; r < STRESS_RINGS; r++) {
+        pthread_join(producers[r], NULL);
+    }
+    __atomic_store_n(&producers_done, 1, __ATOMIC_RELEASE);
+    for (int c = 0; c < STRESS_CONSUMERS; c++) {
+        pthread_join(consumers[c], NULL);
+    }
+
+    for (int c = 0; c < STRESS_CONSUMERS; c++) {
+        for (int r = 0; r < STRESS_RINGS; r++) {
+            // Every sample is either delivered or accounted for as dropped.
+            CHECK(results[c].read[r] + results[c].dropped[r] == STRESS_SAMPLES);
+            printf("consumer %d ring %d: read %llu dropped %llu\n", c, r,
+                (unsigned long long)results[c].read[r],
+                (unsigned long long)results[c].dropped[r]);
+        }
+    }
+}
+
+int main(void) {
+    test_empty_ring();
+    test_reads_every_sample_in_order();
+    test_overrun_counts_dropped_samples();
+    test_independent_cursors();
+    test_concurrent_producers_and_consumers();
+    printf("sample_ring_test: OK\n");
+    return 0;
+}
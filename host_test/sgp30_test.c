@@ -0,0 +1,86 @@
+/**
+ * @file sgp30_test.c
+ * @brief Host tests for the SGP30 frame encoding used by the u008 driver.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sgp30.h"
+#include "check.h"
+
+static void test_crc_vectors(void) {
+    // CRC-8 example from the SGP30 datasheet: CRC(0xBEEF) = 0x92.
+    const uint8_t beef[] = { 0xBE, 0xEF };
+    CHECK(SGP30_Crc8(beef, 2) == 0x92);
+
+    // The measure_test pattern 0xD400 and the all-zero word.
+    const uint8_t test_pattern[] = { 0xD4, 0x00 };
+    CHECK(SGP30_Crc8(test_pattern, 2) == 0xC6);
+    const uint8_t zero[] = { 0x00, 0x00 };
+    CHECK(SGP30_Crc8(zero, 2) == 0x81);
+}
+
+static void test_decode_measurement(void) {
+    // eCO2 400 ppm and TVOC 0 ppb, the readings right after init.
+    const uint8_t reply[SGP30_AIR_QUALITY_REPLY_SIZE] = { 0x01, 0x90, 0x4C, 0x00, 0x00, 0x81 };
+    sgp30_air_quality_t result = { 0 };
+    CHECK(SGP30_DecodeAirQuality(reply, &result));
+    CHECK(result.eCO2 == 400);
+    CHECK(result.tvoc == 0);
+
+    // Values above 255 are no longer truncated.
+    const uint8_t high[SGP30_AIR_QUALITY_REPLY_SIZE] = { 0xBE, 0xEF, 0x92, 0xD4, 0x00, 0xC6 };
+    CHECK(SGP30_DecodeAirQuality(high, &result));
+    CHECK(result.eCO2 == 0xBEEF);
+    CHECK(result.tvoc == 0xD400);
+}
+
+static void test_rejects_corrupted_frames(void) {
+    const uint8_t valid[SGP30_AIR_QUALITY_REPLY_SIZE] = { 0x01, 0x90, 0x4C, 0x00, 0x00, 0x81 };
+    sgp30_air_quality_t result = { .eCO2 = 1, .tvoc = 2 };
+
+    for (size_t byte = 0; byte < sizeof(valid); byte++) {
+        for (int bit = 0; bit < 8; bit++) {
+            uint8_t corrupted[SGP30_AIR_QUALITY_REPLY_SIZE];
+            memcpy(corrupted, valid, sizeof(valid));
+            corrupted[byte] ^= 1 << bit;
+            CHECK(!SGP30_DecodeAirQuality(corrupted, &result));
+        }
+    }
+    // A failed decode leaves the previous values in place.
+    CHECK(result.eCO2 == 1 && result.tvoc == 2);
+
+    // The unit answering with all ones (e.g. disconnected bus).
+    const uint8_t floating[SGP30_AIR_QUALITY_REPLY_SIZE] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    CHECK(!SGP30_DecodeAirQuality(floating, &result));
+}
+
+static void test_encode_commands(void) {
+    uint8_t command[2];
+    SGP30_EncodeCommand(SGP30_CMD_MEASURE_AIR_QUALITY, command);
+    CHECK(command[0] == 0x20 && command[1] == 0x08);
+
+    // Set baseline takes TVOC first, then eCO2 (the reverse of get baseline).
+    const sgp30_air_quality_t baseline = { .eCO2 = 0x8973, .tvoc = 0x8AAE };
+    uint8_t frame[SGP30_SET_BASELINE_SIZE];
+    SGP30_EncodeSetBaseline(&baseline, frame);
+    const uint8_t expected[SGP30_SET_BASELINE_SIZE] = { 0x20, 0x1E, 0x8A, 0xAE, 0xAF, 0x89, 0x73, 0xCA };
+    CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+
+    // A baseline read back with get baseline round-trips.
+    const uint8_t reply[SGP30_AIR_QUALITY_REPLY_SIZE] = { 0x89, 0x73, 0xCA, 0x8A, 0xAE, 0xAF };
+    sgp30_air_quality_t decoded;
+    CHECK(SGP30_DecodeAirQuality(reply, &decoded));
+    CHECK(decoded.eCO2 == baseline.eCO2 && decoded.tvoc == baseline.tvoc);
+}
+
+int main(void) {
+    test_crc_vectors();
+    test_decode_measurement();
+    test_rejects_corrupted_frames();
+    test_encode_commands();
+    printf("sgp30_test: OK\n");
+    return 0;
+}
@@ -0,0 +1,316 @@
+/**
+ * @file sound_classifier_eval.c
+ * @brief Runs the sound classifier over labelled audio the way the sound
+ * sensor does (512 point Welch spectrum, Hann window, 50% overlap) and
+ * reports its accuracy, confusion matrix and time per inference.
+ *
+ * Usage:
+ *   sound_classifier_eval --list FILE          lines of "path.wav label"
+ *   sound_classifier_eval --synthetic N        N synthesized examples per class
+ *   sound_classifier_eval --synthetic N --write-wavs DIR
+ *                                              writes them as WAVs and a list.txt
+ *                                              in DIR, then evaluates those
+ * Options:
+ *   --seed S             first synthetic seed (default 1)
+ *   --features FILE      also writes "label,feature..." CSV lines for
+ *                        sound_classifier_train.py
+ *   --min-accuracy X     exits 1 if the accuracy is below X (0 to 1)
+ *
+ * WAVs are 16-bit PCM at any sample rate; only the first channel is used,
+ * and each complete second is classified on its own. Labels are class names
+ * ("quiet", "speech", "hvac", "keyboard", "music").
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sound_classifier.h"
+#include "sound_synth.h"
+#include "welch_psd.h"
+#include "test_util.h"
+
+#define FRAME_SAMPLES 512
+#define PSD_OVERLAP_PERCENT 50
+#define PSD_SMOOTHING 0.25f
+#define SYNTH_RATE 16000
+#define MAX_PATH 1024
+
+typedef struct {
+    unsigned int confusion[SOUND_CLASS_COUNT][SOUND_CLASS_COUNT];
+    unsigned int seconds;
+    unsigned int correct;
+    double total_ns;
+    double max_ns;
+    FILE *features;
+} eval_t;
+
+static int class_from_name(const char *name) {
+    for (int c = 0; c < SOUND_CLASS_COUNT; c++) {
+        if (strcmp(name, SoundClassifier_Name((sound_class_t)c)) == 0) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+static void classify_second(eval_t *eval, const welch_bands_t *bands, sound_class_t label) {
+    double start = test_now_ns();
+    sound_classification_t result = SoundClassifier_Classify(bands);
+    double elapsed = test_now_ns() - start;
+
+    eval->total_ns += elapsed;
+    if (elapsed > eval->max_ns) {
+        eval->max_ns = elapsed;
+    }
+    eval->confusion[label][result.label]++;
+    eval->correct += (result.label == label);
+    eval->seconds++;
+
+    if (eval->features != NULL) {
+        int8_t features[SOUND_CLASSIFIER_FEATURES];
+        SoundClassifier_Features(bands, features);
+        fprintf(eval->features, "%s", SoundClassifier_Name(label));
+        for (int i = 0; i < SOUND_CLASSIFIER_FEATURES; i++) {
+            fprintf(eval->features, ",%d", features[i]);
+        }
+        fprintf(eval->features, "\n");
+    }
+}
+
+static void evaluate_samples(eval_t *eval, const int16_t *samples, size_t count, uint32_t rate, sound_class_t label) {
+    static float psd[FRAME_SAMPLES / 2 + 1];
+    welch_psd_t estimator;
+    if (!WelchPsd_Init(&estimator, FRAME_SAMPLES, rate, WELCH_WINDOW_HANN, PSD_OVERLAP_PERCENT, PSD_SMOOTHING, psd)) {
+        fprintf(stderr, "Couldn't create the spectrum estimator at %u Hz\n", rate);
+        exit(1);
+    }
+    for (size_t offset = 0; offset + rate <= count; offset += rate) {
+        WelchPsd_Process(&estimator, samples + offset, rate);
+        welch_bands_t bands = WelchPsd_Bands(&estimator);
+        classify_second(eval, &bands, label);
+    }
+    WelchPsd_Free(&estimator);
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Reads the first channel of a 16-bit PCM WAV; returns NULL on any other format.
+static int16_t *read_wav(const char *path, size_t *count, uint32_t *rate) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    uint8_t header[12];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)
+            || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    uint16_t channels = 0, bits = 0, format = 0;
+    int16_t *samples = NULL;
+    uint8_t chunk[8];
+    while (samples == NULL && fread(chunk, 1, sizeof(chunk), file) == sizeof(chunk)) {
+        uint32_t size = read_u32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t fmt[16];
+            if (fread(fmt, 1, sizeof(fmt), file) != sizeof(fmt)) {
+                break;
+            }
+            format = read_u16(fmt);
+            channels = read_u16(fmt + 2);
+            *rate = read_u32(fmt + 4);
+            bits = read_u16(fmt + 14);
+            fseek(file, (long)(size - 16 + (size & 1)), SEEK_CUR);
+        } else if (memcmp(chunk, "data", 4) == 0 && format == 1 && bits == 16 && channels > 0) {
+            size_t frames = size / (2u * channels);
+            int16_t *interleaved = malloc(frames * channels * sizeof(int16_t));
+            if (interleaved == NULL || fread(interleaved, 2 * channels, frames, file) != frames) {
+                free(interleaved);
+                break;
+            }
+            // WAVs are little-endian, like the host this runs on.
+            for (size_t i = 0; i < frames; i++) {
+                interleaved[i] = interleaved[i * channels];
+            }
+            samples = interleaved;
+            *count = frames;
+        } else {
+            fseek(file, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+    fclose(file);
+    return samples;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static bool write_wav(const char *path, const int16_t *samples, size_t count, uint32_t rate) {
+    uint8_t header[44] = { 0 };
+    memcpy(header, "RIFF", 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    memcpy(header + 36, "data", 4);
+    put_u32(header + 4, 36 + count * 2);
+    put_u32(header + 16, 16);
+    header[20] = 1, header[21] = 0;     // PCM
+    header[22] = 1, header[23] = 0;     // mono
+    put_u32(header + 24, rate);
+    put_u32(header + 28, rate * 2);
+    header[32] = 2, header[33] = 0;     // block align
+    header[34] = 16, header[35] = 0;    // bits per sample
+    put_u32(header + 40, count * 2);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header)
+        && fwrite(samples, sizeof(int16_t), count, file) == count;
+    return fclose(file) == 0 && ok;
+}
+
+static bool evaluate_list(eval_t *eval, const char *list_path) {
+    FILE *list = fopen(list_path, "r");
+    if (list == NULL) {
+        fprintf(stderr, "Couldn't open %s\n", list_path);
+        return false;
+    }
+    char path[MAX_PATH], name[32];
+    while (fscanf(list, "%1023s %31s", path, name) == 2) {
+        int label = class_from_name(name);
+        size_t count = 0;
+        uint32_t rate = 0;
+        int16_t *samples = (label >= 0) ? read_wav(path, &count, &rate) : NULL;
+        if (samples == NULL) {
+            fprintf(stderr, "Skipping %s (%s): unknown label or not a 16-bit PCM WAV\n", path, name);
+            continue;
+        }
+        evaluate_samples(eval, samples, count, rate, (sound_class_t)label);
+        free(samples);
+    }
+    fclose(list);
+    return true;
+}
+
+static bool synthesize(eval_t *eval, int per_class, uint32_t seed, const char *wav_dir) {
+    static int16_t samples[SYNTH_RATE];
+    FILE *list = NULL;
+    char path[MAX_PATH];
+    if (wav_dir != NULL) {
+        snprintf(path, sizeof(path), "%s/list.txt", wav_dir);
+        list = fopen(path, "w");
+        if (list == NULL) {
+            fprintf(stderr, "Couldn't create %s\n", path);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < per_class; i++) {
+        for (int c = 0; c < SOUND_CLASS_COUNT; c++) {
+            SoundSynth_Example((sound_class_t)c, seed + i, SYNTH_RATE, samples);
+            if (list == NULL) {
+                evaluate_samples(eval, samples, SYNTH_RATE, SYNTH_RATE, (sound_class_t)c);
+                continue;
+            }
+            snprintf(path, sizeof(path), "%s/%s_%u.wav", wav_dir, SoundClassifier_Name((sound_class_t)c), seed + i);
+            if (!write_wav(path, samples, SYNTH_RATE, SYNTH_RATE)) {
+                fprintf(stderr, "Couldn't write %s\n", path);
+                fclose(list);
+                return false;
+            }
+            fprintf(list, "%s %s\n", path, SoundClassifier_Name((sound_class_t)c));
+        }
+    }
+
+    if (list != NULL) {
+        fclose(list);
+        snprintf(path, sizeof(path), "%s/list.txt", wav_dir);
+        return evaluate_list(eval, path);
+    }
+    return true;
+}
+
+static void report(const eval_t *eval) {
+    printf("%u seconds classified, accuracy %.1f%%\n", eval->seconds,
+        eval->seconds ? 100.0 * eval->correct / eval->seconds : 0.0);
+    printf("%-10s", "actual");
+    for (int p = 0; p < SOUND_CLASS_COUNT; p++) {
+        printf("%9s", SoundClassifier_Name((sound_class_t)p));
+    }
+    printf("\n");
+    for (int a = 0; a < SOUND_CLASS_COUNT; a++) {
+        printf("%-10s", SoundClassifier_Name((sound_class_t)a));
+        for (int p = 0; p < SOUND_CLASS_COUNT; p++) {
+            printf("%9u", eval->confusion[a][p]);
+        }
+        printf("\n");
+    }
+    printf("inference: %.0f ns mean, %.0f ns max\n",
+        eval->seconds ? eval->total_ns / eval->seconds : 0.0, eval->max_ns);
+}
+
+int main(int argc, char **argv) {
+    const char *list_path = NULL, *wav_dir = NULL, *features_path = NULL;
+    int per_class = 0;
+    uint32_t seed = 1;
+    double min_accuracy = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--list") == 0 && has_value) {
+            list_path = argv[++i];
+        } else if (strcmp(argv[i], "--synthetic") == 0 && has_value) {
+            per_class = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--write-wavs") == 0 && has_value) {
+            wav_dir = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--features") == 0 && has_value) {
+            features_path = argv[++i];
+        } else if (strcmp(argv[i], "--min-accuracy") == 0 && has_value) {
+            min_accuracy = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s (--list FILE | --synthetic N [--write-wavs DIR] [--seed S])"
+                " [--features FILE] [--min-accuracy X]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((list_path == NULL) == (per_class <= 0)) {
+        fprintf(stderr, "Give one of --list or --synthetic\n");
+        return 2;
+    }
+
+    eval_t eval = { 0 };
+    if (features_path != NULL && (eval.features = fopen(features_path, "w")) == NULL) {
+        fprintf(stderr, "Couldn't create %s\n", features_path);
+        return 1;
+    }
+    bool ok = list_path != NULL ? evaluate_list(&eval, list_path) : synthesize(&eval, per_class, seed, wav_dir);
+    if (eval.features != NULL) {
+        fclose(eval.features);
+    }
+    if (!ok || eval.seconds == 0) {
+        fprintf(stderr, "Nothing was classified\n");
+        return 1;
+    }
+
+    report(&eval);
+    if ((double)eval.correct / eval.seconds < min_accuracy) {
+        fprintf(stderr, "Accuracy is below %.1f%%\n", 100 * min_accuracy);
+        return 1;
+    }
+    printf("sound_classifier_eval: OK\n");
+    return 0;
+}
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Trains the sound classifier and writes its int8 weight table.
+
+Fits a multinomial logistic regression to the feature CSV written by
+``sound_classifier_eval --features`` (one ``label,feature...`` line per second
+of audio), then quantizes it to int8 weights and int32 biases sharing one
+float scale, as ``sound_classifier.c`` evaluates it. Seconds labelled "quiet"
+are left out: the firmware tells them apart by level alone.
+
+    build_host/sound_classifier_eval --synthetic 200 --seed 1000 --features train.csv
+    python3 host_test/sound_classifier_train.py train.csv \\
+        components/custom/sound-sensor/sound_classifier_weights.h
+
+Plain Python with no dependencies, so that it runs wherever the host tests do.
+"""
+
+import argparse
+import csv
+import math
+import random
+
+CLASSES = ["speech", "hvac", "keyboard", "music"]
+
+
+def load(path):
+    rows, labels = [], []
+    with open(path, newline="") as file:
+        for record in csv.reader(file):
+            if not record or record[0] not in CLASSES:
+                continue
+            labels.append(CLASSES.index(record[0]))
+            rows.append([float(value) for value in record[1:]])
+    return rows, labels
+
+
+def softmax(logits):
+    largest = max(logits)
+    exps = [math.exp(value - largest) for value in logits]
+    total = sum(exps)
+    return [value / total for value in exps]
+
+
+def train(rows, labels, epochs, rate, l2):
+    """Mini-batch gradient descent on standardized features."""
+    features = len(rows[0])
+    means = [sum(row[i] for row in rows) / len(rows) for i in range(features)]
+    stds = [max(1e-3, math.sqrt(sum((row[i] - means[i]) ** 2 for row in rows) / len(rows)))
+            for i in range(features)]
+    data = [([(row[i] - means[i]) / stds[i] for i in range(features)], label)
+            for row, label in zip(rows, labels)]
+
+    weights = [[0.0] * features for _ in CLASSES]
+    bias = [0.0] * len(CLASSES)
+    shuffle = random.Random(1)
+    batch = 32
+    for _ in range(epochs):
+        shuffle.shuffle(data)
+        for start in range(0, len(data), batch):
+            grad_w = [[0.0] * features for _ in CLASSES]
+            grad_b = [0.0] * len(CLASSES)
+            chunk = data[start:start + batch]
+            for x, label in chunk:
+                logits = [bias[c] + sum(w * v for w, v in zip(weights[c], x)) for c in range(len(CLASSES))]
+                probs = softmax(logits)
+                for c in range(len(CLASSES)):
+                    error = probs[c] - (1.0 if c == label else 0.0)
+                    grad_b[c] += error
+                    row = grad_w[c]
+                    for i, v in enumerate(x):
+                        row[i] += error * v
+            step = rate / len(chunk)
+            for c in range(len(CLASSES)):
+                bias[c] -= step * grad_b[c]
+                for i in range(features):
+                    weights[c][i] -= step * grad_w[c][i] + rate * l2 * weights[c][i]
+
+    # Fold the standardization back in, so the model takes the raw features.
+    raw_weights = [[weights[c][i] / stds[i] for i in range(features)] for c in range(len(CLASSES))]
+    raw_bias = [bias[c] - sum(weights[c][i] * means[i] / stds[i] for i in range(features))
+                for c in range(len(CLASSES))]
+    return raw_weights, raw_bias
+
+
+def quantize(weights, bias):
+    scale = max(abs(w) for row in weights for w in row) / 127.0
+    q_weights = [[max(-127, min(127, round(w / scale))) for w in row] for row in weights]
+    q_bias = [round(b / scale) for b in bias]
+    return q_weights, q_bias, scale
+
+
+def accuracy(rows, labels, q_weights, q_bias):
+    correct = 0
+    for row, label in zip(rows, labels):
+        logits = [q_bias[c] + sum(w * int(v) for w, v in zip(q_weights[c], row)) for c in range(len(CLASSES))]
+        correct += logits.index(max(logits)) == label
+    return correct / len(rows)
+
+
+def write_header(path, q_weights, q_bias, scale, samples, train_accuracy):
+    features = len(q_weights[0])
+    lines = [
+        "/**",
+        " * @file sound_classifier_weights.h",
+        " * @brief Generated by host_test/sound_classifier_train.py; do not edit.",
+        " *",
+        " * Multinomial logistic regression over %d features, trained on %d seconds" % (features, samples),
+        " * of audio (%.1f%% training accuracy after int8 quantization)." % (100 * train_accuracy),
+        " * Logit of class c: SOUND_CLASSIFIER_SCALE * (bias[c] + sum weights[c][i] * feature[i]),",
+        " * for the classes after SOUND_CLASS_QUIET.",
+        " */",
+        "",
+        "#pragma once",
+        "",
+        "#include <stdint.h>",
+        "",
+        "#define SOUND_CLASSIFIER_WEIGHT_CLASSES %d" % len(CLASSES),
+        "#define SOUND_CLASSIFIER_WEIGHT_FEATURES %d" % features,
+        "#define SOUND_CLASSIFIER_SCALE %.9ef" % scale,
+        "",
+        "static const int8_t soundClassifierWeights[SOUND_CLASSIFIER_WEIGHT_CLASSES][SOUND_CLASSIFIER_WEIGHT_FEATURES] = {",
+    ]
+    for name, row in zip(CLASSES, q_weights):
+        lines.append("    { %s },  // %s" % (", ".join(str(w) for w in row), name))
+    lines += [
+        "};",
+        "",
+        "static const int32_t soundClassifierBias[SOUND_CLASSIFIER_WEIGHT_CLASSES] = {",
+        "    %s" % ", ".join(str(b) for b in q_bias),
+        "};",
+        "",
+    ]
+    with open(path, "w") as file:
+        file.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("features", help="CSV written by sound_classifier_eval --features")
+    parser.add_argument("header", help="weights header to write")
+    parser.add_argument("--epochs", type=int, default=200)
+    parser.add_argument("--rate", type=float, default=0.1)
+    parser.add_argument("--l2", type=float, default=1e-4)
+    args = parser.parse_args()
+
+    rows, labels = load(args.features)
+    if not rows:
+        parser.error("no labelled seconds in %s" % args.features)
+    weights, bias = train(rows, labels, args.epochs, args.rate, args.l2)
+    q_weights, q_bias, scale = quantize(weights, bias)
+    train_accuracy = accuracy(rows, labels, q_weights, q_bias)
+    write_header(args.header, q_weights, q_bias, scale, len(rows), train_accuracy)
+    print("%d seconds, %.1f%% training accuracy, scale %.3g" % (len(rows), 100 * train_accuracy, scale))
+
+
+if __name__ == "__main__":
+    main()
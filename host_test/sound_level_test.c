@@ -0,0 +1,189 @@
+/**
+ * @file sound_level_test.c
+ * @brief Host tests for the A-weighted sound level meter: the designed
+ * weighting against the IEC 61672 nominal curve, synthesized tones measured
+ * through the meter, calibration, the 1 minute average and LAFmax, plus a
+ * benchmark against the Q15 FFT the sound sensor used per frame.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fft.h"
+#include "sound_level.h"
+#include "check.h"
+#include "test_util.h"
+
+#define SENSITIVITY_DBFS -22.0f
+#define MAX_RATE 48000
+#define FRAME_SIZE 512
+#define BENCH_FRAMES 20000
+
+static int16_t samples[MAX_RATE];
+
+// IEC 61672-1 nominal A-weighting and the class 1 tolerance at each frequency.
+static const struct {
+    float frequency_hz;
+    float weighting_db;
+    float tolerance_db;
+} nominal[] = {
+    { 31.5f, -39.4f, 1.5f },
+    { 63.0f, -26.2f, 1.0f },
+    { 125.0f, -16.1f, 1.0f },
+    { 250.0f, -8.6f, 1.0f },
+    { 500.0f, -3.2f, 1.0f },
+    { 1000.0f, 0.0f, 0.7f },
+    { 2000.0f, 1.2f, 1.0f },
+    { 4000.0f, 1.0f, 1.0f },
+    { 8000.0f, -1.1f, 2.5f },
+};
+
+static const uint32_t rates[] = { 16000, 44100, 48000 };
+
+// One second of a sine at `dbfs`, with 0 dBFS a full-scale sine.
+static void make_tone(uint32_t rate, float frequency_hz, float dbfs, float phase) {
+    float amplitude = 32767.0f * powf(10.0f, dbfs / 20.0f);
+    for (uint32_t i = 0; i < rate; i++) {
+        samples[i] = (int16_t)lrintf(amplitude * sinf(phase + 6.2831853f * frequency_hz * i / rate));
+    }
+}
+
+static void make_silence(uint32_t rate) {
+    for (uint32_t i = 0; i < rate; i++) {
+        samples[i] = 0;
+    }
+}
+
+static void test_weighting_follows_the_nominal_curve(void) {
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        sound_level_t meter;
+        SoundLevel_Init(&meter, rates[r], SENSITIVITY_DBFS);
+
+        for (size_t i = 0; i < sizeof(nominal) / sizeof(nominal[0]); i++) {
+            // The bilinear transform squeezes the top octave towards Nyquist.
+            if (nominal[i].frequency_hz > rates[r] / 4) {
+                continue;
+            }
+            float weighting = SoundLevel_WeightingDb(&meter, nominal[i].frequency_hz);
+            CHECK(fabsf(weighting - nominal[i].weighting_db) <= nominal[i].tolerance_db);
+        }
+        CHECK(fabsf(SoundLevel_WeightingDb(&meter, 1000.0f)) < 0.01f);
+    }
+}
+
+static void test_tones_are_weighted(void) {
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        uint32_t rate = rates[r];
+
+        for (size_t i = 0; i < sizeof(nominal) / sizeof(nominal[0]); i++) {
+            float frequency = nominal[i].frequency_hz;
+            if (frequency > rate / 4) {
+                continue;
+            }
+            sound_level_t meter;
+            SoundLevel_Init(&meter, rate, SENSITIVITY_DBFS);
+
+            // The first second lets the filter settle.
+            for (int second = 0; second < 2; second++) {
+                make_tone(rate, frequency, -30.0f, 6.2831853f * frequency * second);
+                SoundLevel_Process(&meter, samples, rate);
+            }
+            sound_level_readout_t readout = SoundLevel_Latest(&meter);
+            float expected = 94.0f - 30.0f - SENSITIVITY_DBFS + SoundLevel_WeightingDb(&meter, frequency);
+            printf("%5u Hz: %7.1f Hz tone reads %5.2f dBA (expected %5.2f)\n",
+                rate, frequency, readout.laeq_1s, expected);
+            CHECK(readout.seconds == 2);
+            CHECK(fabsf(readout.laeq_1s - expected) < 0.05f);
+        }
+    }
+}
+
+static void test_reference_tone_reads_94_dba(void) {
+    sound_level_t meter;
+    SoundLevel_Init(&meter, 16000, SENSITIVITY_DBFS);
+    make_tone(16000, 1000.0f, SENSITIVITY_DBFS, 0);
+
+    // Fed in frames, as the sound sensor does.
+    for (uint32_t offset = 0; offset < 16000; offset += 500) {
+        SoundLevel_Process(&meter, samples + offset, 500);
+    }
+    sound_level_readout_t readout = SoundLevel_Latest(&meter);
+    CHECK(readout.seconds == 1);
+    CHECK(fabsf(readout.laeq_1s - 94.0f) < 0.05f);
+    CHECK(fabsf(readout.laeq_1min - 94.0f) < 0.05f);
+}
+
+static void test_minute_average_and_fast_maximum(void) {
+    const uint32_t rate = 16000;
+    sound_level_t meter;
+    SoundLevel_Init(&meter, rate, SENSITIVITY_DBFS);
+
+    // 30 s of a 74 dB tone and 30 s of silence average 3 dB below the tone.
+    make_tone(rate, 1000.0f, -42.0f, 0);
+    for (int second = 0; second < 30; second++) {
+        SoundLevel_Process(&meter, samples, rate);
+    }
+    make_silence(rate);
+    for (int second = 0; second < 30; second++) {
+        SoundLevel_Process(&meter, samples, rate);
+    }
+    sound_level_readout_t readout = SoundLevel_Latest(&meter);
+    CHECK(readout.seconds == 60);
+    CHECK(readout.laeq_1s == SOUND_LEVEL_FLOOR_DB);
+    CHECK(fabsf(readout.laeq_1min - (74.0f - 3.01f)) < 0.05f);
+
+    // A 0.5 s burst: LAeq spreads it over the second, LAFmax follows it.
+    make_tone(rate, 1000.0f, -42.0f, 0);
+    for (uint32_t i = rate / 2; i < rate; i++) {
+        samples[i] = 0;
+    }
+    SoundLevel_Process(&meter, samples, rate);
+    readout = SoundLevel_Latest(&meter);
+    CHECK(fabsf(readout.laeq_1s - (74.0f - 3.01f)) < 0.05f);
+    CHECK(fabsf(readout.lafmax - 74.0f) < 0.3f);
+
+    // The tone has left the minute window after 60 more silent seconds.
+    make_silence(rate);
+    for (int second = 0; second < 60; second++) {
+        SoundLevel_Process(&meter, samples, rate);
+    }
+    readout = SoundLevel_Latest(&meter);
+    CHECK(readout.laeq_1min == SOUND_LEVEL_FLOOR_DB);
+    CHECK(readout.lafmax == SOUND_LEVEL_FLOOR_DB);
+}
+
+static void bench_frame(void) {
+    sound_level_t meter;
+    static int16_t fft_output[FRAME_SIZE];
+    fft_plan_t *plan = fft_plan_acquire(FRAME_SIZE, FFT_REAL_Q15, FFT_FORWARD);
+    SoundLevel_Init(&meter, 16000, SENSITIVITY_DBFS);
+    make_tone(16000, 440.0f, -20.0f, 0);
+
+    double start = test_now_s();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        SoundLevel_Process(&meter, samples + (frame % 31) * FRAME_SIZE, FRAME_SIZE);
+    }
+    double level_us = (test_now_s() - start) * 1e6 / BENCH_FRAMES;
+
+    int sink = 0;
+    start = test_now_s();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        sink += fft_plan_execute_q15(plan, samples + (frame % 31) * FRAME_SIZE, fft_output);
+    }
+    double fft_us = (test_now_s() - start) * 1e6 / BENCH_FRAMES;
+
+    CHECK(sink > 0 && SoundLevel_Latest(&meter).seconds > 0);
+    printf("\n%d sample frame: A-weighted level %.2f us, Q15 FFT %.2f us\n", FRAME_SIZE, level_us, fft_us);
+    fft_plan_release(plan);
+}
+
+int main(void) {
+    test_weighting_follows_the_nominal_curve();
+    test_tones_are_weighted();
+    test_reference_tone_reads_94_dba();
+    test_minute_average_and_fast_maximum();
+    bench_frame();
+    printf("sound_level_test: OK\n");
+    return 0;
+}
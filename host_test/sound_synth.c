@@ -0,0 +1,189 @@
+/**
+ * @file sound_synth.c
+ * @brief Synthesized noise type examples for the sound classifier.
+ *
+ * - speech: a jittered glottal pulse train through three formant resonators,
+ *   in syllables of 120 to 300 ms with pauses and the odd fricative.
+ * - hvac: steady low-passed noise with mains hum harmonics.
+ * - keyboard: 2 to 12 short resonant clicks a second over a quiet room.
+ * - music: harmonic notes, sometimes in pairs, changing every 0.2 to 0.5 s.
+ * - quiet: the room noise floor alone.
+ *
+ * Each example is scaled to an RMS level between -55 and -15 dBFS on top of
+ * a -80 dBFS noise floor.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "sound_synth.h"
+#include "test_util.h"
+
+#define FLOOR_DBFS -80.0f
+#define QUIETEST_DBFS -55.0f
+#define LOUDEST_DBFS -15.0f
+
+static float uniform(test_rng_t *rng) {
+    return (float)test_uniform(rng);
+}
+
+static float between(test_rng_t *rng, float low, float high) {
+    return low + (high - low) * uniform(rng);
+}
+
+static float white(test_rng_t *rng) {
+    return 2.0f * uniform(rng) - 1.0f;
+}
+
+// Two-pole resonator with unity gain at its centre frequency.
+typedef struct {
+    float a1, a2, gain, y1, y2;
+} resonator_t;
+
+static void resonator_set(resonator_t *r, float frequency_hz, float bandwidth_hz, uint32_t rate) {
+    float radius = expf(-(float)M_PI * bandwidth_hz / rate);
+    r->a1 = 2.0f * radius * cosf(2.0f * (float)M_PI * frequency_hz / rate);
+    r->a2 = -radius * radius;
+    r->gain = 1.0f - radius;
+}
+
+static float resonator_run(resonator_t *r, float x) {
+    float y = r->gain * x + r->a1 * r->y1 + r->a2 * r->y2;
+    r->y2 = r->y1;
+    r->y1 = y;
+    return y;
+}
+
+static void synth_speech(test_rng_t *rng, uint32_t rate, float *out) {
+    static const float vowels[][3] = {
+        { 730, 1090, 2440 }, { 270, 2290, 3010 }, { 530, 1840, 2480 },
+        { 570, 840, 2410 }, { 300, 870, 2240 }, { 660, 1720, 2410 },
+    };
+    float pitch = between(rng, 90, 230);
+    resonator_t formants[3] = { 0 };
+    resonator_t hiss = { 0 };
+    resonator_set(&hiss, between(rng, 3500, 5500), 2000, rate);
+
+    uint32_t n = (uint32_t)(between(rng, 0, 0.2f) * rate);
+    float phase = 0;
+    while (n < rate) {
+        uint32_t length = (uint32_t)(between(rng, 0.12f, 0.3f) * rate);
+        uint32_t pause = (uint32_t)(between(rng, 0.02f, 0.2f) * rate);
+        bool fricative = uniform(rng) < 0.25f;
+        const float *vowel = vowels[(int)(uniform(rng) * 6) % 6];
+        for (int f = 0; f < 3; f++) {
+            resonator_set(&formants[f], vowel[f] * between(rng, 0.9f, 1.1f), 60 + 40 * f, rate);
+        }
+        float syllable_pitch = pitch * between(rng, 0.85f, 1.2f);
+
+        for (uint32_t i = 0; i < length && n < rate; i++, n++) {
+            float envelope = sinf((float)M_PI * i / length);
+            float x = 0;
+            if (fricative) {
+                x = 0.6f * resonator_run(&hiss, white(rng));
+            } else {
+                phase += syllable_pitch * (1.0f + 0.01f * white(rng)) / rate;
+                float pulse = 0;
+                if (phase >= 1.0f) {
+                    phase -= 1.0f;
+                    pulse = 1.0f;
+                }
+                x = resonator_run(&formants[0], pulse) + 0.5f * resonator_run(&formants[1], pulse)
+                    + 0.25f * resonator_run(&formants[2], pulse);
+            }
+            out[n] += envelope * x;
+        }
+        n += pause;
+    }
+}
+
+static void synth_hvac(test_rng_t *rng, uint32_t rate, float *out) {
+    float cutoff = between(rng, 150, 900);
+    float alpha = 1.0f - expf(-2.0f * (float)M_PI * cutoff / rate);
+    float mains = uniform(rng) < 0.5f ? 50.0f : 60.0f;
+    float hum = between(rng, 0, 0.3f);
+    float hiss = between(rng, 0, 0.05f);
+    float low = 0, lower = 0;
+    for (uint32_t n = 0; n < rate; n++) {
+        low += alpha * (white(rng) - low);
+        lower += alpha * (low - lower);
+        float t = (float)n / rate;
+        out[n] += lower + hiss * white(rng)
+            + hum * (0.1f * sinf(2.0f * (float)M_PI * 2.0f * mains * t)
+                     + 0.05f * sinf(2.0f * (float)M_PI * 4.0f * mains * t));
+    }
+}
+
+static void synth_keyboard(test_rng_t *rng, uint32_t rate, float *out) {
+    int clicks = 2 + (int)(uniform(rng) * 11);
+    for (int c = 0; c < clicks; c++) {
+        uint32_t start = (uint32_t)(uniform(rng) * rate);
+        uint32_t length = (uint32_t)(between(rng, 0.004f, 0.015f) * rate);
+        float decay = expf(-5.0f / length);
+        float level = between(rng, 0.5f, 1.0f);
+        resonator_t body = { 0 };
+        resonator_set(&body, between(rng, 1500, 5000), between(rng, 300, 1500), rate);
+
+        float envelope = level;
+        for (uint32_t i = 0; i < 4 * length && start + i < rate; i++) {
+            out[start + i] += envelope * resonator_run(&body, white(rng));
+            envelope *= decay;
+        }
+    }
+}
+
+static void synth_music(test_rng_t *rng, uint32_t rate, float *out) {
+    float brightness = between(rng, 0.4f, 0.9f);
+    uint32_t n = 0;
+    while (n < rate) {
+        uint32_t length = (uint32_t)(between(rng, 0.2f, 0.5f) * rate);
+        int voices = uniform(rng) < 0.4f ? 2 : 1;
+        float f0[2];
+        for (int v = 0; v < voices; v++) {
+            f0[v] = 110.0f * powf(2.0f, (int)(uniform(rng) * 36) / 12.0f);
+        }
+        for (uint32_t i = 0; i < length && n < rate; i++, n++) {
+            float t = (float)i / rate;
+            float envelope = fminf(1.0f, i / (0.01f * rate)) * expf(-2.0f * t);
+            float x = 0;
+            for (int v = 0; v < voices; v++) {
+                float amplitude = 1.0f;
+                for (int h = 1; h <= 8 && f0[v] * h < rate / 2; h++) {
+                    x += amplitude * sinf(2.0f * (float)M_PI * f0[v] * h * t);
+                    amplitude *= brightness;
+                }
+            }
+            out[n] += envelope * x;
+        }
+    }
+}
+
+void SoundSynth_Example(sound_class_t label, uint32_t seed, uint32_t sample_rate, int16_t *samples) {
+    test_rng_t rng = { .state = seed * 2654435761u + label };
+    float *signal = calloc(sample_rate, sizeof(float));
+    if (signal == NULL) {
+        abort();
+    }
+
+    switch (label) {
+    case SOUND_CLASS_SPEECH: synth_speech(&rng, sample_rate, signal); break;
+    case SOUND_CLASS_HVAC: synth_hvac(&rng, sample_rate, signal); break;
+    case SOUND_CLASS_KEYBOARD: synth_keyboard(&rng, sample_rate, signal); break;
+    case SOUND_CLASS_MUSIC: synth_music(&rng, sample_rate, signal); break;
+    default: break;
+    }
+
+    double energy = 0;
+    for (uint32_t n = 0; n < sample_rate; n++) {
+        energy += (double)signal[n] * signal[n];
+    }
+    float rms = (float)sqrt(energy / sample_rate);
+    float gain = rms > 0 ? 32767.0f * powf(10.0f, between(&rng, QUIETEST_DBFS, LOUDEST_DBFS) / 20.0f) / rms : 0;
+    float floor = 32767.0f * powf(10.0f, FLOOR_DBFS / 20.0f) * sqrtf(3.0f);
+
+    for (uint32_t n = 0; n < sample_rate; n++) {
+        float x = gain * signal[n] + floor * white(&rng);
+        samples[n] = (int16_t)fmaxf(-32768.0f, fminf(32767.0f, lrintf(x)));
+    }
+    free(signal);
+}
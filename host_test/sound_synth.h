@@ -0,0 +1,22 @@
+/**
+ * @file sound_synth.h
+ * @brief Synthesized one-second examples of the noise types the sound
+ * classifier tells apart, for training it and evaluating it on the host when
+ * no recordings are at hand.
+ *
+ * Each example draws its pitch, formants, timing and level from a seeded
+ * generator, so the same seed always gives the same audio.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "sound_classifier.h"
+
+/**
+ * @brief Writes `sample_rate` samples (one second) of `label`.
+ *
+ * @param seed picks the example; different seeds give different examples.
+ */
+void SoundSynth_Example(sound_class_t label, uint32_t seed, uint32_t sample_rate, int16_t *samples);
@@ -0,0 +1,50 @@
+/**
+ * @file test_util.h
+ * @brief Random numbers and the clock of the host tests and benchmarks. The
+ * generator is seeded, so that the fixtures are the same on every run and
+ * do not depend on the libc rand().
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+/** Linear congruential generator; set the state to seed it */
+typedef struct {
+    uint32_t state;
+} test_rng_t;
+
+static inline uint32_t test_rng_next(test_rng_t *rng) {
+    rng->state = rng->state * 1664525u + 1013904223u;
+    return rng->state;
+}
+
+/** Uniform in (0, 1); never 0, so that it can go through log() */
+static inline double test_uniform(test_rng_t *rng) {
+    return ((test_rng_next(rng) >> 8) + 0.5) / 16777216.0;
+}
+
+/** Standard normal, by Box-Muller */
+static inline double test_gaussian(test_rng_t *rng) {
+    double radius = sqrt(-2.0 * log(test_uniform(rng)));
+    return radius * cos(6.283185307179586 * test_uniform(rng));
+}
+
+/** Uniform integer in [-amplitude, amplitude] */
+static inline int32_t test_uniform_int(test_rng_t *rng, int32_t amplitude) {
+    return (int32_t)((test_rng_next(rng) >> 16) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+/** Monotonic time, in nanoseconds */
+static inline int64_t test_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/** Monotonic time, in seconds */
+static inline double test_now_s(void) {
+    return test_now_ns() / 1e9;
+}
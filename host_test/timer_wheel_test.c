@@ -0,0 +1,134 @@
+/**
+ * @file timer_wheel_test.c
+ * @brief Host tests for the hashed timer wheel behind the sensor scheduler.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer_wheel.h"
+#include "check.h"
+#include "test_util.h"
+
+typedef struct {
+    timer_wheel_entry_t timer;
+    uint32_t period;
+    uint32_t due;
+    uint32_t fired;
+} periodic_t;
+
+static void test_empty_wheel(void) {
+    timer_wheel_t wheel;
+    uint32_t next;
+    TimerWheel_Init(&wheel, 100);
+    CHECK(!TimerWheel_NextExpiry(&wheel, &next));
+    CHECK(TimerWheel_Advance(&wheel, 1000) == NULL);
+}
+
+static void test_expiry_order(void) {
+    timer_wheel_t wheel;
+    timer_wheel_entry_t a, b, c, d;
+    uint32_t next;
+    TimerWheel_Init(&wheel, 0);
+
+    TimerWheel_Schedule(&wheel, &a, 5);
+    TimerWheel_Schedule(&wheel, &b, 3);
+    TimerWheel_Schedule(&wheel, &c, 5);
+    // Same bucket as b, one revolution later.
+    TimerWheel_Schedule(&wheel, &d, 3 + TIMER_WHEEL_SLOTS);
+
+    CHECK(TimerWheel_NextExpiry(&wheel, &next) && next == 3);
+    CHECK(TimerWheel_Advance(&wheel, 2) == NULL);
+
+    timer_wheel_entry_t *expired = TimerWheel_Advance(&wheel, 5);
+    CHECK(expired == &b);
+    CHECK(b.next == &a);
+    CHECK(a.next == &c);
+    CHECK(c.next == NULL);
+
+    CHECK(TimerWheel_NextExpiry(&wheel, &next) && next == 3 + TIMER_WHEEL_SLOTS);
+    CHECK(TimerWheel_Advance(&wheel, 3 + TIMER_WHEEL_SLOTS - 1) == NULL);
+    CHECK(TimerWheel_Advance(&wheel, 3 + TIMER_WHEEL_SLOTS) == &d);
+}
+
+static void test_past_expiry_fires_on_next_advance(void) {
+    timer_wheel_t wheel;
+    timer_wheel_entry_t a;
+    uint32_t next;
+    TimerWheel_Init(&wheel, 50);
+    CHECK(TimerWheel_Advance(&wheel, 60) == NULL);
+
+    TimerWheel_Schedule(&wheel, &a, 10);
+    CHECK(TimerWheel_NextExpiry(&wheel, &next) && next == 61);
+    CHECK(TimerWheel_Advance(&wheel, 61) == &a);
+}
+
+// Simulates the sensor scheduler: periodic timers, rescheduled on expiry,
+// with the clock advancing in irregular steps (including across the tick
+// counter wrap-around and jumps of more than one revolution).
+static void test_periodic_timers(uint32_t start) {
+    periodic_t timers[] = {
+        { .period = 10 }, { .period = 100 }, { .period = 20 }, { .period = 6000 }, { .period = 1 },
+    };
+    const size_t count = sizeof(timers) / sizeof(timers[0]);
+    timer_wheel_t wheel;
+    TimerWheel_Init(&wheel, start);
+    for (size_t i = 0; i < count; i++) {
+        timers[i].due = start;
+        timers[i].fired = 0;
+        TimerWheel_Schedule(&wheel, &timers[i].timer, start);
+    }
+
+    uint32_t now = start;
+    test_rng_t rng = { 1 };
+    for (int step = 0; step < 20000; step++) {
+        uint32_t r = test_rng_next(&rng) >> 16;
+        uint32_t jump = r % 8 == 0 ? r % 300 : r % 3;
+        now += jump;
+
+        uint32_t next;
+        CHECK(TimerWheel_NextExpiry(&wheel, &next));
+        timer_wheel_entry_t *expired = TimerWheel_Advance(&wheel, now);
+        if (expired != NULL) {
+            CHECK(expired->expires == next);
+        }
+        uint32_t previous = 0;
+        int first = 1;
+        while (expired != NULL) {
+            periodic_t *timer = (periodic_t *)expired;
+            expired = expired->next;
+
+            CHECK(timer->timer.expires == timer->due);
+            CHECK((int32_t)(now - timer->due) >= 0);
+            CHECK(first || (int32_t)(timer->due - previous) >= 0);
+            previous = timer->due;
+            first = 0;
+
+            timer->fired++;
+            // Skip the periods that were missed, like the scheduler does.
+            do {
+                timer->due += timer->period;
+            } while ((int32_t)(timer->due - now) <= 0);
+            TimerWheel_Schedule(&wheel, &timer->timer, timer->due);
+        }
+
+        // Nothing that is due was left behind.
+        for (size_t i = 0; i < count; i++) {
+            CHECK((int32_t)(timers[i].due - now) > 0);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        CHECK(timers[i].fired > 0);
+    }
+}
+
+int main(void) {
+    test_empty_wheel();
+    test_expiry_order();
+    test_past_expiry_fires_on_next_advance();
+    test_periodic_timers(0);
+    test_periodic_timers(UINT32_MAX - 5000);
+    printf("timer_wheel_test: OK\n");
+    return 0;
+}
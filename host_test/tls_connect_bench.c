@@ -0,0 +1,241 @@
+/**
+ * @file tls_connect_bench.c
+ * @brief Times reconnects through the device's mbedTLS wrapper against a mock
+ * TLS endpoint on the loopback interface, with the credentials kept from
+ * iot_tls_init and with them loaded again for each connect as the wrapper
+ * used to, each with and without session resumption.
+ *
+ * mbedTLS and the ATECC608 are stubbed (tls_stubs/): each credential and
+ * handshake step takes the time set below, and the endpoint waits a round
+ * trip before each reply. The latencies follow from those figures; the step
+ * counts are what the checks hold the wrapper to.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "network_interface.h"
+#include "tls_stubs.h"
+#include "check.h"
+#include "test_util.h"
+
+#define HOST "127.0.0.1"
+#define TIMEOUT_MS 2000
+
+// Rough figures for the Core2 for AWS: an ESP32 at 240 MHz with the ATECC608
+// on the internal I2C bus.
+#define DRBG_SEED_US 1000
+#define CA_PARSE_US 4000            // Amazon Root CA 1, RSA 2048, from PEM
+#define ATCA_CERT_US 40000          // Device and signer certificate rebuilt from several slot reads
+#define ATCA_KEY_US 8000            // Public key read from the key slot
+#define FULL_HANDSHAKE_US 150000    // ECDHE, server chain verify and the ATECC608 ECDSA sign
+#define RESUMED_HANDSHAKE_US 2000   // Key derivation and Finished MACs only
+
+static const char rootCA[] = "-----BEGIN CERTIFICATE-----\nMIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\n"
+    "-----END CERTIFICATE-----\n";
+// Same certificate at another address, as if the application passed new connect parameters
+static const char otherRootCA[] = "-----BEGIN CERTIFICATE-----\nMIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\n"
+    "-----END CERTIFICATE-----\n";
+// The same host under another name
+static const char otherHost[] = HOST;
+
+typedef struct {
+    const char *name;
+    bool reloadCredentials;
+    bool resumption;
+} bench_mode_t;
+
+static const bench_mode_t modes[] = {
+    { "reload credentials, full handshake", true, false },
+    { "reload credentials, resumed", true, true },
+    { "keep credentials, full handshake", false, false },
+    { "keep credentials, resumed", false, true },
+};
+
+typedef struct {
+    double msPerReconnect;
+    double seeds, certParses, atcaCerts, keyLoads, configs;
+    double resumed;
+} result_t;
+
+static IoT_Error_t init_network(Network *network, const char *ca, uint16_t port) {
+    memset(network, 0, sizeof(*network));
+    return iot_tls_init(network, ca, "#", "#0", HOST, port, TIMEOUT_MS, true);
+}
+
+static void close_connection(Network *network) {
+    CHECK(iot_tls_disconnect(network) == SUCCESS);
+    CHECK(iot_tls_destroy(network) == SUCCESS);
+}
+
+static result_t run_mode(const bench_mode_t *mode, uint16_t port, int reconnects) {
+    Network network;
+    tls_stub_counts_t before;
+    result_t result;
+    double elapsed = 0;
+
+    TlsStub_SetResumption(mode->resumption);
+    CHECK(init_network(&network, rootCA, port) == SUCCESS);
+    CHECK(iot_tls_connect(&network, NULL) == SUCCESS);
+
+    before = tls_stub_counts;
+    for (int i = 0; i < reconnects; i++) {
+        close_connection(&network);
+        if (mode->reloadCredentials) {
+            // What iot_tls_destroy used to throw away with the connection
+            iot_tls_free_credentials(&network.tlsDataParams);
+        }
+
+        double start = (test_now_ns() / 1e6);
+        CHECK(iot_tls_connect(&network, NULL) == SUCCESS);
+        elapsed += (test_now_ns() / 1e6) - start;
+    }
+
+    result.msPerReconnect = elapsed / reconnects;
+    result.seeds = (double)(tls_stub_counts.drbgSeeds - before.drbgSeeds) / reconnects;
+    result.certParses = (double)(tls_stub_counts.certParses - before.certParses) / reconnects;
+    result.atcaCerts = (double)(tls_stub_counts.atcaCertAdds - before.atcaCertAdds) / reconnects;
+    result.keyLoads = (double)(tls_stub_counts.keyLoads - before.keyLoads) / reconnects;
+    result.configs = (double)(tls_stub_counts.configs - before.configs) / reconnects;
+    result.resumed = (double)(tls_stub_counts.resumedHandshakes - before.resumedHandshakes) / reconnects;
+
+    const TLSHandshakeStats *stats = iot_tls_get_handshake_stats(&network.tlsDataParams);
+    CHECK(stats->handshakes == (uint32_t)reconnects + 1);
+    CHECK(stats->resumed == (mode->resumption ? (uint32_t)reconnects : 0));
+
+    close_connection(&network);
+    iot_tls_free(&network.tlsDataParams);
+    CHECK(tls_stub_counts.configs == tls_stub_counts.configFrees);
+    return result;
+}
+
+/* Credentials that failed to load at init are loaded by connect, and loaded again when the parameters change */
+static void check_reload(uint16_t port) {
+    Network network;
+    TLSConnectParams params;
+    tls_stub_counts_t before;
+
+    TlsStub_SetResumption(true);
+    CHECK(init_network(&network, "not a certificate", port) == SUCCESS);
+    CHECK(!network.tlsDataParams.credentials.ready);
+    CHECK(iot_tls_connect(&network, NULL) == NETWORK_X509_ROOT_CRT_PARSE_ERROR);
+
+    params = network.tlsConnectParams;
+    params.pRootCALocation = rootCA;
+    CHECK(iot_tls_connect(&network, &params) == SUCCESS);
+    close_connection(&network);
+
+    // Unchanged parameters: nothing is loaded and the session is resumed
+    before = tls_stub_counts;
+    CHECK(iot_tls_connect(&network, &params) == SUCCESS);
+    CHECK(tls_stub_counts.certParses == before.certParses);
+    CHECK(tls_stub_counts.resumedHandshakes == before.resumedHandshakes + 1);
+    close_connection(&network);
+
+    // A new CA: the credentials are loaded again and the old session is not offered
+    before = tls_stub_counts;
+    params.pRootCALocation = otherRootCA;
+    CHECK(iot_tls_connect(&network, &params) == SUCCESS);
+    CHECK(tls_stub_counts.certParses == before.certParses + 1);
+    CHECK(tls_stub_counts.atcaCertAdds == before.atcaCertAdds + 1);
+    CHECK(tls_stub_counts.configFrees == before.configFrees + 1);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes + 1);
+    close_connection(&network);
+
+    // Another host: the session is not offered to it
+    before = tls_stub_counts;
+    params.pDestinationURL = otherHost;
+    CHECK(iot_tls_connect(&network, &params) == SUCCESS);
+    CHECK(tls_stub_counts.configFrees == before.configFrees + 1);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes + 1);
+    close_connection(&network);
+
+    iot_tls_free(&network.tlsDataParams);
+    CHECK(tls_stub_counts.configs == tls_stub_counts.configFrees);
+}
+
+/* Initializing takes no notice of what the Network held; iot_tls_free lets go of it first */
+static void check_reinit(uint16_t port) {
+    Network network;
+    tls_stub_counts_t before;
+
+    TlsStub_SetResumption(true);
+    // As on the stack of the task that creates the client
+    memset(&network, 0xA5, sizeof(network));
+    before = tls_stub_counts;
+    CHECK(iot_tls_init(&network, rootCA, "#", "#0", HOST, port, TIMEOUT_MS, true) == SUCCESS);
+    CHECK(tls_stub_counts.configFrees == before.configFrees);
+    CHECK(network.tlsDataParams.credentials.ready && !network.tlsDataParams.has_session);
+    CHECK(iot_tls_connect(&network, NULL) == SUCCESS);
+    close_connection(&network);
+
+    before = tls_stub_counts;
+    iot_tls_free(&network.tlsDataParams);
+    CHECK(tls_stub_counts.configFrees == before.configFrees + 1);
+    CHECK(!network.tlsDataParams.credentials.ready && !network.tlsDataParams.has_session);
+    CHECK(iot_tls_init(&network, rootCA, "#", "#0", HOST, port, TIMEOUT_MS, true) == SUCCESS);
+    CHECK(iot_tls_connect(&network, NULL) == SUCCESS);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes + 1);
+    close_connection(&network);
+
+    iot_tls_free(&network.tlsDataParams);
+    CHECK(tls_stub_counts.configs == tls_stub_counts.configFrees);
+}
+
+int main(int argc, char **argv) {
+    int reconnects = 10;
+    uint32_t rttMs = 40;
+    result_t results[sizeof(modes) / sizeof(modes[0])];
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--reconnects") == 0 && i + 1 < argc) {
+            reconnects = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rtt") == 0 && i + 1 < argc) {
+            rttMs = (uint32_t)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--reconnects N] [--rtt MS]\n", argv[0]);
+            return 2;
+        }
+    }
+    CHECK(reconnects > 0);
+
+    tls_stub_costs = (tls_stub_costs_t) {
+        .drbgSeedUs = DRBG_SEED_US,
+        .certParseUs = CA_PARSE_US,
+        .atcaCertUs = ATCA_CERT_US,
+        .atcaKeyUs = ATCA_KEY_US,
+        .fullHandshakeUs = FULL_HANDSHAKE_US,
+        .resumedHandshakeUs = RESUMED_HANDSHAKE_US,
+    };
+    uint16_t port = TlsStub_StartEndpoint(rttMs, true);
+    CHECK(port != 0);
+
+    check_reload(port);
+    check_reinit(port);
+
+    printf("%d reconnects per mode, %u ms round trip\n", reconnects, rttMs);
+    printf("%-36s %10s %6s %6s %6s %6s %6s %8s\n", "mode", "ms/conn", "seeds", "CA", "ATECC", "keys", "conf",
+        "resumed");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        result_t *r = &results[m];
+        *r = run_mode(&modes[m], port, reconnects);
+        printf("%-36s %10.1f %6.2f %6.2f %6.2f %6.2f %6.2f %7.0f%%\n", modes[m].name, r->msPerReconnect, r->seeds,
+            r->certParses, r->atcaCerts, r->keyLoads, r->configs, r->resumed * 100);
+
+        double loads = modes[m].reloadCredentials ? 1 : 0;
+        CHECK(r->seeds == loads && r->certParses == loads && r->atcaCerts == loads);
+        CHECK(r->keyLoads == loads && r->configs == loads);
+        CHECK(r->resumed == (modes[m].resumption ? 1 : 0));
+    }
+
+    // Kept credentials save at least half the modelled loading cost per reconnect
+    double loadMs = (DRBG_SEED_US + CA_PARSE_US + ATCA_CERT_US + ATCA_KEY_US) / 1000.0;
+    CHECK(results[2].msPerReconnect + loadMs / 2 < results[0].msPerReconnect);
+    CHECK(results[3].msPerReconnect + loadMs / 2 < results[1].msPerReconnect);
+    printf("reconnect: %.1f ms before, %.1f ms with kept credentials and resumption\n",
+        results[0].msPerReconnect, results[3].msPerReconnect);
+
+    TlsStub_StopEndpoint();
+    return 0;
+}
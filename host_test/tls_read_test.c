@@ -0,0 +1,209 @@
+/**
+ * @file tls_read_test.c
+ * @brief Checks how the device's mbedTLS wrapper reads MQTT packets out of TLS
+ * records: several packets in one record take one mbedtls_ssl_read, a packet
+ * split across two records comes out whole, and the read timeout follows the
+ * time the caller has left without being set again for each read.
+ *
+ * The records are scripted through tls_stubs/ rather than sent by the mock
+ * endpoint, so each mbedtls_ssl_read returns exactly one record's bytes.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "network_interface.h"
+#include "tls_stubs.h"
+#include "check.h"
+
+#define HOST "127.0.0.1"
+#define TIMEOUT_MS 2000
+#define YIELD_MS 100
+
+static const char rootCA[] = "-----BEGIN CERTIFICATE-----\nMIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\n"
+    "-----END CERTIFICATE-----\n";
+
+static const unsigned char puback[] = { 0x40, 0x02, 0x00, 0x01 };
+static const unsigned char pingresp[] = { 0xD0, 0x00 };
+static const unsigned char publish[] = { 0x30, 0x0C, 0x00, 0x05, 'h', 'h', 'o', '/', 't', 'h', 'e', 'l', 'l', 'o' };
+
+/* Reads one packet the way the MQTT client does: the type, the remaining length a byte at a time, then the rest */
+static IoT_Error_t read_packet(Network *network, Timer *timer, unsigned char *buf, size_t *len) {
+    size_t pos = 0, remaining = 0, multiplier = 1, readLen;
+    IoT_Error_t rc;
+
+    do {
+        rc = iot_tls_read(network, buf + pos, 1, timer, &readLen);
+        if (rc != SUCCESS) {
+            return rc;
+        }
+        if (pos > 0) {
+            remaining += (buf[pos] & 0x7F) * multiplier;
+            multiplier *= 128;
+        }
+    } while (pos++ == 0 || (buf[pos - 1] & 0x80) != 0);
+
+    *len = pos;
+    if (remaining > 0) {
+        rc = iot_tls_read(network, buf + pos, remaining, timer, &readLen);
+        *len += readLen;
+    }
+    return rc;
+}
+
+static void check_packet(Network *network, Timer *timer, const unsigned char *expected, size_t expectedLen) {
+    unsigned char buf[1024];
+    size_t len = 0;
+
+    CHECK(read_packet(network, timer, buf, &len) == SUCCESS);
+    CHECK(len == expectedLen && memcmp(buf, expected, len) == 0);
+}
+
+// Each check yields for a different time, so that no two share a deadline
+static void start_yield(Timer *timer) {
+    static uint32_t yields;
+
+    init_timer(timer);
+    countdown_ms(timer, YIELD_MS + yields++);
+}
+
+/* A PUBACK, a PINGRESP and a PUBLISH that the server sent in one record */
+static void check_one_record(Network *network) {
+    unsigned char record[sizeof(puback) + sizeof(pingresp) + sizeof(publish)];
+    tls_stub_counts_t before = tls_stub_counts;
+    Timer timer;
+
+    memcpy(record, puback, sizeof(puback));
+    memcpy(record + sizeof(puback), pingresp, sizeof(pingresp));
+    memcpy(record + sizeof(puback) + sizeof(pingresp), publish, sizeof(publish));
+    TlsStub_QueueRecord(record, sizeof(record));
+
+    start_yield(&timer);
+    check_packet(network, &timer, puback, sizeof(puback));
+    // The rest of the record waits in the wrapper, where select() would not see it
+    CHECK(iot_tls_get_bytes_avail(&network->tlsDataParams) == sizeof(pingresp) + sizeof(publish));
+    check_packet(network, &timer, pingresp, sizeof(pingresp));
+    check_packet(network, &timer, publish, sizeof(publish));
+
+    CHECK(tls_stub_counts.sslReads == before.sslReads + 1);
+    CHECK(tls_stub_counts.readTimeoutSets == before.readTimeoutSets + 1);
+    CHECK(iot_tls_get_bytes_avail(&network->tlsDataParams) == 0);
+}
+
+/* A PUBACK and the start of a PUBLISH in one record, the rest of the PUBLISH in the next */
+static void check_split_packet(Network *network) {
+    const size_t split = 6;
+    unsigned char record[sizeof(puback) + split];
+    tls_stub_counts_t before = tls_stub_counts;
+    Timer timer;
+
+    memcpy(record, puback, sizeof(puback));
+    memcpy(record + sizeof(puback), publish, split);
+    TlsStub_QueueRecord(record, sizeof(record));
+    TlsStub_QueueRecord(publish + split, sizeof(publish) - split);
+
+    start_yield(&timer);
+    check_packet(network, &timer, puback, sizeof(puback));
+    CHECK(iot_tls_get_bytes_avail(&network->tlsDataParams) == split);
+    check_packet(network, &timer, publish, sizeof(publish));
+
+    CHECK(tls_stub_counts.sslReads == before.sslReads + 2);
+    // Both reads ran against the same deadline: set again only if a ms went by in between
+    CHECK(tls_stub_counts.readTimeoutSets <= before.readTimeoutSets + 2);
+    CHECK(iot_tls_get_bytes_avail(&network->tlsDataParams) == 0);
+}
+
+/* A PUBLISH longer than the wrapper's buffer, in one record */
+static void check_long_packet(Network *network) {
+    unsigned char packet[4 + 5 + 2 * IOT_SSL_READ_BUF_LEN];
+    size_t remaining = sizeof(packet) - 3;
+    tls_stub_counts_t before = tls_stub_counts;
+    Timer timer;
+
+    packet[0] = 0x30;
+    packet[1] = 0x80 | (remaining & 0x7F);
+    packet[2] = (unsigned char)(remaining >> 7);
+    packet[3] = 0x00;
+    packet[4] = 0x05;
+    memcpy(packet + 5, "hho/t", 5);
+    for (size_t i = 10; i < sizeof(packet); i++) {
+        packet[i] = (unsigned char)i;
+    }
+    TlsStub_QueueRecord(packet, sizeof(packet));
+
+    start_yield(&timer);
+    check_packet(network, &timer, packet, sizeof(packet));
+    CHECK(tls_stub_counts.sslReads == before.sslReads + 2);
+    CHECK(iot_tls_get_bytes_avail(&network->tlsDataParams) == 0);
+}
+
+/* The start of a packet, then nothing until the deadline */
+static void check_timeout(Network *network) {
+    unsigned char buf[sizeof(publish)];
+    tls_stub_counts_t before = tls_stub_counts;
+    size_t readLen = 0;
+    Timer timer;
+
+    TlsStub_QueueRecord(publish, 5);
+    start_yield(&timer);
+    CHECK(iot_tls_read(network, buf, 2, &timer, &readLen) == SUCCESS && readLen == 2);
+    // The bytes that did arrive are reported, so that the client keeps them
+    CHECK(iot_tls_read(network, buf + 2, sizeof(publish) - 2, &timer, &readLen) == NETWORK_SSL_READ_TIMEOUT_ERROR);
+    CHECK(readLen == 3 && memcmp(buf, publish, 5) == 0);
+    CHECK(has_timer_expired(&timer));
+    CHECK(network->tlsDataParams.credentials.conf.read_timeout <= YIELD_MS + 4);
+
+    // Nothing at all with the next deadline
+    before = tls_stub_counts;
+    start_yield(&timer);
+    CHECK(iot_tls_read(network, buf, 1, &timer, &readLen) == NETWORK_SSL_NOTHING_TO_READ);
+    CHECK(tls_stub_counts.readTimeoutSets > before.readTimeoutSets);
+}
+
+/* The rest of a packet read late in the yield waits no longer than the yield has left */
+static void check_late_read(Network *network) {
+    unsigned char buf[sizeof(publish)];
+    size_t readLen = 0;
+    TickType_t start;
+    uint32_t left;
+    Timer timer;
+
+    TlsStub_QueueRecord(publish, 2);
+    start_yield(&timer);
+    CHECK(iot_tls_read(network, buf, 2, &timer, &readLen) == SUCCESS && readLen == 2);
+    vTaskDelay(YIELD_MS * 3 / 4);
+
+    start = xTaskGetTickCount();
+    left = left_ms(&timer);
+    CHECK(left < YIELD_MS);
+    CHECK(iot_tls_read(network, buf + 2, sizeof(publish) - 2, &timer, &readLen) == NETWORK_SSL_NOTHING_TO_READ);
+    CHECK(network->tlsDataParams.credentials.conf.read_timeout <= left);
+    CHECK(xTaskGetTickCount() - start <= left + 10);
+}
+
+int main(void) {
+    Network network;
+
+    uint16_t port = TlsStub_StartEndpoint(0, false);
+    CHECK(port != 0);
+
+    memset(&network, 0, sizeof(network));
+    CHECK(iot_tls_init(&network, rootCA, "#", "#0", HOST, port, TIMEOUT_MS, true) == SUCCESS);
+    CHECK(iot_tls_connect(&network, NULL) == SUCCESS);
+
+    check_one_record(&network);
+    check_split_packet(&network);
+    check_long_packet(&network);
+    check_timeout(&network);
+    check_late_read(&network);
+    TlsStub_ClearRecords();
+
+    CHECK(iot_tls_disconnect(&network) == SUCCESS);
+    CHECK(iot_tls_destroy(&network) == SUCCESS);
+    iot_tls_free(&network.tlsDataParams);
+    TlsStub_StopEndpoint();
+    printf("tls_read_test: OK\n");
+    return 0;
+}
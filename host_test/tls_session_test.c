@@ -0,0 +1,183 @@
+/**
+ * @file tls_session_test.c
+ * @brief Checks session resumption in the device's mbedTLS wrapper, built
+ * with CONFIG_AWS_IOT_TLS_SESSION_NVS: a reconnect resumes the last session
+ * without writing flash, a session the server no longer knows falls back to
+ * a full handshake, a restart resumes the session saved in NVS, and a failed
+ * handshake or an unreadable saved session leads to a full handshake.
+ *
+ * The handshake and the mock endpoint are the ones of tls_stubs/; NVS is kept
+ * in memory there.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "network_interface.h"
+#include "nvs.h"
+#include "tls_stubs.h"
+#include "check.h"
+
+#define HOST "127.0.0.1"
+#define TIMEOUT_MS 2000
+
+// Where the wrapper saves the session
+#define NVS_NAMESPACE "aws_iot_tls"
+#define NVS_SESSION_KEY "session"
+
+static const char rootCA[] = "-----BEGIN CERTIFICATE-----\nMIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\n"
+    "-----END CERTIFICATE-----\n";
+
+static uint16_t port;
+
+/* Sets up the network as a freshly started device would */
+static void start_device(Network *network) {
+    memset(network, 0, sizeof(*network));
+    CHECK(iot_tls_init(network, rootCA, "#", "#0", HOST, port, TIMEOUT_MS, true) == SUCCESS);
+    CHECK(!network->tlsDataParams.has_session);
+}
+
+static void stop_device(Network *network) {
+    iot_tls_free(&network->tlsDataParams);
+    CHECK(tls_stub_counts.configs == tls_stub_counts.configFrees);
+}
+
+static void close_connection(Network *network) {
+    CHECK(iot_tls_disconnect(network) == SUCCESS);
+    CHECK(iot_tls_destroy(network) == SUCCESS);
+}
+
+static size_t saved_session_len(void) {
+    nvs_handle_t handle;
+    size_t len = 0;
+
+    CHECK(nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK);
+    if (nvs_get_blob(handle, NVS_SESSION_KEY, NULL, &len) != ESP_OK) {
+        len = 0;
+    }
+    nvs_close(handle);
+    return len;
+}
+
+static bool same_session(const mbedtls_ssl_session *a, const mbedtls_ssl_session *b) {
+    return a->id_len == b->id_len && memcmp(a->id, b->id, a->id_len) == 0
+        && memcmp(a->master, b->master, sizeof(a->master)) == 0
+        && a->ciphersuite == b->ciphersuite && a->verify_result == b->verify_result;
+}
+
+/* The first connect saves its new session; reconnects resume it and leave flash alone */
+static void check_resumed_reconnect(Network *network) {
+    tls_stub_counts_t before = tls_stub_counts;
+    mbedtls_ssl_session first;
+
+    CHECK(iot_tls_connect(network, NULL) == SUCCESS);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes + 1);
+    CHECK(tls_stub_counts.nvsWrites == before.nvsWrites + 1);
+    CHECK(network->tlsDataParams.has_session && saved_session_len() > 0);
+    first = network->tlsDataParams.session;
+    close_connection(network);
+
+    before = tls_stub_counts;
+    CHECK(iot_tls_connect(network, NULL) == SUCCESS);
+    CHECK(tls_stub_counts.resumedHandshakes == before.resumedHandshakes + 1);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes);
+    CHECK(tls_stub_counts.nvsWrites == before.nvsWrites);
+    CHECK(same_session(&network->tlsDataParams.session, &first));
+    CHECK(network->tlsDataParams.handshake_stats.resumed == 1);
+    close_connection(network);
+}
+
+/* A server that forgot the session answers with a full handshake, whose session replaces it */
+static void check_rejected_session(Network *network) {
+    tls_stub_counts_t before = tls_stub_counts;
+    mbedtls_ssl_session old = network->tlsDataParams.session;
+
+    TlsStub_SetResumption(false);
+    CHECK(iot_tls_connect(network, NULL) == SUCCESS);
+    TlsStub_SetResumption(true);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes + 1);
+    CHECK(tls_stub_counts.resumedHandshakes == before.resumedHandshakes);
+    CHECK(network->tlsDataParams.has_session && !same_session(&network->tlsDataParams.session, &old));
+    CHECK(tls_stub_counts.nvsWrites == before.nvsWrites + 1);
+    close_connection(network);
+
+    // The new session is the one resumed next
+    before = tls_stub_counts;
+    CHECK(iot_tls_connect(network, NULL) == SUCCESS);
+    CHECK(tls_stub_counts.resumedHandshakes == before.resumedHandshakes + 1);
+    close_connection(network);
+}
+
+/* After a restart the session comes back from NVS, as it was saved */
+static void check_restart(Network *network) {
+    tls_stub_counts_t before;
+    mbedtls_ssl_session saved = network->tlsDataParams.session;
+
+    stop_device(network);
+    start_device(network);
+
+    before = tls_stub_counts;
+    CHECK(iot_tls_connect(network, NULL) == SUCCESS);
+    CHECK(tls_stub_counts.resumedHandshakes == before.resumedHandshakes + 1);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes);
+    CHECK(tls_stub_counts.nvsWrites == before.nvsWrites);
+    CHECK(same_session(&network->tlsDataParams.session, &saved));
+    close_connection(network);
+}
+
+/* A failed handshake drops the session from memory and NVS; the next connect starts over */
+static void check_failed_handshake(Network *network) {
+    tls_stub_counts_t before;
+
+    TlsStub_FailNextHandshake();
+    CHECK(iot_tls_connect(network, NULL) == SSL_CONNECTION_ERROR);
+    CHECK(!network->tlsDataParams.has_session);
+    CHECK(saved_session_len() == 0);
+    CHECK(iot_tls_destroy(network) == SUCCESS);
+
+    before = tls_stub_counts;
+    CHECK(iot_tls_connect(network, NULL) == SUCCESS);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes + 1);
+    CHECK(tls_stub_counts.nvsWrites == before.nvsWrites + 1);
+    close_connection(network);
+}
+
+/* A saved session that does not read back, e.g. from another firmware version, is not offered */
+static void check_unreadable_session(Network *network) {
+    static const unsigned char junk[] = { 0x7F, 1, 2, 3, 4 };
+    tls_stub_counts_t before;
+    nvs_handle_t handle;
+
+    stop_device(network);
+    CHECK(nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK);
+    CHECK(nvs_set_blob(handle, NVS_SESSION_KEY, junk, sizeof(junk)) == ESP_OK);
+    nvs_close(handle);
+    start_device(network);
+
+    before = tls_stub_counts;
+    CHECK(iot_tls_connect(network, NULL) == SUCCESS);
+    CHECK(tls_stub_counts.fullHandshakes == before.fullHandshakes + 1);
+    CHECK(tls_stub_counts.resumedHandshakes == before.resumedHandshakes);
+    // Replaced by the new session
+    CHECK(saved_session_len() > sizeof(junk));
+    close_connection(network);
+}
+
+int main(void) {
+    Network network;
+
+    port = TlsStub_StartEndpoint(0, true);
+    CHECK(port != 0);
+    start_device(&network);
+
+    check_resumed_reconnect(&network);
+    check_rejected_session(&network);
+    check_restart(&network);
+    check_failed_handshake(&network);
+    check_unreadable_session(&network);
+
+    stop_device(&network);
+    TlsStub_StopEndpoint();
+    printf("tls_session_test: OK\n");
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file ssl.h
+ * @brief Just enough of the mbedTLS 2.16 API for the device's TLS wrapper
+ * (components/esp-aws-iot/port) to build on the host. The handshake is a
+ * stand-in spoken with the mock endpoint of tls_stubs.c; the credential and
+ * handshake calls are counted and take the time set in tls_stub_costs.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_NET_SOCKET_FAILED -0x0042
+#define MBEDTLS_ERR_NET_CONNECT_FAILED -0x0044
+#define MBEDTLS_ERR_NET_UNKNOWN_HOST -0x0052
+#define MBEDTLS_ERR_X509_CERT_VERIFY_FAILED -0x2700
+#define MBEDTLS_ERR_X509_INVALID_FORMAT -0x2180
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA -0x7100
+#define MBEDTLS_ERR_SSL_CONN_EOF -0x7280
+#define MBEDTLS_ERR_SSL_HANDSHAKE_FAILURE -0x7780
+#define MBEDTLS_ERR_SSL_TIMEOUT -0x6800
+#define MBEDTLS_ERR_SSL_WANT_READ -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE -0x6880
+
+#define MBEDTLS_NET_PROTO_TCP 0
+#define MBEDTLS_SSL_IS_CLIENT 0
+#define MBEDTLS_SSL_TRANSPORT_STREAM 0
+#define MBEDTLS_SSL_PRESET_DEFAULT 0
+#define MBEDTLS_SSL_VERIFY_OPTIONAL 1
+#define MBEDTLS_SSL_VERIFY_REQUIRED 2
+
+typedef struct {
+    int fd;
+} mbedtls_net_context;
+
+typedef struct {
+    int seeded;
+} mbedtls_entropy_context;
+
+typedef struct {
+    int seeded;
+} mbedtls_ctr_drbg_context;
+
+typedef struct mbedtls_x509_crt {
+    int loaded;
+} mbedtls_x509_crt;
+
+typedef struct {
+    int loaded;
+} mbedtls_pk_context;
+
+typedef struct {
+    int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *);
+    void *p_vrfy;
+    int authmode;
+    uint32_t read_timeout;
+    int ready;
+} mbedtls_ssl_config;
+
+typedef struct {
+    int ciphersuite;
+    int compression;
+    unsigned char id[32];
+    size_t id_len;
+    unsigned char master[48];
+    uint32_t verify_result;
+} mbedtls_ssl_session;
+
+typedef int mbedtls_ssl_send_t(void *ctx, const unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_timeout_t(void *ctx, unsigned char *buf, size_t len, uint32_t timeout);
+
+typedef struct {
+    int state;
+    const mbedtls_ssl_config *conf;
+    void *p_bio;
+    mbedtls_ssl_session session;
+    bool offer_session;
+    mbedtls_x509_crt peer_cert;
+} mbedtls_ssl_context;
+
+typedef struct {
+    int slot;
+} atcacert_def_t;
+
+void mbedtls_net_init(mbedtls_net_context *ctx);
+int mbedtls_net_connect(mbedtls_net_context *ctx, const char *host, const char *port, int proto);
+int mbedtls_net_set_block(mbedtls_net_context *ctx);
+int mbedtls_net_send(void *ctx, const unsigned char *buf, size_t len);
+int mbedtls_net_recv_timeout(void *ctx, unsigned char *buf, size_t len, uint32_t timeout);
+void mbedtls_net_free(mbedtls_net_context *ctx);
+
+void mbedtls_entropy_init(mbedtls_entropy_context *ctx);
+int mbedtls_entropy_func(void *data, unsigned char *output, size_t len);
+void mbedtls_entropy_free(mbedtls_entropy_context *ctx);
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context *ctx);
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context *ctx, int (*f_entropy)(void *, unsigned char *, size_t),
+    void *p_entropy, const unsigned char *custom, size_t len);
+int mbedtls_ctr_drbg_random(void *p_rng, unsigned char *output, size_t output_len);
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context *ctx);
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt *crt);
+int mbedtls_x509_crt_parse(mbedtls_x509_crt *chain, const unsigned char *buf, size_t buflen);
+int mbedtls_x509_crt_parse_file(mbedtls_x509_crt *chain, const char *path);
+int mbedtls_x509_crt_info(char *buf, size_t size, const char *prefix, const mbedtls_x509_crt *crt);
+int mbedtls_x509_crt_verify_info(char *buf, size_t size, const char *prefix, uint32_t flags);
+void mbedtls_x509_crt_free(mbedtls_x509_crt *crt);
+
+void mbedtls_pk_init(mbedtls_pk_context *ctx);
+int mbedtls_pk_parse_key(mbedtls_pk_context *ctx, const unsigned char *key, size_t keylen,
+    const unsigned char *pwd, size_t pwdlen);
+int mbedtls_pk_parse_keyfile(mbedtls_pk_context *ctx, const char *path, const char *password);
+void mbedtls_pk_free(mbedtls_pk_context *ctx);
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf);
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *conf, int endpoint, int transport, int preset);
+void mbedtls_ssl_conf_verify(mbedtls_ssl_config *conf, int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
+    void *p_vrfy);
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *conf, int authmode);
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *conf, int (*f_rng)(void *, unsigned char *, size_t), void *p_rng);
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config *conf, mbedtls_x509_crt *ca_chain, void *ca_crl);
+int mbedtls_ssl_conf_own_cert(mbedtls_ssl_config *conf, mbedtls_x509_crt *own_cert, mbedtls_pk_context *pk_key);
+void mbedtls_ssl_conf_read_timeout(mbedtls_ssl_config *conf, uint32_t timeout);
+void mbedtls_ssl_config_free(mbedtls_ssl_config *conf);
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl);
+int mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf);
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl, const char *hostname);
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *ssl, void *p_bio, mbedtls_ssl_send_t *f_send, void *f_recv,
+    mbedtls_ssl_recv_timeout_t *f_recv_timeout);
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session);
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl, mbedtls_ssl_session *session);
+int mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+const char *mbedtls_ssl_get_version(const mbedtls_ssl_context *ssl);
+const char *mbedtls_ssl_get_ciphersuite(const mbedtls_ssl_context *ssl);
+int mbedtls_ssl_get_record_expansion(const mbedtls_ssl_context *ssl);
+uint32_t mbedtls_ssl_get_verify_result(const mbedtls_ssl_context *ssl);
+const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert(const mbedtls_ssl_context *ssl);
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *ssl);
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len);
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len);
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *ssl);
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl);
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session);
+
+int tng_get_device_cert_def(const atcacert_def_t **cert_def);
+int atca_mbedtls_cert_add(mbedtls_x509_crt *cert, const atcacert_def_t *cert_def);
+int atca_mbedtls_pk_init(mbedtls_pk_context *pkey, int slotid);
@@ -0,0 +1,660 @@
+/**
+ * @file tls_stubs.c
+ * @brief Host stand-ins for the mbedTLS, ATECC608, NVS and FreeRTOS calls of the
+ * device's TLS wrapper, and the mock endpoint its handshake talks to.
+ *
+ * The stubbed handshake sends a hello with the session ID it was given, if
+ * any. The endpoint answers 'R' when it knows the ID, for a one round trip
+ * resumption, or 'F' and a new ID for a full handshake, which verifies the
+ * server certificate through the config's verify callback and takes a second
+ * round trip. Application data goes over the socket as it is.
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mbedtls/ssl.h"
+#include "nvs.h"
+#include "tls_stubs.h"
+
+#define SESSION_ID_LEN 8
+#define RECORD_QUEUE_LEN 16
+#define RECORD_QUEUE_BYTES 4096
+#define NVS_KEYS 4
+#define NVS_BLOB_LEN 256
+#define STUB_CIPHERSUITE 0xC02B     // TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256
+
+tls_stub_costs_t tls_stub_costs;
+tls_stub_counts_t tls_stub_counts;
+
+static const atcacert_def_t deviceCertDef = { .slot = 10 };
+
+static struct {
+    int listenFd;
+    uint32_t rttMs;
+    volatile bool resumption;
+    unsigned char lastId[SESSION_ID_LEN];
+    bool issued;
+    unsigned nextId;
+    pthread_t thread;
+} endpoint = { .listenFd = -1 };
+
+// Records mbedtls_ssl_read returns instead of reading the socket
+static struct {
+    bool active;
+    unsigned char data[RECORD_QUEUE_BYTES];
+    size_t ends[RECORD_QUEUE_LEN];  // End of each record in data
+    size_t count;
+    size_t next;                    // Record being read
+    size_t pos;                     // Read position in data
+} records;
+
+static bool failNextHandshake;
+
+// The NVS blobs, all in one namespace
+static struct {
+    char key[16];
+    unsigned char data[NVS_BLOB_LEN];
+    size_t len;
+    bool used;
+} nvsKeys[NVS_KEYS];
+
+static void spend_us(uint32_t us) {
+    struct timespec delay = { .tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000L };
+    if (us > 0) {
+        nanosleep(&delay, NULL);
+    }
+}
+
+static bool send_all(int fd, const unsigned char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t ret = send(fd, buf, len, MSG_NOSIGNAL);
+        if (ret <= 0) {
+            return false;
+        }
+        buf += ret;
+        len -= (size_t)ret;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, unsigned char *buf, size_t len, int timeoutMs) {
+    while (len > 0) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, timeoutMs) <= 0) {
+            return false;
+        }
+        ssize_t ret = recv(fd, buf, len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        buf += ret;
+        len -= (size_t)ret;
+    }
+    return true;
+}
+
+/* ---- FreeRTOS ---- */
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    spend_us(ticks * 1000);
+}
+
+/* ---- Sockets ---- */
+
+void mbedtls_net_init(mbedtls_net_context *ctx) {
+    ctx->fd = -1;
+}
+
+int mbedtls_net_connect(mbedtls_net_context *ctx, const char *host, const char *port, int proto) {
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *addr;
+    int one = 1;
+
+    if (getaddrinfo(host, port, &hints, &addr) != 0) {
+        return MBEDTLS_ERR_NET_UNKNOWN_HOST;
+    }
+    ctx->fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (ctx->fd < 0) {
+        freeaddrinfo(addr);
+        return MBEDTLS_ERR_NET_SOCKET_FAILED;
+    }
+    if (connect(ctx->fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+        freeaddrinfo(addr);
+        close(ctx->fd);
+        ctx->fd = -1;
+        return MBEDTLS_ERR_NET_CONNECT_FAILED;
+    }
+    freeaddrinfo(addr);
+    setsockopt(ctx->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return 0;
+}
+
+int mbedtls_net_set_block(mbedtls_net_context *ctx) {
+    return 0;
+}
+
+int mbedtls_net_send(void *ctx, const unsigned char *buf, size_t len) {
+    ssize_t ret = send(((mbedtls_net_context *)ctx)->fd, buf, len, MSG_NOSIGNAL);
+    return ret < 0 ? MBEDTLS_ERR_SSL_CONN_EOF : (int)ret;
+}
+
+int mbedtls_net_recv_timeout(void *ctx, unsigned char *buf, size_t len, uint32_t timeout) {
+    struct pollfd pfd = { .fd = ((mbedtls_net_context *)ctx)->fd, .events = POLLIN };
+    if (poll(&pfd, 1, timeout == 0 ? -1 : (int)timeout) == 0) {
+        return MBEDTLS_ERR_SSL_TIMEOUT;
+    }
+    ssize_t ret = recv(pfd.fd, buf, len, 0);
+    return ret < 0 ? MBEDTLS_ERR_SSL_CONN_EOF : (int)ret;
+}
+
+void mbedtls_net_free(mbedtls_net_context *ctx) {
+    if (ctx->fd >= 0) {
+        close(ctx->fd);
+    }
+    ctx->fd = -1;
+}
+
+/* ---- Credentials ---- */
+
+void mbedtls_entropy_init(mbedtls_entropy_context *ctx) {
+    ctx->seeded = 0;
+}
+
+int mbedtls_entropy_func(void *data, unsigned char *output, size_t len) {
+    memset(output, 0x5a, len);
+    return 0;
+}
+
+void mbedtls_entropy_free(mbedtls_entropy_context *ctx) {
+}
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context *ctx) {
+    ctx->seeded = 0;
+}
+
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context *ctx, int (*f_entropy)(void *, unsigned char *, size_t),
+        void *p_entropy, const unsigned char *custom, size_t len) {
+    tls_stub_counts.drbgSeeds++;
+    spend_us(tls_stub_costs.drbgSeedUs);
+    ctx->seeded = 1;
+    return 0;
+}
+
+int mbedtls_ctr_drbg_random(void *p_rng, unsigned char *output, size_t output_len) {
+    memset(output, 0xa5, output_len);
+    return 0;
+}
+
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context *ctx) {
+    ctx->seeded = 0;
+}
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt *crt) {
+    crt->loaded = 0;
+}
+
+int mbedtls_x509_crt_parse(mbedtls_x509_crt *chain, const unsigned char *buf, size_t buflen) {
+    static const char pemHeader[] = "-----BEGIN CERTIFICATE-----";
+
+    tls_stub_counts.certParses++;
+    spend_us(tls_stub_costs.certParseUs);
+    if (buflen < sizeof(pemHeader) || memcmp(buf, pemHeader, sizeof(pemHeader) - 1) != 0) {
+        return MBEDTLS_ERR_X509_INVALID_FORMAT;
+    }
+    chain->loaded = 1;
+    return 0;
+}
+
+int mbedtls_x509_crt_parse_file(mbedtls_x509_crt *chain, const char *path) {
+    return MBEDTLS_ERR_X509_INVALID_FORMAT;
+}
+
+int mbedtls_x509_crt_info(char *buf, size_t size, const char *prefix, const mbedtls_x509_crt *crt) {
+    return snprintf(buf, size, "%smock endpoint certificate", prefix);
+}
+
+int mbedtls_x509_crt_verify_info(char *buf, size_t size, const char *prefix, uint32_t flags) {
+    return snprintf(buf, size, "%sflags 0x%x", prefix, flags);
+}
+
+void mbedtls_x509_crt_free(mbedtls_x509_crt *crt) {
+    crt->loaded = 0;
+}
+
+void mbedtls_pk_init(mbedtls_pk_context *ctx) {
+    ctx->loaded = 0;
+}
+
+int mbedtls_pk_parse_key(mbedtls_pk_context *ctx, const unsigned char *key, size_t keylen,
+        const unsigned char *pwd, size_t pwdlen) {
+    tls_stub_counts.keyLoads++;
+    ctx->loaded = 1;
+    return 0;
+}
+
+int mbedtls_pk_parse_keyfile(mbedtls_pk_context *ctx, const char *path, const char *password) {
+    return MBEDTLS_ERR_X509_INVALID_FORMAT;
+}
+
+void mbedtls_pk_free(mbedtls_pk_context *ctx) {
+    ctx->loaded = 0;
+}
+
+int tng_get_device_cert_def(const atcacert_def_t **cert_def) {
+    *cert_def = &deviceCertDef;
+    return 0;
+}
+
+int atca_mbedtls_cert_add(mbedtls_x509_crt *cert, const atcacert_def_t *cert_def) {
+    tls_stub_counts.atcaCertAdds++;
+    spend_us(tls_stub_costs.atcaCertUs);
+    cert->loaded = 1;
+    return 0;
+}
+
+int atca_mbedtls_pk_init(mbedtls_pk_context *pkey, int slotid) {
+    tls_stub_counts.keyLoads++;
+    spend_us(tls_stub_costs.atcaKeyUs);
+    pkey->loaded = 1;
+    return 0;
+}
+
+/* ---- Config ---- */
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf) {
+    memset(conf, 0, sizeof(*conf));
+}
+
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *conf, int endpoint, int transport, int preset) {
+    tls_stub_counts.configs++;
+    conf->ready = 1;
+    return 0;
+}
+
+void mbedtls_ssl_conf_verify(mbedtls_ssl_config *conf, int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
+        void *p_vrfy) {
+    conf->f_vrfy = f_vrfy;
+    conf->p_vrfy = p_vrfy;
+}
+
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *conf, int authmode) {
+    conf->authmode = authmode;
+}
+
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *conf, int (*f_rng)(void *, unsigned char *, size_t), void *p_rng) {
+}
+
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config *conf, mbedtls_x509_crt *ca_chain, void *ca_crl) {
+}
+
+int mbedtls_ssl_conf_own_cert(mbedtls_ssl_config *conf, mbedtls_x509_crt *own_cert, mbedtls_pk_context *pk_key) {
+    return own_cert->loaded && pk_key->loaded ? 0 : MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+}
+
+void mbedtls_ssl_conf_read_timeout(mbedtls_ssl_config *conf, uint32_t timeout) {
+    tls_stub_counts.readTimeoutSets++;
+    conf->read_timeout = timeout;
+}
+
+void mbedtls_ssl_config_free(mbedtls_ssl_config *conf) {
+    if (conf->ready) {
+        tls_stub_counts.configFrees++;
+    }
+    memset(conf, 0, sizeof(*conf));
+}
+
+/* ---- SSL context ---- */
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl) {
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+int mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf) {
+    if (!conf->ready) {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+    ssl->conf = conf;
+    return 0;
+}
+
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl, const char *hostname) {
+    return 0;
+}
+
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *ssl, void *p_bio, mbedtls_ssl_send_t *f_send, void *f_recv,
+        mbedtls_ssl_recv_timeout_t *f_recv_timeout) {
+    ssl->p_bio = p_bio;
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session) {
+    ssl->session = *session;
+    ssl->offer_session = true;
+    return 0;
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl, mbedtls_ssl_session *session) {
+    *session = ssl->session;
+    return 0;
+}
+
+int mbedtls_ssl_handshake(mbedtls_ssl_context *ssl) {
+    int fd = ((mbedtls_net_context *)ssl->p_bio)->fd;
+    int timeoutMs = (int)ssl->conf->read_timeout;
+    unsigned char hello[2 + SESSION_ID_LEN] = { 'H', 0 };
+    unsigned char reply[1 + SESSION_ID_LEN];
+    unsigned char finished = 'K';
+    uint32_t flags = 0;
+
+    if (ssl->offer_session && ssl->session.id_len == SESSION_ID_LEN) {
+        hello[1] = SESSION_ID_LEN;
+        memcpy(hello + 2, ssl->session.id, SESSION_ID_LEN);
+    }
+    if (failNextHandshake) {
+        failNextHandshake = false;
+        return MBEDTLS_ERR_SSL_HANDSHAKE_FAILURE;
+    }
+    if (!send_all(fd, hello, sizeof(hello)) || !recv_all(fd, reply, sizeof(reply), timeoutMs)) {
+        return MBEDTLS_ERR_SSL_CONN_EOF;
+    }
+
+    if (reply[0] == 'R') {
+        spend_us(tls_stub_costs.resumedHandshakeUs);
+        tls_stub_counts.resumedHandshakes++;
+        ssl->state = 1;
+        return 0;
+    }
+
+    /* Full handshake: the endpoint's certificate, then the client's second flight */
+    ssl->peer_cert.loaded = 1;
+    if (ssl->conf->f_vrfy != NULL) {
+        ssl->conf->f_vrfy(ssl->conf->p_vrfy, &ssl->peer_cert, 0, &flags);
+    }
+    spend_us(tls_stub_costs.fullHandshakeUs);
+    if (!send_all(fd, &finished, 1) || !recv_all(fd, &finished, 1, timeoutMs)) {
+        return MBEDTLS_ERR_SSL_CONN_EOF;
+    }
+    memcpy(ssl->session.id, reply + 1, SESSION_ID_LEN);
+    ssl->session.id_len = SESSION_ID_LEN;
+    ssl->session.ciphersuite = STUB_CIPHERSUITE;
+    for (size_t i = 0; i < sizeof(ssl->session.master); i++) {
+        ssl->session.master[i] = (unsigned char)(ssl->session.id[i % SESSION_ID_LEN] + i);
+    }
+    ssl->session.verify_result = flags;
+    tls_stub_counts.fullHandshakes++;
+    ssl->state = 1;
+    return 0;
+}
+
+const char *mbedtls_ssl_get_version(const mbedtls_ssl_context *ssl) {
+    return "TLSv1.2";
+}
+
+const char *mbedtls_ssl_get_ciphersuite(const mbedtls_ssl_context *ssl) {
+    return "TLS-ECDHE-ECDSA-WITH-AES-128-GCM-SHA256";
+}
+
+int mbedtls_ssl_get_record_expansion(const mbedtls_ssl_context *ssl) {
+    return 29;
+}
+
+uint32_t mbedtls_ssl_get_verify_result(const mbedtls_ssl_context *ssl) {
+    return ssl->session.verify_result;
+}
+
+const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert(const mbedtls_ssl_context *ssl) {
+    return ssl->peer_cert.loaded ? &ssl->peer_cert : NULL;
+}
+
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *ssl) {
+    // What is left of a record that was partly read; the next one is still encrypted
+    size_t start = records.next > 0 ? records.ends[records.next - 1] : 0;
+    return records.active && records.next < records.count && records.pos > start
+        ? records.ends[records.next] - records.pos : 0;
+}
+
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len) {
+    tls_stub_counts.sslReads++;
+    if (!records.active) {
+        return mbedtls_net_recv_timeout(ssl->p_bio, buf, len, ssl->conf->read_timeout);
+    }
+
+    if (records.next == records.count) {
+        spend_us(ssl->conf->read_timeout * 1000);
+        return MBEDTLS_ERR_SSL_TIMEOUT;
+    }
+    size_t n = records.ends[records.next] - records.pos;
+    if (n > len) {
+        n = len;
+    }
+    memcpy(buf, records.data + records.pos, n);
+    records.pos += n;
+    if (records.pos == records.ends[records.next]) {
+        records.next++;
+    }
+    return (int)n;
+}
+
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len) {
+    return mbedtls_net_send(ssl->p_bio, buf, len);
+}
+
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *ssl) {
+    return 0;
+}
+
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl) {
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session) {
+    memset(session, 0, sizeof(*session));
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session) {
+    memset(session, 0, sizeof(*session));
+}
+
+void TlsStub_QueueRecord(const void *data, size_t len) {
+    size_t start = records.count > 0 ? records.ends[records.count - 1] : 0;
+
+    if (records.count == RECORD_QUEUE_LEN || start + len > RECORD_QUEUE_BYTES) {
+        fprintf(stderr, "TlsStub_QueueRecord: queue full\n");
+        return;
+    }
+    memcpy(records.data + start, data, len);
+    records.ends[records.count++] = start + len;
+    records.active = true;
+}
+
+void TlsStub_ClearRecords(void) {
+    memset(&records, 0, sizeof(records));
+}
+
+void TlsStub_FailNextHandshake(void) {
+    failNextHandshake = true;
+}
+
+/* ---- NVS ---- */
+
+static int nvs_find(const char *key) {
+    for (int i = 0; i < NVS_KEYS; i++) {
+        if (nvsKeys[i].used && strcmp(nvsKeys[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    *out_handle = open_mode == NVS_READWRITE ? 2 : 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    int i = nvs_find(key);
+    if (i < 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value != NULL) {
+        if (*length < nvsKeys[i].len) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, nvsKeys[i].data, nvsKeys[i].len);
+    }
+    *length = nvsKeys[i].len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    int i = nvs_find(key);
+
+    if (handle != 2) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    for (int j = 0; i < 0 && j < NVS_KEYS; j++) {
+        if (!nvsKeys[j].used) {
+            i = j;
+        }
+    }
+    if (i < 0 || length > NVS_BLOB_LEN || strlen(key) >= sizeof(nvsKeys[i].key)) {
+        return ESP_FAIL;
+    }
+    strcpy(nvsKeys[i].key, key);
+    memcpy(nvsKeys[i].data, value, length);
+    nvsKeys[i].len = length;
+    nvsKeys[i].used = true;
+    tls_stub_counts.nvsWrites++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    int i = nvs_find(key);
+    if (handle != 2) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (i < 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    nvsKeys[i].used = false;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle) {
+    if (handle != 2) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    memset(nvsKeys, 0, sizeof(nvsKeys));
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+/* ---- Mock endpoint ---- */
+
+static void serve(int fd) {
+    unsigned char hello[2 + SESSION_ID_LEN];
+    unsigned char reply[1 + SESSION_ID_LEN];
+    unsigned char buf[64];
+
+    if (!recv_all(fd, hello, sizeof(hello), -1)) {
+        return;
+    }
+
+    spend_us(endpoint.rttMs * 1000);
+    if (endpoint.resumption && endpoint.issued && hello[1] == SESSION_ID_LEN
+        && memcmp(hello + 2, endpoint.lastId, SESSION_ID_LEN) == 0) {
+        reply[0] = 'R';
+        memcpy(reply + 1, endpoint.lastId, SESSION_ID_LEN);
+        send_all(fd, reply, sizeof(reply));
+    } else {
+        endpoint.nextId++;
+        memset(endpoint.lastId, 0, SESSION_ID_LEN);
+        memcpy(endpoint.lastId, &endpoint.nextId, sizeof(endpoint.nextId));
+        endpoint.issued = true;
+        reply[0] = 'F';
+        memcpy(reply + 1, endpoint.lastId, SESSION_ID_LEN);
+        if (!send_all(fd, reply, sizeof(reply)) || !recv_all(fd, buf, 1, -1)) {
+            return;
+        }
+        spend_us(endpoint.rttMs * 1000);
+        buf[0] = 'D';
+        send_all(fd, buf, 1);
+    }
+
+    // Whatever follows is discarded until the client closes
+    while (recv(fd, buf, sizeof(buf), 0) > 0) {
+    }
+}
+
+static void *endpoint_thread(void *arg) {
+    int one = 1;
+
+    for (;;) {
+        int fd = accept(endpoint.listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return NULL;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        serve(fd);
+        close(fd);
+    }
+}
+
+uint16_t TlsStub_StartEndpoint(uint32_t rttMs, bool resumption) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addrLen = sizeof(addr);
+
+    endpoint.rttMs = rttMs;
+    endpoint.resumption = resumption;
+    endpoint.issued = false;
+    endpoint.listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (endpoint.listenFd < 0
+        || bind(endpoint.listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+        || listen(endpoint.listenFd, 4) != 0
+        || getsockname(endpoint.listenFd, (struct sockaddr *)&addr, &addrLen) != 0
+        || pthread_create(&endpoint.thread, NULL, endpoint_thread, NULL) != 0) {
+        if (endpoint.listenFd >= 0) {
+            close(endpoint.listenFd);
+        }
+        endpoint.listenFd = -1;
+        return 0;
+    }
+    return ntohs(addr.sin_port);
+}
+
+void TlsStub_SetResumption(bool resumption) {
+    endpoint.resumption = resumption;
+}
+
+void TlsStub_StopEndpoint(void) {
+    shutdown(endpoint.listenFd, SHUT_RDWR);
+    pthread_join(endpoint.thread, NULL);
+    close(endpoint.listenFd);
+    endpoint.listenFd = -1;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file tls_stubs.h
+ * @brief Controls of the host stand-ins for mbedTLS, the ATECC608 and NVS: what
+ * each credential and handshake step costs, how often each ran, and the mock
+ * TLS endpoint the stubbed handshake talks to over loopback TCP.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Time each stubbed step takes, in microseconds. All zero by default. */
+typedef struct {
+    uint32_t drbgSeedUs;          ///< mbedtls_ctr_drbg_seed
+    uint32_t certParseUs;         ///< mbedtls_x509_crt_parse, per call
+    uint32_t atcaCertUs;          ///< atca_mbedtls_cert_add, rebuilding the device certificate over I2C
+    uint32_t atcaKeyUs;           ///< atca_mbedtls_pk_init, reading the public key over I2C
+    uint32_t fullHandshakeUs;     ///< Client crypto of a full handshake: key exchange, chain verify, ATECC608 sign
+    uint32_t resumedHandshakeUs;  ///< Client crypto of a resumed handshake
+} tls_stub_costs_t;
+
+/** How often each step ran */
+typedef struct {
+    unsigned drbgSeeds;
+    unsigned certParses;
+    unsigned atcaCertAdds;
+    unsigned keyLoads;
+    unsigned configs;             ///< mbedtls_ssl_config_defaults
+    unsigned configFrees;
+    unsigned fullHandshakes;
+    unsigned resumedHandshakes;
+    unsigned sslReads;            ///< mbedtls_ssl_read
+    unsigned readTimeoutSets;     ///< mbedtls_ssl_conf_read_timeout
+    unsigned nvsWrites;           ///< nvs_set_blob
+} tls_stub_counts_t;
+
+extern tls_stub_costs_t tls_stub_costs;
+extern tls_stub_counts_t tls_stub_counts;
+
+/**
+ * @brief Starts the mock endpoint on an ephemeral loopback port. It serves one
+ * connection at a time and waits @p rttMs before each reply; a full handshake
+ * takes two round trips, a resumed one a single one.
+ *
+ * @param resumption Whether the endpoint resumes the last session it issued
+ * @return The port, 0 on failure
+ */
+uint16_t TlsStub_StartEndpoint(uint32_t rttMs, bool resumption);
+
+/** @brief Whether the running endpoint resumes sessions from now on */
+void TlsStub_SetResumption(bool resumption);
+
+void TlsStub_StopEndpoint(void);
+
+/** @brief Has the next mbedtls_ssl_handshake fail before it sends its hello */
+void TlsStub_FailNextHandshake(void);
+
+/**
+ * @brief Has mbedtls_ssl_read return @p data as one TLS record, after the
+ * records queued before it, instead of reading the socket. Like mbedTLS, a
+ * read returns bytes of one record at most; with none left it times out.
+ */
+void TlsStub_QueueRecord(const void *data, size_t len);
+
+/** @brief Drops the queued records; mbedtls_ssl_read reads the socket again */
+void TlsStub_ClearRecords(void);
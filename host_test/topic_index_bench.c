@@ -0,0 +1,171 @@
+/**
+ * @file topic_index_bench.c
+ * @brief Times how the AWS IoT MQTT client finds the handlers for an incoming
+ * PUBLISH with 5, 25 and 100 subscribed topic filters: its subscription index
+ * against the scan of every filter it replaced, which is reproduced here.
+ * Both must pick the same handlers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aws_iot_config.h"
+#include "aws_iot_mqtt_client_common_internal.h"
+#include "check.h"
+#include "test_util.h"
+
+#define MAX_FILTERS AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS
+#define FILTER_LEN 64
+#define TOPICS 5
+#define LOOKUPS 200000
+
+static AWS_IoT_Client client;
+static char filters[MAX_FILTERS][FILTER_LEN];
+static char topics[TOPICS][FILTER_LEN];
+
+// The matcher the client used before the index, as it was.
+static bool linear_is_topic_matched(const char *pTopicFilter, const char *pTopicName, uint16_t topicNameLen) {
+    const char *curf = pTopicFilter;
+    const char *curn = pTopicName;
+    const char *curn_end = curn + topicNameLen;
+
+    while (*curf && (curn < curn_end)) {
+        if (*curn == '/' && *curf != '/') {
+            break;
+        }
+        if (*curf != '+' && *curf != '#' && *curf != *curn) {
+            break;
+        }
+        if (*curf == '+') {
+            const char *nextpos = curn + 1;
+            while (nextpos < curn_end && *nextpos != '/') {
+                nextpos = ++curn + 1;
+            }
+        } else if (*curf == '#') {
+            curn = curn_end - 1;
+        }
+        curf++;
+        curn++;
+    }
+
+    return (curn == curn_end) && (*curf == '\0');
+}
+
+static uint32_t linear_match(const char *topic, uint16_t topicLen, uint16_t *matches) {
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; i++) {
+        const MessageHandlers *handler = &client.clientData.messageHandlers[i];
+        if (handler->topicName != NULL
+            && ((topicLen == handler->topicNameLen && strncmp(topic, handler->topicName, topicLen) == 0)
+                || linear_is_topic_matched(handler->topicName, topic, topicLen))) {
+            matches[count++] = (uint16_t)i;
+        }
+    }
+    return count;
+}
+
+static uint32_t index_match(const char *topic, uint16_t topicLen, uint16_t *matches) {
+    return aws_iot_mqtt_internal_topic_index_match(&client, topic, topicLen, matches);
+}
+
+// A mix of the shadow topics and the app's own, a quarter of them with wildcards.
+static void subscribe(int count) {
+    memset(&client.clientData.messageHandlers, 0, sizeof(client.clientData.messageHandlers));
+    aws_iot_mqtt_internal_topic_index_init(&client);
+
+    for (int i = 0; i < count; i++) {
+        int room = i / 4;
+        switch (i % 4) {
+        case 0:
+            snprintf(filters[i], FILTER_LEN, "hho/room%d/sensor/temperature", room);
+            break;
+        case 1:
+            snprintf(filters[i], FILTER_LEN, "$aws/things/desk%d/shadow/update/delta", room);
+            break;
+        case 2:
+            snprintf(filters[i], FILTER_LEN, "hho/room%d/+/humidity", room);
+            break;
+        default:
+            snprintf(filters[i], FILTER_LEN, "hho/room%d/alerts/#", room);
+            break;
+        }
+        client.clientData.messageHandlers[i].topicName = filters[i];
+        client.clientData.messageHandlers[i].topicNameLen = (uint16_t)strlen(filters[i]);
+        aws_iot_mqtt_internal_topic_index_add(&client, (uint32_t)i);
+    }
+
+    // Messages for the last room subscribed, and one nobody subscribed to
+    int room = (count - 1) / 4;
+    snprintf(topics[0], FILTER_LEN, "hho/room%d/sensor/temperature", room);
+    snprintf(topics[1], FILTER_LEN, "$aws/things/desk%d/shadow/update/delta", room);
+    snprintf(topics[2], FILTER_LEN, "hho/room%d/desk/humidity", room);
+    snprintf(topics[3], FILTER_LEN, "hho/room%d/alerts/co2/high", room);
+    snprintf(topics[4], FILTER_LEN, "hho/lobby/sensor/temperature");
+}
+
+static double time_lookups(uint32_t (*match)(const char *, uint16_t, uint16_t *), uint32_t *delivered) {
+    uint16_t matches[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+    uint16_t lengths[TOPICS];
+
+    for (int t = 0; t < TOPICS; t++) {
+        lengths[t] = (uint16_t)strlen(topics[t]);
+    }
+
+    *delivered = 0;
+    int64_t start = test_now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        *delivered += match(topics[i % TOPICS], lengths[i % TOPICS], matches);
+    }
+    return (double)(test_now_ns() - start) / LOOKUPS;
+}
+
+static void check_same_handlers(void) {
+    uint16_t expected[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+    uint16_t actual[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+
+    for (int t = 0; t < TOPICS; t++) {
+        uint16_t len = (uint16_t)strlen(topics[t]);
+        uint32_t count = linear_match(topics[t], len, expected);
+        CHECK(index_match(topics[t], len, actual) == count);
+        CHECK(memcmp(expected, actual, count * sizeof(expected[0])) == 0);
+    }
+}
+
+int main(void) {
+    static const int counts[] = { 5, 25, 100 };
+    double linearNs = 0, indexNs = 0;
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        uint32_t linearDelivered, indexDelivered;
+
+        subscribe(counts[c]);
+        check_same_handlers();
+        linearNs = time_lookups(linear_match, &linearDelivered);
+        indexNs = time_lookups(index_match, &indexDelivered);
+        CHECK(linearDelivered == indexDelivered);
+        printf("%3d filters: scan %7.1f ns/message, index %6.1f ns/message, %.1fx\n",
+            counts[c], linearNs, indexNs, linearNs / indexNs);
+    }
+
+    // Unsubscribing every other filter leaves the index consistent
+    for (uint32_t i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; i += 2) {
+        aws_iot_mqtt_internal_topic_index_remove(&client, i);
+        client.clientData.messageHandlers[i].topicName = NULL;
+    }
+    check_same_handlers();
+    for (uint32_t i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; i += 2) {
+        client.clientData.messageHandlers[i].topicName = filters[i];
+        client.clientData.messageHandlers[i].topicNameLen = (uint16_t)strlen(filters[i]);
+        aws_iot_mqtt_internal_topic_index_add(&client, i);
+    }
+    check_same_handlers();
+    CHECK(client.clientData.topicIndex.unindexedHandlers == 0);
+
+    // The index must not lose to the scan once there are many filters
+    CHECK(indexNs < linearNs);
+
+    printf("topic_index_bench: OK\n");
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file welch_psd_test.c
+ * @brief Host tests for the Welch PSD estimator: shared windows, frame
+ * counts for each overlap, Parseval, tone and white noise band levels, plus
+ * a benchmark of one second of 16 kHz audio.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "welch_psd.h"
+#include "check.h"
+#include "test_util.h"
+
+#define RATE 16000
+#define SIZE 512
+#define BINS (SIZE / 2 + 1)
+#define BENCH_SECONDS 50
+
+static int16_t samples[RATE];
+static float psd[BINS];
+
+static test_rng_t rng = { 12345 };
+
+static void make_tone(float frequency_hz, float dbfs) {
+    float amplitude = 32767.0f * powf(10.0f, dbfs / 20.0f);
+    for (int i = 0; i < RATE; i++) {
+        samples[i] = (int16_t)lrintf(amplitude * sinf(6.2831853f * frequency_hz * i / RATE));
+    }
+}
+
+static void make_noise(int amplitude) {
+    for (int i = 0; i < RATE; i++) {
+        samples[i] = test_uniform_int(&rng, amplitude);
+    }
+}
+
+static int band_index(const float *centers, int count, float frequency_hz) {
+    for (int b = 0; b < count; b++) {
+        if (centers[b] == frequency_hz) {
+            return b;
+        }
+    }
+    CHECK(0);
+    return -1;
+}
+
+static void test_windows_are_shared(void) {
+    welch_window_t *hann = WelchPsd_AcquireWindow(WELCH_WINDOW_HANN, SIZE);
+    welch_window_t *again = WelchPsd_AcquireWindow(WELCH_WINDOW_HANN, SIZE);
+    welch_window_t *blackman = WelchPsd_AcquireWindow(WELCH_WINDOW_BLACKMAN, SIZE);
+    CHECK(hann != NULL && hann == again && hann->refs == 2);
+    CHECK(blackman != NULL && blackman != hann);
+    CHECK(WelchPsd_AcquireWindow(WELCH_WINDOW_HANN, 256) == NULL);
+
+    // Periodic: zero at the start, one in the middle, symmetric around it.
+    CHECK(hann->coefficients[0] == 0 && hann->coefficients[SIZE / 2] == 32767);
+    CHECK(hann->coefficients[1] == hann->coefficients[SIZE - 1]);
+    CHECK(fabsf(hann->power_sum - 0.375f * SIZE) < 0.01f * SIZE);
+    CHECK(abs(blackman->coefficients[0]) <= 1);
+
+    WelchPsd_ReleaseWindow(again);
+    WelchPsd_ReleaseWindow(hann);
+    CHECK(hann->refs == 0 && hann->coefficients == NULL);
+    WelchPsd_ReleaseWindow(blackman);
+}
+
+static void test_overlap_sets_the_frame_rate(void) {
+    const int overlaps[] = { 0, 50, 75 };
+    for (size_t i = 0; i < sizeof(overlaps) / sizeof(overlaps[0]); i++) {
+        welch_psd_t estimator;
+        CHECK(WelchPsd_Init(&estimator, SIZE, RATE, WELCH_WINDOW_HANN, overlaps[i], 0.25f, psd));
+        make_noise(1000);
+
+        // Uneven chunks, as the capture frames would not line up with hops.
+        for (int offset = 0; offset < RATE; offset += 700) {
+            WelchPsd_Process(&estimator, samples + offset, offset + 700 <= RATE ? 700 : RATE - offset);
+        }
+        int hop = SIZE * (100 - overlaps[i]) / 100;
+        CHECK(estimator.frames == (uint32_t)(1 + (RATE - SIZE) / hop));
+        CHECK(WelchPsd_Bands(&estimator).seconds == 1);
+        WelchPsd_Free(&estimator);
+    }
+
+    welch_psd_t estimator;
+    CHECK(!WelchPsd_Init(&estimator, SIZE, RATE, WELCH_WINDOW_HANN, 90, 0.25f, psd));
+}
+
+static void test_psd_integrates_to_the_mean_square(void) {
+    welch_psd_t estimator;
+    CHECK(WelchPsd_Init(&estimator, SIZE, RATE, WELCH_WINDOW_HANN, 50, 0.05f, psd));
+    make_noise(8000);
+    double mean_square = 0;
+    for (int i = 0; i < RATE; i++) {
+        mean_square += (samples[i] / 32768.0) * (samples[i] / 32768.0);
+    }
+    mean_square /= RATE;
+
+    for (int second = 0; second < 4; second++) {
+        WelchPsd_Process(&estimator, samples, RATE);
+    }
+    double total = 0;
+    for (int k = 0; k < BINS; k++) {
+        total += psd[k] * ((double)RATE / SIZE);
+    }
+    printf("white noise: PSD integrates to %.2f dB of the mean square\n", 10 * log10(total / mean_square));
+    CHECK(fabs(10 * log10(total / mean_square)) < 0.3);
+    WelchPsd_Free(&estimator);
+}
+
+static void test_tone_lands_in_its_bands(void) {
+    const welch_window_type_t windows[] = { WELCH_WINDOW_HANN, WELCH_WINDOW_BLACKMAN };
+    for (size_t w = 0; w < 2; w++) {
+        welch_psd_t estimator;
+        CHECK(WelchPsd_Init(&estimator, SIZE, RATE, windows[w], 50, 0.25f, psd));
+        // Between bins, where leakage is the worst.
+        make_tone(1015.625f, -20.0f);
+        WelchPsd_Process(&estimator, samples, RATE);
+        welch_bands_t bands = WelchPsd_Bands(&estimator);
+
+        int octave = band_index(welch_octave_centers_hz, WELCH_OCTAVE_BANDS, 1000);
+        int third = band_index(welch_third_octave_centers_hz, WELCH_THIRD_OCTAVE_BANDS, 1000);
+        CHECK(abs(bands.octave_db[octave] + 20) <= 1);
+        CHECK(abs(bands.third_octave_db[third] + 20) <= 1);
+        CHECK(bands.octave_db[octave - 2] < -60);
+        CHECK(bands.octave_db[octave + 2] < -60);
+        CHECK(bands.third_octave_db[third - 3] < -50);
+        CHECK(bands.fluctuation_db <= 1);
+        CHECK(bands.peak_to_mean_db >= 15);
+
+        // The averaged PSD peaks at the tone.
+        int peak = 0;
+        for (int k = 1; k < BINS; k++) {
+            if (psd[k] > psd[peak]) {
+                peak = k;
+            }
+        }
+        CHECK(peak == 32 || peak == 33);
+        WelchPsd_Free(&estimator);
+    }
+}
+
+static void test_white_noise_rises_with_bandwidth(void) {
+    welch_psd_t estimator;
+    CHECK(WelchPsd_Init(&estimator, SIZE, RATE, WELCH_WINDOW_HANN, 50, 0.25f, psd));
+    make_noise(8000);
+    WelchPsd_Process(&estimator, samples, RATE);
+    welch_bands_t bands = WelchPsd_Bands(&estimator);
+
+    // Each octave is twice as wide as the one below: +3 dB.
+    for (int b = 3; b < WELCH_OCTAVE_BANDS; b++) {
+        int step = bands.octave_db[b] - bands.octave_db[b - 1];
+        CHECK(step >= 2 && step <= 4);
+    }
+    CHECK(bands.fluctuation_db <= 1);
+    CHECK(bands.peak_to_mean_db >= 6 && bands.peak_to_mean_db <= 11);
+
+    // Bands above the Nyquist frequency of an 8 kHz stream stay at the floor.
+    welch_psd_t slow;
+    CHECK(WelchPsd_Init(&slow, 256, 8000, WELCH_WINDOW_HANN, 50, 0.25f, psd));
+    WelchPsd_Process(&slow, samples, 8000);
+    CHECK(WelchPsd_Bands(&slow).third_octave_db[WELCH_THIRD_OCTAVE_BANDS - 1] == WELCH_BAND_FLOOR_DB);
+    CHECK(WelchPsd_Bands(&slow).octave_db[0] > WELCH_BAND_FLOOR_DB);
+    WelchPsd_Free(&slow);
+    WelchPsd_Free(&estimator);
+}
+
+static void bench_overlaps(void) {
+    const int overlaps[] = { 50, 75 };
+    make_noise(8000);
+    printf("\n");
+    for (size_t i = 0; i < 2; i++) {
+        welch_psd_t estimator;
+        CHECK(WelchPsd_Init(&estimator, SIZE, RATE, WELCH_WINDOW_HANN, overlaps[i], 0.25f, psd));
+        double start = test_now_s();
+        for (int second = 0; second < BENCH_SECONDS; second++) {
+            WelchPsd_Process(&estimator, samples, RATE);
+        }
+        double us = (test_now_s() - start) * 1e6 / BENCH_SECONDS;
+        printf("%d%% overlap: %.0f us per second of audio (%u frames)\n",
+            overlaps[i], us, estimator.frames / BENCH_SECONDS);
+        WelchPsd_Free(&estimator);
+    }
+}
+
+int main(void) {
+    test_windows_are_shared();
+    test_overlap_sets_the_frame_rate();
+    test_psd_integrates_to_the_mean_square();
+    test_tone_lands_in_its_bands();
+    test_white_noise_rises_with_bandwidth();
+    bench_overlaps();
+    printf("welch_psd_test: OK\n");
+    return 0;
+}
@@ -10,6 +10,7 @@
  */
 
 #include "esp_log.h"
+#include "nvs_flash.h"
 
 #include "core2forAWS.h"
 #include "read_hho_measures.h"
@@ -23,6 +24,14 @@ void app_main()
     // Indicate that the device is on and recording.
     Core2ForAWS_LED_Enable(1);
 
+    // Initialize NVS (Wi-Fi and the gas sensor baseline are stored there)
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+
     UI_Init(3);
     Read_HHO_Measures_Task_Init(2);
     AWS_IoT_Update_Task_Init(1);
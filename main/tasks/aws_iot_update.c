@@ -5,10 +5,12 @@
 #include <limits.h>
 #include <string.h>
 #include <math.h>
+#include <stdarg.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 
 #include "aws_iot_config.h"
@@ -19,12 +21,19 @@
 
 #include "core2forAWS.h"
 #include "read_hho_measures.h"
+#include "measure_stats.h"
+#include "hho_json.h"
 #include "aws_iot_update.h"
+#include "mqtt_io.h"
 #include "wifi.h"
 #include "ui.h"
 
-#define MAX_LENGTH_OF_JSON_BUFFER 400
+// Room for the summaries of all three windows closing at once (about 120
+// bytes per measure and window), the measures and the notifications.
+#define MAX_LENGTH_OF_JSON_BUFFER 4608
 #define MAX_LENGTH_OF_NOTIFICATIONS 200
+#define MAX_LENGTH_OF_STATS 4096
+#define STATS_WINDOW_COUNT 3
 #define CLIENT_ID_LEN (ATCA_SERIAL_NUM_SIZE * 2)
 
 static const char *TAG = "aws_iot_update_task";
@@ -41,25 +50,62 @@ uint32_t mqttPort = AWS_IOT_MQTT_PORT;
 static hho_measures_t _hhoMeasures;
 static char notificationBuffer[MAX_LENGTH_OF_NOTIFICATIONS] = "No current notifications";
 static uint8_t notificationsCount = 0;
-static bool _shadowUpdateInProgress;
+// Set by the update task, cleared from the MQTT I/O task once the update is done
+static volatile bool _shadowUpdateInProgress;
+
+// The delta callbacks run on the MQTT I/O task; the SDK parses deltas into
+// these, and the callbacks copy them into the reported fields under the lock.
+static char recommendationsDelta[MAX_LENGTH_OF_NOTIFICATIONS];
+static uint8_t recommendationCountDelta;
+static SemaphoreHandle_t reportedLock;
+
+// Read positions in the HHO measure rings for shadow updates
+static sample_cursor_t measureCursors[HHO_MEASURE_COUNT];
+
+// Shadow keys of each HHO measure, indexed by hho_measure_t
+#define MEASURE_KEY(id, field, type, key, ...) key,
+static const char *measureKeys[HHO_MEASURE_COUNT] = {
+    HHO_MEASURES(MEASURE_KEY)
+};
+
+static const uint32_t statsWindowSeconds[STATS_WINDOW_COUNT] = {
+    CONFIG_HHO_STATS_SHORT_WINDOW_SEC,
+    CONFIG_HHO_STATS_MEDIUM_WINDOW_SEC,
+    CONFIG_HHO_STATS_LONG_WINDOW_SEC
+};
+
+// Streaming statistics per window length and measure, and whether a window
+// has closed since its summary was last reported.
+static tumbling_window_t statsWindows[STATS_WINDOW_COUNT][HHO_MEASURE_COUNT];
+static bool statsPending[STATS_WINDOW_COUNT][HHO_MEASURE_COUNT];
+static char statsBuffer[MAX_LENGTH_OF_STATS] = "{}";
 
 // JSON Document Buffer and related fields to be initialized.
 char JsonDocumentBuffer[MAX_LENGTH_OF_JSON_BUFFER];
 size_t sizeOfJsonDocumentBuffer = sizeof(JsonDocumentBuffer) / sizeof(JsonDocumentBuffer[0]);
-jsonStruct_t temperatureHandler;
-jsonStruct_t soundHandler;
-jsonStruct_t lightHandler;
-jsonStruct_t tvocHandler;
-jsonStruct_t eCO2Handler;
 jsonStruct_t recommendationsHandler;
 jsonStruct_t recommendationCountHandler;
 
+// Fields of the reported state, in document order.
+#define REPORTED_FIELD(id, field, type, key, jsonType, ...) \
+    HHO_JSON_FIELD(key, jsonType, &_hhoMeasures.field),
+static const hho_json_field_t reportedFields[] = {
+    HHO_MEASURES(REPORTED_FIELD)
+    HHO_JSON_FIELD("notifications", SHADOW_JSON_STRING, notificationBuffer),
+    HHO_JSON_FIELD("notificationCount", SHADOW_JSON_INT8, &notificationsCount),
+    // The window statistics, a pre-serialized JSON object
+    HHO_JSON_FIELD("stats", SHADOW_JSON_OBJECT, statsBuffer),
+};
+
 void notification_message_callback(const char *pJsonString, uint32_t jsonStringDataLen, jsonStruct_t *pContext) {
     IOT_UNUSED(pJsonString);
     IOT_UNUSED(jsonStringDataLen);
 
     char * recommendations = (char *)(pContext->pData);
     ESP_LOGI(TAG, "Updating recommendations with: %s", recommendations);
+    xSemaphoreTake(reportedLock, portMAX_DELAY);
+    strlcpy(notificationBuffer, recommendations, sizeof(notificationBuffer));
+    xSemaphoreGive(reportedLock);
     UI_Recommendations_Textarea_Update(recommendations);
 }
 
@@ -69,60 +115,128 @@ void notification_count_callback(const char *pJsonString, uint32_t jsonStringDat
 
     uint8_t newCount = *(uint8_t *) (pContext->pData);
     ESP_LOGI(TAG, "Update recommendations count to %d", newCount);    
+    xSemaphoreTake(reportedLock, portMAX_DELAY);
+    notificationsCount = newCount;
+    xSemaphoreGive(reportedLock);
     UI_Recommendations_Count_Update(newCount);
 }
 
 void initialize_JSON_buffer_fields() {
-    // Initialize temperature field
-    temperatureHandler.cb = NULL;
-    temperatureHandler.pKey = "temperature";
-    temperatureHandler.pData = &(_hhoMeasures.temperature);
-    temperatureHandler.type = SHADOW_JSON_FLOAT;
-    temperatureHandler.dataLength = sizeof(float);
-
-    // Initialize sound field
-    soundHandler.cb = NULL;
-    soundHandler.pKey = "noiseLevel";
-    soundHandler.pData = &(_hhoMeasures.noiseLevel);
-    soundHandler.type = SHADOW_JSON_INT8;
-    soundHandler.dataLength = sizeof(uint8_t);
-
-    // Initialize the light field
-    lightHandler.cb = NULL;
-    lightHandler.pKey = "lightIntensity";
-    lightHandler.pData = &(_hhoMeasures.lightIntensity);
-    lightHandler.type = SHADOW_JSON_INT32;
-    lightHandler.dataLength = sizeof(uint32_t);
-
-    // Initialize the tvoc field
-    tvocHandler.cb = NULL;
-    tvocHandler.pKey = "tvoc";
-    tvocHandler.pData = &(_hhoMeasures.tvoc);
-    tvocHandler.type = SHADOW_JSON_INT8;
-    tvocHandler.dataLength = sizeof(uint8_t);
-
-    // Initialize the eCO2 field
-    eCO2Handler.cb = NULL;
-    eCO2Handler.pKey = "eCO2";
-    eCO2Handler.pData = &(_hhoMeasures.eC02);
-    eCO2Handler.type = SHADOW_JSON_INT8;
-    eCO2Handler.dataLength = sizeof(uint8_t);
-
     // Initializes the notifications field
     recommendationsHandler.cb = notification_message_callback;
     recommendationsHandler.pKey = "notifications";
-    recommendationsHandler.pData = &notificationBuffer;
+    recommendationsHandler.pData = recommendationsDelta;
     recommendationsHandler.type = SHADOW_JSON_STRING;
     recommendationsHandler.dataLength = MAX_LENGTH_OF_NOTIFICATIONS;
 
     // Initialize the notifications count field
     recommendationCountHandler.cb = notification_count_callback;
     recommendationCountHandler.pKey = "notificationCount";
-    recommendationCountHandler.pData = &notificationsCount;
+    recommendationCountHandler.pData = &recommendationCountDelta;
     recommendationCountHandler.type = SHADOW_JSON_INT8;
     recommendationCountHandler.dataLength = sizeof(uint8_t);
 }
 
+void initialize_stats_windows() {
+    for (int w = 0; w < STATS_WINDOW_COUNT; w++) {
+        for (int i = 0; i < HHO_MEASURE_COUNT; i++) {
+            TumblingWindow_Init(&statsWindows[w][i], statsWindowSeconds[w] * 1000,
+                CONFIG_HHO_STATS_PERCENTILE / 100.0f);
+            statsPending[w][i] = false;
+        }
+    }
+}
+
+/** Drains every sample recorded since the last call into the window statistics. */
+void collect_HHO_measures() {
+    hho_sample_t samples[SAMPLE_RING_CAPACITY];
+
+    for (int i = 0; i < HHO_MEASURE_COUNT; i++) {
+        uint32_t dropped = measureCursors[i].dropped;
+        size_t count = Read_HHO_Measures_Since(i, &measureCursors[i], samples, SAMPLE_RING_CAPACITY);
+        if (measureCursors[i].dropped != dropped) {
+            ESP_LOGW(TAG, "Missed %u samples of measure %d", measureCursors[i].dropped - dropped, i);
+        }
+        ESP_LOGD(TAG, "Collected %u samples of measure %d", (unsigned)count, i);
+
+        for (size_t s = 0; s < count; s++) {
+            for (int w = 0; w < STATS_WINDOW_COUNT; w++) {
+                if (TumblingWindow_Add(&statsWindows[w][i], &samples[s])) {
+                    statsPending[w][i] = true;
+                }
+            }
+        }
+    }
+
+    _hhoMeasures = Read_HHO_Measures();
+}
+
+static bool stats_append(size_t *len, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(statsBuffer + *len, MAX_LENGTH_OF_STATS - *len, format, args);
+    va_end(args);
+
+    if (written < 0 || *len + written >= MAX_LENGTH_OF_STATS) {
+        return false;
+    }
+    *len += written;
+    return true;
+}
+
+/**
+ * Serializes the summaries of the windows that closed since the previous
+ * report into statsBuffer, e.g.
+ * {"10s":{"temperature":{"start":..,"n":..,"min":..,"max":..,"mean":..,"var":..,"p90":..}}}
+ * Each window is reported once; the shadow keeps the last reported summary.
+ *
+ * @return false if the summaries did not fit in statsBuffer.
+ */
+bool serialize_HHO_stats() {
+    size_t len = 0;
+    bool ok = stats_append(&len, "{");
+
+    for (int w = 0; ok && w < STATS_WINDOW_COUNT; w++) {
+        bool firstMeasure = true;
+        for (int i = 0; ok && i < HHO_MEASURE_COUNT; i++) {
+            if (!statsPending[w][i]) {
+                continue;
+            }
+
+            if (firstMeasure) {
+                uint32_t seconds = statsWindowSeconds[w];
+                const char *separator = (len > 1) ? "," : "";
+                ok = (seconds % 60 == 0)
+                    ? stats_append(&len, "%s\"%um\":{", separator, seconds / 60)
+                    : stats_append(&len, "%s\"%us\":{", separator, seconds);
+                firstMeasure = false;
+            } else {
+                ok = stats_append(&len, ",");
+            }
+
+            const window_summary_t *summary = &statsWindows[w][i].last;
+            ok = ok && stats_append(&len,
+                "\"%s\":{\"start\":%u,\"n\":%u,\"min\":%.2f,\"max\":%.2f,\"mean\":%.2f,\"var\":%.3f,\"p%d\":%.2f}",
+                measureKeys[i], summary->window_start_ms, summary->count, summary->min, summary->max,
+                summary->mean, summary->variance, CONFIG_HHO_STATS_PERCENTILE, summary->percentile);
+        }
+        if (ok && !firstMeasure) {
+            ok = stats_append(&len, "}");
+        }
+    }
+    ok = ok && stats_append(&len, "}");
+
+    if (!ok) {
+        ESP_LOGE(TAG, "Window statistics do not fit in %d bytes", MAX_LENGTH_OF_STATS);
+        strcpy(statsBuffer, "{}");
+    }
+    return ok;
+}
+
+void clear_pending_HHO_stats() {
+    memset(statsPending, 0, sizeof(statsPending));
+}
+
 void mqtt_disconnect_callback_handler(AWS_IoT_Client *clientPtr, void *data) {
     ESP_LOGW(TAG, "Disconnected from AWS IoT Core");
     UI_Status_Textarea_Add("Disconnected from AWS IoT Core...", NULL, 0);
@@ -162,7 +276,8 @@ void shadow_update_status_callback(const char *namePtr, ShadowActions_t action,
 }
 
 void update_task(void *param) {
-    AWS_IoT_Client iotCoreClient;
+    // Static: the MQTT I/O task uses it until it has disconnected
+    static AWS_IoT_Client iotCoreClient;
 
     // Initialize the MQTT client
     ShadowInitParameters_t sp = ShadowInitParametersDefault;
@@ -225,64 +340,72 @@ void update_task(void *param) {
         ESP_LOGE(TAG, "Unable to register callback for recommendations count.");
     }
 
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    for (int i = 0; i < HHO_MEASURE_COUNT; i++) {
+        measureCursors[i] = Read_HHO_Measures_Cursor(i);
+    }
+    initialize_stats_windows();
+
+    // From here on the I/O task owns the client; it runs the delta callbacks
+    // as soon as they arrive and sends the updates posted below.
+    if (!MQTT_IO_Start(&iotCoreClient, uxTaskPriorityGet(NULL) + 1)) {
+        ESP_LOGE(TAG, "Unable to start the MQTT I/O task.");
+        abort();
+    }
+
+    TickType_t lastUpdate = xTaskGetTickCount();
+    while (MQTT_IO_Is_Running()) {
+        // Perform update every 10 seconds
+        vTaskDelayUntil(&lastUpdate, pdMS_TO_TICKS(10000));
+
+        // Keep aggregating while an update is pending, so that no samples
+        // are lost from the window statistics.
+        collect_HHO_measures();
 
-    while(rc == NETWORK_ATTEMPTING_RECONNECT || 
-        rc == NETWORK_RECONNECTED || 
-        rc == SUCCESS) {
-        rc = aws_iot_shadow_yield(&iotCoreClient, 1000);
-        if (rc == NETWORK_ATTEMPTING_RECONNECT || _shadowUpdateInProgress) {
-            // Skip the rest of the loop while waiting for a reconnect/pending update
+        if (_shadowUpdateInProgress) {
+            // JsonDocumentBuffer still belongs to the pending update
             continue;
         }
-        
-        _hhoMeasures = Read_HHO_Measures();
 
+        serialize_HHO_stats();
+
+        xSemaphoreTake(reportedLock, portMAX_DELAY);
         rc = aws_iot_shadow_init_json_document(JsonDocumentBuffer, sizeOfJsonDocumentBuffer);
         if (rc == SUCCESS) {
-            rc = aws_iot_shadow_add_reported(
-                JsonDocumentBuffer, sizeOfJsonDocumentBuffer, 7, 
-                &temperatureHandler, &soundHandler, &lightHandler, 
-                &tvocHandler, &eCO2Handler, &recommendationsHandler,
-                &recommendationCountHandler);
+            rc = HHO_Json_AddReported(JsonDocumentBuffer, sizeOfJsonDocumentBuffer,
+                reportedFields, sizeof(reportedFields) / sizeof(reportedFields[0]));
             if (rc == SUCCESS) {
                 rc = aws_iot_finalize_json_document(JsonDocumentBuffer, sizeOfJsonDocumentBuffer);
-                if (rc == SUCCESS) {
-                    ESP_LOGI(TAG, "Updating shadow device: %s", JsonDocumentBuffer);
-                    rc = aws_iot_shadow_update(&iotCoreClient, clientId, 
-                        JsonDocumentBuffer, shadow_update_status_callback, NULL, 6, true);
-                        _shadowUpdateInProgress = true;
-                } else {
+                if (rc != SUCCESS) {
                     ESP_LOGE(TAG, "Unable to finalize JSON document with error: %d", rc);
                 }
             } else {
                 ESP_LOGE(TAG, "Unable to add reported data with error: %d", rc);
             }
-
         } else {
             ESP_LOGE(TAG, "Unable to initialize the JSON message with error: %d", rc);
         }
-        // Perform update every 10 seconds
-        vTaskDelay(pdMS_TO_TICKS(10000)); 
-    }
-
-    if (rc != SUCCESS) {
-        ESP_LOGE(TAG, "An error occured in the loop: %d", rc);
-    }
-    rc = aws_iot_shadow_disconnect(&iotCoreClient);
+        xSemaphoreGive(reportedLock);
 
-    if (rc != SUCCESS) {
-        ESP_LOGE(TAG, "Disconnect error: %d", rc);
-    } else {
-        ESP_LOGI(TAG, "Successfully disconnected.");
+        if (rc == SUCCESS) {
+            ESP_LOGI(TAG, "Updating shadow device: %s", JsonDocumentBuffer);
+            _shadowUpdateInProgress = true;
+            if (MQTT_IO_Shadow_Update(clientId, JsonDocumentBuffer, shadow_update_status_callback, NULL, 6)) {
+                clear_pending_HHO_stats();
+            } else {
+                ESP_LOGE(TAG, "Unable to queue the shadow update.");
+                _shadowUpdateInProgress = false;
+            }
+        }
     }
 
+    ESP_LOGE(TAG, "The MQTT I/O task stopped, no more shadow updates.");
     vTaskDelete(NULL);
 }
 
 void AWS_IoT_Update_Task_Init(UBaseType_t priority) {
     ESP_LOGI(TAG, "AWS IoT SDK Version %d.%d.%d-%s", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH, VERSION_TAG);
     
+    reportedLock = xSemaphoreCreateMutex();
     initialize_JSON_buffer_fields();
     initialise_wifi();
 
@@ -0,0 +1,149 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hho_json.h"
+
+// Largest magnitude written with the integer formatter; anything above falls
+// back to snprintf.
+#define MAX_FIXED_POINT 1e9
+
+typedef struct {
+    char *position;
+    char *end; // One past the last byte available for text, the NUL excluded
+} json_writer_t;
+
+static inline bool put(json_writer_t *writer, const char *text, size_t length) {
+    if ((size_t)(writer->end - writer->position) < length) {
+        return false;
+    }
+    memcpy(writer->position, text, length);
+    writer->position += length;
+    return true;
+}
+
+static inline bool put_char(json_writer_t *writer, char c) {
+    if (writer->position == writer->end) {
+        return false;
+    }
+    *writer->position++ = c;
+    return true;
+}
+
+// Writes the digits of value right-aligned, ending just before `end`.
+static char *format_digits(char *end, uint32_t value) {
+    do {
+        *--end = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return end;
+}
+
+static bool put_uint(json_writer_t *writer, uint32_t value) {
+    char digits[10];
+    char *start = format_digits(digits + sizeof(digits), value);
+    return put(writer, start, digits + sizeof(digits) - start);
+}
+
+static bool put_int(json_writer_t *writer, int32_t value) {
+    if (value < 0) {
+        return put_char(writer, '-') && put_uint(writer, 0u - (uint32_t)value);
+    }
+    return put_uint(writer, (uint32_t)value);
+}
+
+static bool put_fixed2(json_writer_t *writer, double value) {
+    if (isnan(value) || isinf(value)) {
+        return put(writer, "null", 4);
+    }
+    if (fabs(value) >= MAX_FIXED_POINT) {
+        char text[48];
+        int length = snprintf(text, sizeof(text), "%.2f", value);
+        return length > 0 && (size_t)length < sizeof(text) && put(writer, text, length);
+    }
+
+    uint64_t hundredths = (uint64_t)(fabs(value) * 100.0 + 0.5);
+    uint32_t whole = (uint32_t)(hundredths / 100);
+    uint32_t fraction = (uint32_t)(hundredths % 100);
+
+    char digits[14];
+    char *end = digits + sizeof(digits);
+    *--end = (char)('0' + fraction % 10);
+    *--end = (char)('0' + fraction / 10);
+    *--end = '.';
+    char *start = format_digits(end, whole);
+    if (value < 0 && hundredths != 0) {
+        *--start = '-';
+    }
+    return put(writer, start, digits + sizeof(digits) - start);
+}
+
+static bool put_quoted(json_writer_t *writer, const char *text) {
+    return put_char(writer, '"') && put(writer, text, strlen(text)) && put_char(writer, '"');
+}
+
+static IoT_Error_t put_value(json_writer_t *writer, JsonPrimitiveType type, const void *data) {
+    bool ok;
+    switch (type) {
+        case SHADOW_JSON_INT32:  ok = put_int(writer, *(const int32_t *)data); break;
+        case SHADOW_JSON_INT16:  ok = put_int(writer, *(const int16_t *)data); break;
+        case SHADOW_JSON_INT8:   ok = put_int(writer, *(const int8_t *)data); break;
+        case SHADOW_JSON_UINT32: ok = put_uint(writer, *(const uint32_t *)data); break;
+        case SHADOW_JSON_UINT16: ok = put_uint(writer, *(const uint16_t *)data); break;
+        case SHADOW_JSON_UINT8:  ok = put_uint(writer, *(const uint8_t *)data); break;
+        case SHADOW_JSON_FLOAT:  ok = put_fixed2(writer, *(const float *)data); break;
+        case SHADOW_JSON_DOUBLE: ok = put_fixed2(writer, *(const double *)data); break;
+        case SHADOW_JSON_BOOL:
+            ok = *(const bool *)data ? put(writer, "true", 4) : put(writer, "false", 5);
+            break;
+        case SHADOW_JSON_STRING: ok = put_quoted(writer, (const char *)data); break;
+        case SHADOW_JSON_OBJECT: ok = put(writer, (const char *)data, strlen((const char *)data)); break;
+        default:
+            return SHADOW_JSON_ERROR;
+    }
+    return ok ? SUCCESS : SHADOW_JSON_BUFFER_TRUNCATED;
+}
+
+static IoT_Error_t write_reported(json_writer_t *writer, const hho_json_field_t *fields, size_t count) {
+    static const char reported[] = "\"reported\":{";
+    if (!put(writer, reported, sizeof(reported) - 1)) {
+        return SHADOW_JSON_BUFFER_TRUNCATED;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const hho_json_field_t *field = &fields[i];
+        if (field->data == NULL) {
+            return NULL_VALUE_ERROR;
+        }
+        if (i > 0 && !put_char(writer, ',')) {
+            return SHADOW_JSON_BUFFER_TRUNCATED;
+        }
+        if (!put(writer, field->key, field->keyLength)) {
+            return SHADOW_JSON_BUFFER_TRUNCATED;
+        }
+        IoT_Error_t rc = put_value(writer, field->type, field->data);
+        if (rc != SUCCESS) {
+            return rc;
+        }
+    }
+
+    // Like the SDK, leave a trailing comma for aws_iot_finalize_json_document.
+    return put(writer, "},", 2) ? SUCCESS : SHADOW_JSON_BUFFER_TRUNCATED;
+}
+
+IoT_Error_t HHO_Json_AddReported(char *document, size_t size, const hho_json_field_t *fields, size_t count) {
+    if (document == NULL || (fields == NULL && count > 0)) {
+        return NULL_VALUE_ERROR;
+    }
+
+    size_t length = strlen(document);
+    if (size - length <= 1) {
+        return SHADOW_JSON_ERROR;
+    }
+
+    json_writer_t writer = { document + length, document + size - 1 };
+    IoT_Error_t rc = write_reported(&writer, fields, count);
+    *(rc == SUCCESS ? writer.position : document + length) = '\0';
+    return rc;
+}
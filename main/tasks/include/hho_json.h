@@ -0,0 +1,50 @@
+/**
+ * @file hho_json.h
+ * @brief Serializer for the "reported" section of the shadow document, driven
+ * by a constant field table instead of the SDK's varargs handlers.
+ *
+ * `aws_iot_shadow_add_reported` takes its fields through `va_arg`, calls
+ * `strlen` on the whole document before every field and formats every value
+ * (and every key) with `snprintf`. `HHO_Json_AddReported` walks a `const`
+ * table whose keys are pre-quoted literals of known length, finds the end of
+ * the document once and formats numbers by hand. It produces the same
+ * document layout, so `aws_iot_finalize_json_document` is used unchanged.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_error.h"
+#include "aws_iot_shadow_json_data.h"
+
+/** One reported shadow field. */
+typedef struct {
+    const char *key; // The key, quoted and followed by ':'
+    uint8_t keyLength;
+    JsonPrimitiveType type;
+    const void *data;
+} hho_json_field_t;
+
+/** Builds a `hho_json_field_t` from a key literal, e.g. HHO_JSON_FIELD("tvoc", SHADOW_JSON_UINT16, &tvoc). */
+#define HHO_JSON_FIELD(name, jsonType, pData) { "\"" name "\":", sizeof(name) + 2, (jsonType), (pData) }
+
+/**
+ * @brief Appends `"reported":{...},` to a document started with
+ * `aws_iot_shadow_init_json_document`.
+ *
+ * Values are written like the SDK writes them, except that floats and doubles
+ * have 2 decimals and NaN or infinite values are written as `null`. Strings
+ * are not escaped, and objects are copied verbatim.
+ *
+ * @param[in,out] document The JSON document.
+ * @param[in] size The size of the document buffer.
+ * @param[in] fields The fields to report, in order.
+ * @param[in] count The number of fields.
+ *
+ * @return SUCCESS, NULL_VALUE_ERROR if the document or a field's data is NULL,
+ * SHADOW_JSON_ERROR for an unknown type or SHADOW_JSON_BUFFER_TRUNCATED if the
+ * fields do not fit; on error the document is left as it was.
+ */
+IoT_Error_t HHO_Json_AddReported(char *document, size_t size, const hho_json_field_t *fields, size_t count);
@@ -0,0 +1,37 @@
+/**
+ * @file hho_measures_table.h
+ * @brief The single list of "Healthy Home Office" measures.
+ *
+ * Everything that depends on the set of measures is expanded from
+ * `HHO_MEASURES` at compile time: the fields of `hho_measures_t`, the
+ * `hho_measure_t` ids, the reported shadow fields and their serializer
+ * table, the window statistics keys, the measurements screen and the
+ * recording log line. Adding a measure takes a row here and the code that
+ * samples it in `record_measures`.
+ *
+ * Each row is `X(id, field, type, key, jsonType, format, label, unit, box)`:
+ * - id       the `hho_measure_t` value (also its sample ring index)
+ * - field    the `hho_measures_t` member
+ * - type     the C type of the member
+ * - key      the shadow and statistics key
+ * - jsonType the `JsonPrimitiveType` of the shadow field
+ * - format   the printf conversion of the value for logs and the screen
+ * - label    the name shown on the measurements screen
+ * - unit     appended to the value on the screen (part of the format, so % is %%)
+ * - box      the `measure_box_t` the measure is shown in
+ */
+
+#pragma once
+
+#define HHO_MEASURES(X) \
+    X(HHO_TEMPERATURE,       temperature,      float,    "temperature",      SHADOW_JSON_FLOAT,  "%.2f", "Temperature",   " F",   MEASURE_BOX_TOP_LEFT) \
+    X(HHO_NOISE_LEVEL,       noiseLevel,       float,    "noiseLevel",       SHADOW_JSON_FLOAT,  "%.1f", "Noise Level",   " dBA", MEASURE_BOX_TOP_RIGHT) \
+    X(HHO_NOISE_PEAK,        noisePeak,        float,    "noisePeak",        SHADOW_JSON_FLOAT,  "%.1f", "Noise Peak",    " dBA", MEASURE_BOX_NONE) \
+    X(HHO_NOISE_TYPE,        noiseType,        uint8_t,  "noiseType",        SHADOW_JSON_UINT8,  "%u",   "Noise Type",    "",     MEASURE_BOX_NONE) \
+    X(HHO_LIGHT_INTENSITY,   lightIntensity,   uint32_t, "lightIntensity",   SHADOW_JSON_UINT32, "%u",   "Light Level",   " lx",  MEASURE_BOX_MID_LEFT) \
+    X(HHO_FLICKER_PERCENT,   flickerPercent,   float,    "flickerPercent",   SHADOW_JSON_FLOAT,  "%.1f", "Flicker",       " %%",  MEASURE_BOX_NONE) \
+    X(HHO_FLICKER_INDEX,     flickerIndex,     float,    "flickerIndex",     SHADOW_JSON_FLOAT,  "%.2f", "Flicker Index", "",     MEASURE_BOX_NONE) \
+    X(HHO_FLICKER_FREQUENCY, flickerFrequency, uint16_t, "flickerFrequency", SHADOW_JSON_UINT16, "%u",   "Flicker Freq",  " Hz",  MEASURE_BOX_NONE) \
+    X(HHO_TVOC,              tvoc,             uint16_t, "tvoc",             SHADOW_JSON_UINT16, "%u",   "TVOC",          " ppb", MEASURE_BOX_MID_RIGHT) \
+    X(HHO_ECO2,              eC02,             uint16_t, "eCO2",             SHADOW_JSON_UINT16, "%u",   "eCO2",          " ppm", MEASURE_BOX_MID_RIGHT) \
+    X(HHO_ACTIVITY,          activity,         float,    "activity",         SHADOW_JSON_FLOAT,  "%.2f", "Activity",      " mg",  MEASURE_BOX_NONE)
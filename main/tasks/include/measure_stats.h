@@ -0,0 +1,95 @@
+/**
+ * @file measure_stats.h
+ * @brief Streaming (O(1) per sample) statistics over tumbling time windows.
+ *
+ * Each window keeps count/min/max/mean/variance (Welford) and a P-square estimate
+ * of one percentile, so no raw samples are buffered. When a sample arrives
+ * that belongs to a later window, the running statistics are frozen into a
+ * `window_summary_t` and a new window is started.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sample_ring.h"
+
+/**
+ * P-square streaming quantile estimator (Jain & Chlamtac, 1985). Tracks a single
+ * quantile with five markers.
+ */
+typedef struct {
+    float p;
+    uint32_t count;
+    float heights[5];
+    float positions[5];
+    float desired[5];
+    float increments[5];
+} p2_quantile_t;
+
+/** Running statistics of the samples seen in the current window. */
+typedef struct {
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+    float m2;
+    p2_quantile_t percentile;
+} running_stats_t;
+
+/** Frozen statistics of a completed window. */
+typedef struct {
+    uint32_t window_start_ms;
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+    float variance;
+    float percentile;
+} window_summary_t;
+
+/** A tumbling window of fixed length, aligned to multiples of `period_ms`. */
+typedef struct {
+    uint32_t period_ms;
+    uint32_t window_start_ms;
+    running_stats_t current;
+    window_summary_t last;
+    bool has_last;
+} tumbling_window_t;
+
+/** @brief Initializes a P-square estimator for quantile `p` (0 < p < 1). */
+void P2Quantile_Init(p2_quantile_t *estimator, float p);
+
+/** @brief Adds an observation to the estimator. */
+void P2Quantile_Add(p2_quantile_t *estimator, float x);
+
+/** @brief Returns the current quantile estimate (0 if no observations). */
+float P2Quantile_Get(const p2_quantile_t *estimator);
+
+/** @brief Resets the running statistics, tracking quantile `percentile`. */
+void RunningStats_Init(running_stats_t *stats, float percentile);
+
+/** @brief Adds an observation to the running statistics. */
+void RunningStats_Add(running_stats_t *stats, float x);
+
+/** @brief Returns the (sample) variance of the observations so far. */
+float RunningStats_Variance(const running_stats_t *stats);
+
+/**
+ * @brief Initializes a tumbling window.
+ *
+ * @param period_ms length of each window.
+ * @param percentile quantile (0 < p < 1) to estimate within each window.
+ */
+void TumblingWindow_Init(tumbling_window_t *window, uint32_t period_ms, float percentile);
+
+/**
+ * @brief Adds a sample to the window it belongs to.
+ *
+ * Samples must be added in timestamp order.
+ *
+ * @return true if the sample closed the previous window, in which case its
+ * statistics are available in `window->last`.
+ */
+bool TumblingWindow_Add(tumbling_window_t *window, const hho_sample_t *sample);
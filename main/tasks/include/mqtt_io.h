@@ -0,0 +1,70 @@
+/**
+ * @file mqtt_io.h
+ * @brief A FreeRTOS task that owns a connected AWS IoT MQTT client.
+ *
+ * The task sleeps in select() until the TLS socket is readable, a request is
+ * posted or the client has timed work due (keep-alive ping, shadow response
+ * timeout, publish retransmission, reconnect). Incoming messages, and with
+ * them the shadow delta callbacks, are handled as soon as they arrive.
+ *
+ * The SDK is not thread safe, so other tasks publish by posting a request.
+ * Their cadence then does not depend on network latency: a request returns
+ * as soon as it is queued, and its callback runs on the I/O task once the
+ * message is acknowledged or has failed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "aws_iot_mqtt_client_interface.h"
+#include "aws_iot_shadow_interface.h"
+
+/** Requests that can wait for the I/O task. */
+#define MQTT_IO_QUEUE_LENGTH 8
+
+/**
+ * @brief Starts the I/O task for a client that is already connected.
+ *
+ * From then on only the I/O task may use the client, and every callback
+ * registered with it runs on the I/O task. The task disconnects the client
+ * and stops when the connection is lost for good.
+ *
+ * @note Creates a FreeRTOS task with the name `MQTT_IO_Task`.
+ *
+ * @return false if the task or its wake-up socket could not be created.
+ */
+bool MQTT_IO_Start(AWS_IoT_Client *client, UBaseType_t priority);
+
+/**
+ * @brief Queues an update of a thing's shadow, see `aws_iot_shadow_update`.
+ *
+ * `thingName` and `jsonDocument` must stay valid until `callback` runs. If
+ * the update cannot be sent, `callback` runs with `SHADOW_ACK_TIMEOUT`, as it
+ * does when no response arrives.
+ *
+ * @return false if the queue is full or the I/O task has stopped; `callback`
+ * will not run.
+ */
+bool MQTT_IO_Shadow_Update(const char *thingName, char *jsonDocument, fpActionCallback_t callback,
+    void *context, uint8_t timeoutSec);
+
+/**
+ * @brief Queues a publish, see `aws_iot_mqtt_publish_async`.
+ *
+ * QoS 1 messages are pipelined in the client's in-flight window; `callback`
+ * runs once the PUBACK arrives or the retransmissions ran out. For QoS 0 it
+ * runs once the message is sent. `topic` and the payload must stay valid
+ * until then.
+ *
+ * @return false if the queue is full or the I/O task has stopped; `callback`
+ * will not run.
+ */
+bool MQTT_IO_Publish(const char *topic, uint16_t topicLen, const IoT_Publish_Message_Params *params,
+    pPublishCompleteHandler_t callback, void *context);
+
+/** @brief Whether the I/O task is still running. */
+bool MQTT_IO_Is_Running();
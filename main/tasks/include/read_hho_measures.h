@@ -1,7 +1,8 @@
 /**
  * @file read_hho_measures.h
- * @brief Initialize a task that records the "Healthy Home Office" measures
- * every second and publishes the results to a queue for other tasks to
+ * @brief Initialize the sensor scheduler task that polls the HHO peripherals,
+ * records the "Healthy Home Office" measures every second and publishes the
+ * results to lock-free sample rings (one per measure) for other tasks to
  * consume.
  */
 
@@ -10,23 +11,49 @@
 #include <ctype.h>
 #include "freertos/task.h"
 
+#include "sample_ring.h"
+
+#include "hho_measures_table.h"
+
+#define HHO_MEASURE_FIELD(id, field, type, ...) type field;
+#define HHO_MEASURE_ID(id, ...) id,
+
 /**
  * Represents the expected collection of measures captured by this task.
 */
 typedef struct _hho_measures_t {
-    float temperature;
-    uint8_t noiseLevel;
-    uint32_t lightIntensity;
-    uint8_t tvoc;
-    uint8_t eC02;
+    HHO_MEASURES(HHO_MEASURE_FIELD)
 } hho_measures_t;
 
+/** Identifies the sample ring of each measure in `hho_measures_t`. */
+typedef enum {
+    HHO_MEASURES(HHO_MEASURE_ID)
+    HHO_MEASURE_COUNT
+} hho_measure_t;
+
 /**
- * @brief Initializes the task to aggregate the various HHO measures.
+ * @brief Initializes the HHO peripherals and starts the sensor scheduler task
+ * that polls them and aggregates the various HHO measures.
  * 
  * @param priority of the task (lower values indicate lower priorities).
  */
 void Read_HHO_Measures_Task_Init(UBaseType_t priority);
 
-/** @brief Returns the latest recorded HHO measures. */
-hho_measures_t Read_HHO_Measures();
\ No newline at end of file
+/** @brief Returns the latest recorded HHO measures. Does not block. */
+hho_measures_t Read_HHO_Measures();
+
+/**
+ * @brief Creates a cursor positioned at the next sample recorded for the
+ * given measure.
+ *
+ * Each consumer should keep its own cursor per measure.
+ */
+sample_cursor_t Read_HHO_Measures_Cursor(hho_measure_t measure);
+
+/**
+ * @brief Copies up to `max` samples of the given measure recorded since the
+ * cursor's last read (oldest first). Does not block.
+ *
+ * @return the number of samples copied into `out`.
+ */
+size_t Read_HHO_Measures_Since(hho_measure_t measure, sample_cursor_t *cursor, hho_sample_t *out, size_t max);
\ No newline at end of file
@@ -0,0 +1,82 @@
+/**
+ * @file sample_ring.h
+ * @brief A lock-free, single-producer/multi-consumer ring of timestamped
+ * samples.
+ *
+ * Each slot in the ring is guarded by its own sequence counter (a seqlock),
+ * so the producer never waits for a consumer and consumers never block the
+ * producer or each other. Consumers keep their own `sample_cursor_t` and can
+ * retrieve every sample written since their last read, as long as they read
+ * before the producer laps them (samples that were overwritten are counted in
+ * `sample_cursor_t.dropped`).
+ *
+ * @note Only one task may call `SampleRing_Push` on a given ring.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Number of samples retained per ring. Must be a power of two. */
+#define SAMPLE_RING_CAPACITY 64
+
+/** A single timestamped reading. */
+typedef struct {
+    uint32_t timestamp_ms;
+    float value;
+} hho_sample_t;
+
+typedef struct {
+    atomic_uint seq;
+    atomic_uint timestamp_ms;
+    atomic_uint value_bits;
+} sample_slot_t;
+
+/** Ring of the most recent `SAMPLE_RING_CAPACITY` samples for one sensor. */
+typedef struct {
+    atomic_uint head;
+    sample_slot_t slots[SAMPLE_RING_CAPACITY];
+} sample_ring_t;
+
+/** Per-consumer read position within a `sample_ring_t`. */
+typedef struct {
+    uint32_t next;
+    uint32_t dropped;
+} sample_cursor_t;
+
+/** @brief Resets the ring to an empty state. Not safe against concurrent use. */
+void SampleRing_Init(sample_ring_t *ring);
+
+/**
+ * @brief Appends a sample, overwriting the oldest one once the ring is full.
+ *
+ * Wait-free. Must only be called from the ring's single producer.
+ */
+void SampleRing_Push(sample_ring_t *ring, uint32_t timestamp_ms, float value);
+
+/**
+ * @brief Creates a cursor that starts reading at the next sample written.
+ */
+sample_cursor_t SampleRing_Cursor(const sample_ring_t *ring);
+
+/**
+ * @brief Copies up to `max` samples written since the cursor's last read into
+ * `out` (oldest first) and advances the cursor.
+ *
+ * If the producer has overwritten samples the cursor had not read yet, the
+ * cursor skips ahead to the oldest sample still available and the number of
+ * skipped samples is added to `cursor->dropped`.
+ *
+ * @return the number of samples copied into `out`.
+ */
+size_t SampleRing_Read(const sample_ring_t *ring, sample_cursor_t *cursor, hho_sample_t *out, size_t max);
+
+/**
+ * @brief Reads the most recently written sample.
+ *
+ * @return false if nothing has been written to the ring yet.
+ */
+bool SampleRing_Latest(const sample_ring_t *ring, hho_sample_t *out);
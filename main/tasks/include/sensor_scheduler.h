@@ -0,0 +1,77 @@
+/**
+ * @file sensor_scheduler.h
+ * @brief A single FreeRTOS task that runs every periodic sensor read.
+ *
+ * Sensors register a `sensor_descriptor_t` with their period, read callback
+ * and deadline. The scheduler keeps them in a hashed timer wheel and runs the
+ * callbacks that are due from its own stack, so drivers do not need a task or
+ * a mutex of their own: every callback runs on the same task.
+ *
+ * For each sensor the scheduler tracks how late reads start (jitter), reads
+ * that finish after their deadline (overruns) and periods that were skipped
+ * because a previous read ran too long.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "timer_wheel.h"
+
+/** Resolution of the scheduler's timer wheel. */
+#define SENSOR_SCHEDULER_TICK_MS 10
+
+typedef void (*sensor_read_fn_t)(void *context);
+
+/** Timing counters of one sensor. */
+typedef struct {
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t skipped;
+    uint32_t last_jitter_us;
+    uint32_t max_jitter_us;
+    uint32_t max_duration_us;
+} sensor_stats_t;
+
+/**
+ * A periodic sensor read. Fill in the fields up to `context`; the rest is
+ * owned by the scheduler. Descriptors must outlive the scheduler.
+ *
+ * `deadline_ms` is relative to the time the read was due, and `offset_ms`
+ * delays the first read after registration.
+ */
+typedef struct {
+    timer_wheel_entry_t timer;
+    const char *name;
+    uint32_t period_ms;
+    uint32_t deadline_ms;
+    uint32_t offset_ms;
+    sensor_read_fn_t read;
+    void *context;
+
+    int64_t release_us;
+    sensor_stats_t stats;
+} sensor_descriptor_t;
+
+/**
+ * @brief Adds a sensor to the scheduler. Its first read is due `offset_ms` from now.
+ *
+ * @note Must be called before `SensorScheduler_Start`.
+ */
+void SensorScheduler_Register(sensor_descriptor_t *sensor);
+
+/**
+ * @brief Starts the scheduler task.
+ *
+ * @note Creates a FreeRTOS task with the name `SensorScheduler_Task`.
+ */
+void SensorScheduler_Start(UBaseType_t priority);
+
+/** @brief Returns a consistent copy of a sensor's timing counters. */
+sensor_stats_t SensorScheduler_GetStats(const sensor_descriptor_t *sensor);
+
+/** @brief Logs the timing counters of every registered sensor. */
+void SensorScheduler_LogStats();
@@ -0,0 +1,56 @@
+/**
+ * @file timer_wheel.h
+ * @brief A hashed timer wheel of intrusive timer entries.
+ *
+ * Timers are hashed into `TIMER_WHEEL_SLOTS` buckets by their expiry tick, so
+ * scheduling is O(1) and advancing the wheel only visits the buckets of the
+ * ticks that elapsed. Expiry ticks wrap around; timers must be scheduled less
+ * than 2^31 ticks ahead.
+ *
+ * @note Not synchronized. Only one task may use a given wheel.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Number of buckets in the wheel. Must be a power of two. */
+#define TIMER_WHEEL_SLOTS 64
+
+/** A timer; embed it in the structure that should be notified on expiry. */
+typedef struct timer_wheel_entry {
+    struct timer_wheel_entry *next;
+    uint32_t expires;
+} timer_wheel_entry_t;
+
+typedef struct {
+    uint32_t next_tick;
+    timer_wheel_entry_t *slots[TIMER_WHEEL_SLOTS];
+} timer_wheel_t;
+
+/** @brief Initializes an empty wheel whose first tick to process is `now`. */
+void TimerWheel_Init(timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Schedules `entry` to expire at tick `expires`.
+ *
+ * Expiry ticks that were already processed expire on the next advance. The
+ * entry must not already be scheduled.
+ */
+void TimerWheel_Schedule(timer_wheel_t *wheel, timer_wheel_entry_t *entry, uint32_t expires);
+
+/**
+ * @brief Processes every tick up to and including `now`.
+ *
+ * @return the expired entries, linked through `next` in expiry order (entries
+ * expiring on the same tick in the order they were scheduled), or NULL.
+ */
+timer_wheel_entry_t *TimerWheel_Advance(timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Finds the earliest expiry tick of the scheduled entries.
+ *
+ * @return false if no entry is scheduled.
+ */
+bool TimerWheel_NextExpiry(const timer_wheel_t *wheel, uint32_t *expires);
@@ -16,6 +16,17 @@ typedef enum
     RECOMMENDATIONS // 'Recommendations' page displaying recommended actions for the user
 } Page;
 
+/** Boxes on the measurements page, each showing one or two measures */
+typedef enum
+{
+    MEASURE_BOX_TOP_LEFT,
+    MEASURE_BOX_TOP_RIGHT,
+    MEASURE_BOX_MID_LEFT,
+    MEASURE_BOX_MID_RIGHT,
+    MEASURE_BOX_COUNT,
+    MEASURE_BOX_NONE = MEASURE_BOX_COUNT // Measure not shown on the screen
+} measure_box_t;
+
 /** Adds a line to the status page. */
 void UI_Status_Textarea_Add(char *txt, char *param, size_t paramLen);
 
@@ -0,0 +1,180 @@
+#include <math.h>
+#include <string.h>
+
+#include "measure_stats.h"
+
+static void sort_floats(float *values, uint32_t count) {
+    for (uint32_t i = 1; i < count; i++) {
+        float value = values[i];
+        uint32_t j = i;
+        while (j > 0 && values[j - 1] > value) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = value;
+    }
+}
+
+static float p2_parabolic(const p2_quantile_t *e, int i, float d) {
+    const float *q = e->heights;
+    const float *n = e->positions;
+    return q[i] + d / (n[i + 1] - n[i - 1]) *
+        ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+         (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+static float p2_linear(const p2_quantile_t *e, int i, int d) {
+    const float *q = e->heights;
+    const float *n = e->positions;
+    return q[i] + d * (q[i + d] - q[i]) / (n[i + d] - n[i]);
+}
+
+void P2Quantile_Init(p2_quantile_t *estimator, float p) {
+    memset(estimator, 0, sizeof(*estimator));
+    estimator->p = p;
+
+    for (int i = 0; i < 5; i++) {
+        estimator->positions[i] = i;
+    }
+    estimator->desired[0] = 0;
+    estimator->desired[1] = 2 * p;
+    estimator->desired[2] = 4 * p;
+    estimator->desired[3] = 2 + 2 * p;
+    estimator->desired[4] = 4;
+    estimator->increments[0] = 0;
+    estimator->increments[1] = p / 2;
+    estimator->increments[2] = p;
+    estimator->increments[3] = (1 + p) / 2;
+    estimator->increments[4] = 1;
+}
+
+void P2Quantile_Add(p2_quantile_t *estimator, float x) {
+    float *q = estimator->heights;
+    float *n = estimator->positions;
+
+    // The first five observations become the initial marker heights.
+    if (estimator->count < 5) {
+        q[estimator->count++] = x;
+        if (estimator->count == 5) {
+            sort_floats(q, 5);
+        }
+        return;
+    }
+    estimator->count++;
+
+    // Find the cell containing x, extending the extreme markers if needed.
+    int k;
+    if (x < q[0]) {
+        q[0] = x;
+        k = 0;
+    } else if (x >= q[4]) {
+        q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= q[k + 1]) {
+            k++;
+        }
+    }
+
+    for (int i = k + 1; i < 5; i++) {
+        n[i] += 1;
+    }
+    for (int i = 0; i < 5; i++) {
+        estimator->desired[i] += estimator->increments[i];
+    }
+
+    // Nudge the middle markers towards their desired positions.
+    for (int i = 1; i < 4; i++) {
+        float d = estimator->desired[i] - n[i];
+        if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+            int step = (d > 0) ? 1 : -1;
+            float candidate = p2_parabolic(estimator, i, step);
+            if (q[i - 1] < candidate && candidate < q[i + 1]) {
+                q[i] = candidate;
+            } else {
+                q[i] = p2_linear(estimator, i, step);
+            }
+            n[i] += step;
+        }
+    }
+}
+
+float P2Quantile_Get(const p2_quantile_t *estimator) {
+    if (estimator->count == 0) {
+        return 0;
+    }
+    if (estimator->count >= 5) {
+        return estimator->heights[2];
+    }
+
+    // Too few observations for the markers; use the exact sample quantile.
+    float sorted[5];
+    memcpy(sorted, estimator->heights, sizeof(sorted));
+    sort_floats(sorted, estimator->count);
+    uint32_t index = (uint32_t)lroundf(estimator->p * (estimator->count - 1));
+    return sorted[index];
+}
+
+void RunningStats_Init(running_stats_t *stats, float percentile) {
+    stats->count = 0;
+    stats->min = 0;
+    stats->max = 0;
+    stats->mean = 0;
+    stats->m2 = 0;
+    P2Quantile_Init(&stats->percentile, percentile);
+}
+
+void RunningStats_Add(running_stats_t *stats, float x) {
+    if (stats->count == 0) {
+        stats->min = x;
+        stats->max = x;
+    } else {
+        stats->min = fminf(stats->min, x);
+        stats->max = fmaxf(stats->max, x);
+    }
+
+    // Welford's online update for the mean and sum of squared differences.
+    stats->count++;
+    float delta = x - stats->mean;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (x - stats->mean);
+
+    P2Quantile_Add(&stats->percentile, x);
+}
+
+float RunningStats_Variance(const running_stats_t *stats) {
+    return (stats->count > 1) ? stats->m2 / (stats->count - 1) : 0;
+}
+
+void TumblingWindow_Init(tumbling_window_t *window, uint32_t period_ms, float percentile) {
+    memset(window, 0, sizeof(*window));
+    window->period_ms = period_ms;
+    RunningStats_Init(&window->current, percentile);
+}
+
+bool TumblingWindow_Add(tumbling_window_t *window, const hho_sample_t *sample) {
+    uint32_t window_start = sample->timestamp_ms - sample->timestamp_ms % window->period_ms;
+    bool closed = false;
+
+    if (window->current.count > 0 && window_start != window->window_start_ms) {
+        const running_stats_t *current = &window->current;
+        window->last.window_start_ms = window->window_start_ms;
+        window->last.count = current->count;
+        window->last.min = current->min;
+        window->last.max = current->max;
+        window->last.mean = current->mean;
+        window->last.variance = RunningStats_Variance(current);
+        window->last.percentile = P2Quantile_Get(&current->percentile);
+        window->has_last = true;
+        closed = true;
+
+        RunningStats_Init(&window->current, current->percentile.p);
+    }
+
+    if (window->current.count == 0) {
+        window->window_start_ms = window_start;
+    }
+    RunningStats_Add(&window->current, sample->value);
+    return closed;
+}
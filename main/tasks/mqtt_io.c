@@ -0,0 +1,293 @@
+#include <errno.h>
+#include <sys/param.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+
+#include "aws_iot_config.h"
+#include "aws_iot_log.h"
+#include "network_platform.h"
+
+#include "mqtt_io.h"
+
+#define MQTT_IO_STACK_SIZE (4096 * 2)
+
+// Time given to each yield. One tick reads whatever has arrived; the rest of
+// a packet still in transit is read after the next wake-up.
+#define MQTT_IO_YIELD_MS portTICK_PERIOD_MS
+
+// Longest a reply written while handling a wake-up is held back for the
+// requests that follow it, so that they leave in one TLS record
+#define MQTT_IO_CORK_MS 20
+
+// How often the record and wire byte counters are logged
+#define MQTT_IO_STATS_PERIOD_MS (10 * 60 * 1000)
+
+typedef enum {
+    MQTT_IO_SHADOW_UPDATE,
+    MQTT_IO_PUBLISH
+} mqtt_io_request_type_t;
+
+typedef struct {
+    mqtt_io_request_type_t type;
+    union {
+        struct {
+            const char *thingName;
+            char *jsonDocument;
+            fpActionCallback_t callback;
+            void *context;
+            uint8_t timeoutSec;
+        } update;
+        struct {
+            const char *topic;
+            uint16_t topicLen;
+            IoT_Publish_Message_Params params;
+            pPublishCompleteHandler_t callback;
+            void *context;
+        } publish;
+    };
+} mqtt_io_request_t;
+
+static const char *TAG = "MQTT_IO_Task";
+static AWS_IoT_Client *ioClient;
+static QueueHandle_t requests;
+static volatile bool running;
+
+// lwIP's select() cannot wait for a task notification, so posting a request
+// wakes the I/O task with a datagram to a loopback socket in its read set.
+static int wakeRx = -1;
+static int wakeTx = -1;
+
+static bool open_wake_sockets() {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addrLen = sizeof(addr);
+
+    wakeRx = socket(AF_INET, SOCK_DGRAM, 0);
+    wakeTx = socket(AF_INET, SOCK_DGRAM, 0);
+    if (wakeRx >= 0 && wakeTx >= 0
+        && bind(wakeRx, (struct sockaddr *)&addr, sizeof(addr)) == 0
+        && getsockname(wakeRx, (struct sockaddr *)&addr, &addrLen) == 0
+        && connect(wakeTx, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        return true;
+    }
+
+    ESP_LOGE(TAG, "Unable to create the wake-up socket: %d", errno);
+    if (wakeRx >= 0) {
+        close(wakeRx);
+    }
+    if (wakeTx >= 0) {
+        close(wakeTx);
+    }
+    wakeRx = wakeTx = -1;
+    return false;
+}
+
+static void drain_wake_socket() {
+    char buf[16];
+    while (recv(wakeRx, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+    }
+}
+
+static bool post_request(const mqtt_io_request_t *request) {
+    if (!running || xQueueSend(requests, request, 0) != pdTRUE) {
+        return false;
+    }
+
+    // Should the datagram be dropped, the request waits for the next timed wake-up.
+    const char wake = 0;
+    send(wakeTx, &wake, sizeof(wake), MSG_DONTWAIT);
+    return true;
+}
+
+/**
+ * Sends a posted request.
+ *
+ * @return false if the publish window is full; the request is retried after
+ * the next yield.
+ */
+static bool run_request(mqtt_io_request_t *request) {
+    IoT_Error_t rc;
+
+    if (request->type == MQTT_IO_SHADOW_UPDATE) {
+        rc = aws_iot_shadow_update(ioClient, request->update.thingName, request->update.jsonDocument,
+            request->update.callback, request->update.context, request->update.timeoutSec, true);
+        if (rc != SUCCESS) {
+            ESP_LOGE(TAG, "Unable to update the shadow, error: %d", rc);
+            if (request->update.callback != NULL) {
+                request->update.callback(request->update.thingName, SHADOW_UPDATE, SHADOW_ACK_TIMEOUT,
+                    NULL, request->update.context);
+            }
+        }
+        return true;
+    }
+
+    rc = aws_iot_mqtt_publish_async(ioClient, request->publish.topic, request->publish.topicLen,
+        &request->publish.params, request->publish.callback, request->publish.context);
+    if (rc == LIMIT_EXCEEDED_ERROR) {
+        return false;
+    }
+    if (rc != SUCCESS) {
+        ESP_LOGE(TAG, "Unable to publish, error: %d", rc);
+    }
+    // The client only calls back for QoS 1 messages it accepted
+    if ((rc != SUCCESS || request->publish.params.qos == QOS0) && request->publish.callback != NULL) {
+        request->publish.callback(ioClient, request->publish.params.id, rc, request->publish.context);
+    }
+    return true;
+}
+
+static void log_stats() {
+    const IoT_Network_Stats *stats = &ioClient->networkStack.stats;
+    if (stats->messages > 0) {
+        ESP_LOGI(TAG, "%u messages in %u TLS records (%u.%02u per message), %u bytes on the wire",
+            stats->messages, stats->records, stats->records / stats->messages,
+            (stats->records % stats->messages) * 100 / stats->messages, stats->wireBytes);
+    }
+
+    const TLSHandshakeStats *handshakes = iot_tls_get_handshake_stats(&ioClient->networkStack.tlsDataParams);
+    uint32_t full = handshakes->handshakes - handshakes->resumed;
+    if (handshakes->handshakes > 0) {
+        ESP_LOGI(TAG, "%u TLS handshakes, %u resumed; %u ms per full handshake, %u ms per resumed one",
+            handshakes->handshakes, handshakes->resumed,
+            full > 0 ? handshakes->fullHandshakeMs / full : 0,
+            handshakes->resumed > 0 ? handshakes->resumedHandshakeMs / handshakes->resumed : 0);
+    }
+}
+
+static void io_task(void *param) {
+    TLSDataParams *tls = &ioClient->networkStack.tlsDataParams;
+    mqtt_io_request_t pending;
+    bool hasPending = false;
+    IoT_Error_t rc = SUCCESS;
+    TickType_t statsLogged = xTaskGetTickCount();
+
+    for (;;) {
+        while (hasPending || xQueueReceive(requests, &pending, 0) == pdTRUE) {
+            hasPending = !run_request(&pending);
+            if (hasPending) {
+                break;
+            }
+        }
+        // Whatever the last yield and the requests wrote goes out together
+        aws_iot_mqtt_uncork(ioClient);
+
+        if (xTaskGetTickCount() - statsLogged >= pdMS_TO_TICKS(MQTT_IO_STATS_PERIOD_MS)) {
+            log_stats();
+            statsLogged = xTaskGetTickCount();
+        }
+
+        // Sleep until the socket is readable, a request is posted or a timer is due
+        uint32_t waitMs = aws_iot_shadow_get_next_yield_ms(ioClient);
+        int fd = -1;
+        if (aws_iot_mqtt_is_client_connected(ioClient)) {
+            fd = iot_tls_get_socket(tls);
+            if (iot_tls_get_bytes_avail(tls) > 0) {
+                // Already decrypted, select() would not see it
+                waitMs = 0;
+            }
+        }
+
+        fd_set readFds;
+        FD_ZERO(&readFds);
+        FD_SET(wakeRx, &readFds);
+        if (fd >= 0) {
+            FD_SET(fd, &readFds);
+        }
+        struct timeval timeout = {
+            .tv_sec = waitMs / 1000,
+            .tv_usec = (waitMs % 1000) * 1000,
+        };
+        int ready = select(MAX(fd, wakeRx) + 1, &readFds, NULL, NULL, waitMs == UINT32_MAX ? NULL : &timeout);
+        if (ready < 0) {
+            ESP_LOGE(TAG, "select failed: %d", errno);
+            vTaskDelay(1);
+            continue;
+        }
+
+        if (ready > 0 && FD_ISSET(wakeRx, &readFds)) {
+            drain_wake_socket();
+            if (ready == 1 && waitMs > 0) {
+                continue;
+            }
+        }
+
+        // A PUBACK or shadow reply written by a callback waits for the requests
+        // the callback may have posted
+        aws_iot_mqtt_cork(ioClient, MQTT_IO_CORK_MS);
+        rc = aws_iot_shadow_yield(ioClient, MQTT_IO_YIELD_MS);
+        if (rc == NETWORK_SSL_READ_TIMEOUT_ERROR || rc == FAILURE) {
+            // Part of a packet arrived, the client keeps it until the rest does
+            rc = SUCCESS;
+        }
+        if (rc != SUCCESS && rc != NETWORK_ATTEMPTING_RECONNECT && rc != NETWORK_RECONNECTED) {
+            break;
+        }
+    }
+
+    ESP_LOGE(TAG, "An error occured in the loop: %d", rc);
+    running = false;
+    log_stats();
+    rc = aws_iot_shadow_disconnect(ioClient);
+    if (rc != SUCCESS) {
+        ESP_LOGE(TAG, "Disconnect error: %d", rc);
+    } else {
+        ESP_LOGI(TAG, "Successfully disconnected.");
+    }
+
+    vTaskDelete(NULL);
+}
+
+bool MQTT_IO_Start(AWS_IoT_Client *client, UBaseType_t priority) {
+    ioClient = client;
+    requests = xQueueCreate(MQTT_IO_QUEUE_LENGTH, sizeof(mqtt_io_request_t));
+    if (requests == NULL || !open_wake_sockets()) {
+        return false;
+    }
+
+    running = true;
+    if (xTaskCreatePinnedToCore(&io_task, TAG, MQTT_IO_STACK_SIZE, NULL, priority, NULL, 1) != pdPASS) {
+        running = false;
+        return false;
+    }
+    return true;
+}
+
+bool MQTT_IO_Shadow_Update(const char *thingName, char *jsonDocument, fpActionCallback_t callback,
+    void *context, uint8_t timeoutSec) {
+    mqtt_io_request_t request = {
+        .type = MQTT_IO_SHADOW_UPDATE,
+        .update = {
+            .thingName = thingName,
+            .jsonDocument = jsonDocument,
+            .callback = callback,
+            .context = context,
+            .timeoutSec = timeoutSec,
+        },
+    };
+    return post_request(&request);
+}
+
+bool MQTT_IO_Publish(const char *topic, uint16_t topicLen, const IoT_Publish_Message_Params *params,
+    pPublishCompleteHandler_t callback, void *context) {
+    mqtt_io_request_t request = {
+        .type = MQTT_IO_PUBLISH,
+        .publish = {
+            .topic = topic,
+            .topicLen = topicLen,
+            .params = *params,
+            .callback = callback,
+            .context = context,
+        },
+    };
+    return post_request(&request);
+}
+
+bool MQTT_IO_Is_Running() {
+    return running;
+}
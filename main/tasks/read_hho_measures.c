@@ -1,79 +1,141 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "esp_log.h"
 
 #include "core2forAWS.h"
 #include "rb_mst_30.h"
 #include "u008.h"
 #include "sound_sensor.h"
+#include "sensor_scheduler.h"
 #include "read_hho_measures.h"
-#include "ui.h"
 
 static const char *TAG = "read_hho_measures_task";
-static SemaphoreHandle_t thread_mutex;
-static hho_measures_t recordedMeasurements;
+static sample_ring_t measureRings[HHO_MEASURE_COUNT];
 
 float temperature;
+float activity;
+
+// Averages the IMU samples drained since the previous record; falls back to
+// a register read if the FIFO could not be drained. Activity needs the
+// drained samples, so it reads 0 rather than the previous record's value.
+void sampleImu() {
+    mpu6886_imu_summary_t summary;
+    if (MPU6886_FifoTakeSummary(&summary)) {
+        temperature = summary.temperature;
+        // Reported in milli-g, a still desk reads about 1 mg.
+        activity = summary.activity * 1000.0f;
+    } else {
+        MPU6886_GetTempData(&temperature);
+        activity = 0;
+    }
+}
 
 float getTemperature() {
-    // Sample temperature
-    MPU6886_GetTempData(&temperature);
     // Convert to Fahrenheit (formula from the code sample)
     return (temperature * 1.8) + 32 - 50;
 }
 
-void read_task(void *param) {
+// Runs on the sensor scheduler after the driver callbacks, so the drivers'
+// latest values can be read without locking.
+void record_measures(void *context) {
+    hho_measures_t recordedMeasurements;
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
 
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    
-    for (;;) {
-        xSemaphoreTake(thread_mutex, portMAX_DELAY);
-        
-        m5s_u008_readout_t gasSensorResult = M5S_U008_GetLatestReadout();
-        recordedMeasurements.lightIntensity = M5S_RBMST30_ReadMilliVolts();
-        recordedMeasurements.noiseLevel = SoundSensor_GetVolume();
-        recordedMeasurements.temperature = getTemperature();
-        recordedMeasurements.tvoc = gasSensorResult.tvoc;
-        recordedMeasurements.eC02 = gasSensorResult.eC02;
-
-        ESP_LOGI(TAG, "Recorded HHO data: {light:%d temp:%f sound:%d tvoc:%d eC02:%d}", 
-                recordedMeasurements.lightIntensity, 
-                recordedMeasurements.temperature,
-                recordedMeasurements.noiseLevel,
-                recordedMeasurements.tvoc,
-                recordedMeasurements.eC02);
-
-        // Update UI to reflect the most recent recorded measures
-        UI_HHO_Measurements_Update(recordedMeasurements);
-
-        xSemaphoreGive(thread_mutex);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    }
+    m5s_u008_readout_t gasSensorResult = M5S_U008_GetLatestReadout();
+    sound_level_readout_t soundLevels = SoundSensor_GetLevels();
+    sampleImu();
+    recordedMeasurements.lightIntensity = M5S_RBMST30_ReadLux();
+    #if CONFIG_M5S_RBMST30_FLICKER
+    flicker_readout_t flicker = M5S_RBMST30_ReadFlicker();
+    recordedMeasurements.flickerPercent = flicker.percent;
+    recordedMeasurements.flickerIndex = flicker.index;
+    recordedMeasurements.flickerFrequency = (uint16_t)(flicker.frequency_hz + 0.5f);
+    #else
+    recordedMeasurements.flickerPercent = 0;
+    recordedMeasurements.flickerIndex = 0;
+    recordedMeasurements.flickerFrequency = 0;
+    #endif
+    recordedMeasurements.noiseLevel = soundLevels.laeq_1s;
+    recordedMeasurements.noisePeak = soundLevels.lafmax;
+    // A sound_class_t: 0 quiet, 1 speech, 2 HVAC, 3 keyboard, 4 music
+    recordedMeasurements.noiseType = SoundSensor_GetNoiseType().label;
+    recordedMeasurements.temperature = getTemperature();
+    recordedMeasurements.tvoc = gasSensorResult.tvoc;
+    recordedMeasurements.eC02 = gasSensorResult.eC02;
+    recordedMeasurements.activity = activity;
+
+    #define PUSH_SAMPLE(id, field, ...) \
+        SampleRing_Push(&measureRings[id], now, recordedMeasurements.field);
+    HHO_MEASURES(PUSH_SAMPLE)
+
+    // e.g. "Recorded HHO data: { temperature:71.60 noiseLevel:45.2 ... }"
+    #define LOG_FORMAT(id, field, type, key, jsonType, format, ...) " " key ":" format
+    #define LOG_VALUE(id, field, ...) , recordedMeasurements.field
+    #define LOG_RECORDED(...) ESP_LOGI(TAG, __VA_ARGS__)
+    LOG_RECORDED("Recorded HHO data: {" HHO_MEASURES(LOG_FORMAT) " }" HHO_MEASURES(LOG_VALUE));
+}
+
+void log_scheduler_stats(void *context) {
+    SensorScheduler_LogStats();
 
-    vTaskDelete(NULL);
+    sound_capture_stats_t sound = SoundSensor_GetCaptureStats();
+    ESP_LOGI(TAG, "sound capture: %u frames, %u dropped, %u DMA overruns, %u pending",
+        sound.frames, sound.dropped_frames, sound.dma_overruns, sound.pending_frames);
 }
 
+// Periodic reads, in the order they run when due on the same tick.
+static sensor_descriptor_t sensorReads[] = {
+    { .name = "light", .period_ms = 100, .deadline_ms = 20, .read = M5S_RBMST30_Poll },
+    #if CONFIG_M5S_RBMST30_FLICKER
+    // Starts a short burst of the light sensor every few seconds, analyzes it when done.
+    { .name = "flicker", .period_ms = 1000, .deadline_ms = 30, .offset_ms = 500, .read = M5S_RBMST30_FlickerPoll },
+    #endif
+    { .name = "gas", .period_ms = 1000, .deadline_ms = 50, .read = M5S_U008_Poll },
+    { .name = "sound", .period_ms = 100, .deadline_ms = 80, .read = SoundSensor_Poll },
+    { .name = "imu", .period_ms = 250, .deadline_ms = 30, .read = MPU6886_FifoPoll },
+    { .name = "record", .period_ms = 1000, .deadline_ms = 50, .offset_ms = 1000, .read = record_measures },
+    { .name = "stats", .period_ms = 60000, .deadline_ms = 100, .offset_ms = 60000, .read = log_scheduler_stats },
+};
+
 void Read_HHO_Measures_Task_Init(UBaseType_t priority) {
-    // Initialize the expected sensor tasks. Assumes Core2ForAWS was already
+    // Initialize the expected sensors. Assumes Core2ForAWS was already
     // initialized.
     #if CONFIG_SOFTWARE_M5S_RBMST30_SUPPORT && CONFIG_SOFTWARE_M5S_U008_SUPPORT
     M5S_RBMST30_Init();
     M5S_U008_Init();
-    SoundSensor_Init();
+    // The capture task must preempt the scheduler to keep the I2S DMA drained.
+    SoundSensor_Init(priority + 1);
+    MPU6886_FifoStart();
     #else
     ESP_LOGE(TAG, "Couldn't initialize the peripherals for HHO measures.");
     return;
     #endif
     
-    thread_mutex = xSemaphoreCreateMutex();
-    xTaskCreatePinnedToCore(&read_task, TAG, 4096*2, NULL, priority, NULL, 1);
+    for (int i = 0; i < HHO_MEASURE_COUNT; i++) {
+        SampleRing_Init(&measureRings[i]);
+    }
+    for (size_t i = 0; i < sizeof(sensorReads) / sizeof(sensorReads[0]); i++) {
+        SensorScheduler_Register(&sensorReads[i]);
+    }
+    SensorScheduler_Start(priority);
+}
+
+static float latest_value(hho_measure_t measure) {
+    hho_sample_t sample;
+    return SampleRing_Latest(&measureRings[measure], &sample) ? sample.value : 0;
 }
 
-// TODO(caterpillai): Consider using a queue (https://www.freertos.org/a00118.html). 
 hho_measures_t Read_HHO_Measures() {
-    xSemaphoreTake(thread_mutex, portMAX_DELAY);
-    hho_measures_t result = recordedMeasurements;
-    xSemaphoreGive(thread_mutex);
+    hho_measures_t result;
+    #define LATEST_VALUE(id, field, type, ...) result.field = (type)latest_value(id);
+    HHO_MEASURES(LATEST_VALUE)
     return result;
 }
+
+sample_cursor_t Read_HHO_Measures_Cursor(hho_measure_t measure) {
+    return SampleRing_Cursor(&measureRings[measure]);
+}
+
+size_t Read_HHO_Measures_Since(hho_measure_t measure, sample_cursor_t *cursor, hho_sample_t *out, size_t max) {
+    return SampleRing_Read(&measureRings[measure], cursor, out, max);
+}
@@ -0,0 +1,122 @@
+#include <string.h>
+
+#include "sample_ring.h"
+
+#define SAMPLE_RING_MASK (SAMPLE_RING_CAPACITY - 1)
+
+_Static_assert((SAMPLE_RING_CAPACITY & SAMPLE_RING_MASK) == 0,
+    "SAMPLE_RING_CAPACITY must be a power of two");
+
+typedef enum {
+    SLOT_READ,
+    SLOT_NOT_READY,
+    SLOT_OVERWRITTEN
+} slot_status_t;
+
+// Slot sequence values: 2 * index + 1 while sample `index` is being written,
+// 2 * index + 2 once it is complete.
+static inline uint32_t complete_seq(uint32_t index) {
+    return 2 * index + 2;
+}
+
+static slot_status_t read_slot(const sample_ring_t *ring, uint32_t index, hho_sample_t *out) {
+    sample_slot_t *slot = (sample_slot_t *)&ring->slots[index & SAMPLE_RING_MASK];
+    uint32_t expected = complete_seq(index);
+
+    uint32_t before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (before != expected) {
+        return ((int32_t)(before - expected) > 0) ? SLOT_OVERWRITTEN : SLOT_NOT_READY;
+    }
+
+    uint32_t timestamp = atomic_load_explicit(&slot->timestamp_ms, memory_order_relaxed);
+    uint32_t value_bits = atomic_load_explicit(&slot->value_bits, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != before) {
+        return SLOT_OVERWRITTEN;
+    }
+
+    out->timestamp_ms = timestamp;
+    memcpy(&out->value, &value_bits, sizeof(out->value));
+    return SLOT_READ;
+}
+
+static inline uint32_t load_head(const sample_ring_t *ring) {
+    return atomic_load_explicit(&((sample_ring_t *)ring)->head, memory_order_acquire);
+}
+
+void SampleRing_Init(sample_ring_t *ring) {
+    atomic_init(&ring->head, 0);
+    for (size_t i = 0; i < SAMPLE_RING_CAPACITY; i++) {
+        atomic_init(&ring->slots[i].seq, 0);
+        atomic_init(&ring->slots[i].timestamp_ms, 0);
+        atomic_init(&ring->slots[i].value_bits, 0);
+    }
+}
+
+void SampleRing_Push(sample_ring_t *ring, uint32_t timestamp_ms, float value) {
+    uint32_t index = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    sample_slot_t *slot = &ring->slots[index & SAMPLE_RING_MASK];
+
+    uint32_t value_bits;
+    memcpy(&value_bits, &value, sizeof(value_bits));
+
+    atomic_store_explicit(&slot->seq, complete_seq(index) - 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&slot->timestamp_ms, timestamp_ms, memory_order_relaxed);
+    atomic_store_explicit(&slot->value_bits, value_bits, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, complete_seq(index), memory_order_release);
+
+    atomic_store_explicit(&ring->head, index + 1, memory_order_release);
+}
+
+sample_cursor_t SampleRing_Cursor(const sample_ring_t *ring) {
+    sample_cursor_t cursor = {
+        .next = load_head(ring),
+        .dropped = 0,
+    };
+    return cursor;
+}
+
+size_t SampleRing_Read(const sample_ring_t *ring, sample_cursor_t *cursor, hho_sample_t *out, size_t max) {
+    size_t count = 0;
+    uint32_t head = load_head(ring);
+
+    while (count < max && cursor->next != head) {
+        // Skip whatever the producer has already overwritten.
+        if ((uint32_t)(head - cursor->next) > SAMPLE_RING_CAPACITY) {
+            uint32_t oldest = head - SAMPLE_RING_CAPACITY;
+            cursor->dropped += oldest - cursor->next;
+            cursor->next = oldest;
+        }
+
+        slot_status_t status = read_slot(ring, cursor->next, &out[count]);
+        if (status == SLOT_READ) {
+            cursor->next++;
+            count++;
+        } else if (status == SLOT_OVERWRITTEN) {
+            // Lapped mid-read; the slot after the one being written is the
+            // oldest sample that is still stable.
+            head = load_head(ring);
+            uint32_t oldest = head - SAMPLE_RING_CAPACITY + 1;
+            cursor->dropped += oldest - cursor->next;
+            cursor->next = oldest;
+        } else {
+            break;
+        }
+    }
+
+    return count;
+}
+
+bool SampleRing_Latest(const sample_ring_t *ring, hho_sample_t *out) {
+    for (;;) {
+        uint32_t head = load_head(ring);
+        if (head == 0) {
+            return false;
+        }
+        if (read_slot(ring, head - 1, out) == SLOT_READ) {
+            return true;
+        }
+    }
+}
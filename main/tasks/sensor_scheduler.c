@@ -0,0 +1,119 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "sensor_scheduler.h"
+
+#define SENSOR_SCHEDULER_MAX_SENSORS 8
+#define TICK_US (SENSOR_SCHEDULER_TICK_MS * 1000)
+
+static const char *TAG = "SensorScheduler_Task";
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static timer_wheel_t wheel;
+static sensor_descriptor_t *sensors[SENSOR_SCHEDULER_MAX_SENSORS];
+static size_t sensorCount;
+
+static inline uint32_t to_tick(int64_t time_us) {
+    // Round up so that a sensor never runs before its release time.
+    return (uint32_t)((time_us + TICK_US - 1) / TICK_US);
+}
+
+static void run_sensor(sensor_descriptor_t *sensor) {
+    int64_t start = esp_timer_get_time();
+    sensor->read(sensor->context);
+    int64_t end = esp_timer_get_time();
+
+    int64_t period_us = (int64_t)sensor->period_ms * 1000;
+    int64_t jitter = start - sensor->release_us;
+    int64_t duration = end - start;
+    bool overrun = end - sensor->release_us > (int64_t)sensor->deadline_ms * 1000;
+
+    // Skip the periods that already passed instead of running back to back.
+    uint32_t skipped = 0;
+    int64_t next_release = sensor->release_us + period_us;
+    if (next_release <= end) {
+        skipped = (end - next_release) / period_us + 1;
+        next_release += skipped * period_us;
+    }
+
+    portENTER_CRITICAL(&stats_mux);
+    sensor->stats.runs++;
+    sensor->stats.overruns += overrun;
+    sensor->stats.skipped += skipped;
+    sensor->stats.last_jitter_us = jitter;
+    if (jitter > sensor->stats.max_jitter_us) {
+        sensor->stats.max_jitter_us = jitter;
+    }
+    if (duration > sensor->stats.max_duration_us) {
+        sensor->stats.max_duration_us = duration;
+    }
+    portEXIT_CRITICAL(&stats_mux);
+
+    if (overrun) {
+        ESP_LOGD(TAG, "%s missed its %ums deadline (ran %lldus, %lldus late)",
+            sensor->name, sensor->deadline_ms, (long long)duration, (long long)jitter);
+    }
+
+    sensor->release_us = next_release;
+    TimerWheel_Schedule(&wheel, &sensor->timer, to_tick(next_release));
+}
+
+static void scheduler_task(void *param) {
+    for (;;) {
+        timer_wheel_entry_t *expired = TimerWheel_Advance(&wheel, esp_timer_get_time() / TICK_US);
+        while (expired != NULL) {
+            // The timer is the first member of the descriptor.
+            sensor_descriptor_t *sensor = (sensor_descriptor_t *)expired;
+            expired = expired->next;
+            run_sensor(sensor);
+        }
+
+        uint32_t next_tick;
+        if (!TimerWheel_NextExpiry(&wheel, &next_tick)) {
+            break;
+        }
+        int64_t wait_us = (int64_t)next_tick * TICK_US - esp_timer_get_time();
+        TickType_t wait_ticks = pdMS_TO_TICKS(wait_us / 1000);
+        vTaskDelay(wait_ticks > 0 ? wait_ticks : 1);
+    }
+
+    ESP_LOGW(TAG, "No sensors registered, stopping.");
+    vTaskDelete(NULL);
+}
+
+void SensorScheduler_Register(sensor_descriptor_t *sensor) {
+    if (sensorCount == SENSOR_SCHEDULER_MAX_SENSORS) {
+        ESP_LOGE(TAG, "Cannot register %s, at most %d sensors are supported.",
+            sensor->name, SENSOR_SCHEDULER_MAX_SENSORS);
+        return;
+    }
+    if (sensorCount == 0) {
+        TimerWheel_Init(&wheel, esp_timer_get_time() / TICK_US);
+    }
+
+    sensor->release_us = esp_timer_get_time() + (int64_t)sensor->offset_ms * 1000;
+    sensor->stats = (sensor_stats_t){ 0 };
+    sensors[sensorCount++] = sensor;
+    TimerWheel_Schedule(&wheel, &sensor->timer, to_tick(sensor->release_us));
+}
+
+void SensorScheduler_Start(UBaseType_t priority) {
+    xTaskCreatePinnedToCore(&scheduler_task, TAG, 4096*2, NULL, priority, NULL, 1);
+}
+
+sensor_stats_t SensorScheduler_GetStats(const sensor_descriptor_t *sensor) {
+    portENTER_CRITICAL(&stats_mux);
+    sensor_stats_t stats = sensor->stats;
+    portEXIT_CRITICAL(&stats_mux);
+    return stats;
+}
+
+void SensorScheduler_LogStats() {
+    for (size_t i = 0; i < sensorCount; i++) {
+        sensor_stats_t stats = SensorScheduler_GetStats(sensors[i]);
+        ESP_LOGI(TAG, "%s: runs %u overruns %u skipped %u jitter %uus (max %uus) max duration %uus",
+            sensors[i]->name, stats.runs, stats.overruns, stats.skipped,
+            stats.last_jitter_us, stats.max_jitter_us, stats.max_duration_us);
+    }
+}
@@ -0,0 +1,104 @@
+#include <stddef.h>
+
+#include "timer_wheel.h"
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+_Static_assert((TIMER_WHEEL_SLOTS & TIMER_WHEEL_MASK) == 0,
+    "TIMER_WHEEL_SLOTS must be a power of two");
+
+static inline bool tick_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+// Inserts entry into a list kept in expiry order, after entries with the
+// same expiry.
+static void insert_ordered(timer_wheel_entry_t **list, timer_wheel_entry_t *entry) {
+    while (*list != NULL && !tick_before(entry->expires, (*list)->expires)) {
+        list = &(*list)->next;
+    }
+    entry->next = *list;
+    *list = entry;
+}
+
+static void collect_expired(timer_wheel_entry_t **slot, uint32_t now, timer_wheel_entry_t **expired) {
+    while (*slot != NULL) {
+        timer_wheel_entry_t *entry = *slot;
+        if (!tick_before(now, entry->expires)) {
+            *slot = entry->next;
+            insert_ordered(expired, entry);
+        } else {
+            slot = &entry->next;
+        }
+    }
+}
+
+void TimerWheel_Init(timer_wheel_t *wheel, uint32_t now) {
+    wheel->next_tick = now;
+    for (size_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        wheel->slots[i] = NULL;
+    }
+}
+
+void TimerWheel_Schedule(timer_wheel_t *wheel, timer_wheel_entry_t *entry, uint32_t expires) {
+    if (tick_before(expires, wheel->next_tick)) {
+        expires = wheel->next_tick;
+    }
+    entry->expires = expires;
+
+    // Appending keeps same-tick entries in scheduling order.
+    timer_wheel_entry_t **slot = &wheel->slots[expires & TIMER_WHEEL_MASK];
+    while (*slot != NULL) {
+        slot = &(*slot)->next;
+    }
+    entry->next = NULL;
+    *slot = entry;
+}
+
+timer_wheel_entry_t *TimerWheel_Advance(timer_wheel_t *wheel, uint32_t now) {
+    timer_wheel_entry_t *expired = NULL;
+    if (tick_before(now, wheel->next_tick)) {
+        return NULL;
+    }
+
+    uint32_t elapsed = now - wheel->next_tick + 1;
+    if (elapsed >= TIMER_WHEEL_SLOTS) {
+        // Every bucket was passed at least once.
+        for (size_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+            collect_expired(&wheel->slots[i], now, &expired);
+        }
+    } else {
+        for (uint32_t tick = wheel->next_tick; tick != now + 1; tick++) {
+            collect_expired(&wheel->slots[tick & TIMER_WHEEL_MASK], now, &expired);
+        }
+    }
+
+    wheel->next_tick = now + 1;
+    return expired;
+}
+
+bool TimerWheel_NextExpiry(const timer_wheel_t *wheel, uint32_t *expires) {
+    // Usually the next expiry is within one revolution of the wheel.
+    for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        uint32_t tick = wheel->next_tick + i;
+        for (const timer_wheel_entry_t *entry = wheel->slots[tick & TIMER_WHEEL_MASK];
+            entry != NULL; entry = entry->next) {
+            if (!tick_before(tick, entry->expires)) {
+                *expires = entry->expires;
+                return true;
+            }
+        }
+    }
+
+    // Otherwise every entry is further away; find the earliest.
+    bool found = false;
+    for (size_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        for (const timer_wheel_entry_t *entry = wheel->slots[i]; entry != NULL; entry = entry->next) {
+            if (!found || tick_before(entry->expires, *expires)) {
+                *expires = entry->expires;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
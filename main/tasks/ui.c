@@ -21,16 +21,29 @@ Page currentPage = DEVICE_LOGS;
 
 // Components in the measurement screen
 static lv_obj_t *measurementScreen;
-static lv_obj_t *temperature;
-static lv_obj_t *tempLabel;
-static lv_obj_t *sound;
-static lv_obj_t *soundLabel;
-static lv_obj_t *light;
-static lv_obj_t *lightLabel;
-static lv_obj_t *gasSensor;
-static lv_obj_t *gasSensorLabel;
+static lv_obj_t *measureBoxes[MEASURE_BOX_COUNT];
+static lv_obj_t *measureBoxLabels[MEASURE_BOX_COUNT];
 static lv_style_t measureBoxStyle;
 
+// Placement of each measurement box on the screen
+static const struct
+{
+    lv_align_t align;
+    lv_coord_t x;
+    lv_coord_t y;
+} measureBoxPositions[MEASURE_BOX_COUNT] = {
+    [MEASURE_BOX_TOP_LEFT] = { LV_ALIGN_IN_TOP_LEFT, 15, 45 },
+    [MEASURE_BOX_TOP_RIGHT] = { LV_ALIGN_IN_TOP_RIGHT, -15, 45 },
+    [MEASURE_BOX_MID_LEFT] = { LV_ALIGN_IN_LEFT_MID, 15, 45 },
+    [MEASURE_BOX_MID_RIGHT] = { LV_ALIGN_IN_RIGHT_MID, -15, 45 },
+};
+
+// Box and name of each HHO measure, indexed by hho_measure_t
+#define MEASURE_BOX(id, field, type, key, jsonType, format, label, unit, box) box,
+static const measure_box_t measureBox[HHO_MEASURE_COUNT] = { HHO_MEASURES(MEASURE_BOX) };
+#define MEASURE_LABEL(id, field, type, key, jsonType, format, label, ...) label,
+static const char *measureLabel[HHO_MEASURE_COUNT] = { HHO_MEASURES(MEASURE_LABEL) };
+
 // Components in the status screen
 static lv_obj_t *statusScreen;
 static lv_obj_t *statusTxt;
@@ -48,6 +61,9 @@ static lv_obj_t *recommendationsFooter;
 
 static char *TAG = "UI";
 
+// Read positions in the HHO measure rings for the measurements screen
+static sample_cursor_t measureCursors[HHO_MEASURE_COUNT];
+
 static void ui_textarea_prune(size_t new_text_length)
 {
     const char *current_text = lv_textarea_get_text(statusTxt);
@@ -117,24 +133,65 @@ void UI_Wifi_Label_Update(bool state)
     xSemaphoreGive(xGuiSemaphore);
 }
 
-char labelText[40];
+#define LABEL_TEXT_LENGTH 48
+
+/** Writes the value of a measure with its unit, e.g. "71.60 F". */
+static int format_measure(char *text, size_t size, hho_measure_t measure, const hho_measures_t *measures)
+{
+    switch (measure)
+    {
+        #define FORMAT_MEASURE(id, field, type, key, jsonType, format, label, unit, box) \
+        case id: \
+            return snprintf(text, size, format unit, measures->field);
+        HHO_MEASURES(FORMAT_MEASURE)
+        default:
+            return snprintf(text, size, "?");
+    }
+}
+
+/**
+ * Writes the text of a measurement box: "Label\n-----\nvalue" for a single
+ * measure and "Label: value\n-----\nLabel: value" for two. Without measures
+ * only the labels are written.
+ */
+static void format_measure_box(char *text, size_t size, measure_box_t box, const hho_measures_t *measures)
+{
+    int shown[2];
+    int count = 0;
+    for (int i = 0; i < HHO_MEASURE_COUNT && count < 2; i++)
+    {
+        if (measureBox[i] == box)
+        {
+            shown[count++] = i;
+        }
+    }
+
+    size_t len = 0;
+    for (int n = 0; n < count && len < size; n++)
+    {
+        int written = snprintf(text + len, size - len, (count == 1) ? "%s\n-----\n" : (n == 0) ? "%s: " : "\n-----\n%s: ",
+            measureLabel[shown[n]]);
+        len += (written > 0) ? written : 0;
+        if (measures != NULL && len < size)
+        {
+            written = format_measure(text + len, size - len, shown[n], measures);
+            len += (written > 0) ? written : 0;
+        }
+    }
+}
+
+static char labelText[LABEL_TEXT_LENGTH];
 
 /** Updates the measurements screen with the given values. */
 void UI_HHO_Measurements_Update(hho_measures_t measures) {
         
     xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
 
-    snprintf(labelText, 40, "Temperature\n-----\n%0.2f F", measures.temperature);
-    lv_label_set_text(tempLabel, labelText);
-
-    snprintf(labelText, 40, "Noise Level\n-----\n%d", measures.noiseLevel);
-    lv_label_set_text(soundLabel, labelText);
-
-    snprintf(labelText, 40, "Light Level\n-----\n%d lm", measures.lightIntensity);
-    lv_label_set_text(lightLabel, labelText);
-
-    snprintf(labelText, 40, "TVOC: %d ppm\n-----\neCO2: %d ppm", measures.tvoc, measures.eC02);
-    lv_label_set_text(gasSensorLabel, labelText);
+    for (int box = 0; box < MEASURE_BOX_COUNT; box++)
+    {
+        format_measure_box(labelText, LABEL_TEXT_LENGTH, box, &measures);
+        lv_label_set_text(measureBoxLabels[box], labelText);
+    }
 
     xSemaphoreGive(xGuiSemaphore);
 }
@@ -182,15 +239,45 @@ void show_recommendations_page()
     xSemaphoreGive(xGuiSemaphore);
 }
 
+/**
+ * Drains the HHO measure rings and redraws the measurements screen if any new
+ * samples were recorded since the last call.
+ */
+static void refresh_measurements()
+{
+    hho_sample_t samples[8];
+    bool updated = false;
+
+    for (int i = 0; i < HHO_MEASURE_COUNT; i++)
+    {
+        while (Read_HHO_Measures_Since(i, &measureCursors[i], samples, 8) > 0)
+        {
+            updated = true;
+        }
+    }
+
+    if (updated)
+    {
+        UI_HHO_Measurements_Update(Read_HHO_Measures());
+    }
+}
+
 /** 
  * Background task that redraws the UI when a new page is selected via the
- * virtual buttons. 
+ * virtual buttons and whenever new measurements are recorded.
  */
 void _ui_task(void *params)
 {
+    for (int i = 0; i < HHO_MEASURE_COUNT; i++)
+    {
+        measureCursors[i] = Read_HHO_Measures_Cursor(i);
+    }
+
     vTaskDelay(pdMS_TO_TICKS(5000));
     for (;;)
     {
+        refresh_measurements();
+
         if (Button_WasPressed(button_left))
         {
             show_status_page();
@@ -256,30 +343,28 @@ void initialize_measurement_page()
     lv_style_set_border_opa(&measureBoxStyle, 0, LV_OPA_30);
     lv_style_set_border_side(&measureBoxStyle, 0, LV_BORDER_SIDE_FULL);
 
-    // Create measurement boxes
-    temperature = lv_obj_create(measurementScreen, NULL);
-    lv_obj_add_style(temperature, 0, &measureBoxStyle);
-    lv_obj_set_size(temperature, 140, 70);
-    lv_obj_align(temperature, NULL, LV_ALIGN_IN_TOP_LEFT, 15, 45);
-    tempLabel = lv_label_create(temperature, NULL);
-    lv_obj_align(tempLabel, NULL, LV_ALIGN_IN_TOP_LEFT, 10, 10);
-    lv_label_set_recolor(tempLabel, true);
-    lv_label_set_text(tempLabel, "Temperature\n-----");
-
-    sound = lv_obj_create(measurementScreen, temperature);
-    lv_obj_align(sound, NULL, LV_ALIGN_IN_TOP_RIGHT, -15, 45);
-    soundLabel = lv_label_create(sound, tempLabel);
-    lv_label_set_text(soundLabel, "Noise Level\n-----");
-
-    light = lv_obj_create(measurementScreen, temperature);
-    lv_obj_align(light, NULL, LV_ALIGN_IN_LEFT_MID, 15, 45);
-    lightLabel = lv_label_create(light, tempLabel);
-    lv_label_set_text(lightLabel, "Light Level\n-----");
-
-    gasSensor = lv_obj_create(measurementScreen, temperature);
-    lv_obj_align(gasSensor, NULL, LV_ALIGN_IN_RIGHT_MID, -15, 45);
-    gasSensorLabel = lv_label_create(gasSensor, tempLabel);
-    lv_label_set_text(gasSensorLabel, "TVOC: \n-----\neCO2: ");
+    // Create measurement boxes, copying the first box's size and label style
+    for (int box = 0; box < MEASURE_BOX_COUNT; box++)
+    {
+        lv_obj_t *copy = (box == 0) ? NULL : measureBoxes[0];
+        measureBoxes[box] = lv_obj_create(measurementScreen, copy);
+        if (box == 0)
+        {
+            lv_obj_add_style(measureBoxes[box], 0, &measureBoxStyle);
+            lv_obj_set_size(measureBoxes[box], 140, 70);
+        }
+        lv_obj_align(measureBoxes[box], NULL, measureBoxPositions[box].align,
+            measureBoxPositions[box].x, measureBoxPositions[box].y);
+
+        measureBoxLabels[box] = lv_label_create(measureBoxes[box], (box == 0) ? NULL : measureBoxLabels[0]);
+        if (box == 0)
+        {
+            lv_obj_align(measureBoxLabels[box], NULL, LV_ALIGN_IN_TOP_LEFT, 10, 10);
+            lv_label_set_recolor(measureBoxLabels[box], true);
+        }
+        format_measure_box(labelText, LABEL_TEXT_LENGTH, box, NULL);
+        lv_label_set_text(measureBoxLabels[box], labelText);
+    }
 }
 
 void UI_Init(UBaseType_t priority)
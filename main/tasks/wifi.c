@@ -3,7 +3,6 @@
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_log.h"
-#include "nvs_flash.h"
 
 #include "wifi.h"
 #include "ui.h"
@@ -32,14 +31,6 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
 }
 
 void initialise_wifi(void){
-    // Initialize NVS
-    esp_err_t err = nvs_flash_init();
-    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        err = nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(err);
-
     wifi_event_group = xEventGroupCreate();
     
     ESP_ERROR_CHECK(esp_netif_init());
@@ -8,13 +8,13 @@
  */ 
 
 SELECT 
-  CASE state.reported.noiseLevel > 100 WHEN true 
+  CASE state.reported.noiseLevel > 70 WHEN true 
     THEN 'Sound levels are too high!'
   END AS state.desired.notifications
-  CASE state.reported.lightIntensity > 2000 WHEN true
+  CASE state.reported.lightIntensity < 100 WHEN true
     THEN "There's too little light!"
   END AS state.desired.notifications
-  CASE state.reported.lightIntensity < 700 WHEN true
+  CASE state.reported.lightIntensity > 2000 WHEN true
     THEN "There's too much light!"
   END AS state.desired.notifications
   CASE state.desired.notifications <> NULL WHEN true